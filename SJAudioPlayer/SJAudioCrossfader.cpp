@@ -0,0 +1,61 @@
+//
+//  SJAudioCrossfader.cpp
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/13.
+//
+
+#include "SJAudioCrossfader.h"
+#include <Accelerate/Accelerate.h>
+#include <algorithm>
+#include <cmath>
+
+SJAudioCrossfader::SJAudioCrossfader() {
+    for ( int i = 0; i <= TABLE_SIZE; ++i ) {
+        double t = (double)i / TABLE_SIZE;
+        mTables[EqualPower][i] = (float)std::sin(t * M_PI_2);
+        mTables[Linear][i] = (float)t;
+        mTables[SCurve][i] = (float)(t * t * (3 - 2 * t));
+    }
+}
+
+void SJAudioCrossfader::begin(int64_t frameCount, Curve curve) {
+    mTable = mTables[curve >= EqualPower && curve <= SCurve ? curve : EqualPower];
+    mDuration = std::max<int64_t>(0, frameCount);
+    mPosition = 0;
+}
+
+void SJAudioCrossfader::end() {
+    mDuration = 0;
+    mPosition = 0;
+}
+
+float SJAudioCrossfader::lookup(double t) const {
+    double x = std::clamp(t, 0.0, 1.0) * TABLE_SIZE;
+    int i = std::min((int)x, TABLE_SIZE - 1);
+    float frac = (float)(x - i);
+    return mTable[i] + (mTable[i + 1] - mTable[i]) * frac;
+}
+
+void SJAudioCrossfader::process(float *const _Nonnull * _Nonnull incoming, float *const _Nonnull * _Nonnull outgoing, int channels, int frameCount) {
+    int n = (int)std::min<int64_t>(std::min(frameCount, MAX_FRAMES), mDuration - mPosition);
+    if ( n <= 0 ) {
+        return;
+    }
+
+    for ( int i = 0; i < n; ++i ) {
+        double t = (double)(mPosition + i) / mDuration;
+        mGainIn[i] = lookup(t);
+        mGainOut[i] = lookup(1 - t);
+    }
+    for ( int ch = 0; ch < channels; ++ch ) {
+        vDSP_vmul(incoming[ch], 1, mGainIn, 1, incoming[ch], 1, n);
+        vDSP_vmul(outgoing[ch], 1, mGainOut, 1, outgoing[ch], 1, n);
+        vDSP_vadd(incoming[ch], 1, outgoing[ch], 1, incoming[ch], 1, n);
+    }
+
+    mPosition += n;
+    if ( mPosition >= mDuration ) {
+        end();
+    }
+}
@@ -0,0 +1,54 @@
+//
+//  SJAudioCrossfader.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/13.
+//
+
+#ifndef SJAudioCrossfader_h
+#define SJAudioCrossfader_h
+
+#include <cstdint>
+
+/// 交叉淡化; SJAudioPlayer 切换音频时前一个音频的结尾淡出, 同时后一个音频的开头淡入;
+///
+/// 淡化曲线预先计算为查找表, 淡出增益取淡入曲线的镜像(gout(t) = gin(1 - t));
+/// process 只做查表插值与 vDSP 的逐点乘加, 不加锁, 不分配内存; 所有方法都应在渲染线程调用;
+class SJAudioCrossfader {
+public:
+    /// 取值与 SJAudioCrossfadeCurve 一致;
+    enum Curve : int {
+        EqualPower, // sin/cos, 中点处两侧各 -3dB, 不相关的两路音频响度保持不变
+        Linear,     // 增益线性变化, 中点处两侧各 -6dB
+        SCurve,     // smoothstep, 两端变化平缓
+    };
+
+    /// 单次 process 的最大采样数;
+    static constexpr int MAX_FRAMES = 4096;
+
+    SJAudioCrossfader();
+
+    /// 开始淡化, 持续 frameCount 个采样; 未知的曲线按等功率处理;
+    void begin(int64_t frameCount, Curve curve);
+    /// 立即结束淡化;
+    void end();
+
+    bool isActive() const { return mDuration > 0; }
+
+    /// 混合 incoming 与 outgoing(各 frameCount 个采样, 不超过 MAX_FRAMES), 结果写入 incoming, outgoing 会被修改;
+    /// 淡化在中途结束时, 之后的 incoming 保持原样;
+    void process(float *const _Nonnull * _Nonnull incoming, float *const _Nonnull * _Nonnull outgoing, int channels, int frameCount);
+
+private:
+    static constexpr int TABLE_SIZE = 1024;
+    float mTables[3][TABLE_SIZE + 1]; // 各曲线的淡入增益, t = i / TABLE_SIZE
+    const float *_Nonnull mTable = mTables[EqualPower];
+    int64_t mDuration = 0;
+    int64_t mPosition = 0;
+    float mGainIn[MAX_FRAMES];
+    float mGainOut[MAX_FRAMES];
+
+    float lookup(double t) const;
+};
+
+#endif /* SJAudioCrossfader_h */
@@ -0,0 +1,49 @@
+//
+//  SJAudioMixer.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/12.
+//
+
+#import "SJAudioPlaybackController.h"
+@class SJAudioMixerChannel;
+
+NS_ASSUME_NONNULL_BEGIN
+/// 多个播放器共用一个 AVAudioEngine;
+///
+/// 每个播放器使用一个通道作为 playbackController, 所有通道在同一个渲染回调中混音输出;
+/// ```
+/// SJAudioMixer *mixer = [SJAudioMixer.alloc init];
+/// SJAudioPlayer *music = [SJAudioPlayer.alloc initWithPlaybackController:[mixer makeChannel]];
+/// SJAudioPlayer *voice = [SJAudioPlayer.alloc initWithPlaybackController:[mixer makeChannel]];
+/// ```
+@interface SJAudioMixer : NSObject
+/// 创建一个通道; 通道数量已达上限(32)时返回 nil; 通道释放后自动移除;
+- (nullable SJAudioMixerChannel *)makeChannel;
+
+/// 总音量;
+@property (nonatomic) float volume;
+/// 渲染之后到实际播放的延迟(秒); 可在渲染线程读取;
+@property (nonatomic, readonly) NSTimeInterval outputLatency;
+@end
+
+/// 混音器的一个通道; 启用(play)时参与混音, 所有通道都暂停时暂停 engine;
+///
+/// 与独立的 SJAudioPlaybackController 的区别: reset 不会重建共用的 engine, engine 的配置变化由混音器统一处理后再通知各通道;
+@interface SJAudioMixerChannel : NSObject<SJAudioPlaybackController>
+@property (nonatomic) float volume;
+@property (nonatomic, getter=isMute) BOOL mute;
+/// 声像, -1(左) ~ 1(右);
+@property (nonatomic) float pan;
+
+- (BOOL)play:(NSError **)error;
+- (BOOL)pause:(NSError **)error;
+- (BOOL)stop:(NSError **)error;
+- (BOOL)reset:(NSError **)error; // 共用的 engine 不存在时创建;
+
+@property (nonatomic, copy, nullable) void(^renderBlock)(BOOL *isSilence, const AudioTimeStamp *timestamp, AVAudioFrameCount frameCount, AudioBufferList *outputData);
+@property (nonatomic, readonly) NSTimeInterval outputLatency;
+
+@property (nonatomic, copy, nullable) void(^audioEngineConfigurationChangeHandler)(id<SJAudioPlaybackController> playbackController);
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,319 @@
+//
+//  SJAudioMixer.m
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/12.
+//
+
+#import "SJAudioMixer.h"
+#include "SJAudioMixerCore.h"
+#include <atomic>
+#include <mutex>
+
+@interface SJAudioMixer ()
+@property (nonatomic, readonly) SJAudioMixerCore *core; // 与混音器的生命周期相同
+/// 当前渲染块的时间戳; 仅在渲染线程访问;
+@property (nonatomic, readonly) const AudioTimeStamp *renderTimestamp;
+- (BOOL)_channelDidPlay:(NSError **)error;
+- (void)_channelDidPause;
+- (BOOL)_prepare:(NSError **)error;
+@end
+
+@interface SJAudioMixerChannel ()
+- (instancetype)initWithMixer:(SJAudioMixer *)mixer;
+@property (nonatomic, readonly) NSInteger sourceID;
+@end
+
+@implementation SJAudioMixer {
+    SJAudioMixerCore *mCore;
+    AVAudioEngine *mEngine;
+    AVAudioSourceNode *mAudioSourceNode;
+    AVAudioFormat *mOutputFormat;
+    AudioTimeStamp mRenderTimestamp;
+    NSHashTable<SJAudioMixerChannel *> *mChannels;
+    std::atomic<double> mNodeLatency; // 下游节点的延迟
+    std::atomic<double> mOutputLatency;
+    std::mutex mtx; // engine 的操作来自各个播放器的队列
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _volume = 1.0;
+        // fltp, 44100, 2
+        mOutputFormat = [AVAudioFormat.alloc initWithCommonFormat:AVAudioPCMFormatFloat32 sampleRate:44100 channels:2 interleaved:NO];
+        mCore = new SJAudioMixerCore(2, 4096);
+        mChannels = [NSHashTable weakObjectsHashTable];
+        mRenderTimestamp = {};
+
+        mNodeLatency.store(0, std::__1::memory_order_relaxed);
+        mOutputLatency.store(0, std::__1::memory_order_relaxed);
+
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(audioEngineConfigurationChangeWithNote:) name:AVAudioEngineConfigurationChangeNotification object:nil];
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(audioSessionRouteChangeWithNote:) name:AVAudioSessionRouteChangeNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+#ifdef DEBUG
+    NSLog(@"%@<%p>: %d : %s", NSStringFromClass(self.class), self, __LINE__, sel_getName(_cmd));
+#endif
+
+    [NSNotificationCenter.defaultCenter removeObserver:self];
+    [mEngine stop];
+    delete mCore;
+}
+
+- (nullable SJAudioMixerChannel *)makeChannel {
+    SJAudioMixerChannel *channel = [SJAudioMixerChannel.alloc initWithMixer:self];
+    if ( channel.sourceID < 0 ) {
+        return nil;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    [mChannels addObject:channel];
+    return channel;
+}
+
+- (void)setVolume:(float)volume {
+    std::lock_guard<std::mutex> lock(mtx);
+    _volume = volume;
+    if ( mEngine ) mEngine.mainMixerNode.outputVolume = volume;
+}
+
+- (NSTimeInterval)outputLatency {
+    return mOutputLatency.load(std::__1::memory_order_relaxed);
+}
+
+- (SJAudioMixerCore *)core {
+    return mCore;
+}
+
+- (const AudioTimeStamp *)renderTimestamp {
+    return &mRenderTimestamp;
+}
+
+#pragma mark - mark
+
+- (BOOL)_prepare:(NSError **)error {
+    std::lock_guard<std::mutex> lock(mtx);
+    return [self _prepareLocked:error];
+}
+
+- (BOOL)_channelDidPlay:(NSError **)error {
+    std::lock_guard<std::mutex> lock(mtx);
+    @try {
+        if ( !mEngine && ![self _prepareLocked:error] ) {
+            return NO;
+        }
+
+        NSError *err = nil;
+        if ( !mEngine.isRunning && ![mEngine startAndReturnError:&err] ) {
+            if ( error ) *error = [NSError errorWithDomain:SJAudioPlaybackControllerErrorDomain code:-1 userInfo:@{
+                NSLocalizedDescriptionKey: err.description
+             }];
+            return NO;
+        }
+        [self _updateOutputLatency];
+        return YES;
+    } @catch (NSException *exception) {
+        if ( error ) *error = [NSError errorWithDomain:SJAudioPlaybackControllerErrorDomain code:-1 userInfo:@{
+           NSLocalizedDescriptionKey: exception.description
+        }];
+        return NO;
+    }
+}
+
+// 所有通道都暂停后暂停 engine
+- (void)_channelDidPause {
+    std::lock_guard<std::mutex> lock(mtx);
+    if ( mEngine && mEngine.isRunning && mCore->getActiveCount() == 0 ) {
+        @try {
+            [mEngine pause];
+        } @catch (NSException *exception) { }
+    }
+}
+
+- (BOOL)_prepareLocked:(NSError **)error {
+    if ( mEngine ) {
+        return YES;
+    }
+    return [self _rebuildLocked:error];
+}
+
+- (BOOL)_rebuildLocked:(NSError **)error {
+    @try {
+        if ( mEngine ) [mEngine stop];
+
+        mEngine = [AVAudioEngine.alloc init];
+        __weak typeof(self) _self = self;
+        mAudioSourceNode = [AVAudioSourceNode.alloc initWithFormat:mOutputFormat renderBlock:^OSStatus(BOOL * _Nonnull isSilence, const AudioTimeStamp * _Nonnull timestamp, AVAudioFrameCount frameCount, AudioBufferList * _Nonnull outputData) {
+            __strong typeof(_self) self = _self;
+            if ( self == nil ) {
+                *isSilence = YES;
+                return noErr;
+            }
+            self->mRenderTimestamp = *timestamp;
+            float *planes[2] = { (float *)outputData->mBuffers[0].mData, (float *)outputData->mBuffers[1].mData };
+            *isSilence = self->mCore->render(planes, (int)frameCount) == 0;
+            return noErr;
+        }];
+
+        [mEngine attachNode:mAudioSourceNode];
+        [mEngine connect:mAudioSourceNode to:mEngine.mainMixerNode format:mOutputFormat];
+        mEngine.mainMixerNode.outputVolume = _volume;
+
+        [mEngine prepare];
+        [self _updateOutputLatency];
+
+        // 配置变化后重建时, 如果还有通道在播放则恢复
+        if ( mCore->getActiveCount() > 0 ) {
+            NSError *err = nil;
+            if ( ![mEngine startAndReturnError:&err] ) {
+                if ( error ) *error = [NSError errorWithDomain:SJAudioPlaybackControllerErrorDomain code:-1 userInfo:@{
+                    NSLocalizedDescriptionKey: err.description
+                 }];
+                return NO;
+            }
+        }
+        return YES;
+    } @catch (NSException *exception) {
+        mEngine = nil;
+        mAudioSourceNode = nil;
+        if ( error ) *error = [NSError errorWithDomain:SJAudioPlaybackControllerErrorDomain code:-1 userInfo:@{
+           NSLocalizedDescriptionKey: exception.description
+        }];
+        return NO;
+    }
+}
+
+// 访问 AVAudioSession 可能阻塞, 不能在渲染线程中进行
+- (void)_updateOutputLatency {
+    if ( mAudioSourceNode ) mNodeLatency.store(mAudioSourceNode.outputPresentationLatency, std::__1::memory_order_relaxed);
+    [self _updateSessionLatency];
+}
+
+- (void)_updateSessionLatency {
+    NSTimeInterval latency = AVAudioSession.sharedInstance.outputLatency + mNodeLatency.load(std::__1::memory_order_relaxed);
+    mOutputLatency.store(latency, std::__1::memory_order_relaxed);
+}
+
+// 共用的 engine 只重建一次, 之后通知各通道(播放器会调用 reset/play, 此时 engine 已就绪)
+- (void)audioEngineConfigurationChangeWithNote:(NSNotification *)note {
+    NSArray<SJAudioMixerChannel *> *channels = nil;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( note.object != mEngine ) {
+            return;
+        }
+        [self _rebuildLocked:nil];
+        channels = mChannels.allObjects;
+    }
+
+    for ( SJAudioMixerChannel *channel in channels ) {
+        if ( channel.audioEngineConfigurationChangeHandler ) channel.audioEngineConfigurationChangeHandler(channel);
+    }
+}
+
+- (void)audioSessionRouteChangeWithNote:(NSNotification *)note {
+    [self _updateSessionLatency];
+}
+@end
+
+@implementation SJAudioMixerChannel {
+    SJAudioMixer *mMixer;
+    AudioBufferList *mBufferList; // 预分配, 渲染时指向混音器提供的平面
+    std::mutex mtx;
+}
+
+- (instancetype)initWithMixer:(SJAudioMixer *)mixer {
+    self = [super init];
+    if (self) {
+        _volume = 1.0;
+        mMixer = mixer;
+        mBufferList = (AudioBufferList *)calloc(1, offsetof(AudioBufferList, mBuffers) + sizeof(AudioBuffer) * 2);
+        mBufferList->mNumberBuffers = 2;
+        for ( UInt32 i = 0; i < 2; ++i ) {
+            mBufferList->mBuffers[i].mNumberChannels = 1;
+        }
+
+        __weak typeof(self) _self = self;
+        _sourceID = mixer.core->addSource([_self](float *const *data, int frameCount) -> int {
+            __strong SJAudioMixerChannel *channel = _self;
+            if ( channel == nil ) return 0;
+            return [channel _renderFrameCount:frameCount data:data];
+        });
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // 返回后渲染线程不会再访问 mBufferList
+    if ( _sourceID >= 0 ) mMixer.core->removeSource((int)_sourceID);
+    free(mBufferList);
+    [mMixer _channelDidPause];
+}
+
+- (void)setVolume:(float)volume {
+    std::lock_guard<std::mutex> lock(mtx);
+    _volume = volume;
+    mMixer.core->setGain((int)_sourceID, _mute ? 0 : volume);
+}
+
+- (void)setMute:(BOOL)mute {
+    std::lock_guard<std::mutex> lock(mtx);
+    _mute = mute;
+    mMixer.core->setGain((int)_sourceID, mute ? 0 : _volume);
+}
+
+- (void)setPan:(float)pan {
+    std::lock_guard<std::mutex> lock(mtx);
+    _pan = pan;
+    mMixer.core->setPan((int)_sourceID, pan);
+}
+
+- (NSTimeInterval)outputLatency {
+    return mMixer.outputLatency;
+}
+
+- (BOOL)play:(NSError **)error {
+    mMixer.core->setActive((int)_sourceID, true);
+    if ( ![mMixer _channelDidPlay:error] ) {
+        mMixer.core->setActive((int)_sourceID, false);
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)pause:(NSError **)error {
+    mMixer.core->setActive((int)_sourceID, false);
+    [mMixer _channelDidPause];
+    return YES;
+}
+
+- (BOOL)stop:(NSError **)error {
+    return [self pause:error];
+}
+
+- (BOOL)reset:(NSError **)error {
+    return [mMixer _prepare:error];
+}
+
+#pragma mark - mark
+
+// 渲染线程
+- (int)_renderFrameCount:(int)frameCount data:(float *const *)data {
+    if ( !_renderBlock ) {
+        return 0;
+    }
+
+    for ( UInt32 i = 0; i < 2; ++i ) {
+        mBufferList->mBuffers[i].mData = data[i];
+        mBufferList->mBuffers[i].mDataByteSize = (UInt32)(frameCount * sizeof(float));
+    }
+
+    BOOL isSilence = NO;
+    _renderBlock(&isSilence, mMixer.renderTimestamp, (AVAudioFrameCount)frameCount, mBufferList);
+    return isSilence ? 0 : frameCount;
+}
+@end
@@ -0,0 +1,144 @@
+//
+//  SJAudioMixerCore.cpp
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/12.
+//
+
+#include "SJAudioMixerCore.h"
+#include <Accelerate/Accelerate.h>
+#include <algorithm>
+#include <thread>
+
+SJAudioMixerCore::SJAudioMixerCore(int channels, int maxFrames): mChannels(std::max(1, channels)), mMaxFrames(std::max(1, maxFrames)) {
+    mScratch.resize((size_t)mChannels * mMaxFrames);
+    mScratchPlanes.resize(mChannels);
+    for ( int ch = 0; ch < mChannels; ++ch ) {
+        mScratchPlanes[ch] = mScratch.data() + (size_t)ch * mMaxFrames;
+    }
+}
+
+SJAudioMixerCore::~SJAudioMixerCore() {
+    for ( int i = 0; i < MAX_SOURCES; ++i ) {
+        removeSource(i);
+    }
+}
+
+int SJAudioMixerCore::addSource(RenderCallback callback) {
+    for ( int i = 0; i < MAX_SOURCES; ++i ) {
+        Slot &slot = mSlots[i];
+        int expected = Free;
+        if ( slot.state.compare_exchange_strong(expected, Reserved, std::memory_order_acquire) ) {
+            slot.callback = std::move(callback);
+            slot.gain.store(1, std::memory_order_relaxed);
+            slot.pan.store(0, std::memory_order_relaxed);
+            slot.state.store(Inactive, std::memory_order_release);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SJAudioMixerCore::removeSource(int sourceID) {
+    if ( sourceID < 0 || sourceID >= MAX_SOURCES ) {
+        return;
+    }
+
+    Slot &slot = mSlots[sourceID];
+    int state = slot.state.load(std::memory_order_relaxed);
+    do {
+        if ( state == Free || state == Reserved ) {
+            return;
+        }
+    } while ( !slot.state.compare_exchange_weak(state, Reserved, std::memory_order_seq_cst) );
+
+    // 等待渲染线程离开该槽位(最多一个渲染块的时间)
+    while ( slot.rendering.load(std::memory_order_seq_cst) ) {
+        std::this_thread::yield();
+    }
+    slot.callback = nullptr;
+    slot.state.store(Free, std::memory_order_release);
+}
+
+void SJAudioMixerCore::setActive(int sourceID, bool active) {
+    if ( sourceID < 0 || sourceID >= MAX_SOURCES ) {
+        return;
+    }
+    int expected = active ? Inactive : Active;
+    mSlots[sourceID].state.compare_exchange_strong(expected, active ? Active : Inactive, std::memory_order_release, std::memory_order_relaxed);
+}
+
+void SJAudioMixerCore::setGain(int sourceID, float gain) {
+    if ( sourceID >= 0 && sourceID < MAX_SOURCES ) mSlots[sourceID].gain.store(std::max(0.f, gain), std::memory_order_relaxed);
+}
+
+void SJAudioMixerCore::setPan(int sourceID, float pan) {
+    if ( sourceID >= 0 && sourceID < MAX_SOURCES ) mSlots[sourceID].pan.store(std::clamp(pan, -1.f, 1.f), std::memory_order_relaxed);
+}
+
+bool SJAudioMixerCore::isActive(int sourceID) const {
+    return sourceID >= 0 && sourceID < MAX_SOURCES && mSlots[sourceID].state.load(std::memory_order_relaxed) == Active;
+}
+
+int SJAudioMixerCore::getActiveCount() const {
+    int count = 0;
+    for ( const Slot &slot : mSlots ) {
+        if ( slot.state.load(std::memory_order_relaxed) == Active ) ++count;
+    }
+    return count;
+}
+
+int SJAudioMixerCore::render(float *const _Nonnull * _Nonnull data, int frameCount) {
+    int mixed = 0;
+    for ( int offset = 0; offset < frameCount; offset += mMaxFrames ) {
+        mixed = std::max(mixed, renderChunk(data, offset, std::min(mMaxFrames, frameCount - offset)));
+    }
+    return mixed;
+}
+
+int SJAudioMixerCore::renderChunk(float *const _Nonnull * _Nonnull data, int offset, int frameCount) {
+    int mixed = 0;
+    for ( Slot &slot : mSlots ) {
+        if ( slot.state.load(std::memory_order_acquire) != Active ) {
+            continue;
+        }
+
+        // 先标记再确认状态; 与 removeSource 配合, 保证移除返回后不会再调用回调
+        slot.rendering.store(true, std::memory_order_seq_cst);
+        if ( slot.state.load(std::memory_order_seq_cst) != Active ) {
+            slot.rendering.store(false, std::memory_order_release);
+            continue;
+        }
+
+        int count = std::clamp(slot.callback(mScratchPlanes.data(), frameCount), 0, frameCount);
+        float gain = slot.gain.load(std::memory_order_relaxed);
+        float pan = slot.pan.load(std::memory_order_relaxed);
+        if ( count > 0 ) {
+            for ( int ch = 0; ch < mChannels; ++ch ) {
+                float g = gain;
+                if ( mChannels == 2 ) {
+                    if ( ch == 0 && pan > 0 ) g *= 1 - pan;
+                    if ( ch == 1 && pan < 0 ) g *= 1 + pan;
+                }
+
+                float *dst = data[ch] + offset;
+                if ( mixed == 0 ) {
+                    vDSP_vsmul(mScratchPlanes[ch], 1, &g, dst, 1, count);
+                    if ( count < frameCount ) vDSP_vclr(dst + count, 1, frameCount - count);
+                }
+                else {
+                    vDSP_vsma(mScratchPlanes[ch], 1, &g, dst, 1, dst, 1, count);
+                }
+            }
+            ++mixed;
+        }
+        slot.rendering.store(false, std::memory_order_release);
+    }
+
+    if ( mixed == 0 ) {
+        for ( int ch = 0; ch < mChannels; ++ch ) {
+            vDSP_vclr(data[ch] + offset, 1, frameCount);
+        }
+    }
+    return mixed;
+}
@@ -0,0 +1,79 @@
+//
+//  SJAudioMixerCore.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/12.
+//
+
+#ifndef SJAudioMixerCore_h
+#define SJAudioMixerCore_h
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/// 混音核心; SJAudioMixer 在 AVAudioSourceNode 的渲染回调中调用 render;
+///
+/// 音源保存在固定数量的槽位中, 添加时填好回调后再发布, 移除时等待渲染线程离开该槽位后再释放回调,
+/// 因此回调可以安全地持有外部资源; 渲染时依次拉取启用的音源, 按增益/声像通过 vDSP 累加到输出, 不加锁, 不分配内存;
+///
+/// 只依赖 Accelerate, 不接输出设备时直接循环调用 render 即可验证混音结果(见 libffmpeg/tools/tests/audio_mixer_test.cpp);
+class SJAudioMixerCore {
+public:
+    static constexpr int MAX_SOURCES = 32;
+
+    /// 在渲染线程调用; 向 channels 个平面写入最多 frameCount 个采样, 返回写入的数量;
+    /// 返回值小于 frameCount 时之后的部分视为静音, 返回 0 时不参与混音;
+    using RenderCallback = std::function<int(float *const _Nonnull * _Nonnull data, int frameCount)>;
+
+    /// maxFrames 为单次拉取音源的最大采样数, render 请求更多时分多次拉取;
+    SJAudioMixerCore(int channels = 2, int maxFrames = 4096);
+    ~SJAudioMixerCore();
+    SJAudioMixerCore(const SJAudioMixerCore &) = delete;
+    SJAudioMixerCore &operator=(const SJAudioMixerCore &) = delete;
+
+    int getChannels() const { return mChannels; }
+
+    /// 添加音源, 默认未启用, 增益 1, 声像居中; 返回音源的 id, 槽位已满时返回 -1;
+    int addSource(RenderCallback callback);
+
+    /// 移除音源; 返回后渲染线程不会再调用该回调; 不能在渲染回调中调用;
+    void removeSource(int sourceID);
+
+    void setActive(int sourceID, bool active);
+    void setGain(int sourceID, float gain);
+    /// 声像, -1(左) ~ 1(右); 仅对立体声输出生效, 居中时两侧均不衰减;
+    void setPan(int sourceID, float pan);
+
+    bool isActive(int sourceID) const;
+    int getActiveCount() const;
+
+    /// 在渲染线程调用; 混音后输出 frameCount 个采样到 data(平面); 返回参与混音的音源数量, 为 0 时输出静音;
+    int render(float *const _Nonnull * _Nonnull data, int frameCount);
+
+private:
+    enum State : int {
+        Free,
+        Reserved,   // 正在添加或移除, 渲染线程跳过
+        Inactive,
+        Active,
+    };
+
+    struct Slot {
+        std::atomic<int> state { Free };
+        std::atomic<bool> rendering { false };  // 渲染线程正在调用该槽位的回调
+        std::atomic<float> gain { 1 };
+        std::atomic<float> pan { 0 };
+        RenderCallback callback;                // 仅在 state 为 Reserved 时由控制线程修改
+    };
+
+    int mChannels;
+    int mMaxFrames;
+    Slot mSlots[MAX_SOURCES];
+    std::vector<float> mScratch;                // mChannels * mMaxFrames
+    std::vector<float *> mScratchPlanes;
+
+    int renderChunk(float *const _Nonnull * _Nonnull data, int offset, int frameCount);
+};
+
+#endif /* SJAudioMixerCore_h */
@@ -0,0 +1,30 @@
+//
+//  SJAudioPlaybackClock.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/10.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CMTime.h>
+
+NS_ASSUME_NONNULL_BEGIN
+/// 播放时钟; 将输出的采样位置映射到系统时间(mach_absolute_time), 计入输出延迟与播放速率;
+///
+/// 渲染线程每次输出后更新锚点, 任意线程可以无锁、高频地查询插值后的当前时间;
+/// 连续播放时读数单调递增: 锚点的抖动通过微调速率(最多 ±1%)逐渐吸收, 不会产生跳变; seek 等不连续的情况直接跳到新的位置;
+/// 渲染中断(卡顿、暂停)时停在已输出数据的末尾, 不会超前;
+@interface SJAudioPlaybackClock : NSObject
+/// 渲染线程调用;
+/// mediaTime 为本次输出的第一个采样的媒体时间; hostTime 为渲染的时间戳, 加上 latency 后即为该采样实际播放的时刻;
+/// rate 为播放速率, 每个输出采样对应 rate 个媒体采样;
+- (void)updateWithMediaTime:(NSTimeInterval)mediaTime frameCount:(uint32_t)frameCount sampleRate:(double)sampleRate rate:(double)rate hostTime:(uint64_t)hostTime latency:(NSTimeInterval)latency;
+
+/// 停在当前时间, 直到下次更新;
+- (void)pause;
+/// 跳到指定时间并停止走时, 直到下次更新; 用于 seek 及切换资源;
+- (void)resetToTime:(CMTime)time;
+
+@property (nonatomic, readonly) CMTime currentTime;
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,148 @@
+//
+//  SJAudioPlaybackClock.m
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/10.
+//
+
+#import "SJAudioPlaybackClock.h"
+#include <mach/mach_time.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+static const double SJ_CLOCK_MAX_DRIFT = 0.1;       // 秒; 偏差超过该值时视为不连续, 直接跳到新的位置
+static const double SJ_CLOCK_SLEW_WINDOW = 1.0;     // 秒; 偏差在该时间内逐渐吸收
+static const double SJ_CLOCK_MAX_SLEW = 0.01;       // 速率的最大调整幅度
+static const int32_t SJ_CLOCK_TIMESCALE = 1000000;
+
+@implementation SJAudioPlaybackClock {
+    // 锚点; 由 mSeq 保护(奇数表示正在写入), 读取方无锁, 数据被修改时重试
+    std::atomic<uint32_t> mSeq;
+    std::atomic<double> mAnchorMedia;   // 锚点的媒体时间(秒)
+    std::atomic<double> mAnchorHost;    // 锚点的系统时间(秒), 之前读数保持在 mAnchorMedia
+    std::atomic<double> mRate;          // 走时速率(已包含微调), 停止时为 0
+    std::atomic<double> mLimit;         // 已输出数据的末尾, 读数不会超过该值
+
+    // 以下只在写入时访问
+    BOOL mRunning;
+    double mHostTimeScale;              // mach_absolute_time -> 秒
+}
+
+- (instancetype)init {
+    self = [super init];
+    mach_timebase_info_data_t info;
+    mach_timebase_info(&info);
+    mHostTimeScale = (double)info.numer / info.denom / NSEC_PER_SEC;
+    mSeq.store(0, std::__1::memory_order_relaxed);
+    mAnchorMedia.store(0, std::__1::memory_order_relaxed);
+    mAnchorHost.store(0, std::__1::memory_order_relaxed);
+    mRate.store(0, std::__1::memory_order_relaxed);
+    mLimit.store(0, std::__1::memory_order_relaxed);
+    return self;
+}
+
+- (void)updateWithMediaTime:(NSTimeInterval)mediaTime frameCount:(uint32_t)frameCount sampleRate:(double)sampleRate rate:(double)rate hostTime:(uint64_t)hostTime latency:(NSTimeInterval)latency {
+    if ( sampleRate <= 0 || rate <= 0 ) {
+        return;
+    }
+
+    double presentationTime = hostTime * mHostTimeScale + latency;
+    double end = mediaTime + frameCount / sampleRate * rate;
+
+    [self _beginWrite];
+    double now = mach_absolute_time() * mHostTimeScale;
+    double current = [self _valueAtHostTime:now];
+    double target = mediaTime + (now - presentationTime) * rate; // 按本次输出推算的当前时间
+    double err = target - current;
+    if ( mRunning && std::fabs(err) < SJ_CLOCK_MAX_DRIFT && now < mAnchorHost.load(std::__1::memory_order_relaxed) ) {
+        // 起点还未实际播放, 保持锚点
+        mLimit.store(std::max(end, mLimit.load(std::__1::memory_order_relaxed)), std::__1::memory_order_relaxed);
+    }
+    else if ( mRunning && std::fabs(err) < SJ_CLOCK_MAX_DRIFT ) {
+        // 连续播放: 从当前读数继续走, 通过微调速率吸收偏差
+        double slew = std::clamp(err / SJ_CLOCK_SLEW_WINDOW / rate, -SJ_CLOCK_MAX_SLEW, SJ_CLOCK_MAX_SLEW);
+        mAnchorMedia.store(current, std::__1::memory_order_relaxed);
+        mAnchorHost.store(now, std::__1::memory_order_relaxed);
+        mRate.store(rate * (1 + slew), std::__1::memory_order_relaxed);
+        mLimit.store(std::max(end, mLimit.load(std::__1::memory_order_relaxed)), std::__1::memory_order_relaxed);
+    }
+    else {
+        // 开始/恢复播放或不连续: 停在本次输出的起点, 直到它实际开始播放
+        double anchor = mediaTime;
+        if ( !mRunning && std::fabs(mediaTime - current) < SJ_CLOCK_MAX_DRIFT ) {
+            anchor = std::max(mediaTime, current); // 暂停后恢复时不回退
+        }
+        mAnchorMedia.store(anchor, std::__1::memory_order_relaxed);
+        mAnchorHost.store(presentationTime, std::__1::memory_order_relaxed);
+        mRate.store(rate, std::__1::memory_order_relaxed);
+        mLimit.store(std::max(end, anchor), std::__1::memory_order_relaxed);
+    }
+    mRunning = YES;
+    [self _endWrite];
+}
+
+- (void)pause {
+    [self _beginWrite];
+    double now = mach_absolute_time() * mHostTimeScale;
+    double current = [self _valueAtHostTime:now];
+    mAnchorMedia.store(current, std::__1::memory_order_relaxed);
+    mAnchorHost.store(now, std::__1::memory_order_relaxed);
+    mRate.store(0, std::__1::memory_order_relaxed);
+    mLimit.store(current, std::__1::memory_order_relaxed);
+    mRunning = NO;
+    [self _endWrite];
+}
+
+- (void)resetToTime:(CMTime)time {
+    double seconds = CMTIME_IS_NUMERIC(time) ? CMTimeGetSeconds(time) : 0;
+    [self _beginWrite];
+    mAnchorMedia.store(seconds, std::__1::memory_order_relaxed);
+    mAnchorHost.store(mach_absolute_time() * mHostTimeScale, std::__1::memory_order_relaxed);
+    mRate.store(0, std::__1::memory_order_relaxed);
+    mLimit.store(seconds, std::__1::memory_order_relaxed);
+    mRunning = NO;
+    [self _endWrite];
+}
+
+- (CMTime)currentTime {
+    double media, host, rate, limit;
+    uint32_t seq;
+    do {
+        seq = mSeq.load(std::__1::memory_order_acquire);
+        media = mAnchorMedia.load(std::__1::memory_order_relaxed);
+        host = mAnchorHost.load(std::__1::memory_order_relaxed);
+        rate = mRate.load(std::__1::memory_order_relaxed);
+        limit = mLimit.load(std::__1::memory_order_relaxed);
+        std::atomic_thread_fence(std::__1::memory_order_acquire);
+    } while ( (seq & 1) || seq != mSeq.load(std::__1::memory_order_relaxed) );
+
+    double now = mach_absolute_time() * mHostTimeScale;
+    double seconds = std::min(media + std::max(0.0, now - host) * rate, limit);
+    return CMTimeMakeWithSeconds(std::max(0.0, seconds), SJ_CLOCK_TIMESCALE);
+}
+
+#pragma mark - mark
+
+// 渲染线程与播放器队列都会写入, 写入之间互斥; 写入只有几次赋值, 自旋的时间可以忽略
+- (void)_beginWrite {
+    uint32_t seq = mSeq.load(std::__1::memory_order_relaxed);
+    while ( (seq & 1) || !mSeq.compare_exchange_weak(seq, seq + 1, std::__1::memory_order_acquire, std::__1::memory_order_relaxed) ) {
+        seq = mSeq.load(std::__1::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::__1::memory_order_release);
+}
+
+- (void)_endWrite {
+    mSeq.fetch_add(1, std::__1::memory_order_release);
+}
+
+// 写入期间调用
+- (double)_valueAtHostTime:(double)hostTime {
+    double media = mAnchorMedia.load(std::__1::memory_order_relaxed);
+    double host = mAnchorHost.load(std::__1::memory_order_relaxed);
+    double rate = mRate.load(std::__1::memory_order_relaxed);
+    double limit = mLimit.load(std::__1::memory_order_relaxed);
+    return std::min(media + std::max(0.0, hostTime - host) * rate, limit);
+}
+@end
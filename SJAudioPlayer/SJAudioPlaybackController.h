@@ -11,7 +11,6 @@ NS_ASSUME_NONNULL_BEGIN
 FOUNDATION_EXPORT NSErrorDomain const SJAudioPlaybackControllerErrorDomain;
 
 @protocol SJAudioPlaybackController <NSObject>
-@property (nonatomic) float rate;
 @property (nonatomic) float volume;
 @property (nonatomic, getter=isMute) BOOL mute;
 
@@ -22,7 +21,16 @@ FOUNDATION_EXPORT NSErrorDomain const SJAudioPlaybackControllerErrorDomain;
 
 @property (nonatomic, copy, nullable) void(^audioEngineConfigurationChangeHandler)(id<SJAudioPlaybackController> playbackController);
 
-@property (nonatomic, copy, nullable) void(^renderBlock)(BOOL *isSilence, AVAudioFrameCount frameCount, AudioBufferList *outputData, int64_t *pts);
+/// 在渲染线程调用; timestamp 为本次渲染的时间戳, 加上 outputLatency 即为数据实际播放的时刻;
+@property (nonatomic, copy, nullable) void(^renderBlock)(BOOL *isSilence, const AudioTimeStamp *timestamp, AVAudioFrameCount frameCount, AudioBufferList *outputData);
+/// 渲染之后到实际播放的延迟(秒), 包括下游节点与硬件的延迟; 可在渲染线程读取;
+@property (nonatomic, readonly) NSTimeInterval outputLatency;
+
+@optional
+/// 播放速率; 在渲染之后变速(AVAudioUnitTimePitch), renderBlock 输出的采样仍是原速的媒体采样;
+/// FFAudioItem.rate(转码阶段的 atempo)需要重新构建 vendored 的 libffmpeg.xcframework, 目前不使用;
+/// 共用 engine 的通道(SJAudioMixerChannel)不支持变速;
+@property (nonatomic) float rate;
 @end
 
 @interface SJAudioPlaybackController : NSObject<SJAudioPlaybackController>
@@ -35,7 +43,10 @@ FOUNDATION_EXPORT NSErrorDomain const SJAudioPlaybackControllerErrorDomain;
 - (BOOL)stop:(NSError **)error; // stop all nodes
 - (BOOL)reset:(NSError **)error; // rest all nodes, 重新创建engine, 一般在播放报错需要重置时调用;
 
-@property (nonatomic, copy, nullable) void(^renderBlock)(BOOL *isSilence, AVAudioFrameCount frameCount, AudioBufferList *outputData, int64_t *pts);
+/// 在渲染线程调用; timestamp 为本次渲染的时间戳, 加上 outputLatency 即为数据实际播放的时刻;
+@property (nonatomic, copy, nullable) void(^renderBlock)(BOOL *isSilence, const AudioTimeStamp *timestamp, AVAudioFrameCount frameCount, AudioBufferList *outputData);
+/// 渲染之后到实际播放的延迟(秒), 包括下游节点与硬件的延迟; 可在渲染线程读取;
+@property (nonatomic, readonly) NSTimeInterval outputLatency;
 
 @property (nonatomic, copy, nullable) void(^audioEngineConfigurationChangeHandler)(id<SJAudioPlaybackController> playbackController);
 @end
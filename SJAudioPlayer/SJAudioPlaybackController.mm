@@ -6,6 +6,7 @@
 //
 
 #import "SJAudioPlaybackController.h"
+#include <atomic>
 
 typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
     SJAudioPlaybackActionUnknown,
@@ -18,10 +19,12 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
 @implementation SJAudioPlaybackController {
     AVAudioEngine *mEngine;
     AVAudioSourceNode *mAudioSourceNode;
-    AVAudioUnitTimePitch *mRateNode;
+    AVAudioUnitTimePitch *mRateNode; // vendored 的 libffmpeg.xcframework 不包含 atempo, 变速暂时仍在渲染之后进行; 重新构建之后可改用 FFAudioItem.rate 并移除该节点
     AVAudioMixerNode *mOutputVolumeNode;
     AVAudioFormat *mOutputFormat;
     SJAudioPlaybackAction mLastAction;
+    std::atomic<double> mNodeLatency; // 下游节点的延迟
+    std::atomic<double> mOutputLatency;
 }
 
 - (instancetype)init {
@@ -32,7 +35,11 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
         // fltp, 44100, 2
         mOutputFormat = [AVAudioFormat.alloc initWithCommonFormat:AVAudioPCMFormatFloat32 sampleRate:44100 channels:2 interleaved:NO];
         
+        mNodeLatency.store(0, std::__1::memory_order_relaxed);
+        mOutputLatency.store(0, std::__1::memory_order_relaxed);
+        
         [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(audioEngineConfigurationChangeWithNote:) name:AVAudioEngineConfigurationChangeNotification object:nil];
+        [NSNotificationCenter.defaultCenter addObserver:self selector:@selector(audioSessionRouteChangeWithNote:) name:AVAudioSessionRouteChangeNotification object:nil];
     }
     return self;
 }
@@ -60,6 +67,10 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
     if ( mOutputVolumeNode ) mOutputVolumeNode.outputVolume = mute ? 0 : _volume;
 }
 
+- (NSTimeInterval)outputLatency {
+    return mOutputLatency.load(std::__1::memory_order_relaxed);
+}
+
 - (BOOL)play:(NSError **)error {
     if ( mLastAction == SJAudioPlaybackActionPlay ) {
         return YES;
@@ -78,6 +89,7 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
             return NO;
         }
         
+        [self _updateOutputLatency];
         mLastAction = SJAudioPlaybackActionPlay;
         return YES;
     } @catch (NSException *exception) {
@@ -142,8 +154,7 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
         __weak typeof(self) _self = self;
         mAudioSourceNode = [AVAudioSourceNode.alloc initWithFormat:mOutputFormat renderBlock:^OSStatus(BOOL * _Nonnull isSilence, const AudioTimeStamp * _Nonnull timestamp, AVAudioFrameCount frameCount, AudioBufferList * _Nonnull outputData) {
             __strong typeof(_self) self = _self;
-            int64_t pts = 0;
-            self->_renderBlock(isSilence, frameCount, outputData, &pts);
+            self->_renderBlock(isSilence, timestamp, frameCount, outputData);
             return noErr;
         }];
         
@@ -159,6 +170,7 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
         mOutputVolumeNode.outputVolume = _mute ? 0 : _volume;
         
         [mEngine prepare];
+        [self _updateOutputLatency];
         mLastAction = SJAudioPlaybackActionReset;
         return YES;
     } @catch (NSException *exception) {
@@ -171,9 +183,25 @@ typedef NS_ENUM(NSUInteger, SJAudioPlaybackAction) {
 
 #pragma mark - mark
 
+// 访问 AVAudioSession 可能阻塞, 不能在渲染线程中进行; 在播放/重置及线路变化时更新
+- (void)_updateOutputLatency {
+    if ( mAudioSourceNode ) mNodeLatency.store(mAudioSourceNode.outputPresentationLatency, std::__1::memory_order_relaxed);
+    [self _updateSessionLatency];
+}
+
+// 线路变化的通知在其他线程回调, 这里只访问 AVAudioSession
+- (void)_updateSessionLatency {
+    NSTimeInterval latency = AVAudioSession.sharedInstance.outputLatency + mNodeLatency.load(std::__1::memory_order_relaxed);
+    mOutputLatency.store(latency, std::__1::memory_order_relaxed);
+}
+
 - (void)audioEngineConfigurationChangeWithNote:(NSNotification *)note {
     if ( note.object == mEngine && self.audioEngineConfigurationChangeHandler ) {
         self.audioEngineConfigurationChangeHandler(self);
     }
 }
+
+- (void)audioSessionRouteChangeWithNote:(NSNotification *)note {
+    [self _updateSessionLatency];
+}
 @end
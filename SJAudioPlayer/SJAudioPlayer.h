@@ -18,6 +18,12 @@ typedef NS_ENUM(NSUInteger, SJPlayWhenReadyChangeReason) {
     SJPlayWhenReadyChangeReasonReachedMaximumPlayableDurationPosition
 };
 
+typedef NS_ENUM(NSUInteger, SJAudioCrossfadeCurve) {
+    SJAudioCrossfadeCurveEqualPower,    // 等功率, 中点处两侧各 -3dB
+    SJAudioCrossfadeCurveLinear,        // 线性, 中点处两侧各 -6dB
+    SJAudioCrossfadeCurveSCurve,        // S 形, 两端变化平缓
+};
+
 NS_ASSUME_NONNULL_BEGIN
 @interface SJAudioPlayer : NSObject
 - (instancetype)initWithPlaybackController:(id<SJAudioPlaybackController>)playbackController;
@@ -38,10 +44,20 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic) float volume;
 @property (nonatomic, getter=isMute) BOOL mute;
 
+/// 交叉淡化的时长(秒); 默认 0, 表示不淡化;
+///
+/// 大于 0 时, 播放中替换音频(replaceAudioWithURL)会让当前音频从当前位置淡出, 同时新的音频淡入;
+/// 设置了下一个音频(setNextAudioWithURL)时, 在当前音频结束前的这段时间开始淡化到下一个音频;
+/// 两个音频仅在淡化期间同时转码;
+@property (nonatomic) NSTimeInterval crossfadeDuration;
+@property (nonatomic) SJAudioCrossfadeCurve crossfadeCurve; // 默认等功率
+
 /// Replaces the current audio with a new URL of audio.
 ///
 - (void)replaceAudioWithURL:(nullable NSURL *)URL;
 - (void)replaceAudioWithURL:(nullable NSURL *)URL options:(nullable __kindof SJAudioPlayerOptions *)options;
+/// 设置当前音频结束后播放的音频; 开启交叉淡化时在结束前开始淡化, 否则在结束时切换; 传 nil 取消;
+- (void)setNextAudioWithURL:(nullable NSURL *)URL options:(nullable __kindof SJAudioPlayerOptions *)options;
 - (void)seekToTime:(CMTime)time;
 
 - (void)play;
@@ -13,12 +13,17 @@
 #endif
 
 #import "SJAudioPlaybackController.h"
+#import "SJAudioPlaybackClock.h"
+#include "SJAudioCrossfader.h"
+#include <mach/mach_time.h>
 #include <atomic>
 #include <mutex>
+#include <thread>
 
 NSErrorDomain const SJAudioPlaybackControllerErrorDomain = @"SJAudioPlaybackControllerErrorDomain";
 
 static void *FF_AUDIO_PLAYER_QUEUE = &FF_AUDIO_PLAYER_QUEUE;
+static const int SJ_CROSSFADE_MAX_FRAMES = SJAudioCrossfader::MAX_FRAMES;
 
 FOUNDATION_STATIC_INLINE void
 SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
@@ -30,6 +35,10 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     }
 }
 
+static_assert(SJAudioCrossfader::EqualPower == (int)SJAudioCrossfadeCurveEqualPower &&
+              SJAudioCrossfader::Linear == (int)SJAudioCrossfadeCurveLinear &&
+              SJAudioCrossfader::SCurve == (int)SJAudioCrossfadeCurveSCurve, "SJAudioCrossfader::Curve 与 SJAudioCrossfadeCurve 的取值不一致");
+
 @interface SJAudioPlayer ()<FFAudioItemDelegate> {
     id<SJAudioPlaybackController> _mPlaybackController;
     FFAudioItem *_mAudioItem;
@@ -38,10 +47,30 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     NSError *_mError;
     
     std::atomic<CMTime> _mDuration;
-    std::atomic<CMTime> _mCurrentTime;
+    SJAudioPlaybackClock *_mClock; // 当前时间
     std::atomic<CMTimeRange> _mPlayableTimeRange;
     std::atomic<CMTime> _mPlayableDurationLimit;
 
+    std::atomic<float> _mRate;
+    
+    // 交叉淡化
+    FFAudioItem *_Nullable _mFadingOutItem; // 淡出中的音频; 仅在队列中访问, 持有引用
+    std::atomic<void *> _mFadingOutSlot; // 渲染线程使用的淡出音频, 不持有引用; 与 _mCrossfadeGeneration 一起按 seqlock 的方式发布
+    std::atomic<bool> _mFadeRendering; // 渲染线程正在使用 _mFadingOutSlot 中的音频; 队列释放音频之前等待其离开
+    NSURL *_Nullable _mNextURL;
+    __kindof SJAudioPlayerOptions *_Nullable _mNextOptions;
+    std::atomic<BOOL> _mHasNextAudio;
+    std::atomic<double> _mCrossfadeDuration;
+    std::atomic<NSUInteger> _mCrossfadeCurve;
+    std::atomic<uint32_t> _mCrossfadeGeneration; // 开始或取消淡化时加 2; 奇数表示正在更新 _mFadingOutSlot
+    std::atomic<uint32_t> _mCrossfadeEndedGeneration; // 渲染线程结束淡出时记录, 由队列释放对应的音频
+    dispatch_source_t _mCrossfadeEndSource; // 渲染线程通过 merge_data 通知队列, 不分配内存
+    // 以下仅在渲染线程访问
+    SJAudioCrossfader *_mCrossfader;
+    float *_mFadeBuffers[2];
+    uint32_t _mRenderCrossfadeGeneration;
+    BOOL _mCrossfadeBegan;
+    BOOL _mFadeOutEnded; // 本次淡化的淡出音频已结束, 等待队列释放
     std::atomic<BOOL> _mPlayWhenReady;
     SJPlayWhenReadyChangeReason _mPlaybackWhenReadyChangeReason;
     
@@ -77,9 +106,22 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     dispatch_queue_set_specific(_mQueue, FF_AUDIO_PLAYER_QUEUE, FF_AUDIO_PLAYER_QUEUE, nullptr);
     
     _mDuration.store(kCMTimeZero, std::__1::memory_order_relaxed);
-    _mCurrentTime.store(kCMTimeZero, std::__1::memory_order_relaxed);
+    _mClock = [SJAudioPlaybackClock.alloc init];
     _mPlayableTimeRange.store(kCMTimeRangeZero, std::__1::memory_order_relaxed);
     _mPlayWhenReady.store(false, std::__1::memory_order_relaxed);
+    _mRate.store(1.0, std::__1::memory_order_relaxed);
+    
+    _mHasNextAudio.store(NO, std::__1::memory_order_relaxed);
+    _mCrossfadeDuration.store(0, std::__1::memory_order_relaxed);
+    _mCrossfadeCurve.store(SJAudioCrossfadeCurveEqualPower, std::__1::memory_order_relaxed);
+    _mCrossfadeGeneration.store(0, std::__1::memory_order_relaxed);
+    _mCrossfadeEndedGeneration.store(0, std::__1::memory_order_relaxed);
+    _mFadingOutSlot.store(nullptr, std::__1::memory_order_relaxed);
+    _mFadeRendering.store(false, std::__1::memory_order_relaxed);
+    _mCrossfader = new SJAudioCrossfader();
+    for ( int ch = 0; ch < 2; ++ch ) {
+        _mFadeBuffers[ch] = (float *)calloc(SJ_CROSSFADE_MAX_FRAMES, sizeof(float));
+    }
     
     _mPlaybackController = playbackController;
     __weak typeof(self) _self = self;
@@ -89,11 +131,19 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
         [self handleAudioEngineConfigurationChange];
     };
     
+    _mCrossfadeEndSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, _mQueue);
+    dispatch_source_set_event_handler(_mCrossfadeEndSource, ^{
+        __strong typeof(_self) self = _self;
+        if ( self == nil ) return;
+        [self _onCrossfadeEnded];
+    });
+    dispatch_resume(_mCrossfadeEndSource);
+    
     if ( @available(iOS 13.0, *) ) {
-        _mPlaybackController.renderBlock = ^(BOOL * _Nonnull isSilence, AVAudioFrameCount frameCount, AudioBufferList * _Nonnull outputData, int64_t * _Nonnull pts) {
+        _mPlaybackController.renderBlock = ^(BOOL * _Nonnull isSilence, const AudioTimeStamp * _Nonnull timestamp, AVAudioFrameCount frameCount, AudioBufferList * _Nonnull outputData) {
             __strong typeof(_self) self = _self;
             if ( self == nil ) return;
-            [self handleRenderWithSilence:isSilence frameCount:frameCount outputData:outputData pts:pts];
+            [self handleRenderWithSilence:isSilence timestamp:timestamp frameCount:frameCount outputData:outputData];
         };
     }
     
@@ -113,6 +163,11 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     
     [_mPlaybackController stop:NULL];
     [NSNotificationCenter.defaultCenter removeObserver:self];
+    dispatch_source_cancel(_mCrossfadeEndSource);
+    delete _mCrossfader;
+    for ( int ch = 0; ch < 2; ++ch ) {
+        free(_mFadeBuffers[ch]);
+    }
 }
 
 - (NSURL *)URL {
@@ -150,12 +205,23 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     return _mPlayWhenReady.load(std::__1::memory_order_relaxed);
 }
 
+// 跳到指定时间, 直到开始播放新的数据
 - (void)setCurrentTime:(CMTime)currentTime {
-    _mCurrentTime.store(currentTime, std::__1::memory_order_relaxed);
+    [_mClock resetToTime:currentTime];
 }
 
+// 由播放时钟插值得到, 已计入输出延迟; 不加锁, 可以高频查询(例如歌词同步)
 - (CMTime)currentTime {
-    return _mCurrentTime.load(std::__1::memory_order_relaxed);
+    CMTime currentTime = _mClock.currentTime;
+    CMTime playableDurationLimit = _mPlayableDurationLimit.load(std::__1::memory_order_relaxed);
+    if ( CMTimeCompare(playableDurationLimit, kCMTimeZero) && CMTimeCompare(currentTime, playableDurationLimit) > 0 ) {
+        currentTime = playableDurationLimit;
+    }
+    CMTime duration = _mDuration.load(std::__1::memory_order_relaxed);
+    if ( CMTimeCompare(duration, kCMTimeZero) && CMTimeCompare(currentTime, duration) > 0 ) {
+        currentTime = duration;
+    }
+    return currentTime;
 }
 
 - (void)setDuration:(CMTime)duration {
@@ -191,14 +257,19 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
 
 - (void)setRate:(float)rate {
     SJQueueSync(_mQueue, ^{
+        // 变速由 playbackController 在渲染之后完成(AVAudioUnitTimePitch); 不支持变速的 playbackController 保持原速
+        if ( ![_mPlaybackController respondsToSelector:@selector(setRate:)] ) {
+            return;
+        }
         _mPlaybackController.rate = rate;
+        _mRate.store(rate, std::__1::memory_order_relaxed);
     });
 }
 
 - (float)rate {
     __block float ret;
     SJQueueSync(_mQueue, ^{
-        ret = _mPlaybackController.rate;
+        ret = _mRate.load(std::__1::memory_order_relaxed);
     });
     return ret;
 }
@@ -231,6 +302,22 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     return ret;
 }
 
+- (void)setCrossfadeDuration:(NSTimeInterval)crossfadeDuration {
+    _mCrossfadeDuration.store(MAX(0, crossfadeDuration), std::__1::memory_order_relaxed);
+}
+
+- (NSTimeInterval)crossfadeDuration {
+    return _mCrossfadeDuration.load(std::__1::memory_order_relaxed);
+}
+
+- (void)setCrossfadeCurve:(SJAudioCrossfadeCurve)crossfadeCurve {
+    _mCrossfadeCurve.store(crossfadeCurve, std::__1::memory_order_relaxed);
+}
+
+- (SJAudioCrossfadeCurve)crossfadeCurve {
+    return (SJAudioCrossfadeCurve)_mCrossfadeCurve.load(std::__1::memory_order_relaxed);
+}
+
 - (void)setAudioItem:(FFAudioItem *)audioItem {
     @synchronized (self) {
         _mAudioItem = audioItem;
@@ -251,40 +338,103 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
 
 - (void)replaceAudioWithURL:(nullable NSURL *)URL options:(nullable __kindof SJAudioPlayerOptions *)options {
     dispatch_async(_mQueue, ^{
-        NSError *error = NULL;
-        if ( ![self->_mPlaybackController stop:&error] && ![self->_mPlaybackController reset:&error] ) {
+        [self _replaceAudioWithURL:URL options:options];
+    });
+}
+
+- (void)setNextAudioWithURL:(nullable NSURL *)URL options:(nullable __kindof SJAudioPlayerOptions *)options {
+    dispatch_async(_mQueue, ^{
+        self->_mNextURL = URL;
+        self->_mNextOptions = options;
+        self->_mHasNextAudio.store(URL != nil, std::__1::memory_order_relaxed);
+    });
+}
+
+- (void)_replaceAudioWithURL:(nullable NSURL *)URL options:(nullable __kindof SJAudioPlayerOptions *)options {
+    NSError *error = NULL;
+    // 播放中替换时交叉淡化, 不停止输出; 当前音频转为淡出, 直到淡化结束
+    BOOL crossfade = URL != nil && self.audioItem != nil && _mError == nil && self.playWhenReady &&
+                     _mCrossfadeDuration.load(std::__1::memory_order_relaxed) > 0;
+    if ( crossfade ) {
+        [self _setFadingOutItem:self.audioItem newGeneration:YES];
+    }
+    else {
+        [self _cancelCrossfade];
+        if ( ![_mPlaybackController stop:&error] && ![_mPlaybackController reset:&error] ) {
             [self onError:error];
             return;
         }
-        
-        if ( URL ) {
-            FFAudioItemOptions *itemOptions = nil;
-            if ( options ) {
-                itemOptions = [FFAudioItemOptions.alloc init];
-                itemOptions.startTimePosition = options.startTimePosition;
-            }
-            self.audioItem = [FFAudioItem.alloc initWithURL:URL options:itemOptions delegate:self];
+    }
+    
+    if ( URL ) {
+        FFAudioItemOptions *itemOptions = nil;
+        if ( options ) {
+            itemOptions = [FFAudioItemOptions.alloc init];
+            itemOptions.startTimePosition = options.startTimePosition;
         }
-        else {
-            self.audioItem = nil;
+        self.audioItem = [FFAudioItem.alloc initWithURL:URL options:itemOptions delegate:self];
+    }
+    else {
+        self.audioItem = nil;
+    }
+    
+    _mURL = URL;
+    _mOptions = options;
+    self.playableDurationLimit = options ? options.playableDurationLimit : kCMTimeZero;
+    self.currentTime = kCMTimeZero;
+    self.playableTimeRange = kCMTimeRangeZero;
+    self.duration = kCMTimeZero;
+    [self onError:nil];
+    
+    [self setPlayWhenReady:self.playWhenReady changeReason:SJPlayWhenReadyChangeReasonUserRequest];
+    if ( self.playWhenReady ) {
+        if ( ![_mPlaybackController play:&error] ) {
+            [self onError:error];
+            return;
         }
-        
-        self->_mURL = URL;
-        self->_mOptions = options;
-        self.playableDurationLimit = options ? options.playableDurationLimit : kCMTimeZero;
-        self.currentTime = kCMTimeZero;
-        self.playableTimeRange = kCMTimeRangeZero;
-        self.duration = kCMTimeZero;
-        [self onError:nil];
-        
-        [self setPlayWhenReady:self.playWhenReady changeReason:SJPlayWhenReadyChangeReasonUserRequest];
-        if ( self.playWhenReady ) {
-            if ( ![self->_mPlaybackController play:&error] ) {
-                [self onError:error];
-                return;
-            }
+    }
+}
+
+// 切换到下一个音频; 由渲染线程在当前音频即将结束(交叉淡化)或结束时触发
+- (void)_advanceToNextAudioFromItem:(FFAudioItem *)audioItem {
+    if ( audioItem != self.audioItem || _mNextURL == nil ) {
+        return;
+    }
+    NSURL *URL = _mNextURL;
+    __kindof SJAudioPlayerOptions *options = _mNextOptions;
+    _mNextURL = nil;
+    _mNextOptions = nil;
+    _mHasNextAudio.store(NO, std::__1::memory_order_relaxed);
+    [self _replaceAudioWithURL:URL options:options];
+}
+
+// 淡出的音频可能已经结束, 但新的音频仍在淡入; 都需要结束
+- (void)_cancelCrossfade {
+    [self _setFadingOutItem:nil newGeneration:YES];
+}
+
+// 在队列中调用; 更新渲染线程使用的淡出音频; newGeneration 为 YES 时开始新的淡化(渲染线程重置淡化状态);
+// 渲染线程不持有引用, 旧的音频等渲染线程离开之后(最多一个渲染块的时间)再释放, 转码器不会在渲染线程中销毁
+- (void)_setFadingOutItem:(FFAudioItem *_Nullable)item newGeneration:(BOOL)newGeneration {
+    FFAudioItem *oldItem = _mFadingOutItem;
+    _mFadingOutItem = item;
+    
+    if ( newGeneration ) _mCrossfadeGeneration.fetch_add(1, std::__1::memory_order_seq_cst); // 奇数: 正在更新
+    _mFadingOutSlot.store((__bridge void *)item, std::__1::memory_order_seq_cst);
+    if ( newGeneration ) _mCrossfadeGeneration.fetch_add(1, std::__1::memory_order_seq_cst);
+    
+    if ( oldItem != nil && oldItem != item ) {
+        while ( _mFadeRendering.load(std::__1::memory_order_seq_cst) ) {
+            std::this_thread::yield();
         }
-    });
+    }
+}
+
+// 渲染线程结束了淡出(淡化完成或淡出的音频已结束); 期间没有新的淡化时释放淡出的音频
+- (void)_onCrossfadeEnded {
+    if ( _mFadingOutItem != nil && _mCrossfadeEndedGeneration.load(std::__1::memory_order_acquire) == _mCrossfadeGeneration.load(std::__1::memory_order_relaxed) ) {
+        [self _setFadingOutItem:nil newGeneration:NO];
+    }
 }
 
 - (void)seekToTime:(CMTime)time {
@@ -293,6 +443,7 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
             return;
         }
         
+        [self _cancelCrossfade];
         CMTime seekTime = time;
         CMTime playableDurationLimit = self.playableDurationLimit;
         if ( CMTimeCompare(playableDurationLimit, kCMTimeZero) != 0 ) {
@@ -307,6 +458,7 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
         else {
             [self.audioItem seekToTime:seekTime];
         }
+        self.currentTime = seekTime;
 
         NSError *error = nil;
         if ( ![self->_mPlaybackController stop:&error] && ![self->_mPlaybackController reset:&error] ) {
@@ -320,7 +472,7 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
 - (void)play {
     dispatch_async(_mQueue, ^{
         if ( self->_mError ) {
-            [self _onReprepareByErrorWithStartTimePosition:self->_mCurrentTime];
+            [self _onReprepareByErrorWithStartTimePosition:self.currentTime];
             return;
         }
 
@@ -384,6 +536,7 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     }
     
     [self setPlayWhenReady:false changeReason:reason];
+    [_mClock pause];
 
     NSError *error = nil;
     if ( ![_mPlaybackController pause:&error] ) {
@@ -424,6 +577,7 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
         _mError = error;
         
         if ( error ) {
+            [self _cancelCrossfade];
             [self->_mPlaybackController stop:nil];
         }
         [self _notifyOnErrorChange:error];
@@ -481,11 +635,19 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
 
 - (void)audioItem:(FFAudioItem *)item anErrorOccurred:(NSError *)error {
     dispatch_async(_mQueue, ^{
+        // 淡出中的音频出错时由渲染线程直接结束淡化
+        if ( item == self->_mFadingOutItem ) {
+            return;
+        }
         [self onError:error];
     });
 }
 
 - (void)audioItem:(FFAudioItem *)item playableTimeRangeDidChange:(CMTimeRange)timeRange {
+    // 只比较地址
+    if ( (__bridge void *)item == _mFadingOutSlot.load(std::__1::memory_order_relaxed) ) {
+        return;
+    }
     self.playableTimeRange = timeRange;
 }
 
@@ -507,7 +669,7 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     });
 }
 
-- (void)handleRenderWithSilence:(BOOL *)isSilence frameCount:(AVAudioFrameCount)frameCount outputData:(AudioBufferList *)outputData pts:(int64_t *)outPts {
+- (void)handleRenderWithSilence:(BOOL *)isSilence timestamp:(const AudioTimeStamp *)timestamp frameCount:(AVAudioFrameCount)frameCount outputData:(AudioBufferList *)outputData {
     FFAudioItem *audioItem = self.audioItem;
     UInt32 channels = outputData->mNumberBuffers;
     if ( audioItem != nil ) {
@@ -541,9 +703,8 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
         *isSilence = NO;
     }
     
-    if ( outPts ) {
-        *outPts = pts;
-    }
+    // 交叉淡化期间混入淡出中的音频
+    [self _renderCrossfadeWithSilence:isSilence outputs:outPtrs channels:channels frameCount:frameCount incomingFrames:framesRead incomingItem:audioItem];
     
     if ( error != nil ) {
         dispatch_async(_mQueue, ^{
@@ -558,13 +719,27 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
         return;
     }
     
+    // 更新播放时钟; pts 为本次输出的第一个采样的媒体时间
+    if ( framesRead > 0 ) {
+        double sampleRate = audioItem.outputFormat.sampleRate;
+        uint64_t hostTime = (timestamp->mFlags & kAudioTimeStampHostTimeValid) ? timestamp->mHostTime : mach_absolute_time();
+        // 渲染之后才变速, 输出的每个采样对应一个媒体采样, 按 rate 倍的采样率走时
+        double rate = _mRate.load(std::__1::memory_order_relaxed);
+        [_mClock updateWithMediaTime:pts / sampleRate
+                          frameCount:framesRead
+                          sampleRate:sampleRate * rate
+                                rate:rate
+                            hostTime:hostTime
+                             latency:_mPlaybackController.outputLatency];
+    }
+    
     CMTime duration = self.duration;
     if ( CMTimeCompare(duration, kCMTimeZero) == 0 ) {
         return;
     }
     
-    CMTime currentTime = self.currentTime;
-    currentTime = CMTimeMake(pts, audioItem.outputFormat.sampleRate);
+    // 渲染位置; 用于判断是否到达限制的播放时长, 当前时间由播放时钟提供
+    CMTime currentTime = CMTimeMake(pts, audioItem.outputFormat.sampleRate);
     
     // 如果限制了播放时长, 则判断pts是否超出了限制;
     CMTime playableDurationLimit = _mPlayableDurationLimit.load(std::__1::memory_order_relaxed);
@@ -580,13 +755,27 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
         currentTime = duration;
     }
     
-    // 更新当前时间
-    self.currentTime = currentTime;
+    // 设置了下一个音频且开启了交叉淡化, 在结束前开始淡化
+    BOOL hasNextAudio = _mHasNextAudio.load(std::__1::memory_order_relaxed);
+    NSTimeInterval crossfadeDuration = _mCrossfadeDuration.load(std::__1::memory_order_relaxed);
+    if ( hasNextAudio && crossfadeDuration > 0 && !eof ) {
+        CMTime endTime = CMTimeCompare(playableDurationLimit, kCMTimeZero) ? CMTimeMinimum(playableDurationLimit, duration) : duration;
+        if ( CMTimeCompare(CMTimeAdd(currentTime, CMTimeMakeWithSeconds(crossfadeDuration, NSEC_PER_SEC)), endTime) >= 0 ) {
+            dispatch_async(_mQueue, ^{
+                [self _advanceToNextAudioFromItem:audioItem];
+            });
+            return;
+        }
+    }
     
     // eof & 播放结束
     if ( eof && ret == 0 ) {
         dispatch_async(_mQueue, ^{
             if ( audioItem == self.audioItem ) {
+                if ( self->_mNextURL != nil ) {
+                    [self _advanceToNextAudioFromItem:audioItem];
+                    return;
+                }
                 [self _onPause:SJPlayWhenReadyChangeReasonReachedEndPosition];
             }
         });
@@ -601,6 +790,102 @@ SJQueueSync(dispatch_queue_t queue, NS_NOESCAPE dispatch_block_t block) {
     }
 }
 
+// 渲染线程; 无锁读取淡出的音频
+- (void)_renderCrossfadeWithSilence:(BOOL *)isSilence outputs:(float *_Nonnull *_Nonnull)outPtrs channels:(UInt32)channels frameCount:(AVAudioFrameCount)frameCount incomingFrames:(AVAudioFrameCount)incomingFrames incomingItem:(FFAudioItem *_Nullable)incomingItem {
+    // 先标记再读取; 与 _setFadingOutItem:newGeneration: 配合, 保证使用期间音频不会被释放
+    _mFadeRendering.store(true, std::__1::memory_order_seq_cst);
+    uint32_t generation = _mCrossfadeGeneration.load(std::__1::memory_order_seq_cst);
+    void *slot = _mFadingOutSlot.load(std::__1::memory_order_seq_cst);
+    // 队列正在开始或取消淡化, 本次不处理, 下一次渲染时生效
+    if ( (generation & 1) == 0 && generation == _mCrossfadeGeneration.load(std::__1::memory_order_seq_cst) ) {
+        [self _renderCrossfadeWithGeneration:generation outgoingItem:(__bridge FFAudioItem *)slot silence:isSilence outputs:outPtrs channels:channels frameCount:frameCount incomingFrames:incomingFrames incomingItem:incomingItem];
+    }
+    _mFadeRendering.store(false, std::__1::memory_order_release);
+}
+
+// 渲染线程; 新的音频读到数据后开始淡化, 在此之前只输出淡出的音频; 淡出的音频结束或淡化完成后通知队列释放
+- (void)_renderCrossfadeWithGeneration:(uint32_t)generation outgoingItem:(__unsafe_unretained FFAudioItem *_Nullable)outgoingItem silence:(BOOL *)isSilence outputs:(float *_Nonnull *_Nonnull)outPtrs channels:(UInt32)channels frameCount:(AVAudioFrameCount)frameCount incomingFrames:(AVAudioFrameCount)incomingFrames incomingItem:(FFAudioItem *_Nullable)incomingItem {
+    if ( generation != _mRenderCrossfadeGeneration ) {
+        _mRenderCrossfadeGeneration = generation;
+        _mCrossfadeBegan = NO;
+        _mFadeOutEnded = NO;
+        _mCrossfader->end();
+    }
+    
+    // 已结束的淡出音频等待队列释放, 不再读取
+    if ( _mFadeOutEnded ) {
+        outgoingItem = nil;
+    }
+    // 替换音频的过程中两者可能暂时相同, 等待下一次渲染
+    if ( outgoingItem != nil && outgoingItem == incomingItem ) {
+        return;
+    }
+    if ( outgoingItem == nil && !_mCrossfader->isActive() ) {
+        return;
+    }
+    if ( channels != 2 ) {
+        [self _endCrossfadeWithGeneration:generation];
+        return;
+    }
+    
+    // 淡化已完成
+    if ( _mCrossfadeBegan && !_mCrossfader->isActive() ) {
+        [self _endCrossfadeWithGeneration:generation];
+        return;
+    }
+    
+    if ( !_mCrossfadeBegan && incomingFrames > 0 ) {
+        _mCrossfadeBegan = YES;
+        double sampleRate = incomingItem.outputFormat.sampleRate;
+        _mCrossfader->begin((int64_t)(_mCrossfadeDuration.load(std::__1::memory_order_relaxed) * sampleRate), (SJAudioCrossfader::Curve)_mCrossfadeCurve.load(std::__1::memory_order_relaxed));
+    }
+    
+    for ( AVAudioFrameCount offset = 0; offset < frameCount; ) {
+        int n = (int)MIN(frameCount - offset, (AVAudioFrameCount)SJ_CROSSFADE_MAX_FRAMES);
+        int framesRead = 0;
+        if ( outgoingItem != nil ) {
+            BOOL eof = NO;
+            int64_t pts = 0;
+            // 不需要 NSError, 避免在渲染线程中创建; 返回值小于 0 表示出错
+            int ret = [outgoingItem tryTranscodeWithFrameCapacity:n data:(void **)_mFadeBuffers pts:&pts eof:&eof error:NULL];
+            framesRead = MAX(0, ret);
+            if ( ret < 0 || (eof && ret == 0) ) {
+                [self _endCrossfadeWithGeneration:generation];
+                outgoingItem = nil;
+            }
+        }
+        if ( framesRead < n ) {
+            for ( UInt32 ch = 0; ch < 2; ch++ ) {
+                memset(_mFadeBuffers[ch] + framesRead, 0, sizeof(float) * (n - framesRead));
+            }
+        }
+        
+        float *inPtrs[2] = { outPtrs[0] + offset, outPtrs[1] + offset };
+        if ( _mCrossfadeBegan ) {
+            _mCrossfader->process(inPtrs, _mFadeBuffers, 2, n);
+            *isSilence = NO;
+        }
+        // 新的音频还没有数据(输出为静音), 先输出淡出的音频
+        else if ( framesRead > 0 ) {
+            for ( UInt32 ch = 0; ch < 2; ch++ ) {
+                memcpy(inPtrs[ch], _mFadeBuffers[ch], sizeof(float) * n);
+            }
+            *isSilence = NO;
+        }
+        offset += n;
+    }
+}
+
+// 渲染线程; 每次淡化只通知一次; 释放在队列中进行, 避免在渲染线程中销毁转码器
+- (void)_endCrossfadeWithGeneration:(uint32_t)generation {
+    if ( _mFadeOutEnded ) {
+        return;
+    }
+    _mFadeOutEnded = YES;
+    _mCrossfadeEndedGeneration.store(generation, std::__1::memory_order_release);
+    dispatch_source_merge_data(_mCrossfadeEndSource, 1);
+}
+
 - (void)handleAudioEngineConfigurationChange {
     dispatch_async(_mQueue, ^{
         NSError *error = nil;
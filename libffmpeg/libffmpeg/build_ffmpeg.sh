@@ -92,11 +92,12 @@ for TARGET in "${ARCHS[@]}"; do
     --enable-neon \
     --enable-asm \
     --enable-network \
-    --enable-filter=aformat,aresample \
+    --enable-pthreads \
+    --enable-filter=aformat,aresample,atempo,equalizer,acompressor,dynaudnorm,volume,ebur128 \
     --enable-protocol=file,http \
-    --enable-decoder=mp3,aac,alac,flac,opus,vorbis,pcm* \
-    --enable-demuxer=mp3,aac,wav,flac,ogg,opus,mov \
-    --enable-parser=mp3,mpegaudio,flac,opus,vorbis \
+    --enable-decoder=mp3,aac,alac,flac,opus,vorbis,ac3,eac3,dca,pcm* \
+    --enable-demuxer=mp3,aac,wav,flac,ogg,opus,mov,ac3,eac3,dts \
+    --enable-parser=mp3,mpegaudio,flac,opus,vorbis,ac3,dca \
     --extra-cflags="${ARCH_FLAGS} -mios-version-min=${IOS_MIN_VERSION}" \
     --extra-ldflags="${ARCH_FLAGS} -mios-version-min=${IOS_MIN_VERSION}"
 
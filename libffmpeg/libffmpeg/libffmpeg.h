@@ -16,3 +16,6 @@ FOUNDATION_EXPORT const unsigned char libffmpegVersionString[];
 // In this header, you should import all the public headers of your framework using statements like #import <libffmpeg/PublicHeader.h>
 
 #import <libffmpeg/FFAudioItem.h>
+#import <libffmpeg/FFAudioLoudnessAnalyzer.h>
+#import <libffmpeg/FFAudioWaveform.h>
+#import <libffmpeg/FFAudioSpectrumAnalyzer.h>
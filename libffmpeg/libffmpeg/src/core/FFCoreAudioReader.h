@@ -11,29 +11,42 @@ EXTERN_C_START
 #include <libavcodec/packet.h>
 #include <libavformat/avformat.h>
 EXTERN_C_END
+#include <vector>
 
 @protocol FFCoreAudioReaderDelegate;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// prepare/读取/reset 在共享的 I/O 线程池(FFAV::IOScheduler)上串行执行; EOF 或缓冲已满时挂起, 不占用线程;
 @interface FFCoreAudioReader : NSObject
 
 - (instancetype)initWithURL:(NSURL *)URL delegate:(id<FFCoreAudioReaderDelegate>)delegate;
 
-- (void)prepareWithStartTimePosition:(int64_t)startTimePosition; // in base q;
+- (void)prepareWithStartTimePosition:(int64_t)startTimePosition; // in base q; startTimePosition 有效时会产生一次 seek 命令;
 - (void)reset; // 重置所有状态(仅限报错后使用), 重置后可以重新调用 prepare 初始化;
 - (void)start;
 - (void)stop; // 停止后不可继续操作了;
 
 @property (nonatomic, getter=isPacketBufferFull) BOOL packetBufferFull; // 设置缓冲是否已满; 缓冲满后将会暂停读取, 等待缓冲消费后继续;
-- (void)seekToTime:(int64_t)time;  // in base q;
+/// 发送 seek 命令; 返回该命令的 generation; 之后回调的 packet 均以处理命令时的 generation 标记, 小于该值的即为过期的数据;
+- (uint64_t)seekToTime:(int64_t)time;  // in base q;
+/// 最新命令的 generation;
+@property (nonatomic, readonly) uint64_t generation;
+
+/// 所有音频流; 仅在 readyToReadStream 回调之后可用;
+@property (nonatomic, readonly) std::vector<AVStream *> audioStreams;
+/// 切换到指定的音频流并从 time 开始读取; 未选择的流由 demuxer 直接丢弃(AVDISCARD_ALL);
+/// 切换后的 packet 会以 shouldFlush 回调; 准备完成之前调用时, prepare 会直接选择该流;
+- (uint64_t)switchToStreamAtIndex:(int)streamIndex time:(int64_t)time; // in base q;
 @end
 
 /// 所有回调都在子线程;
 @protocol FFCoreAudioReaderDelegate <NSObject>
 - (void)audioReader:(FFCoreAudioReader *)reader readyToReadStream:(AVStream *)stream;
-/// EOF 时 pkt 返回 null;
-- (void)audioReader:(FFCoreAudioReader *)reader didReadPacket:(AVPacket *_Nullable)packet shouldFlush:(BOOL)shouldFlush;
+/// 切换音频流后回调, 之后的 packet 均来自该流;
+- (void)audioReader:(FFCoreAudioReader *)reader didSwitchToStream:(AVStream *)stream;
+/// EOF 时 pkt 返回 null; generation 为读取该 packet 时已处理的命令; 每个 generation 的第一个 packet 的 shouldFlush 为 YES;
+- (void)audioReader:(FFCoreAudioReader *)reader didReadPacket:(AVPacket *_Nullable)packet generation:(uint64_t)generation shouldFlush:(BOOL)shouldFlush;
 - (void)audioReader:(FFCoreAudioReader *)reader anErrorOccurred:(int)error;
 @end
 
@@ -6,33 +6,35 @@
 //
 
 #import "FFCoreAudioReader.h"
-#include <mutex>
-#include <condition_variable>
 #include "MediaReader.h"
+#include "CommandChannel.h"
+#include "IOScheduler.h"
+
+// 每次调度最多读取的 packet 数量, 之后让出线程给其他 reader
+static const int FF_READ_PACKETS_PER_STEP = 16;
 
 @implementation FFCoreAudioReader {
     NSURL *mURL;
-    dispatch_queue_t mQueue;
+    std::shared_ptr<FFAV::IOTask> task; // prepare/read/reset 均在共享的 I/O 线程池上串行执行;
     __weak id<FFCoreAudioReaderDelegate> mDelegate;
 
     FFAV::MediaReader *media_reader;
     AVStream *stream;
-    std::atomic<bool> stopped;
+    FFAV::CommandChannel channel; // seek/切换音轨/停止; 选择的音频流在 reset 时保留, 重新 prepare 时直接选择该流;
     std::atomic<bool> buffer_full;
     bool has_error;
     bool eof;
-    std::atomic<int64_t> req_seek_time; // in base q; default AV_NOPTS_VALUE;
-    int64_t seeking_time; // in base q; current seek time; default AV_NOPTS_VALUE;
-    std::mutex mtx;
-    std::condition_variable cv;
+    FFAV::CommandConsumer consumer; // 读取线程已处理/已回调过 packet 的命令; reset 时保留, 保证 generation 单调递增;
+    AVPacket *pkt;
 }
 
 - (instancetype)initWithURL:(NSURL *)URL delegate:(id<FFCoreAudioReaderDelegate>)delegate {
     self = [super init];
     mURL = URL;
-    mQueue = dispatch_queue_create("FF_AUDIO_READER_QUEUE", DISPATCH_QUEUE_SERIAL);
+    task = FFAV::IOScheduler::shared().createTask();
     mDelegate = delegate;
     media_reader = nullptr;
+    pkt = av_packet_alloc();
 
     [self reset];
     return self;
@@ -44,43 +46,73 @@
 #endif
     
     if ( media_reader ) delete media_reader;
+    av_packet_free(&pkt);
 }
 
 - (void)prepareWithStartTimePosition:(int64_t)startTimePosition {
-    dispatch_async(mQueue, ^{
-        NSParameterAssert(!self->media_reader);
+    // 同步发送 seek 命令, 调用方可以立即通过 generation 得到该命令
+    if ( startTimePosition != AV_NOPTS_VALUE ) {
+        channel.seek(startTimePosition);
+    }
+    
+    task->post([self] {
+        NSCParameterAssert(!self->media_reader);
         
-        [self onPrepareWithStartTimePosition:startTimePosition];
+        [self onPrepare];
+        return FFAV::IOTask::Status::Done;
     });
 }
 
 - (void)start {
-    dispatch_async(mQueue, ^{
-        [self _onRead];
+    task->post([self] {
+        return [self _onRead];
     });
 }
 
 - (void)stop {
-    if ( !stopped.exchange(true, std::__1::memory_order_relaxed) ) {
-        cv.notify_all();
+    if ( !channel.isStopped() ) {
+        channel.stop();
+        [self _notify];
     }
 }
 
 - (void)reset {
-    dispatch_async(mQueue, ^{
+    task->post([self] {
         [self _onReset];
+        return FFAV::IOTask::Status::Done;
     });
 }
 
-- (void)seekToTime:(int64_t)time {
-    if ( req_seek_time.exchange(time) != time ) {
-        cv.notify_all();
+- (uint64_t)seekToTime:(int64_t)time {
+    uint64_t generation = channel.seek(time);
+    [self _notify];
+    return generation;
+}
+
+- (uint64_t)switchToStreamAtIndex:(int)streamIndex time:(int64_t)time {
+    // 流与 seek 时间在同一个命令中生效, 读取线程总是先切换再 seek
+    uint64_t generation = channel.seek(time, streamIndex);
+    [self _notify];
+    return generation;
+}
+
+- (uint64_t)generation {
+    return channel.getGeneration();
+}
+
+- (std::vector<AVStream *>)audioStreams {
+    std::vector<AVStream *> streams;
+    if ( media_reader ) {
+        for ( int index : media_reader->findStreams(AVMEDIA_TYPE_AUDIO) ) {
+            streams.push_back(media_reader->getStream(index));
+        }
     }
+    return streams;
 }
 
 - (void)setPacketBufferFull:(BOOL)packetBufferFull {
-    buffer_full.store(packetBufferFull, std::__1::memory_order_relaxed);
-    if ( !packetBufferFull ) cv.notify_all();
+    // 仅在由满变为未满时唤醒
+    if ( buffer_full.exchange(packetBufferFull, std::__1::memory_order_relaxed) && !packetBufferFull ) [self _notify];
 }
 
 - (BOOL)isPacketBufferFull {
@@ -89,18 +121,18 @@
 
 #pragma mark - mark
 
-- (void)onPrepareWithStartTimePosition:(int64_t)startTimePosition {
+- (void)onPrepare {
     media_reader = new FFAV::MediaReader();
     int ret = 0;
     
     if ( mURL.isFileURL ) {
-        ret = media_reader->open([mURL.path UTF8String]); // maybe thread blocked;
+        ret = media_reader->open([mURL.path UTF8String], { }, AVMEDIA_TYPE_AUDIO); // maybe thread blocked;
     }
     else {
-        ret = media_reader->open([mURL.absoluteString UTF8String]); // maybe thread blocked;
+        ret = media_reader->open([mURL.absoluteString UTF8String], { }, AVMEDIA_TYPE_AUDIO); // maybe thread blocked;
     }
     
-    if ( stopped.load(std::__1::memory_order_relaxed) ) {
+    if ( channel.isStopped() ) {
         return;
     }
     
@@ -110,160 +142,127 @@
         return;
     }
     
-    stream = media_reader->getBestStream(AVMEDIA_TYPE_AUDIO);
+    // 优先使用选择的音频流(切换过音轨后重新 prepare), 否则使用默认的最佳音频流
+    {
+        AVStream *selected = media_reader->getStream(channel.read().stream_index);
+        stream = selected && selected->codecpar->codec_type == AVMEDIA_TYPE_AUDIO ? selected : media_reader->getBestStream(AVMEDIA_TYPE_AUDIO);
+    }
     if ( !stream ) {
         ret = AVERROR_STREAM_NOT_FOUND;
         has_error = true;
         [mDelegate audioReader:self anErrorOccurred:ret];
         return;
     }
-
-    if ( startTimePosition != AV_NOPTS_VALUE ) {
-        req_seek_time.store(startTimePosition, std::__1::memory_order_relaxed);
-    }
+    media_reader->selectStream(stream->index);
 
     [mDelegate audioReader:self readyToReadStream:stream];
 }
 
 // on read thread
-- (void)_onRead {
-    AVPacket* pkt = av_packet_alloc();
+// EOF 或缓冲已满时返回 Wait 挂起, 不占用线程; 新的命令或缓冲有空间时唤醒;
+- (FFAV::IOTask::Status)_onRead {
+    FFAV::CommandChannel::Command cmd;
+    bool is_new_command;
     int ret;
-    bool should_seek;
-    bool should_restart;
-    bool should_exit;
-    bool error_occurred;
-    int64_t st;
     
-    do {
-restart:
-        ret = 0;
-        should_seek = false;
-        should_restart = false;
-        should_exit = false;
-        error_occurred = false;
-
-        if      ( has_error || stopped.load(std::__1::memory_order_acquire) ) {
-            should_exit = true;
-        }
-        // 仅当有变化时才触发 seek
-        else if ( (st = req_seek_time.exchange(AV_NOPTS_VALUE, std::__1::memory_order_acquire)) != AV_NOPTS_VALUE ) {
-            should_seek = true;
-            seeking_time = st;
+    for ( int i = 0 ; i < FF_READ_PACKETS_PER_STEP ; ++ i ) {
+        cmd = consumer.next(channel, is_new_command);
+        if ( has_error || cmd.stopped ) {
+            return FFAV::IOTask::Status::Done;
         }
         
-        if ( should_exit ) {
-            goto exit_thread;
-        }
-        
-        // handle seek
-        if ( should_seek ) {
-            ret = media_reader->seek(seeking_time, -1); // maybe thread blocked;
-            // recheck stop
-            if ( stopped.load(std::__1::memory_order_acquire) ) {
-                should_exit = true;
-            }
-            // recheck seek req
-            else if ( req_seek_time.load(std::__1::memory_order_relaxed) != AV_NOPTS_VALUE ) {
-                should_restart = true;
-            }
-            // seek error
-            else if ( ret < 0 ) {
-                // eof
-                if ( ret == AVERROR_EOF ) {
-                    // nothing
+        // 有新的命令
+        if ( is_new_command ) {
+            eof = false;
+            // 切换音轨; 需要在 seek 之前设置 discard, 使新的流也被 seek 到目标位置
+            [self _switchStreamIfNeeded:cmd.stream_index];
+            
+            // handle seek
+            if ( cmd.seek_time != AV_NOPTS_VALUE ) {
+                ret = media_reader->seek(cmd.seek_time, -1); // maybe thread blocked;
+                // recheck stop/seek/switch req
+                if ( consumer.isOutdated(channel) ) {
+                    continue;
                 }
-                // error
-                else {
-                    has_error = true;
-                    error_occurred = true;
-                    [mDelegate audioReader:self anErrorOccurred:ret];
+                // seek error
+                else if ( ret < 0 ) {
+                    // eof
+                    if ( ret == AVERROR_EOF ) {
+                        // nothing
+                    }
+                    // error
+                    else {
+                        has_error = true;
+                        [mDelegate audioReader:self anErrorOccurred:ret];
+                        return FFAV::IOTask::Status::Done;
+                    }
                 }
             }
-            // seek finish
-            else {
-                eof = false;
-            }
-        }
-        
-        if ( should_exit || error_occurred ) {
-            goto exit_thread;
         }
         
-        if ( should_restart ) {
-            goto restart;
+        // wait next signal
+        // 新命令的第一个 packet(flush)不受缓冲限制, 下游需要它来清空旧的缓冲
+        if ( consumer.hasDelivered() && (eof || buffer_full.load(std::__1::memory_order_relaxed)) ) {
+            return FFAV::IOTask::Status::Wait;
         }
         
         // read pkt
         av_packet_unref(pkt);
         ret = media_reader->readPacket(pkt); // maybe thread blocked;
-        // recheck stop
-        if ( stopped.load(std::__1::memory_order_acquire) ) {
-            should_exit = true;
-        }
-        // recheck seek req
-        else if ( req_seek_time.load(std::__1::memory_order_relaxed) != AV_NOPTS_VALUE ) {
-            should_restart = true;
+        // recheck stop/seek/switch req
+        if ( consumer.isOutdated(channel) ) {
+            continue;
         }
         // read finish
         else if ( ret == 0 ) {
+            // 未选择的流已被 demuxer 丢弃; open 时已排队的封面等 packet 仍可能返回, 这里再过滤一次
             if ( pkt->stream_index == stream->index ) {
-                bool should_flush = seeking_time != AV_NOPTS_VALUE;
-                if ( should_flush ) {
-                    seeking_time = AV_NOPTS_VALUE;
-                }
-                
-                [mDelegate audioReader:self didReadPacket:pkt shouldFlush:should_flush];
+                bool should_flush = consumer.deliver();
+                [mDelegate audioReader:self didReadPacket:pkt generation:consumer.getGeneration() shouldFlush:should_flush];
             }
         }
         // read eof
         else if ( ret == AVERROR_EOF ) {
             eof = true;
             
-            bool should_flush = seeking_time != AV_NOPTS_VALUE;
-            if ( should_flush ) {
-                seeking_time = AV_NOPTS_VALUE;
-            }
-            
             // notify eof
-            [mDelegate audioReader:self didReadPacket:nullptr shouldFlush:should_flush];
-            
-            {
-                // wait next signal
-                std::unique_lock<std::mutex> lock(mtx);
-                cv.wait(lock, [self] {
-                    // 这里不需要专门对 hasError 进行判断
-                    
-                    if ( stopped.load(std::__1::memory_order_acquire) ) {
-                        return true;
-                    }
-                    
-                    if ( req_seek_time.load(std::__1::memory_order_relaxed) != AV_NOPTS_VALUE ) {
-                        return true;
-                    }
-                
-                    return !eof && !buffer_full.load(std::__1::memory_order_relaxed);
-                });
-            }
+            bool should_flush = consumer.deliver();
+            [mDelegate audioReader:self didReadPacket:nullptr generation:consumer.getGeneration() shouldFlush:should_flush];
         }
         // ret < 0;
         // read error
         else {
             has_error = true;
-            error_occurred = true;
             [mDelegate audioReader:self anErrorOccurred:ret];
+            return FFAV::IOTask::Status::Done;
         }
-        
-        if ( should_exit || error_occurred ) {
-            goto exit_thread;
-        }
-    } while (true);
+    }
     
-exit_thread:
-    av_packet_free(&pkt);
+    return FFAV::IOTask::Status::Yield;
+}
+
+// on read thread
+- (void)_switchStreamIfNeeded:(int)index {
+    if ( index == -1 || index == stream->index ) {
+        return;
+    }
+    
+    AVStream *selected = media_reader->getStream(index);
+    if ( !selected || selected->codecpar->codec_type != AVMEDIA_TYPE_AUDIO ) {
+        return;
+    }
+    
+    stream = selected;
+    media_reader->selectStream(index);
+    [mDelegate audioReader:self didSwitchToStream:stream];
+}
+
+// 唤醒挂起的读取任务; 读取任务运行期间的唤醒不会丢失
+- (void)_notify {
+    task->wake();
 }
 
-// 报错重置时, req_seek_time, seeking_time 也会一起重置
+// 报错重置时, 命令通道和 generation 会保留; 重新 prepare 时按最新的命令选择音频流;
 - (void)_onReset {
     if ( media_reader ) {
         delete media_reader;
@@ -271,11 +270,8 @@ exit_thread:
     }
     
     stream = nullptr;
-    stopped.store(false, std::__1::memory_order_relaxed);
     buffer_full.store(false, std::__1::memory_order_relaxed);
     has_error = false;
     eof = false;
-    req_seek_time.store(AV_NOPTS_VALUE, std::__1::memory_order_relaxed);
-    seeking_time = AV_NOPTS_VALUE;
 }
 @end
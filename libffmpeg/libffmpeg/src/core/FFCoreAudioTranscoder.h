@@ -13,6 +13,12 @@ EXTERN_C_START
 #include <libavcodec/packet.h>
 #include <libavformat/avformat.h>
 EXTERN_C_END
+#include "AudioEffectChain.h"
+#include "ResamplePresets.h"
+#include "SilenceTrimmer.h"
+#include "SpectrumAnalyzer.h"
+#include "TimeRangeList.h"
+#include <memory>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -20,16 +26,42 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, strong, readonly) AVAudioFormat *outputFormat;
 @property (nonatomic, readonly, getter=isPacketBufferFull) BOOL packetBufferFull; // 缓冲是否已满;
-@property (nonatomic, readonly) CMTimeRange timeRange;
 @property (nonatomic, readonly) BOOL eof;
 
+/// 播放速率(变速不变调), 范围 0.5 ~ 100; 已准备好时通过 sendCommand 实时生效;
+@property (nonatomic, readonly) float rate;
+- (int)setRate:(float)rate;
+
+/// 重采样质量, 默认 Balanced; 已准备好时会在下次转码前重建 filter graph;
+@property (nonatomic) FFAV::ResampleQuality resampleQuality;
+
+/// 音效链; 参数变更实时生效, stage 开关变化后会在下次转码前重建 filter graph;
+@property (nonatomic, readonly) FFAV::AudioEffectChain *effects;
+
+/// 静音裁剪; 位于 filter graph 的输出与 fifo 之间, 默认关闭; 参数变更在之后写入的数据上生效;
+@property (nonatomic, readonly) FFAV::SilenceTrimmer *silenceTrimmer;
+
+/// 被静音裁剪跳过的范围(媒体时间), 单位为微秒(AV_TIME_BASE); 精确记录每一段, 任意线程读取;
+@property (nonatomic, readonly) const FFAV::TimeRangeList *skippedRanges;
+
+/// 频谱分析; 设置后每次读取 fifo 时将输出的 pcm 复制给它, FFT 由其他线程完成;
+@property (nonatomic) std::shared_ptr<FFAV::SpectrumAnalyzer> spectrumAnalyzer;
+
 - (int)prepareByAudioStream:(AVStream *)stream;
 
+/// 切换音轨; 使用新的流重新创建解码器与 filter graph, 并清空缓存的 packet 与 pcm 数据; 速率及音效设置保持不变;
+/// 失败时保持原来的状态;
+- (int)switchToAudioStream:(AVStream *)stream;
+
+/// packet 的数据引用会被转移到内部队列(av_packet_move_ref), 调用后 packet 被重置;
 - (int)pushPacket:(AVPacket *_Nullable)packet shouldFlush:(BOOL)shouldFlush;
 - (int)pushPacket:(AVPacket *_Nullable)packet shouldOnlyFlushPackets:(BOOL)shouldOnlyFlushPackets;
 
 @property (nonatomic, readonly) CMTime fifoEndPts; // 可能返回 kCMTimeInvalid;
 
+/// 已缓冲的范围(从未播放的位置到已读取的末尾), 单位为微秒(AV_TIME_BASE); 未准备好或范围未知时返回 NO;
+- (BOOL)getBufferedRangeStart:(int64_t *)outStart end:(int64_t *)outEnd;
+
 /// 尝试转码出指定数量的音频数据;
 ///
 /// 数据足够时返回值与frameCapacity一致;
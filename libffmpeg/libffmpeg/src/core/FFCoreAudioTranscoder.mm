@@ -12,10 +12,16 @@
 #import "FilterGraph.h"
 #import "AudioFifo.h"
 #import "AudioUtils.h"
+#import "SampleTimeline.h"
 #import "FFCoreFormat.h"
+#import "AudioKernels.h"
 
 static const std::string FF_FILTER_BUFFER_SRC_NAME = "0:a";
 static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
+static const std::string FF_FILTER_RATE_NAME = "atempo";
+
+static const double FF_MIN_RATE = 0.5; // atempo 支持的范围
+static const double FF_MAX_RATE = 100.0;
 
 @implementation FFCoreAudioTranscoder {
     AVAudioFormat *mOutputAudioFormat;
@@ -29,13 +35,27 @@ static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
     
     BOOL mShouldDrainPackets; // 控制缓冲， 确保流畅播放(满3s)
     
+    double mRate; // 播放速率, 由 filter graph 中的 atempo 完成变速;
+    int64_t mGraphOutputEndPts; // filter graph 已输出的结束位置(输出时间线)
+    FFAV::SampleTimeline *mGraphTimeline; // filter graph 输出位置 -> 媒体时间
+    FFAV::SampleTimeline *mFifoTimeline;  // fifo 位置 -> 媒体时间
+    FFAV::AudioEffectChain *mEffects;
+    FFAV::ResampleQuality mResampleQuality;
+    BOOL mResampleQualityChanged; // 重采样质量发生变化, 需要重建 graph
+    
     int64_t mAudioStreamDuration;
     AVRational mAudioStreamTimeBase;
     AVBufferSrcParameters *mBufferSrcParams;
     FFAV::MediaDecoder *mAudioDecoder;
     FFAV::FilterGraph *mFilterGraph;
+    FFAV::BufferSourceHandle mBufferSrc; // configure 后缓存, 每帧直接使用
+    FFAV::BufferSinkHandle mBufferSink;
+    AVFilterContext *mTempoFilter;
     FFAV::PacketQueue *mPacketQueue;
     FFAV::AudioFifo *mAudioFifo;
+    std::shared_ptr<FFAV::SpectrumAnalyzer> mSpectrumAnalyzer;
+    FFAV::SilenceTrimmer *mSilenceTrimmer;
+    FFAV::TimeRangeList *mSkippedRanges;
     
     AVPacket *mPacket;
     AVFrame *mDecFrame;
@@ -51,6 +71,22 @@ static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
                                                        interleaved:FFCoreFormat::FF_OUTOUT_INTERLEAVED];
     mOutputBytesPerSample = av_get_bytes_per_sample(FFCoreFormat::FF_OUTPUT_SAMPLE_FORMAT);
     mPacketSizeThreshold = 5 * 1024 * 1024;
+    mRate = 1.0;
+    mGraphOutputEndPts = AV_NOPTS_VALUE;
+    mGraphTimeline = new FFAV::SampleTimeline();
+    mFifoTimeline = new FFAV::SampleTimeline();
+    mEffects = new FFAV::AudioEffectChain();
+    mResampleQuality = FFAV::ResampleQuality::Balanced;
+    
+    // 未被裁剪的数据写入 fifo; 跳过的部分在 fifo 的时间线上表现为不连续
+    __unsafe_unretained FFCoreAudioTranscoder *unretainedSelf = self;
+    mSilenceTrimmer = new FFAV::SilenceTrimmer(FFCoreFormat::FF_OUTPUT_CHANNELS, FFCoreFormat::FF_OUTPUT_SAMPLE_RATE, [unretainedSelf](const float *const *planes, int nb_samples, int64_t media_pts, double rate) {
+        return [unretainedSelf _writeSamples:(uint8_t **)planes count:nb_samples pts:media_pts mediaPts:media_pts rate:rate];
+    });
+    mSkippedRanges = new FFAV::TimeRangeList();
+    mSilenceTrimmer->setSkipHandler([unretainedSelf](int64_t media_start, int64_t media_end) {
+        [unretainedSelf _onSkipSilenceFrom:media_start to:media_end];
+    });
     return self;
 }
 
@@ -67,57 +103,126 @@ static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
     if ( mPacket ) av_packet_free(&mPacket);
     if ( mDecFrame ) av_frame_free(&mDecFrame);
     if ( mFiltFrame ) av_frame_free(&mFiltFrame);
+    delete mGraphTimeline;
+    delete mFifoTimeline;
+    delete mEffects;
+    delete mSilenceTrimmer;
+    delete mSkippedRanges;
 }
 
 - (BOOL)isPacketBufferFull {
-    return mPacketQueue->getSize() >= mPacketSizeThreshold;
+    // 倍速播放时消耗得更快, 缓冲阈值需按速率放大
+    return mPacketQueue->getSize() >= mPacketSizeThreshold * MAX(mRate, 1.0);
+}
+
+- (float)rate {
+    return mRate;
+}
+
+- (FFAV::ResampleQuality)resampleQuality {
+    return mResampleQuality;
+}
+
+- (void)setResampleQuality:(FFAV::ResampleQuality)resampleQuality {
+    if ( resampleQuality == mResampleQuality ) {
+        return;
+    }
+    mResampleQuality = resampleQuality;
+    mResampleQualityChanged = mPrepared && mFilterGraph != nullptr;
+}
+
+- (int)setRate:(float)rate {
+    double tempo = MIN(MAX(rate, FF_MIN_RATE), FF_MAX_RATE);
+    if ( tempo == mRate ) {
+        return 0;
+    }
+    
+    // libavfilter 未包含 atempo 时只支持原速
+    if ( !FFAV::FilterGraph::isFilterAvailable(FF_FILTER_RATE_NAME) ) {
+        return AVERROR_FILTER_NOT_FOUND;
+    }
+    
+    mRate = tempo;
+    if ( !mPrepared || mFilterGraph == nullptr ) {
+        return 0;
+    }
+    
+    // 从 graph 当前的输出位置开始按新速率换算
+    if ( mGraphOutputEndPts != AV_NOPTS_VALUE ) {
+        mGraphTimeline->changeRate(mGraphOutputEndPts, tempo);
+    }
+    if ( mTempoFilter == nullptr ) {
+        return AVERROR_FILTER_NOT_FOUND;
+    }
+    return mFilterGraph->sendCommand(mTempoFilter, "tempo", std::to_string(tempo));
+}
+
+- (FFAV::AudioEffectChain *)effects {
+    return mEffects;
+}
+
+- (FFAV::SilenceTrimmer *)silenceTrimmer {
+    return mSilenceTrimmer;
+}
+
+- (const FFAV::TimeRangeList *)skippedRanges {
+    return mSkippedRanges;
+}
+
+- (void)setSpectrumAnalyzer:(std::shared_ptr<FFAV::SpectrumAnalyzer>)spectrumAnalyzer {
+    mSpectrumAnalyzer = std::move(spectrumAnalyzer);
+}
+
+- (std::shared_ptr<FFAV::SpectrumAnalyzer>)spectrumAnalyzer {
+    return mSpectrumAnalyzer;
 }
 
 - (AVAudioFormat *)outputFormat {
     return mOutputAudioFormat;
 }
 
-- (CMTimeRange)timeRange {
-    CMTimeRange timeRange = kCMTimeRangeZero;
-    if ( mPrepared ) {
-        int64_t startPts = 0;
-        int64_t endPts = 0;
-        
-        int64_t fifoNextPts = mAudioFifo->getNextPts();         // range start, (还未读取的pcm数据)
-        int64_t frontPts = mPacketQueue->getFrontPacketPts();   // range start, (未调用pop时取该值为起始值)
-        int64_t lastPopPts = mPacketQueue->getLastPopPts();     // range start
-        int64_t lastPushPts = mPacketQueue->getLastPushPts();   // range end
-
-        // start pts
-        if ( fifoNextPts != AV_NOPTS_VALUE ) {
-            startPts = av_rescale_q(fifoNextPts, (AVRational) { 1, (int)mOutputAudioFormat.sampleRate }, mAudioStreamTimeBase);
-        }
-        else if ( mPacketEOF && mPacketQueue->getCount() == 0 ) {
-            startPts = mAudioStreamDuration;
-        }
-        else if ( lastPopPts != AV_NOPTS_VALUE ) {
-            startPts = lastPopPts;
-        }
-        else {
-            startPts = frontPts;
-        }
-        
-        // end pts
-        if ( mPacketEOF ) {
-            endPts = mAudioStreamDuration;
-        }
-        else {
-            endPts = lastPushPts;
-        }
-        
-        if ( startPts != AV_NOPTS_VALUE && endPts != AV_NOPTS_VALUE ) {
-            CMTime rangeStart = CMTimeMake(startPts * mAudioStreamTimeBase.num, mAudioStreamTimeBase.den);
-            CMTime rangeEnd = CMTimeMake(endPts * mAudioStreamTimeBase.num, mAudioStreamTimeBase.den);
-            CMTime rangeDuration = CMTimeSubtract(rangeEnd, rangeStart);
-            timeRange = CMTimeRangeMake(rangeStart, rangeDuration);
-        }
+- (BOOL)getBufferedRangeStart:(int64_t *)outStart end:(int64_t *)outEnd {
+    if ( !mPrepared ) {
+        return NO;
+    }
+    
+    int64_t startPts = 0;
+    int64_t endPts = 0;
+    
+    int64_t fifoNextPts = mAudioFifo->getNextPts();         // range start, (还未读取的pcm数据)
+    int64_t frontPts = mPacketQueue->getFrontPacketPts();   // range start, (未调用pop时取该值为起始值)
+    int64_t lastPopPts = mPacketQueue->getLastPopPts();     // range start
+    int64_t lastPushPts = mPacketQueue->getLastPushPts();   // range end
+
+    // start pts
+    if ( fifoNextPts != AV_NOPTS_VALUE ) {
+        startPts = av_rescale_q(mFifoTimeline->toMedia(fifoNextPts), (AVRational) { 1, (int)mOutputAudioFormat.sampleRate }, mAudioStreamTimeBase);
+    }
+    else if ( mPacketEOF && mPacketQueue->getCount() == 0 ) {
+        startPts = mAudioStreamDuration;
+    }
+    else if ( lastPopPts != AV_NOPTS_VALUE ) {
+        startPts = lastPopPts;
+    }
+    else {
+        startPts = frontPts;
     }
-    return timeRange;
+    
+    // end pts
+    if ( mPacketEOF ) {
+        endPts = mAudioStreamDuration;
+    }
+    else {
+        endPts = lastPushPts;
+    }
+    
+    if ( startPts == AV_NOPTS_VALUE || endPts == AV_NOPTS_VALUE ) {
+        return NO;
+    }
+    
+    *outStart = av_rescale_q(startPts, mAudioStreamTimeBase, AV_TIME_BASE_Q);
+    *outEnd = av_rescale_q(endPts, mAudioStreamTimeBase, AV_TIME_BASE_Q);
+    return YES;
 }
 
 - (BOOL)eof {
@@ -128,7 +233,7 @@ static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
     if ( mPrepared ) {
         int64_t pts = mAudioFifo->getEndPts();
         if ( pts != AV_NOPTS_VALUE ) {
-            return CMTimeMake(pts, (int)mOutputAudioFormat.sampleRate);
+            return CMTimeMake(mFifoTimeline->toMedia(pts), (int)mOutputAudioFormat.sampleRate);
         }
     }
     return kCMTimeInvalid;
@@ -147,19 +252,25 @@ static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
     mAudioStreamTimeBase = stream->time_base;
 
     // init decoder
-    mAudioDecoder = new FFAV::MediaDecoder();
-    ff_ret = mAudioDecoder->init(stream->codecpar);
+    mAudioDecoder = [self _createDecoderWithStream:stream error:&ff_ret];
     if ( ff_ret < 0 ) {
         goto on_exit; // exit;
     }
     
     // create buffer src params
     mBufferSrcParams = mAudioDecoder->createBufferSrcParameters(stream->time_base);
+    if ( mBufferSrcParams == nullptr ) {
+        ff_ret = AVERROR(ENOMEM);
+        goto on_exit; // exit;
+    }
    
     // init filter graph
-    mFilterGraph = [self _createFilterGraphWithError:&ff_ret];
-    if ( ff_ret < 0 ) {
-        goto on_exit; // exit;
+    {
+        FFAV::FilterGraph *filterGraph = [self _createFilterGraphWithBufferSrcParams:mBufferSrcParams error:&ff_ret];
+        if ( ff_ret < 0 ) {
+            goto on_exit; // exit;
+        }
+        [self _setFilterGraph:filterGraph];
     }
     
     // init pkt queue
@@ -176,13 +287,83 @@ static const std::string FF_FILTER_BUFFER_SINK_NAME = "result";
     mPacket = av_packet_alloc();
     mDecFrame = av_frame_alloc();
     mFiltFrame = av_frame_alloc();
+    mPrepared = YES;
 
 on_exit:
     return ff_ret;
 }
 
+- (int)switchToAudioStream:(AVStream *)stream {
+    NSParameterAssert(mPrepared);
+    
+    if ( stream->codecpar == nullptr ) {
+        return AVERROR_DECODER_NOT_FOUND;
+    }
+    
+    // 新的解码器与 filter graph 都创建成功之后再替换, 任一步失败时保持原来的状态
+    int ff_ret = 0;
+    FFAV::MediaDecoder *decoder = [self _createDecoderWithStream:stream error:&ff_ret];
+    if ( ff_ret < 0 ) {
+        return ff_ret;
+    }
+    
+    AVBufferSrcParameters *bufferSrcParams = decoder->createBufferSrcParameters(stream->time_base);
+    if ( bufferSrcParams == nullptr ) {
+        delete decoder;
+        return AVERROR(ENOMEM);
+    }
+    
+    FFAV::FilterGraph *filterGraph = [self _createFilterGraphWithBufferSrcParams:bufferSrcParams error:&ff_ret];
+    if ( ff_ret < 0 ) {
+        // 音效链重新关联到原来的 graph
+        if ( mFilterGraph ) mEffects->attach(mFilterGraph);
+        av_free(bufferSrcParams);
+        delete decoder;
+        return ff_ret;
+    }
+    
+    delete mAudioDecoder;
+    av_free(mBufferSrcParams);
+    mAudioDecoder = decoder;
+    mBufferSrcParams = bufferSrcParams;
+    mAudioStreamDuration = stream->duration;
+    mAudioStreamTimeBase = stream->time_base;
+    
+    mResampleQualityChanged = NO;
+    mGraphTimeline->clear();
+    mGraphOutputEndPts = AV_NOPTS_VALUE;
+    [self _setFilterGraph:filterGraph];
+    
+    mPacketEOF = false;
+    mTranscodingEOF = false;
+    mShouldAlignFrames = NO;
+    mAudioFifo->clear();
+    mFifoTimeline->clear();
+    mSilenceTrimmer->reset();
+    mSkippedRanges->clear();
+    mPacketQueue->clear();
+    return 0;
+}
+
+- (FFAV::MediaDecoder *_Nullable)_createDecoderWithStream:(AVStream *)stream error:(int *)errPtr {
+    FFAV::MediaDecoder *decoder = new FFAV::MediaDecoder();
+    // 高码率的无损格式(flac, alac)在低端设备上单线程解码可能跟不上, 由 avcodec 按核数开启帧级多线程
+    FFAV::MediaDecoderOptions decoderOptions;
+    decoderOptions.thread_count = 0;
+    // 多声道(ac3/eac3/dca 等)在解码阶段直接下混为输出布局, 并请求输出格式, 减少 filter graph 中的转换
+    decoderOptions.downmix = FFCoreFormat::FF_OUTPUT_CHANNEL_DESC;
+    decoderOptions.request_sample_fmt = FFCoreFormat::FF_OUTPUT_SAMPLE_FORMAT;
+    int ff_ret = decoder->init(stream->codecpar, decoderOptions);
+    if ( ff_ret < 0 ) {
+        if ( errPtr ) *errPtr = ff_ret;
+        delete decoder;
+        return nullptr;
+    }
+    return decoder;
+}
+
 - (int)push:(AVPacket *)packet {
-    mPacketQueue->push(packet);
+    mPacketQueue->pushMoveRef(packet);
     return 0;
 }
 
@@ -192,6 +373,8 @@ on_exit:
         mTranscodingEOF = false;
         
         mAudioFifo->clear();
+        mFifoTimeline->clear();
+        mSilenceTrimmer->reset();
         mPacketQueue->clear();
         mAudioDecoder->flush();
      
@@ -203,7 +386,7 @@ on_exit:
     }
     
     if ( packet ) {
-        mPacketQueue->push(packet);
+        mPacketQueue->pushMoveRef(packet);
     }
     else {
         mPacketEOF = true;
@@ -221,6 +404,8 @@ on_exit:
         mPacketEOF = false;
         mTranscodingEOF = false;
         mShouldAlignFrames = mAudioFifo->getNumberOfSamples() > 0;
+        // 暂存的静音位于 fifo 之后, 会由新的数据重新生成
+        mSilenceTrimmer->reset();
     
         mPacketQueue->clear();
         mAudioDecoder->flush();
@@ -233,7 +418,7 @@ on_exit:
     }
     
     if ( packet ) {
-        mPacketQueue->push(packet);
+        mPacketQueue->pushMoveRef(packet);
     }
     else {
         mPacketEOF = true;
@@ -256,7 +441,8 @@ on_exit:
             int64_t startPts = mPacketQueue->getFrontPacketPts();
             int64_t endPts = mPacketQueue->getLastPushPts();
             if ( endPts != AV_NOPTS_VALUE && startPts != AV_NOPTS_VALUE ) {
-                if ( endPts - startPts >= av_rescale_q(3, (AVRational){ 1, 1 }, mAudioStreamTimeBase) ) {
+                // 倍速播放时 3s 的墙上时间需要 3 * rate 的媒体时长
+                if ( endPts - startPts >= av_rescale_q((int64_t)(3 * MAX(mRate, 1.0) * AV_TIME_BASE), AV_TIME_BASE_Q, mAudioStreamTimeBase) ) {
                     mShouldDrainPackets = YES; // 需要榨干pkts
                 }
             }
@@ -267,90 +453,45 @@ on_exit:
         return 0;
     }
     
+    // 音效 stage 开关或重采样质量发生变化, 需要重建 graph
+    if ( !mTranscodingEOF && (mEffects->needsRebuild() || mResampleQualityChanged) ) {
+        int ff_ret = [self _rebuildFilterGraph];
+        if ( ff_ret < 0 ) {
+            return ff_ret;
+        }
+    }
+    
     // transcoding
     if ( !mTranscodingEOF ) {
-        int ff_ret = 0;
-        do {
-            // 如果转码后的数据足够或者已转码结束, 则退出循环
-            if ( mAudioFifo->getNumberOfSamples() >= frameCapacity || mTranscodingEOF ) {
-                break;
+        // 一次调用连续转码多个 packet; 数据足够或暂无可转码数据时停止;
+        int ff_ret = FFAV::AudioUtils::transcodePackets([self, frameCapacity](AVPacket *&pkt) {
+            // 如果转码后的数据足够, 则退出循环
+            if ( self->mAudioFifo->getNumberOfSamples() >= frameCapacity ) {
+                return false;
             }
             
             // 当前无可转码数据时, 退出循环
-            if ( !mPacketEOF && mPacketQueue->getSize() == 0 ) {
-                break;
+            if ( !self->mPacketEOF && self->mPacketQueue->getSize() == 0 ) {
+                return false;
             }
             
             // 有可转码数据或已`read eof`
-            AVPacket* nextPacket = nullptr;
-            if ( mPacketQueue->pop(mPacket) ) {
-                nextPacket = mPacket;
-            }
-            
-            // do transcode
-            ff_ret = FFAV::AudioUtils::transcode(nextPacket, mAudioDecoder, mDecFrame, mFilterGraph, mFiltFrame, FF_FILTER_BUFFER_SRC_NAME, FF_FILTER_BUFFER_SINK_NAME, [self](AVFrame *filtFrame) {
-                // flush packets 已完成 && 需要对齐时
-                if ( mShouldAlignFrames ) {
-                    int64_t aligned_pts = mAudioFifo->getEndPts();
-                    int64_t start_pts = filtFrame->pts;
-                    if ( aligned_pts != AV_NOPTS_VALUE && aligned_pts != start_pts ) {
-                        if ( start_pts > aligned_pts ) {
-                            return AVERROR_BUG2;
-                        }
-
-                        int64_t end_pts = start_pts + filtFrame->nb_samples;
-                        if ( aligned_pts >= end_pts ) {
-                            return 0;
-                        }
-
-                        // intersecting samples
-                        int64_t nb_samples = end_pts - aligned_pts;
-                        // LR LR LR
-                        if ( FFCoreFormat::FF_OUTOUT_INTERLEAVED ) {
-                            int64_t pos_offset = (aligned_pts - start_pts) * mOutputBytesPerSample * FFCoreFormat::FF_OUTPUT_CHANNELS;
-                            uint8_t *ptr = filtFrame->data[0] + pos_offset;
-                            mShouldAlignFrames = false;
-                            return mAudioFifo->write((void **)&ptr, (int)nb_samples, aligned_pts);
-                        }
-                        // ch0: L L L
-                        // ch1: R R R
-                        else {
-                            int64_t pos_offset = (aligned_pts - start_pts) * mOutputBytesPerSample;
-                            uint8_t *chPtr[FFCoreFormat::FF_OUTPUT_CHANNELS];
-                            for (int ch = 0; ch < FFCoreFormat::FF_OUTPUT_CHANNELS; ++ch) {
-                                chPtr[ch] = filtFrame->data[ch] + pos_offset;
-                            }
-                            mShouldAlignFrames = false;
-                            return mAudioFifo->write((void **)chPtr, (int)nb_samples, aligned_pts);
-                        }
-                    }
-                    else {
-                        mShouldAlignFrames = false;
-                    }
-                }
-                return mAudioFifo->write((void **)filtFrame->data, filtFrame->nb_samples, filtFrame->pts);
-            });
-            
-            if ( nextPacket ) {
-                av_packet_unref(nextPacket);
-            }
-            
-            // eof
-            if ( ff_ret == AVERROR_EOF ) {
-                mTranscodingEOF = true;
-                break;
-            }
-            else if ( ff_ret == AVERROR(EAGAIN) ) {
-                // nothing
-            }
-            // error
-            else if ( ff_ret < 0 ) {
-                break;
-            }
-        } while (true);
+            pkt = self->mPacketQueue->pop(self->mPacket) ? self->mPacket : nullptr;
+            return true;
+        }, mAudioDecoder, mDecFrame, mFilterGraph, mFiltFrame, mBufferSrc, mBufferSink, [self](AVFrame *filtFrame) {
+            return [self _writeFilteredFrame:filtFrame];
+        });
         
+        // eof; 输出静音裁剪暂存的数据
+        if ( ff_ret == AVERROR_EOF ) {
+            ff_ret = mSilenceTrimmer->flush();
+            if ( ff_ret < 0 ) {
+                return ff_ret;
+            }
+            mTranscodingEOF = true;
+        }
         // transcode error
-        if ( ff_ret < 0 && ff_ret != AVERROR_EOF && ff_ret != AVERROR(EAGAIN) ) {
+        else if ( ff_ret < 0 ) {
             return ff_ret;
         }
     }
@@ -361,7 +502,9 @@ on_exit:
         if ( mAudioFifo->getNumberOfSamples() >= frameCapacity || mTranscodingEOF ) {
             int64_t pts = 0;
             ret = mAudioFifo->read(outData, frameCapacity, &pts);
-            if ( outPts ) *outPts = pts;
+            if ( outPts ) *outPts = mFifoTimeline->toMedia(pts);
+            mFifoTimeline->trim(pts);
+            if ( ret > 0 && mSpectrumAnalyzer ) mSpectrumAnalyzer->push((const float *const *)outData, ret);
         }
     }
     
@@ -379,15 +522,144 @@ on_exit:
 
 #pragma mark - mark
 
+- (int)_writeFilteredFrame:(AVFrame *)filtFrame {
+    // 新建的 graph 中 atempo 以第一帧的 pts 为起点, 之后按输出样本数递增
+    if ( mGraphTimeline->isEmpty() ) {
+        mGraphTimeline->start(filtFrame->pts, filtFrame->pts, mRate);
+    }
+    mGraphOutputEndPts = filtFrame->pts + filtFrame->nb_samples;
+    
+    double rate = mGraphTimeline->getRate(filtFrame->pts);
+    int64_t media_pts = mGraphTimeline->toMedia(filtFrame->pts);
+    int64_t offset = 0;
+    
+    // flush packets 已完成 && 需要对齐时
+    if ( mShouldAlignFrames ) {
+        int64_t fifo_end_pts = mAudioFifo->getEndPts();
+        if ( fifo_end_pts != AV_NOPTS_VALUE ) {
+            int64_t aligned_media_pts = mFifoTimeline->toMedia(fifo_end_pts);
+            if ( media_pts > aligned_media_pts ) {
+                return AVERROR_BUG2;
+            }
+            
+            int64_t media_end_pts = media_pts + llround(filtFrame->nb_samples * rate);
+            if ( aligned_media_pts >= media_end_pts ) {
+                return 0;
+            }
+            
+            // intersecting samples
+            offset = (int64_t)((aligned_media_pts - media_pts) / rate);
+            media_pts = aligned_media_pts;
+        }
+        mShouldAlignFrames = false;
+    }
+    
+    int64_t nb_samples = filtFrame->nb_samples - offset;
+    if ( nb_samples <= 0 ) {
+        return 0;
+    }
+    
+    // libavfilter 未包含 volume 时音量在这里施加(fltp/flt)
+    float gain = mEffects->getSoftwareGain();
+    if ( gain != 1.0f ) {
+        int ff_ret = av_frame_make_writable(filtFrame);
+        if ( ff_ret < 0 ) {
+            return ff_ret;
+        }
+        if ( FFCoreFormat::FF_OUTOUT_INTERLEAVED ) {
+            float *ptr = (float *)filtFrame->data[0];
+            FFAV::AudioKernels::applyGain(&ptr, 1, gain, filtFrame->nb_samples * FFCoreFormat::FF_OUTPUT_CHANNELS);
+        }
+        else {
+            FFAV::AudioKernels::applyGain((float **)filtFrame->data, FFCoreFormat::FF_OUTPUT_CHANNELS, gain, filtFrame->nb_samples);
+        }
+    }
+    
+    // LR LR LR
+    if ( FFCoreFormat::FF_OUTOUT_INTERLEAVED ) {
+        int64_t pos_offset = offset * mOutputBytesPerSample * FFCoreFormat::FF_OUTPUT_CHANNELS;
+        uint8_t *ptr = filtFrame->data[0] + pos_offset;
+        return [self _writeSamples:&ptr count:(int)nb_samples pts:filtFrame->pts + offset mediaPts:media_pts rate:rate];
+    }
+    // ch0: L L L
+    // ch1: R R R
+    int64_t pos_offset = offset * mOutputBytesPerSample;
+    uint8_t *chPtr[FFCoreFormat::FF_OUTPUT_CHANNELS];
+    for (int ch = 0; ch < FFCoreFormat::FF_OUTPUT_CHANNELS; ++ch) {
+        chPtr[ch] = filtFrame->data[ch] + pos_offset;
+    }
+    // 静音裁剪(fltp); 未被裁剪的部分通过 _writeSamples 写入 fifo
+    if ( mSilenceTrimmer->isActive() ) {
+        return mSilenceTrimmer->process((const float *const *)chPtr, (int)nb_samples, media_pts, rate);
+    }
+    return [self _writeSamples:chPtr count:(int)nb_samples pts:filtFrame->pts + offset mediaPts:media_pts rate:rate];
+}
+
+- (int)_writeSamples:(uint8_t *_Nonnull *_Nonnull)data count:(int)nb_samples pts:(int64_t)pts mediaPts:(int64_t)media_pts rate:(double)rate {
+    // 记录 fifo 的时间线; 速率变更或不连续(例如跳过了静音)时追加锚点
+    int64_t fifo_end_pts = mAudioFifo->getEndPts();
+    if ( fifo_end_pts == AV_NOPTS_VALUE ) {
+        mFifoTimeline->start(pts, media_pts, rate);
+    }
+    else if ( mFifoTimeline->getRate(fifo_end_pts) != rate || mFifoTimeline->toMedia(fifo_end_pts) != media_pts ) {
+        mFifoTimeline->append(fifo_end_pts, media_pts, rate);
+    }
+    return mAudioFifo->write((void **)data, nb_samples, pts);
+}
+
+- (void)_onSkipSilenceFrom:(int64_t)media_start to:(int64_t)media_end {
+    AVRational sampleTimeBase = (AVRational){ 1, (int)mOutputAudioFormat.sampleRate };
+    mSkippedRanges->add(av_rescale_q(media_start, sampleTimeBase, AV_TIME_BASE_Q), av_rescale_q(media_end, sampleTimeBase, AV_TIME_BASE_Q));
+}
+
+// 先将旧 graph 中缓存的数据全部输出到 fifo, 再重建 graph, 避免丢失样本;
+- (int)_rebuildFilterGraph {
+    int ff_ret = mFilterGraph->addFrame(mBufferSrc, nullptr, AV_BUFFERSRC_FLAG_PUSH);
+    while ( ff_ret >= 0 ) {
+        ff_ret = mFilterGraph->getFrame(mBufferSink, mFiltFrame);
+        if ( ff_ret < 0 ) {
+            break;
+        }
+        ff_ret = [self _writeFilteredFrame:mFiltFrame];
+        av_frame_unref(mFiltFrame);
+    }
+    
+    if ( ff_ret < 0 && ff_ret != AVERROR_EOF && ff_ret != AVERROR(EAGAIN) ) {
+        return ff_ret;
+    }
+    return [self _recreateFilterGraph];
+}
+
 - (int)_recreateFilterGraph {
     int ff_ret = 0;
-    if ( mFilterGraph ) delete mFilterGraph;
-    mFilterGraph = [self _createFilterGraphWithError:&ff_ret];
+    mEffects->detach();
+    mResampleQualityChanged = NO;
+    mGraphTimeline->clear();
+    mGraphOutputEndPts = AV_NOPTS_VALUE;
+    [self _setFilterGraph:[self _createFilterGraphWithBufferSrcParams:mBufferSrcParams error:&ff_ret]];
     return ff_ret;
 }
 
-- (FFAV::FilterGraph *_Nullable)_createFilterGraphWithError:(int*)errPtr {
-    NSParameterAssert(mBufferSrcParams != nil);
+// 替换当前的 graph(删除旧的), 并缓存 buffer src/sink 与 atempo 的句柄
+- (void)_setFilterGraph:(FFAV::FilterGraph *_Nullable)filterGraph {
+    if ( mFilterGraph ) delete mFilterGraph;
+    mFilterGraph = filterGraph;
+    if ( filterGraph == nullptr ) {
+        mBufferSrc = { };
+        mBufferSink = { };
+        mTempoFilter = nullptr;
+        return;
+    }
+    
+    mBufferSrc = filterGraph->getBufferSource(FF_FILTER_BUFFER_SRC_NAME);
+    mBufferSink = filterGraph->getBufferSink(FF_FILTER_BUFFER_SINK_NAME);
+    std::vector<AVFilterContext *> tempoFilters = filterGraph->findFilters(FF_FILTER_RATE_NAME);
+    mTempoFilter = tempoFilters.empty() ? nullptr : tempoFilters.front();
+}
+
+// 创建 graph 并将音效链关联到新的 graph; 不修改当前的 graph 及其句柄
+- (FFAV::FilterGraph *_Nullable)_createFilterGraphWithBufferSrcParams:(AVBufferSrcParameters *)bufferSrcParams error:(int*)errPtr {
+    NSParameterAssert(bufferSrcParams != nil);
     
     FFAV::FilterGraph *filterGraph = new FFAV::FilterGraph();
     NSString *filter_desc = nil;
@@ -402,7 +674,7 @@ on_exit:
         goto on_exit;
     }
     
-    ff_ret = filterGraph->addBufferSourceFilter(FF_FILTER_BUFFER_SRC_NAME, AVMEDIA_TYPE_AUDIO, mBufferSrcParams);
+    ff_ret = filterGraph->addBufferSourceFilter(FF_FILTER_BUFFER_SRC_NAME, AVMEDIA_TYPE_AUDIO, bufferSrcParams);
     if ( ff_ret < 0 ) {
         goto on_exit;
     }
@@ -412,7 +684,21 @@ on_exit:
         goto on_exit;
     }
 
-    filter_desc = [NSString stringWithFormat:@"[%s]aformat=sample_fmts=%s:channel_layouts=%s,aresample=%d[%s]", FF_FILTER_BUFFER_SRC_NAME.c_str(), av_get_sample_fmt_name(FFCoreFormat::FF_OUTPUT_SAMPLE_FORMAT), FFCoreFormat::FF_OUTPUT_CHANNEL_DESC.c_str(), FFCoreFormat::FF_OUTPUT_SAMPLE_RATE, FF_FILTER_BUFFER_SINK_NAME.c_str()];
+    // atempo: WSOLA 变速不变调, 速率通过 sendCommand 动态调整, 无需重建 graph; libavfilter 未包含 atempo 时省略(只支持原速);
+    // 音效链放在 atempo 之后, 倍速时处理的样本更少;
+    // aresample: 参数由重采样质量预设决定, 输入已是 44100 Hz 时不做重采样;
+    {
+        NSMutableString *desc = [NSMutableString stringWithFormat:@"[%s]aformat=sample_fmts=%s:channel_layouts=%s,aresample=%d%s", FF_FILTER_BUFFER_SRC_NAME.c_str(), av_get_sample_fmt_name(FFCoreFormat::FF_OUTPUT_SAMPLE_FORMAT), FFCoreFormat::FF_OUTPUT_CHANNEL_DESC.c_str(), FFCoreFormat::FF_OUTPUT_SAMPLE_RATE, FFAV::ResamplePresets::getOptions(mResampleQuality).c_str()];
+        if ( FFAV::FilterGraph::isFilterAvailable(FF_FILTER_RATE_NAME) ) {
+            [desc appendFormat:@",%s=tempo=%g", FF_FILTER_RATE_NAME.c_str(), mRate];
+        }
+        std::string effects = mEffects->getFilterDescription();
+        if ( !effects.empty() ) {
+            [desc appendFormat:@",%s", effects.c_str()];
+        }
+        [desc appendFormat:@"[%s]", FF_FILTER_BUFFER_SINK_NAME.c_str()];
+        filter_desc = desc;
+    }
         
     ff_ret = filterGraph->parse(filter_desc.UTF8String);
     
@@ -425,10 +711,15 @@ on_exit:
         goto on_exit;
     }
     
+    ff_ret = mEffects->attach(filterGraph);
+    if ( ff_ret < 0 ) {
+        goto on_exit;
+    }
     
 on_exit:
     if ( ff_ret < 0 ) {
         if ( errPtr ) *errPtr = ff_ret;
+        delete filterGraph;
         filterGraph = nullptr;
     }
     return filterGraph;
@@ -0,0 +1,240 @@
+//
+// Created on 2025/5/22.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "AudioEffectChain.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace FFAV {
+
+const int AudioEffectChain::EQ_BAND_FREQUENCIES[EQ_BAND_COUNT] = { 31, 62, 125, 250, 500, 1000, 2000, 4000, 8000, 16000 };
+
+static inline double db_to_linear(double db) {
+    return pow(10.0, db / 20.0);
+}
+
+AudioEffectChain::AudioEffectChain() = default;
+AudioEffectChain::~AudioEffectChain() = default;
+
+void AudioEffectChain::setEqualizerEnabled(bool enabled) {
+    eq_enabled = enabled;
+}
+
+bool AudioEffectChain::isEqualizerEnabled() const {
+    return eq_enabled;
+}
+
+void AudioEffectChain::setCompressorEnabled(bool enabled) {
+    compressor_enabled = enabled;
+}
+
+bool AudioEffectChain::isCompressorEnabled() const {
+    return compressor_enabled;
+}
+
+void AudioEffectChain::setLoudnessNormalizationEnabled(bool enabled) {
+    loudnorm_enabled = enabled;
+}
+
+bool AudioEffectChain::isLoudnessNormalizationEnabled() const {
+    return loudnorm_enabled;
+}
+
+int AudioEffectChain::setEqualizerGain(int band, float gain_db) {
+    if ( band < 0 || band >= EQ_BAND_COUNT ) {
+        return AVERROR(EINVAL);
+    }
+
+    gain_db = std::clamp(gain_db, EQ_MIN_GAIN, EQ_MAX_GAIN);
+    if ( eq_gains[band] == gain_db ) {
+        return 0;
+    }
+
+    eq_gains[band] = gain_db;
+    if ( band < (int)eq_ctxs.size() ) {
+        return sendCommand(eq_ctxs[band], "gain", gain_db);
+    }
+    return 0;
+}
+
+float AudioEffectChain::getEqualizerGain(int band) const {
+    if ( band < 0 || band >= EQ_BAND_COUNT ) {
+        return 0;
+    }
+    return eq_gains[band];
+}
+
+int AudioEffectChain::setCompressorParams(const CompressorParams& params) {
+    CompressorParams old_params = compressor_params;
+    compressor_params = params;
+    if ( compressor_ctx == nullptr ) {
+        return 0;
+    }
+
+    int ret = 0;
+    if ( ret >= 0 && old_params.threshold_db != params.threshold_db ) ret = sendCommand(compressor_ctx, "threshold", db_to_linear(params.threshold_db));
+    if ( ret >= 0 && old_params.ratio != params.ratio ) ret = sendCommand(compressor_ctx, "ratio", params.ratio);
+    if ( ret >= 0 && old_params.attack_ms != params.attack_ms ) ret = sendCommand(compressor_ctx, "attack", params.attack_ms);
+    if ( ret >= 0 && old_params.release_ms != params.release_ms ) ret = sendCommand(compressor_ctx, "release", params.release_ms);
+    if ( ret >= 0 && old_params.makeup_db != params.makeup_db ) ret = sendCommand(compressor_ctx, "makeup", db_to_linear(params.makeup_db));
+    return ret;
+}
+
+AudioEffectChain::CompressorParams AudioEffectChain::getCompressorParams() const {
+    return compressor_params;
+}
+
+int AudioEffectChain::setVolume(float volume) {
+    volume = std::max(volume, 0.0f);
+    if ( this->volume == volume ) {
+        return 0;
+    }
+
+    this->volume = volume;
+    return sendCommand(volume_ctx, "volume", getOutputVolume());
+}
+
+float AudioEffectChain::getVolume() const {
+    return volume;
+}
+
+int AudioEffectChain::setReplayGain(float gain_db) {
+    if ( replay_gain == gain_db ) {
+        return 0;
+    }
+
+    replay_gain = gain_db;
+    return sendCommand(volume_ctx, "volume", getOutputVolume());
+}
+
+float AudioEffectChain::getReplayGain() const {
+    return replay_gain;
+}
+
+std::string AudioEffectChain::getFilterDescription() const {
+    std::stringstream ss;
+    const char* sep = "";
+    if ( hasEqualizer() ) {
+        // 倍频程宽度的峰值滤波器
+        for ( int i = 0; i < EQ_BAND_COUNT; ++i ) {
+            ss << sep << "equalizer=f=" << EQ_BAND_FREQUENCIES[i] << ":t=o:w=1:g=" << eq_gains[i];
+            sep = ",";
+        }
+    }
+
+    if ( hasCompressor() ) {
+        ss << sep << "acompressor=threshold=" << db_to_linear(compressor_params.threshold_db)
+           << ":ratio=" << compressor_params.ratio
+           << ":attack=" << compressor_params.attack_ms
+           << ":release=" << compressor_params.release_ms
+           << ":makeup=" << db_to_linear(compressor_params.makeup_db);
+        sep = ",";
+    }
+
+    if ( hasLoudnessNormalization() ) {
+        // 使用较短的帧长与窗口, 控制 lookahead 带来的延迟(约 0.5s)
+        ss << sep << "dynaudnorm=f=100:g=5:p=0.95:m=10";
+        sep = ",";
+    }
+
+    if ( hasVolume() ) {
+        ss << sep << "volume=volume=" << getOutputVolume() << ":precision=float";
+    }
+    return ss.str();
+}
+
+float AudioEffectChain::getSoftwareGain() const {
+    return hasVolume() ? 1.0f : (float)getOutputVolume();
+}
+
+int AudioEffectChain::attach(FilterGraph* _Nonnull filter_graph) {
+    detach();
+
+    graph = filter_graph;
+    if ( hasEqualizer() ) {
+        eq_ctxs = filter_graph->findFilters("equalizer");
+        if ( eq_ctxs.size() != EQ_BAND_COUNT ) {
+            detach();
+            return AVERROR_FILTER_NOT_FOUND;
+        }
+    }
+
+    if ( hasCompressor() ) {
+        std::vector<AVFilterContext*> ctxs = filter_graph->findFilters("acompressor");
+        compressor_ctx = ctxs.empty() ? nullptr : ctxs.front();
+    }
+
+    if ( hasLoudnessNormalization() ) {
+        std::vector<AVFilterContext*> ctxs = filter_graph->findFilters("dynaudnorm");
+        loudnorm_ctx = ctxs.empty() ? nullptr : ctxs.front();
+    }
+
+    if ( hasVolume() ) {
+        std::vector<AVFilterContext*> ctxs = filter_graph->findFilters("volume");
+        volume_ctx = ctxs.empty() ? nullptr : ctxs.front();
+    }
+
+    if ( (hasCompressor() && compressor_ctx == nullptr) ||
+         (hasLoudnessNormalization() && loudnorm_ctx == nullptr) ||
+         (hasVolume() && volume_ctx == nullptr) ) {
+        detach();
+        return AVERROR_FILTER_NOT_FOUND;
+    }
+    return 0;
+}
+
+void AudioEffectChain::detach() {
+    graph = nullptr;
+    eq_ctxs.clear();
+    compressor_ctx = nullptr;
+    loudnorm_ctx = nullptr;
+    volume_ctx = nullptr;
+}
+
+bool AudioEffectChain::needsRebuild() const {
+    if ( graph == nullptr ) {
+        return false;
+    }
+
+    return hasEqualizer() != !eq_ctxs.empty() ||
+           hasCompressor() != (compressor_ctx != nullptr) ||
+           hasLoudnessNormalization() != (loudnorm_ctx != nullptr);
+}
+
+// 可用性只查询一次; needsRebuild 在转码循环中频繁调用
+bool AudioEffectChain::hasEqualizer() const {
+    static const bool available = FilterGraph::isFilterAvailable("equalizer");
+    return eq_enabled && available;
+}
+
+bool AudioEffectChain::hasCompressor() const {
+    static const bool available = FilterGraph::isFilterAvailable("acompressor");
+    return compressor_enabled && available;
+}
+
+bool AudioEffectChain::hasLoudnessNormalization() const {
+    static const bool available = FilterGraph::isFilterAvailable("dynaudnorm");
+    return loudnorm_enabled && available;
+}
+
+bool AudioEffectChain::hasVolume() {
+    static const bool available = FilterGraph::isFilterAvailable("volume");
+    return available;
+}
+
+double AudioEffectChain::getOutputVolume() const {
+    return volume * db_to_linear(replay_gain);
+}
+
+int AudioEffectChain::sendCommand(AVFilterContext* _Nullable filter_ctx, const char* _Nonnull cmd, double value) {
+    if ( graph == nullptr || filter_ctx == nullptr ) {
+        return 0;
+    }
+    return graph->sendCommand(filter_ctx, cmd, std::to_string(value));
+}
+
+}
@@ -0,0 +1,112 @@
+//
+// Created on 2025/5/22.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_AUDIOEFFECTCHAIN_H
+#define FFMPEGPROJ_AUDIOEFFECTCHAIN_H
+
+#include "FilterGraph.h"
+#include <string>
+#include <vector>
+
+namespace FFAV {
+
+/**
+ * @class AudioEffectChain
+ * @brief 可配置的音效(DSP)链: 均衡器 -> 动态范围压缩 -> 响度归一化 -> 音量;
+ *
+ * 生成插入到转码 filter graph 中的描述片段, 并在 graph configure 后解析出各 stage 的 filter 实例;
+ * 参数变更直接通过 avfilter_process_command 发送给对应实例实时生效, 不需要重建 graph;
+ * 仅当开启/关闭某个 stage 时(graph 的组成发生变化)才需要重建, 见 `needsRebuild`;
+ * 裁剪编译的 libavfilter 未包含某个 stage 的 filter 时跳过该 stage; 缺少 volume 时音量改由 `getSoftwareGain` 在 graph 之后处理;
+ *
+ * 使用示例:
+ * ```
+ * AudioEffectChain effects;
+ * effects.setEqualizerEnabled(true);
+ * std::string descr = "[in]aresample=44100," + effects.getFilterDescription() + "[out]";
+ * graph.parse(descr);
+ * graph.configure();
+ * effects.attach(&graph);
+ * effects.setEqualizerGain(3, 6.0f); // 实时生效
+ * ```
+ */
+class AudioEffectChain {
+public:
+    static const int EQ_BAND_COUNT = 10;
+    static const int EQ_BAND_FREQUENCIES[EQ_BAND_COUNT];
+    static constexpr float EQ_MIN_GAIN = -24.0f; // dB
+    static constexpr float EQ_MAX_GAIN = 24.0f;  // dB
+
+    struct CompressorParams {
+        float threshold_db { -18.0f };
+        float ratio { 4.0f };
+        float attack_ms { 20.0f };
+        float release_ms { 250.0f };
+        float makeup_db { 6.0f };
+    };
+
+    AudioEffectChain();
+    ~AudioEffectChain();
+
+    // stage 开关; 变化后需要重建 graph;
+    void setEqualizerEnabled(bool enabled);
+    bool isEqualizerEnabled() const;
+    void setCompressorEnabled(bool enabled);
+    bool isCompressorEnabled() const;
+    void setLoudnessNormalizationEnabled(bool enabled);
+    bool isLoudnessNormalizationEnabled() const;
+
+    // 参数; 已 attach 时实时生效;
+    int setEqualizerGain(int band, float gain_db);
+    float getEqualizerGain(int band) const;
+    int setCompressorParams(const CompressorParams& params);
+    CompressorParams getCompressorParams() const;
+    int setVolume(float volume); // 线性增益
+    float getVolume() const;
+    int setReplayGain(float gain_db); // 静态增益(dB), 例如响度分析得到的 ReplayGain; 与音量合并到同一个 volume 实例;
+    float getReplayGain() const;
+
+    // 插入到 graph 中的描述片段, 例如 "equalizer=...,volume=..."; 只包含已开启且可用的 stage, 可能为空;
+    std::string getFilterDescription() const;
+
+    // volume filter 不可用时需要在 graph 之后施加的增益(音量与 ReplayGain 的合并值); 否则为 1;
+    float getSoftwareGain() const;
+
+    // 在 graph configure 之后调用, 解析各 stage 的 filter 实例;
+    int attach(FilterGraph* _Nonnull filter_graph);
+    void detach();
+
+    // stage 的组成与当前 attach 的 graph 不一致;
+    bool needsRebuild() const;
+
+private:
+    bool eq_enabled { false };
+    bool compressor_enabled { false };
+    bool loudnorm_enabled { false };
+    float eq_gains[EQ_BAND_COUNT] { };
+    CompressorParams compressor_params;
+    float volume { 1.0f };
+    float replay_gain { 0.0f };
+
+    FilterGraph* _Nullable graph { nullptr };
+    std::vector<AVFilterContext*> eq_ctxs;
+    AVFilterContext* _Nullable compressor_ctx { nullptr };
+    AVFilterContext* _Nullable loudnorm_ctx { nullptr };
+    AVFilterContext* _Nullable volume_ctx { nullptr };
+
+    // 各 stage 是否包含在 graph 中(已开启且 filter 可用)
+    bool hasEqualizer() const;
+    bool hasCompressor() const;
+    bool hasLoudnessNormalization() const;
+    static bool hasVolume();
+
+    double getOutputVolume() const;
+    int sendCommand(AVFilterContext* _Nullable filter_ctx, const char* _Nonnull cmd, double value);
+};
+
+}
+
+#endif //FFMPEGPROJ_AUDIOEFFECTCHAIN_H
@@ -0,0 +1,880 @@
+//
+// Created on 2025/5/29.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "AudioKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+EXTERN_C_START
+#include <libavutil/error.h>
+#include <libavutil/frame.h>
+EXTERN_C_END
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FFAV_KERNELS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FFAV_KERNELS_X86 1
+#define FFAV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// 不允许编译器把乘加合并为 FMA, 否则标量尾部与向量实现的结果可能不一致
+#pragma STDC FP_CONTRACT OFF
+
+namespace FFAV {
+
+#pragma mark - scalar
+
+static void scale_scalar(float* dst, const float* src, float gain, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        dst[i] = src[i] * gain;
+    }
+}
+
+static void mix_add_scalar(float* dst, const float* src, float gain, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        dst[i] = dst[i] + src[i] * gain;
+    }
+}
+
+static void s16_to_float_scalar(float* dst, const int16_t* src, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        dst[i] = (float)src[i] * (1.0f / 32768.0f);
+    }
+}
+
+static inline int16_t float_to_s16(float v) {
+    v = v * 32768.0f;
+    v = v < -32768.0f ? -32768.0f : (v > 32767.0f ? 32767.0f : v);
+    return (int16_t)lrintf(v);
+}
+
+static void float_to_s16_scalar(int16_t* dst, const float* src, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        dst[i] = float_to_s16(src[i]);
+    }
+}
+
+static void interleave2_scalar(float* dst, const float* l, const float* r, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        dst[2 * i] = l[i];
+        dst[2 * i + 1] = r[i];
+    }
+}
+
+static void deinterleave2_scalar(float* l, float* r, const float* src, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        l[i] = src[2 * i];
+        r[i] = src[2 * i + 1];
+    }
+}
+
+// 平方和按下标 i % 4 分为 4 路以 double 累加, 最后按 (0 + 1) + (2 + 3) 合并;
+// float 的平方在 double 中是精确的, 各实现按相同的顺序累加, 结果逐位一致;
+static inline void peak_summary_tail(const float* src, int i, int nb_samples, double acc[4], float& min, float& max) {
+    for ( ; i < nb_samples; ++i ) {
+        float v = src[i];
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+        acc[i & 3] += (double)v * (double)v;
+    }
+}
+
+static void peak_summary_scalar(const float* src, int nb_samples, float* min, float* max, double* sum_sq) {
+    double acc[4] = { 0, 0, 0, 0 };
+    peak_summary_tail(src, 0, nb_samples, acc, *min, *max);
+    *sum_sq += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+static void multiply_scalar(float* dst, const float* a, const float* b, int nb_samples) {
+    for ( int i = 0; i < nb_samples; ++i ) {
+        dst[i] = a[i] * b[i];
+    }
+}
+
+static void fft_butterfly_scalar(float* re0, float* im0, float* re1, float* im1, const float* wr, const float* wi, int n) {
+    for ( int k = 0; k < n; ++k ) {
+        float tr = re1[k] * wr[k] - im1[k] * wi[k];
+        float ti = re1[k] * wi[k] + im1[k] * wr[k];
+        re1[k] = re0[k] - tr;
+        im1[k] = im0[k] - ti;
+        re0[k] = re0[k] + tr;
+        im0[k] = im0[k] + ti;
+    }
+}
+
+static void power_spectrum_scalar(float* dst, const float* re, const float* im, int n) {
+    for ( int k = 0; k < n; ++k ) {
+        dst[k] = re[k] * re[k] + im[k] * im[k];
+    }
+}
+
+#if FFAV_KERNELS_NEON
+#pragma mark - neon
+
+static void scale_neon(float* dst, const float* src, float gain, int nb_samples) {
+    int i = 0;
+    float32x4_t g = vdupq_n_f32(gain);
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(src + i), g));
+    }
+    scale_scalar(dst + i, src + i, gain, nb_samples - i);
+}
+
+static void mix_add_neon(float* dst, const float* src, float gain, int nb_samples) {
+    int i = 0;
+    float32x4_t g = vdupq_n_f32(gain);
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        // 不使用 vfmaq_f32, 与标量实现保持一致
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vmulq_f32(vld1q_f32(src + i), g)));
+    }
+    mix_add_scalar(dst + i, src + i, gain, nb_samples - i);
+}
+
+static void s16_to_float_neon(float* dst, const int16_t* src, int nb_samples) {
+    int i = 0;
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        int16x8_t v = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), 1.0f / 32768.0f));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f / 32768.0f));
+    }
+    s16_to_float_scalar(dst + i, src + i, nb_samples - i);
+}
+
+static void float_to_s16_neon(int16_t* dst, const float* src, int nb_samples) {
+    int i = 0;
+    float32x4_t lo = vdupq_n_f32(-32768.0f);
+    float32x4_t hi = vdupq_n_f32(32767.0f);
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        float32x4_t a = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i), 32768.0f), lo), hi);
+        float32x4_t b = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32768.0f), lo), hi);
+        // vcvtnq: round to nearest, ties to even, 与 lrintf 默认舍入模式一致
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    float_to_s16_scalar(dst + i, src + i, nb_samples - i);
+}
+
+static void interleave2_neon(float* dst, const float* l, const float* r, int nb_samples) {
+    int i = 0;
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        float32x4x2_t v = { vld1q_f32(l + i), vld1q_f32(r + i) };
+        vst2q_f32(dst + 2 * i, v);
+    }
+    interleave2_scalar(dst + 2 * i, l + i, r + i, nb_samples - i);
+}
+
+static void deinterleave2_neon(float* l, float* r, const float* src, int nb_samples) {
+    int i = 0;
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        float32x4x2_t v = vld2q_f32(src + 2 * i);
+        vst1q_f32(l + i, v.val[0]);
+        vst1q_f32(r + i, v.val[1]);
+    }
+    deinterleave2_scalar(l + i, r + i, src + 2 * i, nb_samples - i);
+}
+
+static void peak_summary_neon(const float* src, int nb_samples, float* min, float* max, double* sum_sq) {
+    int i = 0;
+    float32x4_t vmin = vdupq_n_f32(*min);
+    float32x4_t vmax = vdupq_n_f32(*max);
+    float64x2_t acc01 = vdupq_n_f64(0);
+    float64x2_t acc23 = vdupq_n_f64(0);
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        float32x4_t v = vld1q_f32(src + i);
+        vmin = vminq_f32(vmin, v);
+        vmax = vmaxq_f32(vmax, v);
+        float64x2_t lo = vcvt_f64_f32(vget_low_f32(v));
+        float64x2_t hi = vcvt_high_f64_f32(v);
+        acc01 = vaddq_f64(acc01, vmulq_f64(lo, lo));
+        acc23 = vaddq_f64(acc23, vmulq_f64(hi, hi));
+    }
+    double acc[4];
+    vst1q_f64(acc, acc01);
+    vst1q_f64(acc + 2, acc23);
+    *min = vminvq_f32(vmin);
+    *max = vmaxvq_f32(vmax);
+    peak_summary_tail(src, i, nb_samples, acc, *min, *max);
+    *sum_sq += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+static void multiply_neon(float* dst, const float* a, const float* b, int nb_samples) {
+    int i = 0;
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    multiply_scalar(dst + i, a + i, b + i, nb_samples - i);
+}
+
+static void fft_butterfly_neon(float* re0, float* im0, float* re1, float* im1, const float* wr, const float* wi, int n) {
+    int k = 0;
+    for ( ; k + 4 <= n; k += 4 ) {
+        float32x4_t xr = vld1q_f32(re1 + k), xi = vld1q_f32(im1 + k);
+        float32x4_t cr = vld1q_f32(wr + k), ci = vld1q_f32(wi + k);
+        float32x4_t tr = vsubq_f32(vmulq_f32(xr, cr), vmulq_f32(xi, ci));
+        float32x4_t ti = vaddq_f32(vmulq_f32(xr, ci), vmulq_f32(xi, cr));
+        float32x4_t ar = vld1q_f32(re0 + k), ai = vld1q_f32(im0 + k);
+        vst1q_f32(re1 + k, vsubq_f32(ar, tr));
+        vst1q_f32(im1 + k, vsubq_f32(ai, ti));
+        vst1q_f32(re0 + k, vaddq_f32(ar, tr));
+        vst1q_f32(im0 + k, vaddq_f32(ai, ti));
+    }
+    fft_butterfly_scalar(re0 + k, im0 + k, re1 + k, im1 + k, wr + k, wi + k, n - k);
+}
+
+static void power_spectrum_neon(float* dst, const float* re, const float* im, int n) {
+    int k = 0;
+    for ( ; k + 4 <= n; k += 4 ) {
+        float32x4_t r = vld1q_f32(re + k), i = vld1q_f32(im + k);
+        vst1q_f32(dst + k, vaddq_f32(vmulq_f32(r, r), vmulq_f32(i, i)));
+    }
+    power_spectrum_scalar(dst + k, re + k, im + k, n - k);
+}
+#endif
+
+#if FFAV_KERNELS_X86
+#pragma mark - sse2
+
+static void scale_sse2(float* dst, const float* src, float gain, int nb_samples) {
+    int i = 0;
+    __m128 g = _mm_set1_ps(gain);
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+    }
+    scale_scalar(dst + i, src + i, gain, nb_samples - i);
+}
+
+static void mix_add_sse2(float* dst, const float* src, float gain, int nb_samples) {
+    int i = 0;
+    __m128 g = _mm_set1_ps(gain);
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    }
+    mix_add_scalar(dst + i, src + i, gain, nb_samples - i);
+}
+
+static void s16_to_float_sse2(float* dst, const int16_t* src, int nb_samples) {
+    int i = 0;
+    __m128 k = _mm_set1_ps(1.0f / 32768.0f);
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        // 高 16 位放入样本后算术右移, 完成符号扩展
+        __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(a), k));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), k));
+    }
+    s16_to_float_scalar(dst + i, src + i, nb_samples - i);
+}
+
+static void float_to_s16_sse2(int16_t* dst, const float* src, int nb_samples) {
+    int i = 0;
+    __m128 k = _mm_set1_ps(32768.0f);
+    __m128 lo = _mm_set1_ps(-32768.0f);
+    __m128 hi = _mm_set1_ps(32767.0f);
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        // 先限幅再转换, 超出 int32 范围的值 cvtps 会返回 0x80000000
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), k), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), k), lo), hi);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    float_to_s16_scalar(dst + i, src + i, nb_samples - i);
+}
+
+static void interleave2_sse2(float* dst, const float* l, const float* r, int nb_samples) {
+    int i = 0;
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        __m128 a = _mm_loadu_ps(l + i);
+        __m128 b = _mm_loadu_ps(r + i);
+        _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(a, b));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(a, b));
+    }
+    interleave2_scalar(dst + 2 * i, l + i, r + i, nb_samples - i);
+}
+
+static void deinterleave2_sse2(float* l, float* r, const float* src, int nb_samples) {
+    int i = 0;
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleave2_scalar(l + i, r + i, src + 2 * i, nb_samples - i);
+}
+
+static void peak_summary_sse2(const float* src, int nb_samples, float* min, float* max, double* sum_sq) {
+    int i = 0;
+    __m128 vmin = _mm_set1_ps(*min);
+    __m128 vmax = _mm_set1_ps(*max);
+    __m128d acc01 = _mm_setzero_pd();
+    __m128d acc23 = _mm_setzero_pd();
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        __m128 v = _mm_loadu_ps(src + i);
+        vmin = _mm_min_ps(vmin, v);
+        vmax = _mm_max_ps(vmax, v);
+        __m128d lo = _mm_cvtps_pd(v);
+        __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        acc01 = _mm_add_pd(acc01, _mm_mul_pd(lo, lo));
+        acc23 = _mm_add_pd(acc23, _mm_mul_pd(hi, hi));
+    }
+    float mins[4], maxs[4];
+    double acc[4];
+    _mm_storeu_ps(mins, vmin);
+    _mm_storeu_ps(maxs, vmax);
+    _mm_storeu_pd(acc, acc01);
+    _mm_storeu_pd(acc + 2, acc23);
+    *min = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+    *max = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+    peak_summary_tail(src, i, nb_samples, acc, *min, *max);
+    *sum_sq += (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+static void multiply_sse2(float* dst, const float* a, const float* b, int nb_samples) {
+    int i = 0;
+    for ( ; i + 4 <= nb_samples; i += 4 ) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    multiply_scalar(dst + i, a + i, b + i, nb_samples - i);
+}
+
+static void fft_butterfly_sse2(float* re0, float* im0, float* re1, float* im1, const float* wr, const float* wi, int n) {
+    int k = 0;
+    for ( ; k + 4 <= n; k += 4 ) {
+        __m128 xr = _mm_loadu_ps(re1 + k), xi = _mm_loadu_ps(im1 + k);
+        __m128 cr = _mm_loadu_ps(wr + k), ci = _mm_loadu_ps(wi + k);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+        __m128 ar = _mm_loadu_ps(re0 + k), ai = _mm_loadu_ps(im0 + k);
+        _mm_storeu_ps(re1 + k, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(im1 + k, _mm_sub_ps(ai, ti));
+        _mm_storeu_ps(re0 + k, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(im0 + k, _mm_add_ps(ai, ti));
+    }
+    fft_butterfly_scalar(re0 + k, im0 + k, re1 + k, im1 + k, wr + k, wi + k, n - k);
+}
+
+static void power_spectrum_sse2(float* dst, const float* re, const float* im, int n) {
+    int k = 0;
+    for ( ; k + 4 <= n; k += 4 ) {
+        __m128 r = _mm_loadu_ps(re + k), i = _mm_loadu_ps(im + k);
+        _mm_storeu_ps(dst + k, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i)));
+    }
+    power_spectrum_scalar(dst + k, re + k, im + k, n - k);
+}
+
+#pragma mark - avx2
+
+FFAV_TARGET_AVX2 static void scale_avx2(float* dst, const float* src, float gain, int nb_samples) {
+    int i = 0;
+    __m256 g = _mm256_set1_ps(gain);
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+    }
+    scale_scalar(dst + i, src + i, gain, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void mix_add_avx2(float* dst, const float* src, float gain, int nb_samples) {
+    int i = 0;
+    __m256 g = _mm256_set1_ps(gain);
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+    }
+    mix_add_scalar(dst + i, src + i, gain, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void s16_to_float_avx2(float* dst, const int16_t* src, int nb_samples) {
+    int i = 0;
+    __m256 k = _mm256_set1_ps(1.0f / 32768.0f);
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), k));
+    }
+    s16_to_float_scalar(dst + i, src + i, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void float_to_s16_avx2(int16_t* dst, const float* src, int nb_samples) {
+    int i = 0;
+    __m256 k = _mm256_set1_ps(32768.0f);
+    __m256 lo = _mm256_set1_ps(-32768.0f);
+    __m256 hi = _mm256_set1_ps(32767.0f);
+    for ( ; i + 16 <= nb_samples; i += 16 ) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), k), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), k), lo), hi);
+        // packs 在 128 位通道内进行, 需要重新排列 64 位块
+        __m256i v = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    float_to_s16_sse2(dst + i, src + i, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void interleave2_avx2(float* dst, const float* l, const float* r, int nb_samples) {
+    int i = 0;
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        __m256 a = _mm256_loadu_ps(l + i);
+        __m256 b = _mm256_loadu_ps(r + i);
+        __m256 lo = _mm256_unpacklo_ps(a, b);
+        __m256 hi = _mm256_unpackhi_ps(a, b);
+        _mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    interleave2_sse2(dst + 2 * i, l + i, r + i, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void deinterleave2_avx2(float* l, float* r, const float* src, int nb_samples) {
+    int i = 0;
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        __m256 a = _mm256_loadu_ps(src + 2 * i);
+        __m256 b = _mm256_loadu_ps(src + 2 * i + 8);
+        __m256 t0 = _mm256_permute2f128_ps(a, b, 0x20);
+        __m256 t1 = _mm256_permute2f128_ps(a, b, 0x31);
+        _mm256_storeu_ps(l + i, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps(r + i, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleave2_sse2(l + i, r + i, src + 2 * i, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void peak_summary_avx2(const float* src, int nb_samples, float* min, float* max, double* sum_sq) {
+    int i = 0;
+    __m256 vmin = _mm256_set1_ps(*min);
+    __m256 vmax = _mm256_set1_ps(*max);
+    __m256d acc = _mm256_setzero_pd(); // 4 路, 与标量实现的分组相同
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        __m256 v = _mm256_loadu_ps(src + i);
+        vmin = _mm256_min_ps(vmin, v);
+        vmax = _mm256_max_ps(vmax, v);
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(lo, lo));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(hi, hi));
+    }
+    float mins[8], maxs[8];
+    double lanes[4];
+    _mm256_storeu_ps(mins, vmin);
+    _mm256_storeu_ps(maxs, vmax);
+    _mm256_storeu_pd(lanes, acc);
+    for ( int k = 0; k < 8; ++k ) {
+        *min = std::min(*min, mins[k]);
+        *max = std::max(*max, maxs[k]);
+    }
+    peak_summary_tail(src, i, nb_samples, lanes, *min, *max);
+    *sum_sq += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+FFAV_TARGET_AVX2 static void multiply_avx2(float* dst, const float* a, const float* b, int nb_samples) {
+    int i = 0;
+    for ( ; i + 8 <= nb_samples; i += 8 ) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    multiply_sse2(dst + i, a + i, b + i, nb_samples - i);
+}
+
+FFAV_TARGET_AVX2 static void fft_butterfly_avx2(float* re0, float* im0, float* re1, float* im1, const float* wr, const float* wi, int n) {
+    int k = 0;
+    for ( ; k + 8 <= n; k += 8 ) {
+        __m256 xr = _mm256_loadu_ps(re1 + k), xi = _mm256_loadu_ps(im1 + k);
+        __m256 cr = _mm256_loadu_ps(wr + k), ci = _mm256_loadu_ps(wi + k);
+        __m256 tr = _mm256_sub_ps(_mm256_mul_ps(xr, cr), _mm256_mul_ps(xi, ci));
+        __m256 ti = _mm256_add_ps(_mm256_mul_ps(xr, ci), _mm256_mul_ps(xi, cr));
+        __m256 ar = _mm256_loadu_ps(re0 + k), ai = _mm256_loadu_ps(im0 + k);
+        _mm256_storeu_ps(re1 + k, _mm256_sub_ps(ar, tr));
+        _mm256_storeu_ps(im1 + k, _mm256_sub_ps(ai, ti));
+        _mm256_storeu_ps(re0 + k, _mm256_add_ps(ar, tr));
+        _mm256_storeu_ps(im0 + k, _mm256_add_ps(ai, ti));
+    }
+    fft_butterfly_sse2(re0 + k, im0 + k, re1 + k, im1 + k, wr + k, wi + k, n - k);
+}
+
+FFAV_TARGET_AVX2 static void power_spectrum_avx2(float* dst, const float* re, const float* im, int n) {
+    int k = 0;
+    for ( ; k + 8 <= n; k += 8 ) {
+        __m256 r = _mm256_loadu_ps(re + k), i = _mm256_loadu_ps(im + k);
+        _mm256_storeu_ps(dst + k, _mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(i, i)));
+    }
+    power_spectrum_sse2(dst + k, re + k, im + k, n - k);
+}
+#endif
+
+#pragma mark - dispatch
+
+namespace {
+struct KernelTable {
+    const char* name;
+    void (*scale)(float*, const float*, float, int);
+    void (*mix_add)(float*, const float*, float, int);
+    void (*s16_to_float)(float*, const int16_t*, int);
+    void (*float_to_s16)(int16_t*, const float*, int);
+    void (*interleave2)(float*, const float*, const float*, int);
+    void (*deinterleave2)(float*, float*, const float*, int);
+    void (*peak_summary)(const float*, int, float*, float*, double*);
+    void (*multiply)(float*, const float*, const float*, int);
+    void (*fft_butterfly)(float*, float*, float*, float*, const float*, const float*, int);
+    void (*power_spectrum)(float*, const float*, const float*, int);
+};
+}
+
+// 当前 CPU 可用的实现, 按优先级排列; 标量实现总是在最后
+static std::vector<KernelTable> available_kernels() {
+    std::vector<KernelTable> tables;
+#if FFAV_KERNELS_NEON
+    tables.push_back({ "neon", scale_neon, mix_add_neon, s16_to_float_neon, float_to_s16_neon, interleave2_neon, deinterleave2_neon, peak_summary_neon, multiply_neon, fft_butterfly_neon, power_spectrum_neon });
+#elif FFAV_KERNELS_X86
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) {
+        tables.push_back({ "avx2", scale_avx2, mix_add_avx2, s16_to_float_avx2, float_to_s16_avx2, interleave2_avx2, deinterleave2_avx2, peak_summary_avx2, multiply_avx2, fft_butterfly_avx2, power_spectrum_avx2 });
+    }
+    tables.push_back({ "sse2", scale_sse2, mix_add_sse2, s16_to_float_sse2, float_to_s16_sse2, interleave2_sse2, deinterleave2_sse2, peak_summary_sse2, multiply_sse2, fft_butterfly_sse2, power_spectrum_sse2 });
+#endif
+    tables.push_back({ "scalar", scale_scalar, mix_add_scalar, s16_to_float_scalar, float_to_s16_scalar, interleave2_scalar, deinterleave2_scalar, peak_summary_scalar, multiply_scalar, fft_butterfly_scalar, power_spectrum_scalar });
+    return tables;
+}
+
+// 只在首次调用时检测一次 CPU, 之后直接通过函数指针调用; 仅 setImplementation 会修改
+static KernelTable& kernels() {
+    static KernelTable table = available_kernels().front();
+    return table;
+}
+
+const char* _Nonnull AudioKernels::getImplementationName() {
+    return kernels().name;
+}
+
+std::vector<const char*> AudioKernels::getAvailableImplementations() {
+    std::vector<const char*> names;
+    for ( const KernelTable& table : available_kernels() ) {
+        names.push_back(table.name);
+    }
+    return names;
+}
+
+bool AudioKernels::setImplementation(const char* _Nonnull name) {
+    for ( const KernelTable& table : available_kernels() ) {
+        if ( strcmp(table.name, name) == 0 ) {
+            kernels() = table;
+            return true;
+        }
+    }
+    return false;
+}
+
+#pragma mark - downmix
+
+static const float DOWNMIX_CENTER = (float)M_SQRT1_2;   // -3 dB
+static const float DOWNMIX_SURROUND = (float)M_SQRT1_2; // -3 dB
+
+void AudioKernels::makeStereoDownmixMatrix(const AVChannelLayout* _Nonnull in_layout, std::vector<float>& matrix) {
+    int nb_channels = in_layout->nb_channels;
+    matrix.assign(2 * nb_channels, 0.0f);
+    float* left = matrix.data();
+    float* right = matrix.data() + nb_channels;
+    
+    for ( int ch = 0; ch < nb_channels; ++ch ) {
+        AVChannel channel = av_channel_layout_channel_from_index(in_layout, ch);
+        switch ( channel ) {
+            case AV_CHAN_FRONT_LEFT:
+            case AV_CHAN_FRONT_LEFT_OF_CENTER:
+            case AV_CHAN_WIDE_LEFT:
+                left[ch] = 1.0f;
+                break;
+            case AV_CHAN_FRONT_RIGHT:
+            case AV_CHAN_FRONT_RIGHT_OF_CENTER:
+            case AV_CHAN_WIDE_RIGHT:
+                right[ch] = 1.0f;
+                break;
+            case AV_CHAN_FRONT_CENTER:
+                left[ch] = right[ch] = DOWNMIX_CENTER;
+                break;
+            case AV_CHAN_BACK_LEFT:
+            case AV_CHAN_SIDE_LEFT:
+            case AV_CHAN_TOP_FRONT_LEFT:
+            case AV_CHAN_TOP_BACK_LEFT:
+            case AV_CHAN_TOP_SIDE_LEFT:
+            case AV_CHAN_SURROUND_DIRECT_LEFT:
+                left[ch] = DOWNMIX_SURROUND;
+                break;
+            case AV_CHAN_BACK_RIGHT:
+            case AV_CHAN_SIDE_RIGHT:
+            case AV_CHAN_TOP_FRONT_RIGHT:
+            case AV_CHAN_TOP_BACK_RIGHT:
+            case AV_CHAN_TOP_SIDE_RIGHT:
+            case AV_CHAN_SURROUND_DIRECT_RIGHT:
+                right[ch] = DOWNMIX_SURROUND;
+                break;
+            case AV_CHAN_LOW_FREQUENCY:
+            case AV_CHAN_LOW_FREQUENCY_2:
+                break;
+            default:
+                // 中置类(后中置/顶部中置)及未知声道平均分配到两侧
+                left[ch] = right[ch] = DOWNMIX_SURROUND * DOWNMIX_CENTER;
+                break;
+        }
+    }
+    
+    // 单声道输入直接复制到两侧
+    if ( nb_channels == 1 ) {
+        left[0] = right[0] = 1.0f;
+        return;
+    }
+    
+    float sum_l = 0, sum_r = 0;
+    for ( int ch = 0; ch < nb_channels; ++ch ) {
+        sum_l += left[ch];
+        sum_r += right[ch];
+    }
+    float norm = std::max(sum_l, sum_r);
+    if ( norm > 1.0f ) {
+        for ( float& c : matrix ) c /= norm;
+    }
+}
+
+void AudioKernels::downmixToStereoPlanar(const float* _Nonnull const* _Nonnull in, int nb_channels, const float* _Nonnull matrix, float* _Nonnull out_l, float* _Nonnull out_r, int nb_samples) {
+    const float* left = matrix;
+    const float* right = matrix + nb_channels;
+    
+    // 按声道累加, 内层为连续内存上的乘加, 便于向量化
+    scale(out_l, in[0], left[0], nb_samples);
+    scale(out_r, in[0], right[0], nb_samples);
+    for ( int ch = 1; ch < nb_channels; ++ch ) {
+        if ( left[ch] != 0.0f ) mixAdd(out_l, in[ch], left[ch], nb_samples);
+        if ( right[ch] != 0.0f ) mixAdd(out_r, in[ch], right[ch], nb_samples);
+    }
+}
+
+void AudioKernels::downmixToStereoInterleaved(const float* _Nonnull in, int nb_channels, const float* _Nonnull matrix, float* _Nonnull out, int nb_samples) {
+    const float* left = matrix;
+    const float* right = matrix + nb_channels;
+    for ( int i = 0; i < nb_samples; ++i ) {
+        const float* frame = in + (int64_t)i * nb_channels;
+        float l = 0, r = 0;
+        for ( int ch = 0; ch < nb_channels; ++ch ) {
+            l += frame[ch] * left[ch];
+            r += frame[ch] * right[ch];
+        }
+        out[2 * i] = l;
+        out[2 * i + 1] = r;
+    }
+}
+
+#pragma mark - gain
+
+void AudioKernels::scale(float* _Nonnull dst, const float* _Nonnull src, float gain, int nb_samples) {
+    kernels().scale(dst, src, gain, nb_samples);
+}
+
+void AudioKernels::mixAdd(float* _Nonnull dst, const float* _Nonnull src, float gain, int nb_samples) {
+    kernels().mix_add(dst, src, gain, nb_samples);
+}
+
+void AudioKernels::applyGain(float* _Nonnull const* _Nonnull planes, int nb_planes, float gain, int nb_samples) {
+    if ( gain == 1.0f ) {
+        return;
+    }
+    
+    for ( int i = 0; i < nb_planes; ++i ) {
+        if ( gain == 0.0f ) {
+            fillSilence(planes[i], nb_samples);
+        }
+        else {
+            kernels().scale(planes[i], planes[i], gain, nb_samples);
+        }
+    }
+}
+
+void AudioKernels::peakSummary(const float* _Nonnull src, int nb_samples, float& min, float& max, double& sum_sq) {
+    kernels().peak_summary(src, nb_samples, &min, &max, &sum_sq);
+}
+
+void AudioKernels::multiply(float* _Nonnull dst, const float* _Nonnull a, const float* _Nonnull b, int nb_samples) {
+    kernels().multiply(dst, a, b, nb_samples);
+}
+
+void AudioKernels::fillSilence(float* _Nonnull dst, int nb_samples) {
+    // +0.0f 的位模式全为 0, memset 本身已经是向量化的实现
+    memset(dst, 0, sizeof(float) * nb_samples);
+}
+
+#pragma mark - fft
+
+void AudioKernels::fftButterfly(float* _Nonnull re0, float* _Nonnull im0, float* _Nonnull re1, float* _Nonnull im1, const float* _Nonnull wr, const float* _Nonnull wi, int n) {
+    kernels().fft_butterfly(re0, im0, re1, im1, wr, wi, n);
+}
+
+void AudioKernels::powerSpectrum(float* _Nonnull dst, const float* _Nonnull re, const float* _Nonnull im, int n) {
+    kernels().power_spectrum(dst, re, im, n);
+}
+
+#pragma mark - conversion
+
+void AudioKernels::s16ToFloat(float* _Nonnull dst, const int16_t* _Nonnull src, int nb_samples) {
+    kernels().s16_to_float(dst, src, nb_samples);
+}
+
+void AudioKernels::floatToS16(int16_t* _Nonnull dst, const float* _Nonnull src, int nb_samples) {
+    kernels().float_to_s16(dst, src, nb_samples);
+}
+
+void AudioKernels::interleave(float* _Nonnull dst, const float* _Nonnull const* _Nonnull src, int nb_channels, int nb_samples) {
+    if ( nb_channels == 2 ) {
+        kernels().interleave2(dst, src[0], src[1], nb_samples);
+        return;
+    }
+    
+    if ( nb_channels == 1 ) {
+        memcpy(dst, src[0], sizeof(float) * nb_samples);
+        return;
+    }
+    
+    for ( int i = 0; i < nb_samples; ++i ) {
+        for ( int ch = 0; ch < nb_channels; ++ch ) {
+            dst[(int64_t)i * nb_channels + ch] = src[ch][i];
+        }
+    }
+}
+
+void AudioKernels::deinterleave(float* _Nonnull const* _Nonnull dst, const float* _Nonnull src, int nb_channels, int nb_samples) {
+    if ( nb_channels == 2 ) {
+        kernels().deinterleave2(dst[0], dst[1], src, nb_samples);
+        return;
+    }
+    
+    if ( nb_channels == 1 ) {
+        memcpy(dst[0], src, sizeof(float) * nb_samples);
+        return;
+    }
+    
+    for ( int i = 0; i < nb_samples; ++i ) {
+        for ( int ch = 0; ch < nb_channels; ++ch ) {
+            dst[ch][i] = src[(int64_t)i * nb_channels + ch];
+        }
+    }
+}
+
+static bool is_s16(AVSampleFormat fmt) {
+    return fmt == AV_SAMPLE_FMT_S16 || fmt == AV_SAMPLE_FMT_S16P;
+}
+
+static bool is_float(AVSampleFormat fmt) {
+    return fmt == AV_SAMPLE_FMT_FLT || fmt == AV_SAMPLE_FMT_FLTP;
+}
+
+bool AudioKernels::canConvert(AVSampleFormat dst_fmt, int dst_nb_channels, AVSampleFormat src_fmt, int src_nb_channels) {
+    if ( dst_nb_channels <= 0 || dst_nb_channels > AV_NUM_DATA_POINTERS || src_nb_channels <= 0 ) {
+        return false;
+    }
+    
+    if ( !is_s16(src_fmt) && !is_float(src_fmt) ) {
+        return false;
+    }
+    
+    if ( is_float(dst_fmt) ) {
+        return src_nb_channels == dst_nb_channels || (src_nb_channels == 1 && dst_nb_channels == 2);
+    }
+    
+    if ( is_s16(dst_fmt) ) {
+        return src_nb_channels == dst_nb_channels && av_sample_fmt_is_planar(src_fmt) == av_sample_fmt_is_planar(dst_fmt);
+    }
+    return false;
+}
+
+// convert 时 s16 输入按块转换为 float, 临时缓冲保持在 L1 内
+static const int CONVERT_CHUNK_SIZE = 4096;
+
+int AudioKernels::convert(
+    uint8_t* _Nonnull const* _Nonnull dst,
+    AVSampleFormat dst_fmt,
+    int dst_nb_channels,
+    const uint8_t* _Nonnull const* _Nonnull src,
+    AVSampleFormat src_fmt,
+    int src_nb_channels,
+    int nb_samples
+) {
+    if ( !canConvert(dst_fmt, dst_nb_channels, src_fmt, src_nb_channels) ) {
+        return AVERROR(ENOSYS);
+    }
+    
+    bool src_planar = av_sample_fmt_is_planar(src_fmt);
+    bool dst_planar = av_sample_fmt_is_planar(dst_fmt);
+    int nb_planes = src_planar ? src_nb_channels : 1;
+    int stride = src_planar ? 1 : src_nb_channels;
+    
+    // 输出为 s16: 与输入同为平面或同为交错, 逐个平面转换或复制
+    if ( is_s16(dst_fmt) ) {
+        int count = nb_samples * stride;
+        for ( int p = 0; p < nb_planes; ++p ) {
+            if ( is_s16(src_fmt) ) {
+                memcpy(dst[p], src[p], sizeof(int16_t) * count);
+            }
+            else {
+                floatToS16((int16_t *)dst[p], (const float *)src[p], count);
+            }
+        }
+        return 0;
+    }
+    
+    // 输出为 float
+    float tmp[CONVERT_CHUNK_SIZE];
+    int chunk_size = CONVERT_CHUNK_SIZE / src_nb_channels;
+    const float* planes[AV_NUM_DATA_POINTERS];
+    const float* mapped[AV_NUM_DATA_POINTERS];
+    float* outs[AV_NUM_DATA_POINTERS];
+    for ( int off = 0; off < nb_samples; off += chunk_size ) {
+        int n = std::min(chunk_size, nb_samples - off);
+        
+        // 输入的 float 视图
+        for ( int p = 0; p < nb_planes; ++p ) {
+            if ( is_s16(src_fmt) ) {
+                float* t = tmp + p * n * stride;
+                s16ToFloat(t, (const int16_t *)src[p] + (int64_t)off * stride, n * stride);
+                planes[p] = t;
+            }
+            else {
+                planes[p] = (const float *)src[p] + (int64_t)off * stride;
+            }
+        }
+        
+        // 排列到输出; 单声道输入时每个输出声道都取第 0 个声道
+        if ( src_planar ) {
+            for ( int ch = 0; ch < dst_nb_channels; ++ch ) {
+                mapped[ch] = planes[src_nb_channels == 1 ? 0 : ch];
+            }
+            
+            if ( dst_planar ) {
+                for ( int ch = 0; ch < dst_nb_channels; ++ch ) {
+                    memcpy((float *)dst[ch] + off, mapped[ch], sizeof(float) * n);
+                }
+            }
+            else {
+                interleave((float *)dst[0] + (int64_t)off * dst_nb_channels, mapped, dst_nb_channels, n);
+            }
+        }
+        else if ( src_nb_channels == dst_nb_channels ) {
+            if ( dst_planar ) {
+                for ( int ch = 0; ch < dst_nb_channels; ++ch ) {
+                    outs[ch] = (float *)dst[ch] + off;
+                }
+                deinterleave(outs, planes[0], dst_nb_channels, n);
+            }
+            else {
+                memcpy((float *)dst[0] + (int64_t)off * dst_nb_channels, planes[0], sizeof(float) * n * dst_nb_channels);
+            }
+        }
+        else {
+            // 单声道交错数据即单个平面
+            if ( dst_planar ) {
+                memcpy((float *)dst[0] + off, planes[0], sizeof(float) * n);
+                memcpy((float *)dst[1] + off, planes[0], sizeof(float) * n);
+            }
+            else {
+                mapped[0] = mapped[1] = planes[0];
+                interleave((float *)dst[0] + (int64_t)off * 2, mapped, 2, n);
+            }
+        }
+    }
+    return 0;
+}
+
+}
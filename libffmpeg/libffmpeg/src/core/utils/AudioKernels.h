@@ -0,0 +1,119 @@
+//
+// Created on 2025/5/29.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_AUDIOKERNELS_H
+#define FFMPEGPROJ_AUDIOKERNELS_H
+#include "common.h"
+
+EXTERN_C_START
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+EXTERN_C_END
+
+#include <cstdint>
+#include <vector>
+
+namespace FFAV {
+
+/**
+ * @class AudioKernels
+ * @brief 常用的 PCM 处理内核(格式转换、交错/解交错、增益、下混、峰值统计、FFT 蝶形运算);
+ *
+ * 实现在首次调用时按 CPU 选择一次: ARM 上使用 NEON, x86 上支持 AVX2 时使用 AVX2, 否则使用 SSE2, 其他平台为标量实现;
+ * 各实现的结果与标量实现逐位一致(输入为 NaN 时除外), 可以放心在不同设备间比较输出;
+ *
+ * 使用示例:
+ * ```
+ * // s16 交错 -> float 平面
+ * if ( AudioKernels::canConvert(AV_SAMPLE_FMT_FLTP, 2, AV_SAMPLE_FMT_S16, 2) ) {
+ *     AudioKernels::convert(frame->extended_data, AV_SAMPLE_FMT_FLTP, 2, (const uint8_t **)&pcm, AV_SAMPLE_FMT_S16, 2, nb_samples);
+ * }
+ * ```
+ */
+class AudioKernels {
+public:
+    /// 当前使用的实现: "neon", "avx2", "sse2" 或 "scalar";
+    static const char* _Nonnull getImplementationName();
+
+    /// 当前 CPU 支持的实现, 按优先级排列, 最后一个总是 "scalar";
+    static std::vector<const char*> getAvailableImplementations();
+
+    /// 切换到指定的实现, 用于测试各实现与标量实现的一致性及基准对比; 当前 CPU 不支持时返回 false;
+    /// 不是线程安全的, 调用时不能有其他线程在使用 AudioKernels;
+    static bool setImplementation(const char* _Nonnull name);
+
+    /// 根据输入声道布局生成立体声下混矩阵(ITU-R BS.775, LFE 丢弃), 并按最大行和归一化避免削波;
+    /// matrix 大小为 2 * nb_channels: [0, nb_channels) 为左声道系数, [nb_channels, 2 * nb_channels) 为右声道系数;
+    static void makeStereoDownmixMatrix(const AVChannelLayout* _Nonnull in_layout, std::vector<float>& matrix);
+
+    /// 平面 float 下混为立体声; in 为 nb_channels 个平面;
+    static void downmixToStereoPlanar(const float* _Nonnull const* _Nonnull in, int nb_channels, const float* _Nonnull matrix, float* _Nonnull out_l, float* _Nonnull out_r, int nb_samples);
+
+    /// 交错 float 下混为交错立体声;
+    static void downmixToStereoInterleaved(const float* _Nonnull in, int nb_channels, const float* _Nonnull matrix, float* _Nonnull out, int nb_samples);
+
+    /// dst[i] = src[i] * gain
+    static void scale(float* _Nonnull dst, const float* _Nonnull src, float gain, int nb_samples);
+
+    /// dst[i] += src[i] * gain
+    static void mixAdd(float* _Nonnull dst, const float* _Nonnull src, float gain, int nb_samples);
+
+    /// 对 nb_planes 个平面原地应用增益; gain 为 0 时直接填充静音, 为 1 时不做处理;
+    static void applyGain(float* _Nonnull const* _Nonnull planes, int nb_planes, float gain, int nb_samples);
+
+    /// 统计最小值、最大值和平方和, 结果合并到 min/max/sum_sq 中; 初始值为 +inf/-inf/0, 可跨多次调用(多个声道)累计;
+    /// 平方和以 double 按固定的分组累加, 各实现逐位一致; +0/-0 相等时 min/max 可能返回任意一个;
+    static void peakSummary(const float* _Nonnull src, int nb_samples, float& min, float& max, double& sum_sq);
+
+    /// dst[i] = a[i] * b[i]; 例如加窗;
+    static void multiply(float* _Nonnull dst, const float* _Nonnull a, const float* _Nonnull b, int nb_samples);
+
+    /// 基 2 FFT 的一组蝶形运算(实部/虚部分开存放); 对 k in [0, n):
+    /// t = x1[k] * w[k]; x1[k] = x0[k] - t; x0[k] = x0[k] + t;
+    static void fftButterfly(float* _Nonnull re0, float* _Nonnull im0, float* _Nonnull re1, float* _Nonnull im1, const float* _Nonnull wr, const float* _Nonnull wi, int n);
+
+    /// dst[k] = re[k]^2 + im[k]^2
+    static void powerSpectrum(float* _Nonnull dst, const float* _Nonnull re, const float* _Nonnull im, int n);
+
+    /// 填充静音;
+    static void fillSilence(float* _Nonnull dst, int nb_samples);
+
+    /// s16 -> float, 与 swresample 一致按 1/32768 缩放; nb_samples 为样本总数(交错数据为 帧数 * 声道数);
+    static void s16ToFloat(float* _Nonnull dst, const int16_t* _Nonnull src, int nb_samples);
+
+    /// float -> s16, 按 32768 缩放后四舍五入(ties to even)并饱和到 [-32768, 32767];
+    static void floatToS16(int16_t* _Nonnull dst, const float* _Nonnull src, int nb_samples);
+
+    /// 平面 -> 交错; src 为 nb_channels 个平面, 同一个平面可以出现多次(例如单声道复制为立体声);
+    static void interleave(float* _Nonnull dst, const float* _Nonnull const* _Nonnull src, int nb_channels, int nb_samples);
+
+    /// 交错 -> 平面;
+    static void deinterleave(float* _Nonnull const* _Nonnull dst, const float* _Nonnull src, int nb_channels, int nb_samples);
+
+    /// 是否可以由 convert 直接完成转换;
+    ///
+    /// 支持的情况(采样率不变):
+    /// - 输出为 flt/fltp: 输入为 s16/s16p/flt/fltp, 声道数相同或单声道复制为立体声;
+    /// - 输出为 s16/s16p: 输入为 s16/s16p/flt/fltp 且与输出同为平面或同为交错, 声道数相同;
+    /// 声道数不超过 AV_NUM_DATA_POINTERS;
+    static bool canConvert(AVSampleFormat dst_fmt, int dst_nb_channels, AVSampleFormat src_fmt, int src_nb_channels);
+
+    /// 格式转换; dst/src 为每个平面的指针(交错数据只使用第一个);
+    /// @return 0 表示成功; 不支持的转换返回 AVERROR(ENOSYS);
+    static int convert(
+        uint8_t* _Nonnull const* _Nonnull dst,
+        AVSampleFormat dst_fmt,
+        int dst_nb_channels,
+        const uint8_t* _Nonnull const* _Nonnull src,
+        AVSampleFormat src_fmt,
+        int src_nb_channels,
+        int nb_samples
+    );
+};
+
+}
+
+#endif //FFMPEGPROJ_AUDIOKERNELS_H
@@ -8,11 +8,19 @@
 
 namespace FFAV {
 
+static const int AVIO_BUFFER_SIZE = 32 * 1024;
+
 AudioMuxer::AudioMuxer() {}
 
 AudioMuxer::~AudioMuxer() {
     if ( fmt_ctx ) {
-        if ( !(fmt_ctx->oformat->flags & AVFMT_NOFILE) && fmt_ctx->pb ) {
+        if ( custom_io ) {
+            if ( fmt_ctx->pb ) {
+                av_freep(&fmt_ctx->pb->buffer);
+                avio_context_free(&fmt_ctx->pb);
+            }
+        }
+        else if ( !(fmt_ctx->oformat->flags & AVFMT_NOFILE) && fmt_ctx->pb ) {
             avio_closep(&fmt_ctx->pb);
         }
         avformat_free_context(fmt_ctx);
@@ -46,15 +54,53 @@ int AudioMuxer::init(const std::string& file_path, AVCodecContext* codec_ctx, AV
     return 0;
 }
 
+int AudioMuxer::init(const std::string& format_name, AVCodecContext* codec_ctx, WriteCallback write_callback) {
+    int ret = 0;
+    AVFormatContext* fmt_ctx;
+    ret = avformat_alloc_output_context2(&fmt_ctx, NULL, format_name.c_str(), NULL);
+    if ( ret < 0 ) return ret;
+    ret = init(codec_ctx, fmt_ctx, write_callback);
+    if ( ret < 0 ) avformat_free_context(fmt_ctx);
+    return ret;
+}
+
+int AudioMuxer::init(AVCodecContext* codec_ctx, AVFormatContext* fmt_ctx, WriteCallback write_callback) {
+    if ( !write_callback ) return AVERROR(EINVAL);
+    int ret = init("", codec_ctx, fmt_ctx);
+    if ( ret < 0 ) return ret;
+    this->write_callback = write_callback;
+    this->custom_io = true;
+    return 0;
+}
+
 int AudioMuxer::open() {
+    if ( custom_io ) {
+        uint8_t* buffer = (uint8_t*)av_malloc(AVIO_BUFFER_SIZE);
+        if ( !buffer ) return AVERROR(ENOMEM);
+        fmt_ctx->pb = avio_alloc_context(buffer, AVIO_BUFFER_SIZE, 1, this, nullptr, write_packet, nullptr);
+        if ( !fmt_ctx->pb ) {
+            av_free(buffer);
+            return AVERROR(ENOMEM);
+        }
+        fmt_ctx->pb->seekable = 0;
+        fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+        return 0;
+    }
+
     if ( !(fmt_ctx->oformat->flags & AVFMT_NOFILE) ) { 
         return avio_open(&fmt_ctx->pb, file_path.c_str(), AVIO_FLAG_WRITE);
     }
     return 0;
 }
 
-int AudioMuxer::writeHeader() {
-    return avformat_write_header(fmt_ctx, nullptr);
+int AudioMuxer::writeHeader(const std::map<std::string, std::string>& options) {
+    AVDictionary* opts = nullptr;
+    for ( auto& pair : options ) {
+        av_dict_set(&opts, pair.first.c_str(), pair.second.c_str(), 0);
+    }
+    int ret = avformat_write_header(fmt_ctx, &opts);
+    av_dict_free(&opts);
+    return ret;
 }
 
 int AudioMuxer::writePacket(AVPacket* pkt) {
@@ -64,7 +110,18 @@ int AudioMuxer::writePacket(AVPacket* pkt) {
 }
 
 int AudioMuxer::writeTrailer() {
-    return av_write_trailer(fmt_ctx);
+    int ret = av_write_trailer(fmt_ctx);
+    if ( ret >= 0 && custom_io ) {
+        avio_flush(fmt_ctx->pb);
+        ret = fmt_ctx->pb->error;
+    }
+    return ret;
+}
+
+int AudioMuxer::write_packet(void* opaque, uint8_t* buf, int buf_size) {
+    AudioMuxer* muxer = static_cast<AudioMuxer*>(opaque);
+    int ret = muxer->write_callback(buf, buf_size);
+    return ret < 0 ? ret : buf_size;
 }
 
 }
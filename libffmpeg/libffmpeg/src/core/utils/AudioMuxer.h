@@ -7,6 +7,8 @@
 #ifndef PRIVATE_FFMPEG_HARMONY_OS_AUDIOMUXER_H
 #define PRIVATE_FFMPEG_HARMONY_OS_AUDIOMUXER_H
 
+#include <functional>
+#include <map>
 #include <string>
 
 extern "C" {
@@ -39,21 +41,37 @@ namespace FFAV {
  * muxer.writePacket(encoded_packet);
  * muxer.writeTrailer();
  * ```
+ *
+ * 也可以不写文件, 通过自定义 AVIO 将封装后的数据交给回调(例如写入内存或直接发送):
+ * ```
+ * std::vector<uint8_t> data;
+ * muxer.init("adts", codec_ctx, [&](const uint8_t* buf, int size) {
+ *     data.insert(data.end(), buf, buf + size);
+ *     return size;
+ * });
+ * ```
+ * @note 回调输出不支持 seek; mp4 需要使用分片模式(movflags=frag_keyframe+empty_moov), 见 `writeHeader`;
  */
 class AudioMuxer {
 public:
+    /// 封装后的数据回调; 返回写入的字节数, 小于0表示报错;
+    using WriteCallback = std::function<int(const uint8_t* _Nonnull buf, int size)>;
+
     AudioMuxer();
     ~AudioMuxer();
 
     /// 初始化封装器
     int init(const std::string& file_path, AVCodecContext* codec_ctx);
     int init(const std::string& file_path, AVCodecContext* codec_ctx, AVFormatContext* fmt_ctx);
+    /// 初始化封装器, 输出到回调; format_name 为封装格式的短名称, 例如 "mp4", "adts", "ogg";
+    int init(const std::string& format_name, AVCodecContext* codec_ctx, WriteCallback write_callback);
+    int init(AVCodecContext* codec_ctx, AVFormatContext* fmt_ctx, WriteCallback write_callback);
 
     /// 打开文件
     int open();
 
-    /// 写文件头
-    int writeHeader();
+    /// 写文件头; options 为封装器的私有选项, 例如 { "movflags", "frag_keyframe+empty_moov" };
+    int writeHeader(const std::map<std::string, std::string>& options = {});
 
     /// 接收编码后的音频数据并写入文件
     int writePacket(AVPacket* pkt);
@@ -66,6 +84,10 @@ private:
     AVFormatContext* fmt_ctx { nullptr };
     AVRational time_base;
     AVStream* stream { nullptr };
+    WriteCallback write_callback { nullptr };
+    bool custom_io { false };
+
+    static int write_packet(void* opaque, uint8_t* buf, int buf_size);
 };
 
 }
@@ -8,23 +8,7 @@
 
 namespace FFAV {
 
-int AudioUtils::transcode(
-    AVPacket* _Nullable pkt,
-    MediaDecoder* _Nonnull decoder, 
-    AVFrame* _Nonnull dec_frame,
-    FilterGraph* _Nonnull filter_graph,
-    AVFrame* _Nonnull filt_frame,
-    const std::string& buf_src_name,
-    const std::string& buf_sink_name,
-    FilterFrameCallback callback
-) {
-    int ret = decoder->send(pkt);
-    if ( ret < 0 ) {
-        return ret;
-    }
-        
-    return process_decoded_frames(decoder, dec_frame, filter_graph, filt_frame, buf_src_name, buf_sink_name, callback);
-}
+// 转码流水线为模板实现, 见 AudioUtils.h;
 
 //AVSampleFormat AudioUtils::ohToAVSampleFormat(OH_AudioStream_SampleFormat fmt) {
 //    switch (fmt) {
@@ -41,69 +25,4 @@ int AudioUtils::transcode(
 //    }
 //}
 
-int AudioUtils::process_decoded_frames(
-    MediaDecoder* _Nonnull decoder, 
-    AVFrame* _Nonnull dec_frame,
-    FilterGraph* _Nonnull filter_graph,
-    AVFrame* _Nonnull filt_frame,
-    const std::string& buf_src_name,
-    const std::string& buf_sink_name,
-    FilterFrameCallback callback
-) {
-    int ret = 0;
-    do {
-        ret = decoder->receive(dec_frame);
-        if ( ret == AVERROR_EOF ) {
-            ret = process_filter_frame(NULL, filter_graph, filt_frame, buf_src_name, buf_sink_name, callback);
-            break;
-        }
-    
-        if ( ret < 0 ) {
-            break;
-        }
-        
-        ret = process_filter_frame(dec_frame, filter_graph, filt_frame, buf_src_name, buf_sink_name, callback);
-        av_frame_unref(dec_frame);
-    } while(ret >= 0);
-    return ret;
-}
-
-int AudioUtils::process_filter_frame(
-    AVFrame* _Nullable frame,
-    FilterGraph* _Nonnull filter_graph,
-    AVFrame* _Nonnull filt_frame,
-    const std::string& buf_src_name,
-    const std::string& buf_sink_name,
-    FilterFrameCallback callback
-) {
-    int flags = frame != nullptr ? AV_BUFFERSRC_FLAG_KEEP_REF : AV_BUFFERSRC_FLAG_PUSH;
-    int ret = filter_graph->addFrame(buf_src_name, frame, flags);
-    if ( ret < 0 ) {
-        return ret;
-    }  
-    return transfer_filtered_frames(filter_graph, filt_frame, buf_sink_name, callback);
-}
-
-int AudioUtils::transfer_filtered_frames(
-    FilterGraph* _Nonnull filter_graph,
-    AVFrame* _Nonnull filt_frame,
-    const std::string& buf_sink_name,
-    FilterFrameCallback callback
-) {
-    int ret = 0;
-    int callback_ret = 0;
-    do {
-        ret = filter_graph->getFrame(buf_sink_name, filt_frame);
-        if ( ret < 0 ) {
-            break;
-        }
-        callback_ret = callback(filt_frame); // callback
-        if ( callback_ret < 0 ) {
-            ret = callback_ret;
-        }
-        av_frame_unref(filt_frame);
-    } while (ret >= 0);
-    return ret;
-}
-    
 }
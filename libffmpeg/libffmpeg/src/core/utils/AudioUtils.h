@@ -11,55 +11,196 @@
 #include "MediaDecoder.h"
 #include "FilterGraph.h"
 #include <functional>
+#include <utility>
 
 namespace FFAV {
 
+/**
+ * 解码 -> 滤镜 -> sink 的转码流水线;
+ *
+ * sink 为模板参数(任意 `int(AVFrame*)` 的可调用对象), 调用在编译期展开并内联, 不经过 std::function;
+ * 整个流程只复用调用方传入的 pkt/frame, 稳态下不产生额外的内存分配;
+ *
+ * 使用示例:
+ * ```
+ * auto src = graph->getBufferSource("in");
+ * auto sink = graph->getBufferSink("out");
+ * AudioUtils::transcode(pkt, decoder, dec_frame, graph, filt_frame, src, sink, [&](AVFrame* frame) {
+ *     return fifo->write((void **)frame->data, frame->nb_samples, frame->pts);
+ * });
+ * ```
+ */
 class AudioUtils {
 public:
     using FilterFrameCallback = std::function<int(AVFrame* _Nonnull filt_frame)>;
-    
+
+    template <typename Sink>
     static int transcode(
         AVPacket* _Nullable pkt,
-        MediaDecoder* _Nonnull decoder, 
+        MediaDecoder* _Nonnull decoder,
         AVFrame* _Nonnull dec_frame,
         FilterGraph* _Nonnull filter_graph,
         AVFrame* _Nonnull filt_frame,
         const std::string& buf_src_name,
         const std::string& buf_sink_name,
-        FilterFrameCallback callback
-    );
-    
+        Sink&& sink
+    ) {
+        return transcode(pkt, decoder, dec_frame, filter_graph, filt_frame, filter_graph->getBufferSource(buf_src_name), filter_graph->getBufferSink(buf_sink_name), sink);
+    }
+
+    // 使用 configure 时缓存的 source/sink, 每帧不再按名称查找;
+    template <typename Sink>
+    static int transcode(
+        AVPacket* _Nullable pkt,
+        MediaDecoder* _Nonnull decoder,
+        AVFrame* _Nonnull dec_frame,
+        FilterGraph* _Nonnull filter_graph,
+        AVFrame* _Nonnull filt_frame,
+        BufferSourceHandle buf_src,
+        BufferSinkHandle buf_sink,
+        Sink&& sink
+    ) {
+        int ret = decoder->send(pkt);
+        if ( ret < 0 ) {
+            return ret;
+        }
+        return process_decoded_frames<true>(decoder, dec_frame, filter_graph, filt_frame, buf_src, buf_sink, sink);
+    }
+
+    // 仅解码, 不经过 filter graph; 解码后的 frame 直接交给 sink;
+    template <typename Sink>
+    static int decode(
+        AVPacket* _Nullable pkt,
+        MediaDecoder* _Nonnull decoder,
+        AVFrame* _Nonnull dec_frame,
+        Sink&& sink
+    ) {
+        int ret = decoder->send(pkt);
+        if ( ret < 0 ) {
+            return ret;
+        }
+        return process_decoded_frames<false>(decoder, dec_frame, nullptr, nullptr, { }, { }, sink);
+    }
+
+    /**
+     * 批量转码: 一次调用处理多个 packet, 直到 next_packet 返回 false、出错或 EOF;
+     *
+     * `bool next_packet(AVPacket*& pkt)`: 返回 false 表示暂时没有更多数据; 返回 true 时 pkt 为待转码的包,
+     * 为 nullptr 表示输入结束(flush); 转码后会对 pkt 调用 av_packet_unref;
+     *
+     * @return 0 表示 next_packet 返回了 false; AVERROR_EOF 表示已全部输出; 其他负值表示出错;
+     */
+    template <typename PacketSource, typename Sink>
+    static int transcodePackets(
+        PacketSource&& next_packet,
+        MediaDecoder* _Nonnull decoder,
+        AVFrame* _Nonnull dec_frame,
+        FilterGraph* _Nonnull filter_graph,
+        AVFrame* _Nonnull filt_frame,
+        BufferSourceHandle buf_src,
+        BufferSinkHandle buf_sink,
+        Sink&& sink
+    ) {
+        int ret = 0;
+        AVPacket* pkt = nullptr;
+        while ( next_packet(pkt) ) {
+            ret = transcode(pkt, decoder, dec_frame, filter_graph, filt_frame, buf_src, buf_sink, sink);
+            if ( pkt ) {
+                av_packet_unref(pkt);
+            }
+
+            if ( ret == AVERROR(EAGAIN) ) {
+                ret = 0;
+                continue;
+            }
+
+            if ( ret < 0 ) {
+                return ret;
+            }
+        }
+        return ret;
+    }
+
 //    static AVSampleFormat ohToAVSampleFormat(OH_AudioStream_SampleFormat fmt);
 
 private:
+    template <bool UseFilterGraph, typename Sink>
     static int process_decoded_frames(
-        MediaDecoder* _Nonnull decoder, 
+        MediaDecoder* _Nonnull decoder,
         AVFrame* _Nonnull dec_frame,
-        FilterGraph* _Nonnull filter_graph,
-        AVFrame* _Nonnull filt_frame,
-        const std::string& buf_src_name,
-        const std::string& buf_sink_name,
-        FilterFrameCallback callback
-    );
-    
+        FilterGraph* _Nullable filter_graph,
+        AVFrame* _Nullable filt_frame,
+        BufferSourceHandle buf_src,
+        BufferSinkHandle buf_sink,
+        Sink& sink
+    ) {
+        int ret = 0;
+        do {
+            ret = decoder->receive(dec_frame);
+            if ( ret == AVERROR_EOF ) {
+                if constexpr ( UseFilterGraph ) {
+                    ret = process_filter_frame(NULL, filter_graph, filt_frame, buf_src, buf_sink, sink);
+                }
+                break;
+            }
+
+            if ( ret < 0 ) {
+                break;
+            }
+
+            if constexpr ( UseFilterGraph ) {
+                ret = process_filter_frame(dec_frame, filter_graph, filt_frame, buf_src, buf_sink, sink);
+            }
+            else {
+                ret = sink(dec_frame);
+            }
+            av_frame_unref(dec_frame);
+        } while(ret >= 0);
+        return ret;
+    }
+
+    template <typename Sink>
     static int process_filter_frame(
         AVFrame* _Nullable frame,
         FilterGraph* _Nonnull filter_graph,
         AVFrame* _Nonnull filt_frame,
-        const std::string& buf_src_name,
-        const std::string& buf_sink_name,
-        FilterFrameCallback callback
-    );
-    
+        BufferSourceHandle buf_src,
+        BufferSinkHandle buf_sink,
+        Sink& sink
+    ) {
+        // frame 的引用直接转交给 buffersrc(成功后 frame 被重置), 不再为每帧额外创建一份引用
+        int flags = frame != nullptr ? 0 : AV_BUFFERSRC_FLAG_PUSH;
+        int ret = filter_graph->addFrame(buf_src, frame, flags);
+        if ( ret < 0 ) {
+            return ret;
+        }
+        return transfer_filtered_frames(filter_graph, filt_frame, buf_sink, sink);
+    }
+
+    template <typename Sink>
     static int transfer_filtered_frames(
         FilterGraph* _Nonnull filter_graph,
         AVFrame* _Nonnull filt_frame,
-        const std::string& buf_sink_name,
-        FilterFrameCallback callback
-    );
+        BufferSinkHandle buf_sink,
+        Sink& sink
+    ) {
+        int ret = 0;
+        int sink_ret = 0;
+        do {
+            ret = filter_graph->getFrame(buf_sink, filt_frame);
+            if ( ret < 0 ) {
+                break;
+            }
+            sink_ret = sink(filt_frame); // callback
+            if ( sink_ret < 0 ) {
+                ret = sink_ret;
+            }
+            av_frame_unref(filt_frame);
+        } while (ret >= 0);
+        return ret;
+    }
 };
 
 }
 
 #endif //FFMPEGPROJ_AUDIOUTILS_H
-
@@ -5,8 +5,10 @@
 // please include "napi/native_api.h".
 
 #include "AudioWriter.h"
+#include "AudioKernels.h"
 #include <cerrno>
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 
 namespace FFAV {
@@ -47,6 +49,16 @@ AudioWriter::~AudioWriter() {
     if ( fifo_out_frame ) {
         av_frame_free(&fifo_out_frame);
     }
+    
+    if ( in_frame ) {
+        av_frame_free(&in_frame);
+    }
+    
+    if ( convert_frame ) {
+        av_frame_free(&convert_frame);
+    }
+    
+    av_buffer_pool_uninit(&in_buffer_pool);
 }
 
 int AudioWriter::init(
@@ -54,6 +66,68 @@ int AudioWriter::init(
     AVSampleFormat in_sample_fmt,
     int in_sample_rate,
     int in_nb_channels
+) {
+    // Allocate the output format context
+    AVFormatContext* fmt_ctx { nullptr };
+    int ret = avformat_alloc_output_context2(&fmt_ctx, NULL, NULL, out_file_path.c_str());
+    if ( ret < 0 ) {
+        return ret;
+    }
+    return init(fmt_ctx, out_file_path, nullptr, in_sample_fmt, in_sample_rate, in_nb_channels);
+}
+
+int AudioWriter::init(
+    const std::string& format_name,
+    AudioMuxer::WriteCallback write_callback,
+    AVSampleFormat in_sample_fmt,
+    int in_sample_rate,
+    int in_nb_channels
+) {
+    if ( !write_callback ) {
+        return AVERROR(EINVAL);
+    }
+
+    AVFormatContext* fmt_ctx { nullptr };
+    int ret = avformat_alloc_output_context2(&fmt_ctx, NULL, format_name.c_str(), NULL);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    // 回调输出不支持 seek, mov 系列需要分片写入, 否则无法回写 moov
+    const char* name = fmt_ctx->oformat->name;
+    if ( strcmp(name, "mp4") == 0 || strcmp(name, "mov") == 0 || strcmp(name, "ipod") == 0 ) {
+        muxer_options["movflags"] = "frag_keyframe+empty_moov+default_base_moof";
+    }
+    return init(fmt_ctx, "", write_callback, in_sample_fmt, in_sample_rate, in_nb_channels);
+}
+
+int AudioWriter::init(
+    const std::string& out_file_path,
+    PacketCallback packet_callback,
+    AVSampleFormat in_sample_fmt,
+    int in_sample_rate,
+    int in_nb_channels
+) {
+    if ( !packet_callback ) {
+        return AVERROR(EINVAL);
+    }
+
+    AVFormatContext* fmt_ctx { nullptr };
+    int ret = avformat_alloc_output_context2(&fmt_ctx, NULL, NULL, out_file_path.c_str());
+    if ( ret < 0 ) {
+        return ret;
+    }
+    this->packet_callback = packet_callback;
+    return init(fmt_ctx, out_file_path, nullptr, in_sample_fmt, in_sample_rate, in_nb_channels);
+}
+
+int AudioWriter::init(
+    AVFormatContext* _Nonnull fmt_ctx,
+    const std::string& out_file_path,
+    AudioMuxer::WriteCallback write_callback,
+    AVSampleFormat in_sample_fmt,
+    int in_sample_rate,
+    int in_nb_channels
 ) {
     int ret = 0;
     
@@ -62,13 +136,6 @@ int AudioWriter::init(
     this->in_nb_channels = in_nb_channels;
     av_channel_layout_default(&in_ch_layout, in_nb_channels);
     
-    // Allocate the output format context
-    AVFormatContext* fmt_ctx { nullptr };
-    ret = avformat_alloc_output_context2(&fmt_ctx, NULL, NULL, out_file_path.c_str());
-    if ( ret < 0 ) {
-        return ret;
-    }
-    
     // Find the encoder for the output format
     const AVCodec* codec = avcodec_find_encoder(fmt_ctx->oformat->audio_codec);
     if ( codec == nullptr ) {
@@ -87,14 +154,23 @@ int AudioWriter::init(
         return ret;
     }
     
-    // Create muxer
-    muxer = new AudioMuxer();
-    ret = muxer->init(out_file_path, encoder->getCodecContext(), fmt_ctx);
-    if ( ret < 0 ) {
+    // 只编码时不需要封装器, fmt_ctx 仅用于选择编码器
+    if ( packet_callback ) {
         avformat_free_context(fmt_ctx);
-        return ret;
+        fmt_ctx = nullptr;
     }
     
+    // Create muxer
+    if ( fmt_ctx ) {
+        muxer = new AudioMuxer();
+        ret = write_callback ? muxer->init(encoder->getCodecContext(), fmt_ctx, write_callback)
+                             : muxer->init(out_file_path, encoder->getCodecContext(), fmt_ctx);
+        if ( ret < 0 ) {
+            avformat_free_context(fmt_ctx);
+            return ret;
+        }
+    }
+
     // Get output formats
     out_sample_fmt = encoder->getSampleFormat();
     out_sample_rate = encoder->getSampleRate();
@@ -105,6 +181,8 @@ int AudioWriter::init(
     AVSampleFormat out_sample_fmts[] = { out_sample_fmt, AV_SAMPLE_FMT_NONE };
     char out_ch_layout_desc[64];
     av_channel_layout_describe(&out_ch_layout, out_ch_layout_desc, sizeof(out_ch_layout_desc)); // get channel layout desc
+    char in_ch_layout_desc[64];
+    av_channel_layout_describe(&in_ch_layout, in_ch_layout_desc, sizeof(in_ch_layout_desc));
     
     // Create filter graph
     filter_graph = new FilterGraph();
@@ -118,7 +196,7 @@ int AudioWriter::init(
         (AVRational){ 1, in_sample_rate },
         in_sample_rate, 
         in_sample_fmt,
-        out_ch_layout_desc
+        in_ch_layout_desc
     );
     if ( ret < 0 ) {
         return ret;
@@ -148,6 +226,8 @@ int AudioWriter::init(
     if ( ret < 0 ) {
         return ret;
     }
+    buf_src = filter_graph->getBufferSource(FILTER_ABUFFER_SRC_NAME);
+    buf_sink = filter_graph->getBufferSink(FILTER_ABUFFER_SINK_NAME);
     
     fifo = new AudioFifo();
     ret = fifo->init(out_sample_fmt, out_nb_channels, 1);
@@ -155,7 +235,19 @@ int AudioWriter::init(
         return ret;
     }
     
+    {
+        // 采样率与声道布局一致时, s16 <-> float、交错 <-> 平面、单声道 -> 立体声 这类转换不需要经过 aformat/aresample
+        AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+        bool same_layout = av_channel_layout_compare(&in_ch_layout, &out_ch_layout) == 0;
+        bool mono_to_stereo = in_nb_channels == 1 && av_channel_layout_compare(&out_ch_layout, &stereo) == 0;
+        direct_convert = in_sample_rate == out_sample_rate &&
+                         (same_layout || mono_to_stereo) &&
+                         AudioKernels::canConvert(out_sample_fmt, out_nb_channels, in_sample_fmt, in_nb_channels);
+    }
+    
     filter_out_frame = av_frame_alloc();
+    in_frame = av_frame_alloc();
+    convert_frame = av_frame_alloc();
     out_pkt = av_packet_alloc();
     
     fifo_out_frame = av_frame_alloc();
@@ -174,13 +266,17 @@ exit_init:
 }
 
 int AudioWriter::open() {
+    if ( !muxer ) {
+        return 0;
+    }
+    
     int ret = muxer->open();
     if ( ret < 0 ) return ret;
-    return muxer->writeHeader();
+    return muxer->writeHeader(muxer_options);
 }
 
 int AudioWriter::write(AVFrame* frame) {
-    int ret = filter_graph->addFrame(FILTER_ABUFFER_SRC_NAME, frame);
+    int ret = filter_graph->addFrame(buf_src, frame);
     if ( ret < 0 ) {
         return ret;
     }
@@ -188,27 +284,91 @@ int AudioWriter::write(AVFrame* frame) {
 }
 
 int AudioWriter::write(void *buffer, int buffer_size) {     
-    AVFrame* frame = av_frame_alloc();
+    if ( direct_convert ) {
+        return writeConverted(buffer, buffer_size);
+    }
+    
+    // 输入缓冲从 AVBufferPool 获取并复用; 写入更大的缓冲时重建 pool
+    if ( in_buffer_pool == nullptr || buffer_size > in_buffer_pool_size ) {
+        av_buffer_pool_uninit(&in_buffer_pool);
+        in_buffer_pool = av_buffer_pool_init(buffer_size, nullptr);
+        if ( in_buffer_pool == nullptr ) {
+            return AVERROR(ENOMEM);
+        }
+        in_buffer_pool_size = buffer_size;
+    }
+    
+    AVBufferRef* buf = av_buffer_pool_get(in_buffer_pool);
+    if ( buf == nullptr ) {
+        return AVERROR(ENOMEM);
+    }
+    memcpy(buf->data, buffer, buffer_size);
+    
+    AVFrame* frame = in_frame;
     frame->format = in_sample_fmt;
     frame->sample_rate = in_sample_rate;
     frame->ch_layout = in_ch_layout;
     frame->nb_samples = buffer_size / (av_get_bytes_per_sample(in_sample_fmt) * in_nb_channels);
+    frame->buf[0] = buf;
     
-    int ret = avcodec_fill_audio_frame(frame, in_ch_layout.nb_channels, in_sample_fmt, (uint8_t*)buffer, buffer_size, 1);
+    int ret = avcodec_fill_audio_frame(frame, in_ch_layout.nb_channels, in_sample_fmt, buf->data, buffer_size, 1);
     if ( ret < 0 ) {
+        av_frame_unref(frame);
         return ret;
     } 
     
     frame->pts = in_pts;
     in_pts += frame->nb_samples;
     
-    ret = write(frame);
-    av_frame_free(&frame);
-    return ret;
+    // 转移引用, buffersrc 不再复制数据; 调用后 frame 被重置
+    ret = filter_graph->addFrame(buf_src, frame, 0);
+    if ( ret < 0 ) {
+        av_frame_unref(frame);
+        return ret;
+    }
+    return consumeAbufferSink();
+}
+
+int AudioWriter::writeConverted(void *buffer, int buffer_size) {
+    int nb_samples = buffer_size / (av_get_bytes_per_sample(in_sample_fmt) * in_nb_channels);
+    if ( nb_samples <= 0 ) {
+        return 0;
+    }
+    
+    // 输出缓冲复用; 写入更多样本时重新分配
+    if ( convert_frame->nb_samples < nb_samples ) {
+        av_frame_unref(convert_frame);
+        convert_frame->format = out_sample_fmt;
+        convert_frame->sample_rate = out_sample_rate;
+        av_channel_layout_copy(&convert_frame->ch_layout, &out_ch_layout);
+        convert_frame->nb_samples = nb_samples;
+        int ret = av_frame_get_buffer(convert_frame, 0);
+        if ( ret < 0 ) {
+            return ret;
+        }
+    }
+    
+    uint8_t* src[AV_NUM_DATA_POINTERS] = { nullptr };
+    int ret = av_samples_fill_arrays(src, nullptr, (const uint8_t *)buffer, in_nb_channels, nb_samples, in_sample_fmt, 1);
+    if ( ret < 0 ) {
+        return ret;
+    }
+    
+    ret = AudioKernels::convert(convert_frame->extended_data, out_sample_fmt, out_nb_channels, src, in_sample_fmt, in_nb_channels, nb_samples);
+    if ( ret < 0 ) {
+        return ret;
+    }
+    
+    ret = fifo->write((void **)convert_frame->extended_data, nb_samples, in_pts);
+    if ( ret < 0 ) {
+        return ret;
+    }
+    in_pts += nb_samples;
+    return consumeFifo(false);
 }
 
 int AudioWriter::close() {
-    int ret = filter_graph->addFrame(FILTER_ABUFFER_SRC_NAME, nullptr, AV_BUFFERSRC_FLAG_PUSH);
+    int ret = filter_graph->addFrame(buf_src, nullptr, AV_BUFFERSRC_FLAG_PUSH);
     if ( ret < 0 ) {
         return ret;
     }
@@ -217,13 +377,13 @@ int AudioWriter::close() {
     if ( ret < 0 ) {
         return ret;
     }
-    return muxer->writeTrailer();
+    return muxer ? muxer->writeTrailer() : 0;
 }
 
 int AudioWriter::consumeAbufferSink() {
     int ret = 0;
     while (true) {
-        ret = filter_graph->getFrame(FILTER_ABUFFER_SINK_NAME, filter_out_frame);
+        ret = filter_graph->getFrame(buf_sink, filter_out_frame);
         if ( ret == AVERROR(EAGAIN) ) {
             return 0;
         }
@@ -277,8 +437,11 @@ int AudioWriter::consumeFifo(bool eos) {
             return ret;
         }
         
-        ret = muxer->writePacket(out_pkt);
+        ret = packet_callback ? packet_callback(out_pkt) : muxer->writePacket(out_pkt);
         av_packet_unref(out_pkt);
+        if ( ret < 0 ) {
+            return ret;
+        }
     }
     return 0;
 }
@@ -12,6 +12,11 @@
 #include "AudioMuxer.h"
 #include "FilterGraph.h"
 #include <cstdint>
+#include <functional>
+
+extern "C" {
+#include <libavutil/buffer.h>
+}
 
 namespace FFAV {
 
@@ -36,10 +41,13 @@ namespace FFAV {
  * writer.close();
  * ```
  * @note **注意:** 目标文件名必须包含正确的文件后缀（如 `.mp4`、`.aac`、`.wav`），以便自动推测封装格式。
+ * 需要直接获取封装后的数据时(上传、缓存等), 可以使用 `init(format_name, write_callback, ...)` 输出到回调, 避免写临时文件。
  */
 class AudioWriter {
 
 public:
+    using PacketCallback = std::function<int(AVPacket* _Nonnull pkt)>;
+
     AudioWriter();
     ~AudioWriter();
     
@@ -50,17 +58,42 @@ public:
         int in_sample_rate,
         int in_nb_channels
     );
+    /// 输出到回调而不是文件; format_name 为封装格式的短名称, 例如 "mp4", "adts", "ogg";
+    /// mp4/mov 会自动使用分片模式(movflags=frag_keyframe+empty_moov+default_base_moof), 便于边编码边消费;
+    int init(
+        const std::string& format_name,
+        AudioMuxer::WriteCallback write_callback,
+        AVSampleFormat in_sample_fmt,
+        int in_sample_rate,
+        int in_nb_channels
+    );
+    /// 只编码不封装, 编码后的 packet 交给回调(pts 以 1/输出采样率 为单位); out_file_path 仅用于按后缀选择编码器;
+    /// 用于由调用方自行封装, 例如分段编码后按顺序拼接; open/close 不再写文件头及文件尾;
+    int init(
+        const std::string& out_file_path,
+        PacketCallback packet_callback,
+        AVSampleFormat in_sample_fmt,
+        int in_sample_rate,
+        int in_nb_channels
+    );
     
     int open();
     int write(AVFrame* frame);
     int write(void *buffer, int buffer_size);
     int close();
     
+    int getSampleRate() const { return out_sample_rate; }
+    int getFrameSize() const { return out_frame_size; }
+    AVCodecContext* _Nullable getCodecContext() { return encoder ? encoder->getCodecContext() : nullptr; }
+    
 private:
     AudioEncoder* encoder { nullptr };
     AudioFifo* fifo { nullptr };
     FilterGraph* filter_graph { nullptr };
+    BufferSourceHandle buf_src;
+    BufferSinkHandle buf_sink;
     AudioMuxer* muxer { nullptr };
+    PacketCallback packet_callback { nullptr };
     
     AVSampleFormat in_sample_fmt;
     int in_sample_rate;
@@ -76,8 +109,23 @@ private:
     
     AVFrame* filter_out_frame { nullptr };
     AVFrame* fifo_out_frame { nullptr };
+    AVFrame* in_frame { nullptr };               // write(buffer, size) 复用
+    AVBufferPool* in_buffer_pool { nullptr };
+    int in_buffer_pool_size { 0 };
+    bool direct_convert { false };               // 仅格式/交错方式/单声道转立体声不同, write(buffer, size) 直接转换后写入 fifo
+    AVFrame* convert_frame { nullptr };
     AVPacket* out_pkt { nullptr };
+    std::map<std::string, std::string> muxer_options;
+    int init(
+        AVFormatContext* _Nonnull fmt_ctx,
+        const std::string& out_file_path,
+        AudioMuxer::WriteCallback write_callback,
+        AVSampleFormat in_sample_fmt,
+        int in_sample_rate,
+        int in_nb_channels
+    );
     
+    int writeConverted(void *buffer, int buffer_size);
     int consumeAbufferSink();
     int consumeFifo(bool eos);
 };
@@ -0,0 +1,455 @@
+//
+// Created on 2025/5/27.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "BatchTranscoder.h"
+#include "MediaReader.h"
+#include "MediaDecoder.h"
+#include "FilterGraph.h"
+#include "AudioUtils.h"
+#include "MediaObjectPool.h"
+#include "AudioWriter.h"
+#include "SegmentedDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <thread>
+
+namespace FFAV {
+
+static const std::string FILTER_ABUFFER_SRC_NAME = "in";
+static const std::string FILTER_ABUFFER_SINK_NAME = "out";
+
+// 统一转为 fltp 及标准声道布局, 采样率保持不变; 编码器所需的格式由 AudioWriter 负责转换;
+// 调用前需要已添加 buffer source;
+static int configure_fltp_graph(FilterGraph& graph, int sample_rate, int nb_channels) {
+    AVChannelLayout ch_layout;
+    av_channel_layout_default(&ch_layout, nb_channels);
+    char ch_layout_desc[64];
+    av_channel_layout_describe(&ch_layout, ch_layout_desc, sizeof(ch_layout_desc));
+
+    int ret = graph.addAudioBufferSinkFilter(FILTER_ABUFFER_SINK_NAME, sample_rate, AV_SAMPLE_FMT_FLTP, ch_layout_desc);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    ret = graph.parse("[" + FILTER_ABUFFER_SRC_NAME + "]aformat=sample_fmts=fltp:channel_layouts=" + ch_layout_desc + "[" + FILTER_ABUFFER_SINK_NAME + "]");
+    if ( ret < 0 ) {
+        return ret;
+    }
+    return graph.configure();
+}
+
+namespace {
+// 按段的顺序写出 packet; 正在写出的段直接写入封装器, 后面的段先缓存, 前面的段全部完成后依次写出;
+class PacketStitcher {
+public:
+    PacketStitcher(AudioMuxer& muxer, int nb_segments): muxer(muxer), segments(nb_segments) { }
+
+    ~PacketStitcher() {
+        for ( auto& segment : segments ) {
+            for ( AVPacket* pkt : segment.packets ) av_packet_free(&pkt);
+        }
+    }
+
+    int write(int index, AVPacket* _Nonnull pkt) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( error < 0 ) {
+            return error;
+        }
+
+        if ( index == next_index ) {
+            error = std::min(0, muxer.writePacket(pkt));
+            return error;
+        }
+
+        AVPacket* copy = av_packet_clone(pkt);
+        if ( copy == nullptr ) {
+            return error = AVERROR(ENOMEM);
+        }
+        segments[index].packets.push_back(copy);
+        return 0;
+    }
+
+    int finish(int index) {
+        std::lock_guard<std::mutex> lock(mtx);
+        segments[index].finished = true;
+        while ( error >= 0 && next_index < (int)segments.size() ) {
+            Segment& segment = segments[next_index];
+            for ( AVPacket*& pkt : segment.packets ) {
+                if ( error >= 0 ) error = std::min(0, muxer.writePacket(pkt));
+                av_packet_free(&pkt);
+            }
+            segment.packets.clear();
+            if ( !segment.finished ) {
+                break;
+            }
+            next_index += 1;
+        }
+        return error;
+    }
+
+    int getError() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return error;
+    }
+
+private:
+    struct Segment {
+        std::vector<AVPacket*> packets;
+        bool finished { false };
+    };
+
+    AudioMuxer& muxer;
+    std::vector<Segment> segments;
+    int next_index { 0 };
+    int error { 0 };
+    std::mutex mtx;
+};
+}
+
+BatchTranscoder::BatchTranscoder(int thread_count): thread_count(thread_count) {
+    if ( this->thread_count <= 0 ) {
+        this->thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+BatchTranscoder::~BatchTranscoder() = default;
+
+void BatchTranscoder::setProgressCallback(ProgressCallback callback) {
+    progress_callback = callback;
+}
+
+void BatchTranscoder::setDecoderOptions(const MediaDecoderOptions& options) {
+    decoder_options = options;
+}
+
+void BatchTranscoder::setSegmentCount(int segment_count) {
+    this->segment_count = segment_count;
+}
+
+BatchStats BatchTranscoder::run(const std::vector<BatchJob>& jobs) {
+    cancelled.store(false);
+
+    BatchStats stats;
+    stats.total = jobs.size();
+    if ( jobs.empty() ) {
+        return stats;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::atomic<size_t> next_index { 0 };
+    auto worker = [&]() {
+        size_t index;
+        while ( (index = next_index.fetch_add(1)) < jobs.size() ) {
+            if ( cancelled.load(std::memory_order_relaxed) ) {
+                break;
+            }
+
+            double duration = 0;
+            int ret = segment_count != 1 ? transcodeSegmented(jobs[index], decoder_options, segment_count, &cancelled, &duration)
+                                         : transcode(jobs[index], decoder_options, &cancelled, &duration);
+
+            std::lock_guard<std::mutex> lock(mtx);
+            stats.completed += 1;
+            if ( ret < 0 ) stats.failed += 1;
+            else stats.media_duration += duration;
+            stats.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            if ( progress_callback ) progress_callback(index, jobs[index], ret, stats);
+        }
+    };
+
+    int nb_threads = std::min(thread_count, (int)jobs.size());
+    std::vector<std::thread> threads;
+    threads.reserve(nb_threads - 1);
+    for ( int i = 1; i < nb_threads; ++i ) {
+        threads.emplace_back(worker);
+    }
+    worker(); // 当前线程也参与转码
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    stats.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return stats;
+}
+
+void BatchTranscoder::cancel() {
+    cancelled.store(true);
+}
+
+int BatchTranscoder::transcode(const BatchJob& job, const MediaDecoderOptions& decoder_options, const std::atomic<bool>* _Nullable cancelled, double* _Nullable out_duration) {
+    MediaReader reader;
+    int ret = reader.open(job.input, { }, AVMEDIA_TYPE_AUDIO);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVStream* stream = reader.getBestStream(AVMEDIA_TYPE_AUDIO);
+    if ( stream == nullptr ) {
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+
+    // 仅读取音频流
+    reader.selectStream(stream->index);
+
+    MediaDecoder decoder;
+    ret = decoder.init(stream->codecpar, decoder_options);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    int sample_rate = decoder.getSampleRate();
+    int nb_channels = decoder.getChannels();
+
+    FilterGraph graph;
+    ret = graph.init();
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVBufferSrcParameters* params = decoder.createBufferSrcParameters(stream->time_base);
+    if ( params == nullptr ) {
+        return AVERROR(ENOMEM);
+    }
+    ret = graph.addBufferSourceFilter(FILTER_ABUFFER_SRC_NAME, AVMEDIA_TYPE_AUDIO, params);
+    av_free(params);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    ret = configure_fltp_graph(graph, sample_rate, nb_channels);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    BufferSourceHandle buf_src = graph.getBufferSource(FILTER_ABUFFER_SRC_NAME);
+    BufferSinkHandle buf_sink = graph.getBufferSink(FILTER_ABUFFER_SINK_NAME);
+
+    AudioWriter writer;
+    ret = writer.init(job.output, AV_SAMPLE_FMT_FLTP, sample_rate, nb_channels);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    ret = writer.open();
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVPacket* pkt = PacketPool::shared().acquire();
+    AVFrame* dec_frame = FramePool::shared().acquire();
+    AVFrame* filt_frame = FramePool::shared().acquire();
+    int64_t nb_samples = 0;
+    bool eof = false;
+    // AudioWriter 的输入 time_base 为 1/sample_rate, 这里按写入的样本数生成连续的 pts
+    auto on_filtered = [&writer, &nb_samples](AVFrame* frame) {
+        frame->pts = nb_samples;
+        nb_samples += frame->nb_samples;
+        return writer.write(frame);
+    };
+
+    do {
+        if ( cancelled && cancelled->load(std::memory_order_relaxed) ) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+
+        ret = reader.readPacket(pkt);
+        if ( ret == AVERROR_EOF ) {
+            eof = true;
+            ret = AudioUtils::transcode(nullptr, &decoder, dec_frame, &graph, filt_frame, buf_src, buf_sink, on_filtered);
+        }
+        else if ( ret >= 0 ) {
+            if ( pkt->stream_index == stream->index ) {
+                ret = AudioUtils::transcode(pkt, &decoder, dec_frame, &graph, filt_frame, buf_src, buf_sink, on_filtered);
+            }
+            av_packet_unref(pkt);
+        }
+
+        if ( ret == AVERROR(EAGAIN) ) {
+            ret = 0;
+        }
+        // 解码出错的包直接跳过
+        else if ( ret == AVERROR_INVALIDDATA ) {
+            ret = 0;
+        }
+    } while ( ret >= 0 && !eof );
+
+    PacketPool::shared().release(pkt);
+    FramePool::shared().release(dec_frame);
+    FramePool::shared().release(filt_frame);
+
+    if ( ret < 0 && ret != AVERROR_EOF ) {
+        return ret;
+    }
+
+    ret = writer.close();
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    if ( out_duration ) *out_duration = (double)nb_samples / sample_rate;
+    return 0;
+}
+
+int BatchTranscoder::transcodeSegmented(const BatchJob& job, const MediaDecoderOptions& decoder_options, int segment_count, const std::atomic<bool>* _Nullable cancelled, double* _Nullable out_duration) {
+    SegmentedDecodeOptions options;
+    options.nb_segments = segment_count;
+    options.decoder_options = decoder_options;
+
+    SegmentPlan plan;
+    int ret = SegmentedDecoder::plan(job.input, options, plan);
+    if ( ret < 0 || plan.getSegmentCount() <= 1 ) {
+        return transcode(job, decoder_options, cancelled, out_duration);
+    }
+
+    int64_t duration = 0;
+    {
+        // 仅用于确定编码器参数及初始化封装器, 不参与编码; 各段的编码器参数与其一致
+        AudioWriter header;
+        ret = header.init(job.output, [](AVPacket*) { return 0; }, AV_SAMPLE_FMT_FLTP, plan.sample_rate, plan.nb_channels);
+        if ( ret < 0 ) {
+            return ret;
+        }
+
+        // 需要重采样时各段输出的帧网格无法对齐
+        if ( header.getSampleRate() != plan.sample_rate ) {
+            return transcode(job, decoder_options, cancelled, out_duration);
+        }
+
+        // 分段边界对齐到编码器的帧长, 各段编码出的 packet 与顺序编码时处于同一帧网格
+        int frame_size = header.getFrameSize();
+        for ( int64_t& boundary : plan.boundaries ) {
+            boundary = boundary / frame_size * frame_size;
+        }
+
+        // 重叠部分: encoder delay 及其前后各一帧, 使保留的第一个/最后一个 packet 编码时的输入与顺序编码时一致
+        int64_t padding = header.getCodecContext()->initial_padding;
+        int64_t overlap = ((padding + frame_size - 1) / frame_size + 2) * frame_size;
+
+        AudioMuxer muxer;
+        ret = muxer.init(job.output, header.getCodecContext());
+        if ( ret < 0 ) {
+            return ret;
+        }
+
+        ret = muxer.open();
+        if ( ret < 0 ) {
+            return ret;
+        }
+
+        ret = muxer.writeHeader();
+        if ( ret < 0 ) {
+            return ret;
+        }
+
+        int nb_segments = plan.getSegmentCount();
+        PacketStitcher stitcher(muxer, nb_segments);
+        std::vector<int64_t> segment_end(nb_segments, 0);
+        ret = SegmentedDecoder::run(nb_segments, [&](int i) -> int {
+            int64_t start = plan.getStart(i);
+            int64_t end = plan.getEnd(i);
+            // packet 的 pts 已减去 encoder delay; 首段保留开头的 priming, 末段保留 flush 出的全部 packet
+            int64_t keep_from = i == 0 ? INT64_MIN : start - padding;
+            int64_t keep_to = end >= 0 ? end - padding : INT64_MAX;
+
+            AudioWriter writer;
+            int ret = writer.init(job.output, [&stitcher, i, keep_from, keep_to](AVPacket* pkt) {
+                if ( pkt->pts < keep_from || pkt->pts >= keep_to ) {
+                    return 0;
+                }
+                // 各段的编码器只看到了自己的部分, 结束时更新的 extradata(例如 flac 的 STREAMINFO)不能写入
+                av_packet_shrink_side_data(pkt, AV_PKT_DATA_NEW_EXTRADATA, 0);
+                return stitcher.write(i, pkt);
+            }, AV_SAMPLE_FMT_FLTP, plan.sample_rate, plan.nb_channels);
+            if ( ret < 0 ) {
+                return ret;
+            }
+
+            // 解码参数以第一个 frame 为准, 收到后再创建 FilterGraph
+            FilterGraph graph;
+            BufferSourceHandle buf_src;
+            BufferSinkHandle buf_sink;
+            bool configured = false;
+            AVFrame* filt_frame = FramePool::shared().acquire();
+            auto drain = [&]() {
+                int ret;
+                while ( (ret = graph.getFrame(buf_sink, filt_frame)) >= 0 ) {
+                    ret = writer.write(filt_frame);
+                    av_frame_unref(filt_frame);
+                    if ( ret < 0 ) {
+                        return ret;
+                    }
+                }
+                return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+            };
+            auto on_frame = [&](AVFrame* frame) {
+                // 其他段出错时尽快结束
+                int ret = stitcher.getError();
+                if ( ret < 0 ) {
+                    return ret;
+                }
+
+                if ( !configured ) {
+                    char ch_layout_desc[64];
+                    av_channel_layout_describe(&frame->ch_layout, ch_layout_desc, sizeof(ch_layout_desc));
+                    ret = graph.init();
+                    if ( ret >= 0 ) ret = graph.addAudioBufferSourceFilter(FILTER_ABUFFER_SRC_NAME, (AVRational){ 1, frame->sample_rate }, frame->sample_rate, (AVSampleFormat)frame->format, ch_layout_desc);
+                    if ( ret >= 0 ) ret = configure_fltp_graph(graph, plan.sample_rate, plan.nb_channels);
+                    if ( ret < 0 ) {
+                        return ret;
+                    }
+                    buf_src = graph.getBufferSource(FILTER_ABUFFER_SRC_NAME);
+                    buf_sink = graph.getBufferSink(FILTER_ABUFFER_SINK_NAME);
+                    configured = true;
+                }
+
+                ret = graph.addFrame(buf_src, frame);
+                if ( ret < 0 ) {
+                    return ret;
+                }
+                return drain();
+            };
+
+            int64_t decode_start = std::max<int64_t>(0, start - overlap);
+            int64_t decode_end = end >= 0 ? end + overlap : -1;
+            ret = SegmentedDecoder::decode(job.input, options, decode_start, decode_end, on_frame, cancelled, &segment_end[i]);
+            if ( ret >= 0 && configured ) {
+                ret = graph.addFrame(buf_src, nullptr, AV_BUFFERSRC_FLAG_PUSH);
+                if ( ret >= 0 ) ret = drain();
+            }
+            FramePool::shared().release(filt_frame);
+            if ( ret < 0 ) {
+                return ret;
+            }
+
+            ret = writer.close();
+            if ( ret < 0 ) {
+                return ret;
+            }
+            return stitcher.finish(i);
+        });
+
+        if ( ret >= 0 ) {
+            ret = muxer.writeTrailer();
+        }
+        duration = segment_end.back();
+    }
+
+    // 分段失败(例如无法 seek 或缺少 pts)时退回顺序转码; 已写出的部分会被覆盖
+    if ( ret < 0 && ret != AVERROR_EXIT ) {
+        return transcode(job, decoder_options, cancelled, out_duration);
+    }
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    if ( out_duration ) *out_duration = (double)duration / plan.sample_rate;
+    return 0;
+}
+
+}
@@ -0,0 +1,101 @@
+//
+// Created on 2025/5/27.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_BATCHTRANSCODER_H
+#define FFMPEGPROJ_BATCHTRANSCODER_H
+
+#include "MediaDecoder.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FFAV {
+
+struct BatchJob {
+    std::string input;
+    std::string output; // 通过后缀推测封装格式与编码器, 例如 .m4a, .mp3, .flac, .wav
+};
+
+struct BatchStats {
+    size_t total { 0 };
+    size_t completed { 0 };          // 含失败
+    size_t failed { 0 };
+    double elapsed { 0 };            // 墙钟时间, 秒
+    double media_duration { 0 };     // 已转码的媒体时长, 秒
+
+    double getFilesPerSecond() const { return elapsed > 0 ? completed / elapsed : 0; }
+    double getRealtimeFactor() const { return elapsed > 0 ? media_duration / elapsed : 0; }
+};
+
+/**
+ * @class BatchTranscoder
+ * @brief 离线批量转码; 多个文件在线程池中并发处理;
+ *
+ * 每个任务使用独立的 MediaReader -> MediaDecoder -> FilterGraph -> AudioWriter 链, 逐包流式处理;
+ * 同一时刻最多只有 thread_count 条链存在, 内存占用与任务数量无关;
+ * 设置 segment_count 后单个长文件也会分段并发处理, 见 transcodeSegmented;
+ *
+ * 使用示例：
+ * ```
+ * BatchTranscoder transcoder(4);
+ * transcoder.setProgressCallback([](size_t index, const BatchJob& job, int ret, const BatchStats& stats) {
+ *     printf("%zu/%zu %s\n", stats.completed, stats.total, job.output.c_str());
+ * });
+ * BatchStats stats = transcoder.run({ { "a.flac", "a.m4a" }, { "b.wav", "b.mp3" } });
+ * ```
+ */
+class BatchTranscoder {
+public:
+    // 单个任务完成(成功或失败)后回调; 回调之间是串行的, 但发生在工作线程;
+    using ProgressCallback = std::function<void(size_t index, const BatchJob& job, int ret, const BatchStats& stats)>;
+
+    explicit BatchTranscoder(int thread_count = 0); // thread_count <= 0 时使用 CPU 核数
+    ~BatchTranscoder();
+
+    void setProgressCallback(ProgressCallback callback);
+    
+    // 解码器选项; 默认单线程解码, 并发已经由多个任务提供;
+    void setDecoderOptions(const MediaDecoderOptions& options);
+
+    // 同步执行全部任务, 返回最终的统计;
+    BatchStats run(const std::vector<BatchJob>& jobs);
+
+    // 单个文件的分段数; 默认 1 不分段; 大于 1 时长文件按时间分段并发解码/编码(0 表示使用 CPU 核数), 见 transcodeSegmented;
+    // 每个任务最多同时占用 segment_count 个线程, 处理少量长文件时建议同时减小 thread_count;
+    void setSegmentCount(int segment_count);
+
+    // 取消; 进行中的任务会尽快结束(返回 AVERROR_EXIT), 未开始的任务不再执行;
+    void cancel();
+
+    // 转码单个文件; out_duration 返回转码的媒体时长(秒); 返回值小于0表示报错;
+    static int transcode(const BatchJob& job, const MediaDecoderOptions& decoder_options, const std::atomic<bool>* _Nullable cancelled, double* _Nullable out_duration);
+
+    /**
+     * 分段转码单个文件; 由 SegmentedDecoder 按时间分段, 每段使用独立的 解码 -> FilterGraph -> 编码 链并发处理, 编码后的 packet 按顺序写入同一个封装器;
+     *
+     * 分段边界对齐到编码器的帧长, 各段的编码器在边界前后多编码一段重叠(encoder delay + 2 帧)后丢弃重叠部分的 packet,
+     * 使边界处的 packet 与顺序编码时处于同一帧网格且编码器状态已稳定;
+     * 后面的段先于前面的段完成时, 其 packet 缓存在内存中等待写出(编码后的数据, 远小于 PCM);
+     *
+     * 不可分段(时长未知/不可 seek/编码器需要重采样)或分段失败时退回 transcode;
+     */
+    static int transcodeSegmented(const BatchJob& job, const MediaDecoderOptions& decoder_options, int segment_count, const std::atomic<bool>* _Nullable cancelled, double* _Nullable out_duration);
+
+private:
+    int thread_count;
+    int segment_count { 1 };
+    ProgressCallback progress_callback;
+    MediaDecoderOptions decoder_options;
+    std::atomic<bool> cancelled { false };
+    std::mutex mtx;
+};
+
+}
+
+#endif //FFMPEGPROJ_BATCHTRANSCODER_H
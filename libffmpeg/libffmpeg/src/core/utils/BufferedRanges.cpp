@@ -0,0 +1,166 @@
+//
+// Created on 2025/6/11.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "BufferedRanges.h"
+#include "common.h"
+#include <algorithm>
+#include <cstdlib>
+
+EXTERN_C_START
+#include <libavutil/time.h>
+EXTERN_C_END
+
+namespace FFAV {
+
+// 将 [0, count) 按起点排序, 合并重叠或相接的范围, 返回合并后的数量
+static int merge_sorted(BufferedRanges::Range* _Nonnull ranges, int count) {
+    std::sort(ranges, ranges + count, [](const BufferedRanges::Range& a, const BufferedRanges::Range& b) {
+        return a.start < b.start;
+    });
+    int n = 0;
+    for ( int i = 0; i < count; ++i ) {
+        if ( n > 0 && ranges[i].start <= ranges[n - 1].end ) {
+            ranges[n - 1].end = std::max(ranges[n - 1].end, ranges[i].end);
+        }
+        else {
+            ranges[n++] = ranges[i];
+        }
+    }
+    return n;
+}
+
+BufferedRanges::BufferedRanges(int64_t min_interval, int64_t jump_threshold): min_interval(min_interval), jump_threshold(jump_threshold) {
+    for ( int i = 0; i < MAX_RANGES; ++i ) {
+        snapshot_starts[i].store(0, std::memory_order_relaxed);
+        snapshot_ends[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void BufferedRanges::setActive(int64_t start, int64_t end) {
+    active = end > start ? Range { start, end } : Range { 0, 0 };
+}
+
+void BufferedRanges::clearActive() {
+    active = { 0, 0 };
+}
+
+void BufferedRanges::add(int64_t start, int64_t end) {
+    if ( end <= start ) {
+        return;
+    }
+
+    // 预留一个位置给 active
+    Range ranges[MAX_RANGES + 1];
+    std::copy(extras, extras + nb_extras, ranges);
+    ranges[nb_extras] = { start, end };
+    int count = merge_sorted(ranges, nb_extras + 1);
+    while ( count > MAX_RANGES - 1 ) {
+        // 合并间隔最小的相邻两段
+        int index = 0;
+        for ( int i = 1; i + 1 < count; ++i ) {
+            if ( ranges[i + 1].start - ranges[i].end < ranges[index + 1].start - ranges[index].end ) index = i;
+        }
+        ranges[index].end = ranges[index + 1].end;
+        std::copy(ranges + index + 2, ranges + count, ranges + index + 1);
+        --count;
+    }
+    std::copy(ranges, ranges + count, extras);
+    nb_extras = count;
+}
+
+void BufferedRanges::clear() {
+    active = { 0, 0 };
+    nb_extras = 0;
+}
+
+int BufferedRanges::merge(Range* _Nonnull out) const {
+    std::copy(extras, extras + nb_extras, out);
+    int count = nb_extras;
+    if ( active.end > active.start ) {
+        out[count++] = active;
+    }
+    return merge_sorted(out, count);
+}
+
+bool BufferedRanges::isStructuralChange(int count) const {
+    if ( count != nb_published ) {
+        return true;
+    }
+    bool has_active = active.end > active.start;
+    bool had_active = published_active.end > published_active.start;
+    if ( has_active != had_active ) {
+        return true;
+    }
+    return has_active && std::llabs(active.start - published_active.start) >= jump_threshold;
+}
+
+bool BufferedRanges::publish(bool force) {
+    Range ranges[MAX_RANGES];
+    int count = merge(ranges);
+
+    bool changed = count != nb_published || active.start != published_active.start || active.end != published_active.end;
+    for ( int i = 0; !changed && i < count; ++i ) {
+        changed = ranges[i].start != published[i].start || ranges[i].end != published[i].end;
+    }
+    if ( !changed && !force ) {
+        return false;
+    }
+
+    int64_t now = av_gettime_relative();
+    if ( !force && !isStructuralChange(count) && now - last_publish_time < min_interval ) {
+        return false;
+    }
+
+    std::copy(ranges, ranges + count, published);
+    nb_published = count;
+    published_active = active;
+    last_publish_time = now;
+    writeSnapshot(ranges, count);
+    return true;
+}
+
+void BufferedRanges::writeSnapshot(const Range* _Nonnull ranges, int count) {
+    // 只有一个写入方
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    snapshot_active_start.store(active.start, std::memory_order_relaxed);
+    snapshot_active_end.store(active.end, std::memory_order_relaxed);
+    for ( int i = 0; i < count; ++i ) {
+        snapshot_starts[i].store(ranges[i].start, std::memory_order_relaxed);
+        snapshot_ends[i].store(ranges[i].end, std::memory_order_relaxed);
+    }
+    snapshot_count.store(count, std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+}
+
+bool BufferedRanges::getActive(Range& out) const {
+    uint32_t s;
+    do {
+        s = seq.load(std::memory_order_acquire);
+        out.start = snapshot_active_start.load(std::memory_order_relaxed);
+        out.end = snapshot_active_end.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ( (s & 1) || s != seq.load(std::memory_order_relaxed) );
+    return out.end > out.start;
+}
+
+int BufferedRanges::getRanges(Range* _Nonnull out, int capacity) const {
+    uint32_t s;
+    int count;
+    do {
+        s = seq.load(std::memory_order_acquire);
+        count = snapshot_count.load(std::memory_order_relaxed);
+        for ( int i = 0; i < std::min(count, capacity); ++i ) {
+            out[i].start = snapshot_starts[i].load(std::memory_order_relaxed);
+            out[i].end = snapshot_ends[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ( (s & 1) || s != seq.load(std::memory_order_relaxed) );
+    return count;
+}
+
+}
@@ -0,0 +1,94 @@
+//
+// Created on 2025/6/11.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_BUFFEREDRANGES_H
+#define FFMPEGPROJ_BUFFEREDRANGES_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace FFAV {
+
+/**
+ * @class BufferedRanges
+ * @brief 已缓冲的时间范围; 增量更新, 合并发布, 任意线程无锁读取快照;
+ *
+ * 范围以微秒(AV_TIME_BASE)为单位, 均为 [start, end);
+ * active 为正在读取的范围(从播放位置到已读取的末尾), 每读取一个 packet 更新一次;
+ * 其他已缓存的范围(例如磁盘缓存)通过 add 加入, 与 active 重叠或相接时合并;
+ *
+ * publish 与上次发布的快照比较, 只在有结构性变化(范围数量变化、起点跳变即 seek)时立即发布,
+ * 其余的变化(末尾增长、起点随播放推进)最多每 min_interval 发布一次;
+ * 写入方同一时刻只能有一个(由调用方加锁), 读取方通过序号(seqlock)判断读取到的快照是否完整;
+ *
+ * 使用示例:
+ * ```
+ * // 写入方
+ * ranges.setActive(start, end);
+ * if ( ranges.publish(eof) ) notify();
+ *
+ * // 任意线程
+ * BufferedRanges::Range active;
+ * if ( ranges.getActive(active) ) { ... }
+ * ```
+ */
+class BufferedRanges {
+public:
+    static constexpr int MAX_RANGES = 16;
+
+    struct Range {
+        int64_t start;
+        int64_t end;
+    };
+
+    /// min_interval: 非结构性变化的最小发布间隔, 微秒; jump_threshold: 起点变化超过该值时视为跳变, 微秒;
+    explicit BufferedRanges(int64_t min_interval = 100000, int64_t jump_threshold = 1000000);
+
+    void setActive(int64_t start, int64_t end);
+    void clearActive();
+
+    /// 加入其他已缓存的范围; 超出 MAX_RANGES 时与相邻最近的范围合并;
+    void add(int64_t start, int64_t end);
+    void clear();
+
+    /// 需要发布时更新快照并返回 true; force 为 true 时总是发布(例如 eof、seek 完成、缓冲已满);
+    bool publish(bool force = false);
+
+    /// 已发布的 active 范围; 没有时返回 false;
+    bool getActive(Range& out) const;
+
+    /// 已发布的全部范围(已合并, 按起点排序); 返回范围的数量, 最多写入 capacity 个;
+    int getRanges(Range* _Nonnull out, int capacity) const;
+
+private:
+    int64_t min_interval;
+    int64_t jump_threshold;
+
+    // 写入方的状态
+    Range active { 0, 0 };
+    Range extras[MAX_RANGES];
+    int nb_extras { 0 };
+    Range published_active { 0, 0 };
+    Range published[MAX_RANGES];
+    int nb_published { 0 };
+    int64_t last_publish_time { 0 };
+
+    // 快照; seq 为奇数时表示正在写入
+    std::atomic<uint32_t> seq { 0 };
+    std::atomic<int64_t> snapshot_active_start { 0 };
+    std::atomic<int64_t> snapshot_active_end { 0 };
+    std::atomic<int64_t> snapshot_starts[MAX_RANGES];
+    std::atomic<int64_t> snapshot_ends[MAX_RANGES];
+    std::atomic<int> snapshot_count { 0 };
+
+    int merge(Range* _Nonnull out) const;
+    bool isStructuralChange(int count) const;
+    void writeSnapshot(const Range* _Nonnull ranges, int count);
+};
+
+}
+
+#endif //FFMPEGPROJ_BUFFEREDRANGES_H
@@ -0,0 +1,99 @@
+//
+// Created on 2025/5/31.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "CommandChannel.h"
+#include <thread>
+
+namespace FFAV {
+
+uint32_t CommandChannel::beginWrite() {
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    while ( true ) {
+        if ( (s & 1) == 0 && seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed) ) {
+            break;
+        }
+        std::this_thread::yield();
+        s = seq.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return s;
+}
+
+void CommandChannel::endWrite(uint32_t s) {
+    seq.store(s + 2, std::memory_order_release);
+}
+
+uint64_t CommandChannel::seek(int64_t time, int index) {
+    uint32_t s = beginWrite();
+    seek_time.store(time, std::memory_order_relaxed);
+    if ( index != -1 ) {
+        stream_index.store(index, std::memory_order_relaxed);
+    }
+    uint64_t g = generation.load(std::memory_order_relaxed) + 1;
+    generation.store(g, std::memory_order_release);
+    endWrite(s);
+    return g;
+}
+
+uint64_t CommandChannel::stop() {
+    uint32_t s = beginWrite();
+    stopped.store(true, std::memory_order_relaxed);
+    uint64_t g = generation.load(std::memory_order_relaxed) + 1;
+    generation.store(g, std::memory_order_release);
+    endWrite(s);
+    return g;
+}
+
+CommandChannel::Command CommandChannel::read() const {
+    Command cmd;
+    uint32_t s1, s2;
+    do {
+        s1 = seq.load(std::memory_order_acquire);
+        if ( s1 & 1 ) {
+            std::this_thread::yield();
+            continue;
+        }
+        cmd.generation = generation.load(std::memory_order_relaxed);
+        cmd.seek_time = seek_time.load(std::memory_order_relaxed);
+        cmd.stream_index = stream_index.load(std::memory_order_relaxed);
+        cmd.stopped = stopped.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = seq.load(std::memory_order_relaxed);
+        if ( s1 == s2 ) {
+            break;
+        }
+    } while ( true );
+    return cmd;
+}
+
+uint64_t CommandChannel::getGeneration() const {
+    return generation.load(std::memory_order_acquire);
+}
+
+bool CommandChannel::isStopped() const {
+    return stopped.load(std::memory_order_acquire);
+}
+
+CommandChannel::Command CommandConsumer::next(const CommandChannel& channel, bool& is_new) {
+    CommandChannel::Command cmd = channel.read();
+    is_new = cmd.generation != consumed_generation;
+    if ( is_new ) {
+        consumed_generation = cmd.generation;
+    }
+    return cmd;
+}
+
+bool CommandConsumer::isOutdated(const CommandChannel& channel) const {
+    return channel.getGeneration() != consumed_generation;
+}
+
+bool CommandConsumer::deliver() {
+    bool should_flush = delivered_generation != consumed_generation;
+    delivered_generation = consumed_generation;
+    return should_flush;
+}
+
+}
@@ -0,0 +1,157 @@
+//
+// Created on 2025/5/31.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_COMMANDCHANNEL_H
+#define FFMPEGPROJ_COMMANDCHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+namespace FFAV {
+
+/**
+ * @class CommandChannel
+ * @brief 读取线程的控制命令(seek、切换音轨、停止)通道;
+ *
+ * 只保存最新的状态而不是命令队列: 连续多次 seek 时只有最后一次生效, 停止后不可恢复;
+ * 每次发送命令 generation 加 1; 消费者记录已处理的 generation, 读取到不同的值即表示有新命令;
+ * 产出的数据以处理命令时的 generation 标记(epoch), 下游比较 generation 即可丢弃过期的数据, 无需加锁;
+ *
+ * 发送方之间通过 seqlock 的写标记串行(仅自旋极短的时间), 读取方无锁, 读取过程中被写入时重试;
+ *
+ * 使用示例:
+ * ```
+ * // 控制线程
+ * uint64_t generation = channel.seek(time);
+ *
+ * // 读取线程
+ * CommandChannel::Command cmd = channel.read();
+ * if ( cmd.stopped ) return;
+ * if ( cmd.generation != consumed_generation ) {
+ *     consumed_generation = cmd.generation;
+ *     reader->seek(cmd.seek_time, -1);
+ * }
+ * ```
+ */
+class CommandChannel {
+public:
+    struct Command {
+        uint64_t generation { 0 };              // 0 表示还未发送过命令
+        int64_t seek_time { AV_NOPTS_VALUE };   // 最近一次 seek 的时间; 单位由调用方决定
+        int stream_index { -1 };                // 选择的流; -1 表示未指定
+        bool stopped { false };
+    };
+    
+    CommandChannel() = default;
+    CommandChannel(const CommandChannel&) = delete;
+    CommandChannel& operator=(const CommandChannel&) = delete;
+    
+    /// seek 到 time; stream_index 不为 -1 时同时切换流, 与 seek 原子地生效;
+    /// @return 该命令的 generation
+    uint64_t seek(int64_t time, int stream_index = -1);
+    
+    /// 停止; 之后的命令不再生效;
+    /// @return 该命令的 generation
+    uint64_t stop();
+    
+    /// 读取最新的状态;
+    Command read() const;
+    
+    /// 最新命令的 generation;
+    uint64_t getGeneration() const;
+    
+    bool isStopped() const;
+
+private:
+    std::atomic<uint32_t> seq { 0 };        // 奇数表示正在写入
+    std::atomic<uint64_t> generation { 0 };
+    std::atomic<int64_t> seek_time { AV_NOPTS_VALUE };
+    std::atomic<int> stream_index { -1 };
+    std::atomic<bool> stopped { false };
+    
+    uint32_t beginWrite();
+    void endWrite(uint32_t s);
+};
+
+/**
+ * @class CommandConsumer
+ * @brief 读取线程一侧的 generation 记录; 只在读取线程使用;
+ *
+ * consumed 为已处理的命令, delivered 为已回调过数据的命令; 两者不同时下一个数据需要 flush(该命令的第一个数据);
+ * 执行阻塞操作(seek、读取 packet)之后需要调用 isOutdated 重检, 期间有新的命令时丢弃本次的结果;
+ *
+ * 使用示例:
+ * ```
+ * bool is_new = false;
+ * CommandChannel::Command cmd = consumer.next(channel, is_new);
+ * if ( cmd.stopped ) return;
+ * if ( is_new ) reader->seek(cmd.seek_time, -1);
+ * if ( consumer.hasDelivered() && buffer_full ) return Wait;
+ * reader->readPacket(pkt);
+ * if ( consumer.isOutdated(channel) ) continue;
+ * bool should_flush = consumer.deliver();
+ * output(pkt, consumer.getGeneration(), should_flush);
+ * ```
+ */
+class CommandConsumer {
+public:
+    /// 读取最新的命令; 与已处理的 generation 不同时 is_new 为 true, 并记为已处理;
+    CommandChannel::Command next(const CommandChannel& channel, bool& is_new);
+
+    /// 处理当前命令之后又有新的命令(包括停止);
+    bool isOutdated(const CommandChannel& channel) const;
+
+    /// 当前命令已回调过数据; 为 false 时下一个数据(flush)不受缓冲限制, 下游需要它来清空旧的缓冲;
+    bool hasDelivered() const { return delivered_generation == consumed_generation; }
+
+    /// 回调数据之前调用; 返回是否需要 flush;
+    bool deliver();
+
+    /// 已处理的命令; 回调的数据以此标记;
+    uint64_t getGeneration() const { return consumed_generation; }
+
+private:
+    uint64_t consumed_generation { 0 };
+    uint64_t delivered_generation { 0 };
+};
+
+/**
+ * @class GenerationGate
+ * @brief 下游一侧的 generation 过滤; 丢弃过期的数据, 新的命令 flush 之前停止输出;
+ *
+ * requested 为最近一次发送的命令(seek/切换音轨), applied 为已 flush 的命令;
+ * 小于 requested 的数据为过期数据; applied < requested 时旧的缓冲还未清空, 不应输出;
+ * request 与 apply 由调用方加锁串行, isOutdated/isPending 可以在任意线程无锁调用(加锁后需要再检查一次);
+ */
+class GenerationGate {
+public:
+    /// 记录新发送的命令;
+    void request(uint64_t generation) { requested.store(generation, std::memory_order_release); }
+
+    /// 数据所属的命令已过期;
+    bool isOutdated(uint64_t generation) const { return generation < requested.load(std::memory_order_acquire); }
+
+    /// 按 generation 的命令 flush 之后调用;
+    void apply(uint64_t generation) { applied.store(generation, std::memory_order_release); }
+
+    /// 最近一次发送的命令;
+    uint64_t getRequested() const { return requested.load(std::memory_order_acquire); }
+
+    /// 最新的命令还未 flush(例如 seeking);
+    bool isPending() const { return applied.load(std::memory_order_acquire) < requested.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint64_t> requested { 0 };
+    std::atomic<uint64_t> applied { 0 };
+};
+
+}
+
+#endif //FFMPEGPROJ_COMMANDCHANNEL_H
@@ -6,6 +6,7 @@
 
 #include "FilterGraph.h"
 #include <sstream>
+#include <cstring>
 
 extern "C" {
 #include "libavutil/opt.h"
@@ -347,31 +348,92 @@ int FilterGraph::createAudioBufferSinkFilter(const std::string& name, const int
 }
 
 int FilterGraph::configure() {
-    return avfilter_graph_config(filter_graph, NULL);
+    int ret = avfilter_graph_config(filter_graph, NULL);
+    if ( ret < 0 ) {
+        return ret;
+    }
+    
+    // 缓存 source/sink, 之后每帧不再按名称查找
+    buffer_srcs.clear();
+    buffer_sinks.clear();
+    for ( unsigned int i = 0; i < filter_graph->nb_filters; ++i ) {
+        AVFilterContext* filter_ctx = filter_graph->filters[i];
+        if ( filter_ctx->name == nullptr ) {
+            continue;
+        }
+        
+        const char* filter_name = filter_ctx->filter->name;
+        if ( strcmp(filter_name, "abuffer") == 0 || strcmp(filter_name, "buffer") == 0 ) {
+            buffer_srcs[filter_ctx->name] = filter_ctx;
+        }
+        else if ( strcmp(filter_name, "abuffersink") == 0 || strcmp(filter_name, "buffersink") == 0 ) {
+            buffer_sinks[filter_ctx->name] = filter_ctx;
+        }
+    }
+    return 0;
+}
+
+BufferSourceHandle FilterGraph::getBufferSource(const std::string& name) const {
+    auto it = buffer_srcs.find(name);
+    return it != buffer_srcs.end() ? BufferSourceHandle { it->second } : BufferSourceHandle { };
+}
+
+BufferSinkHandle FilterGraph::getBufferSink(const std::string& name) const {
+    auto it = buffer_sinks.find(name);
+    return it != buffer_sinks.end() ? BufferSinkHandle { it->second } : BufferSinkHandle { };
 }
 
 int FilterGraph::addFrame(const std::string& src_name, AVFrame* _Nullable frame, int flags) {
-    AVFilterContext *buffer_ctx = avfilter_graph_get_filter(filter_graph, src_name.c_str());
-    if ( buffer_ctx == nullptr ) {
+    return addFrame(getBufferSource(src_name), frame, flags);
+}
+
+int FilterGraph::addFrame(BufferSourceHandle src, AVFrame* _Nullable frame, int flags) {
+    if ( src.filter_ctx == nullptr ) {
         return AVERROR_FILTER_NOT_FOUND;
     }
     
-    return av_buffersrc_add_frame_flags(buffer_ctx, frame, flags);
+    return av_buffersrc_add_frame_flags(src.filter_ctx, frame, flags);
 }
 
 int FilterGraph::getFrame(const std::string& sink_name, AVFrame* _Nonnull frame) {
-    AVFilterContext *buffersink_ctx = avfilter_graph_get_filter(filter_graph, sink_name.c_str());
-    if ( buffersink_ctx == nullptr ) {
+    return getFrame(getBufferSink(sink_name), frame);
+}
+
+int FilterGraph::getFrame(BufferSinkHandle sink, AVFrame* _Nonnull frame) {
+    if ( sink.filter_ctx == nullptr ) {
         return AVERROR_FILTER_NOT_FOUND;
     }
     
-    return av_buffersink_get_frame(buffersink_ctx, frame);
+    return av_buffersink_get_frame(sink.filter_ctx, frame);
 }
 
 int FilterGraph::sendCommand(const std::string& target_name, const std::string& cmd, const std::string& arg, int flags) {
     return avfilter_graph_send_command(filter_graph, target_name.c_str(), cmd.c_str(), arg.c_str(), nullptr, 0, flags);
 }
 
+int FilterGraph::sendCommand(AVFilterContext* _Nonnull filter_ctx, const std::string& cmd, const std::string& arg) {
+    return avfilter_process_command(filter_ctx, cmd.c_str(), arg.c_str(), nullptr, 0, 0);
+}
+
+std::vector<AVFilterContext*> FilterGraph::findFilters(const std::string& filter_name) {
+    std::vector<AVFilterContext*> filters;
+    if ( filter_graph == nullptr ) {
+        return filters;
+    }
+    
+    for ( unsigned int i = 0; i < filter_graph->nb_filters; ++i ) {
+        AVFilterContext* filter_ctx = filter_graph->filters[i];
+        if ( filter_name == filter_ctx->filter->name ) {
+            filters.push_back(filter_ctx);
+        }
+    }
+    return filters;
+}
+
+bool FilterGraph::isFilterAvailable(const std::string& filter_name) {
+    return avfilter_get_by_name(filter_name.c_str()) != nullptr;
+}
+
 void FilterGraph::release() {
     if ( outputs != nullptr ) {
         avfilter_inout_free(&outputs);
@@ -381,6 +443,9 @@ void FilterGraph::release() {
         avfilter_inout_free(&inputs);
     }
 
+    buffer_srcs.clear();
+    buffer_sinks.clear();
+    
     if ( filter_graph != nullptr ) {
         avfilter_graph_free(&filter_graph);
     }
@@ -10,6 +10,7 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 extern "C" {
 #include "libavfilter/avfilter.h"
@@ -22,6 +23,18 @@ extern "C" {
 }
 namespace FFAV {
 
+/// configure 之后解析出的 buffersrc 实例; 每帧直接使用, 避免按名称查找;
+struct BufferSourceHandle {
+    AVFilterContext* _Nullable filter_ctx { nullptr };
+    bool isValid() const { return filter_ctx != nullptr; }
+};
+
+/// configure 之后解析出的 buffersink 实例;
+struct BufferSinkHandle {
+    AVFilterContext* _Nullable filter_ctx { nullptr };
+    bool isValid() const { return filter_ctx != nullptr; }
+};
+
 class FilterGraph {
 public:
     FilterGraph();
@@ -50,7 +63,13 @@ public:
 
     int createAudioBufferSinkFilter(const std::string& name, const int sample_rate, const AVSampleFormat sample_fmt, const std::string& ch_layout_desc, AVFilterContext *_Nullable*_Nullable filter_ctx);
     
+    // 配置 graph; 成功后会缓存所有 buffersrc/buffersink 实例, 见 `getBufferSource`/`getBufferSink`;
     int configure();
+
+    // 按名称获取 configure 时缓存的 source/sink; 名称不存在时返回无效的 handle;
+    // 可以有多个 source/sink, 分别按名称获取;
+    BufferSourceHandle getBufferSource(const std::string& name) const;
+    BufferSinkHandle getBufferSink(const std::string& name) const;
     
     /**
      * av_buffersrc_add_frame_flags
@@ -70,6 +89,7 @@ public:
      *                    in case of failure
      */
     int addFrame(const std::string& src_name, AVFrame* _Nullable frame, int flags = AV_BUFFERSRC_FLAG_KEEP_REF);
+    int addFrame(BufferSourceHandle src, AVFrame* _Nullable frame, int flags = AV_BUFFERSRC_FLAG_KEEP_REF);
 
     /**
      * av_buffersink_get_frame
@@ -88,6 +108,7 @@ public:
      *         - A different negative AVERROR code in other failure cases.
      */
     int getFrame(const std::string& sink_name, AVFrame* _Nonnull frame);
+    int getFrame(BufferSinkHandle sink, AVFrame* _Nonnull frame);
 
     /**
      * Send a command to one or more filter instances.
@@ -106,6 +127,28 @@ public:
      */
     int sendCommand(const std::string& target_name, const std::string& cmd, const std::string& arg, int flags = AVFILTER_CMD_FLAG_ONE);
     
+    /**
+     * avfilter_process_command
+     *
+     * 直接向已解析出的 filter 实例发送命令, 避免按名称遍历 graph;
+     */
+    int sendCommand(AVFilterContext* _Nonnull filter_ctx, const std::string& cmd, const std::string& arg);
+    
+    /**
+     * 按 filter 类名(例如 "equalizer")查找 graph 中的实例;
+     *
+     * 返回顺序与 filter 的创建顺序(即 parse 时的描述顺序)一致; 需在 configure 之后调用;
+     */
+    std::vector<AVFilterContext*> findFilters(const std::string& filter_name);
+    
+    /**
+     * avfilter_get_by_name
+     *
+     * 当前链接的 libavfilter 是否包含该 filter; 裁剪编译的 libavfilter 只包含部分 filter,
+     * 可选的处理环节应先检查, 缺失时跳过而不是让 parse 失败;
+     */
+    static bool isFilterAvailable(const std::string& filter_name);
+    
 private:
     AVFilterGraph* _Nullable filter_graph = nullptr;
     AVFilterInOut* _Nullable outputs = nullptr;
@@ -118,6 +161,8 @@ private:
 
     const AVFilter* _Nullable abuffersink = nullptr;
     const AVFilter* _Nullable vbuffersink = nullptr;
+    std::unordered_map<std::string, AVFilterContext*> buffer_srcs; // configure 后缓存
+    std::unordered_map<std::string, AVFilterContext*> buffer_sinks;
     int addBufferSourceFilter(const std::string& name, AVFilterContext* _Nonnull buffer_ctx);
     int addBufferSinkFilter(const std::string& name, AVFilterContext* _Nonnull buffersink_ctx);
     void release();
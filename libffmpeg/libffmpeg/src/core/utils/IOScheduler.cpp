@@ -0,0 +1,129 @@
+//
+// Created on 2025/6/2.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "IOScheduler.h"
+#include <algorithm>
+
+namespace FFAV {
+
+IOTask::IOTask(IOScheduler& scheduler): scheduler(scheduler) { }
+
+void IOTask::post(Job job) {
+    std::lock_guard<std::mutex> lock(scheduler.mtx);
+    jobs.push_back(std::move(job));
+    if ( state == State::Idle ) {
+        scheduler.enqueue(shared_from_this());
+    }
+}
+
+void IOTask::wake() {
+    std::lock_guard<std::mutex> lock(scheduler.mtx);
+    switch ( state ) {
+        case State::Waiting:
+            scheduler.enqueue(shared_from_this());
+            break;
+        case State::Running:
+            wake_pending = true;
+            break;
+        case State::Idle:
+        case State::Queued:
+            break;
+    }
+}
+
+IOScheduler::IOScheduler(int nb_workers) {
+    if ( nb_workers <= 0 ) {
+        // 线程大多阻塞在 I/O 上, 数量可以多于 CPU 核心数
+        nb_workers = std::max(4u, std::thread::hardware_concurrency() * 2);
+    }
+    
+    workers.reserve(nb_workers);
+    for ( int i = 0; i < nb_workers; ++i ) {
+        workers.emplace_back(&IOScheduler::run, this);
+    }
+}
+
+IOScheduler::~IOScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopped = true;
+    }
+    cv.notify_all();
+    for ( auto& worker : workers ) {
+        worker.join();
+    }
+}
+
+IOScheduler& IOScheduler::shared() {
+    static IOScheduler* scheduler = new IOScheduler();
+    return *scheduler;
+}
+
+std::shared_ptr<IOTask> IOScheduler::createTask() {
+    return std::make_shared<IOTask>(*this);
+}
+
+int IOScheduler::getWorkerCount() const {
+    return (int)workers.size();
+}
+
+void IOScheduler::enqueue(const std::shared_ptr<IOTask>& task) {
+    task->state = IOTask::State::Queued;
+    ready_tasks.push_back(task);
+    cv.notify_one();
+}
+
+void IOScheduler::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while ( true ) {
+        cv.wait(lock, [this] { return stopped || !ready_tasks.empty(); });
+        if ( stopped ) {
+            break;
+        }
+        
+        std::shared_ptr<IOTask> task = std::move(ready_tasks.front());
+        ready_tasks.pop_front();
+        
+        task->state = IOTask::State::Running;
+        task->wake_pending = false;
+        IOTask::Job job = std::move(task->jobs.front());
+        task->jobs.pop_front();
+        
+        lock.unlock();
+        IOTask::Status status = job();
+        // 在锁外释放 job 捕获的对象
+        if ( status == IOTask::Status::Done ) {
+            job = nullptr;
+        }
+        lock.lock();
+        
+        switch ( status ) {
+            case IOTask::Status::Done:
+                if ( task->jobs.empty() ) {
+                    task->state = IOTask::State::Idle;
+                }
+                else {
+                    enqueue(task);
+                }
+                break;
+            case IOTask::Status::Yield:
+                task->jobs.push_front(std::move(job));
+                enqueue(task);
+                break;
+            case IOTask::Status::Wait:
+                task->jobs.push_front(std::move(job));
+                if ( task->wake_pending ) {
+                    enqueue(task);
+                }
+                else {
+                    task->state = IOTask::State::Waiting;
+                }
+                break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,119 @@
+//
+// Created on 2025/6/2.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_IOSCHEDULER_H
+#define FFMPEGPROJ_IOSCHEDULER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FFAV {
+
+class IOScheduler;
+
+/**
+ * @class IOTask
+ * @brief 在 IOScheduler 上串行执行的任务序列;
+ *
+ * 同一个 task 的 job 按 post 的顺序执行, 且任意时刻最多只在一个线程上运行;
+ * job 通过返回值告诉调度器下一步:
+ * - Done:  执行完毕, 继续执行下一个 job;
+ * - Yield: 还有工作, 让出线程后重新排队(排在其他 task 之后);
+ * - Wait:  暂时没有可做的工作(例如缓冲已满或 EOF), 挂起且不占用线程, 直到调用 wake;
+ *
+ * wake 可以在任意线程调用; job 运行期间调用的 wake 不会丢失, 返回 Wait 后会立即重新调度;
+ */
+class IOTask: public std::enable_shared_from_this<IOTask> {
+public:
+    enum class Status {
+        Done,
+        Yield,
+        Wait,
+    };
+    using Job = std::function<Status()>;
+    
+    explicit IOTask(IOScheduler& scheduler);
+    IOTask(const IOTask&) = delete;
+    IOTask& operator=(const IOTask&) = delete;
+    
+    void post(Job job);
+    void wake();
+
+private:
+    friend class IOScheduler;
+    enum class State {
+        Idle,       // 没有 job
+        Queued,     // 在调度器的就绪队列中
+        Running,
+        Waiting,    // 队首的 job 返回了 Wait
+    };
+    
+    IOScheduler& scheduler;
+    std::deque<Job> jobs; // 由 scheduler 的锁保护
+    State state { State::Idle };
+    bool wake_pending { false };
+};
+
+/**
+ * @class IOScheduler
+ * @brief 固定数量的 I/O 线程, 服务任意数量的 IOTask;
+ *
+ * 用于替代每个 reader 一个串行队列并在 EOF/缓冲已满时阻塞线程的方式:
+ * 挂起的 task 不占用线程, 线程数不随 reader 的数量增长;
+ * 注意 job 内部的阻塞 I/O(open/read)仍会占用线程, job 应在读取少量数据后返回 Yield 让出线程;
+ *
+ * FFCoreAudioReader 的读取循环目前按 job 的方式运行在这里, 没有使用 C++20 协程;
+ * 协程化的读取/解码流水线(可等待的读包与缓冲空间、seek/stop 的取消)尚未实现, 需要时应作为 IOTask 的 job 接入, 而不是另起一套线程;
+ *
+ * 使用示例:
+ * ```
+ * std::shared_ptr<IOTask> task = IOScheduler::shared().createTask();
+ * task->post([&] {
+ *     if ( buffer_full ) return IOTask::Status::Wait;
+ *     ...
+ *     return IOTask::Status::Yield;
+ * });
+ *
+ * // 缓冲有空间时
+ * task->wake();
+ * ```
+ */
+class IOScheduler {
+public:
+    /// nb_workers <= 0 时使用默认数量;
+    explicit IOScheduler(int nb_workers = 0);
+    /// 停止所有线程; 未执行的 job 直接丢弃;
+    ~IOScheduler();
+    IOScheduler(const IOScheduler&) = delete;
+    IOScheduler& operator=(const IOScheduler&) = delete;
+    
+    /// 共享的调度器; 不会被销毁(退出时可能仍有线程阻塞在网络 I/O 中);
+    static IOScheduler& shared();
+    
+    std::shared_ptr<IOTask> createTask();
+    
+    int getWorkerCount() const;
+
+private:
+    friend class IOTask;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<IOTask>> ready_tasks;
+    std::vector<std::thread> workers;
+    bool stopped { false };
+    
+    void enqueue(const std::shared_ptr<IOTask>& task); // 需要持有 mtx
+    void run();
+};
+
+}
+
+#endif //FFMPEGPROJ_IOSCHEDULER_H
@@ -0,0 +1,271 @@
+//
+// Created on 2025/5/26.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "LoudnessAnalyzer.h"
+#include "MediaReader.h"
+#include "MediaDecoder.h"
+#include "FilterGraph.h"
+#include "AudioUtils.h"
+#include "MediaObjectPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+extern "C" {
+#include <libavutil/dict.h>
+}
+
+namespace FFAV {
+
+static const std::string FILTER_ABUFFER_SRC_NAME = "in";
+static const std::string FILTER_ABUFFER_SINK_NAME = "out";
+
+double LoudnessResult::getGain(double target_lufs, double max_true_peak, double max_gain) const {
+    // 静音或所有块都被门限过滤时 ebur128 报告 -70 LUFS(没有测得的块), 不调整
+    if ( integrated <= -70.0 ) {
+        return 0;
+    }
+    double gain = std::min(target_lufs - integrated, max_gain);
+    // 提升增益后不能超过真峰值上限
+    return std::min(gain, max_true_peak - true_peak);
+}
+
+static void read_loudness_metadata(AVFrame* _Nonnull frame, LoudnessResult& result) {
+    AVDictionaryEntry* entry = av_dict_get(frame->metadata, "lavfi.r128.I", nullptr, 0);
+    if ( entry ) result.integrated = strtod(entry->value, nullptr);
+
+    entry = av_dict_get(frame->metadata, "lavfi.r128.LRA", nullptr, 0);
+    if ( entry ) result.loudness_range = strtod(entry->value, nullptr);
+
+    // lavfi.r128.true_peaks_ch0, lavfi.r128.true_peaks_ch1, ... (dBFS)
+    entry = nullptr;
+    while ( (entry = av_dict_get(frame->metadata, "lavfi.r128.true_peaks_ch", entry, AV_DICT_IGNORE_SUFFIX)) ) {
+        result.true_peak = std::max(result.true_peak, strtod(entry->value, nullptr));
+    }
+}
+
+LoudnessAnalyzer::LoudnessAnalyzer() = default;
+LoudnessAnalyzer::~LoudnessAnalyzer() = default;
+
+int LoudnessAnalyzer::analyze(const std::string& url, LoudnessResult& result) {
+    MediaReader reader;
+    int ret = reader.open(url, { }, AVMEDIA_TYPE_AUDIO);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVStream* stream = reader.getBestStream(AVMEDIA_TYPE_AUDIO);
+    if ( stream == nullptr ) {
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+
+    // 仅读取音频流
+    reader.selectStream(stream->index);
+
+    MediaDecoder decoder;
+    ret = decoder.init(stream->codecpar);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    // ebur128 直接接收解码后的数据, 不做重采样
+    FilterGraph graph;
+    ret = graph.init();
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVBufferSrcParameters* params = decoder.createBufferSrcParameters(stream->time_base);
+    if ( params == nullptr ) {
+        return AVERROR(ENOMEM);
+    }
+    char ch_layout_desc[64];
+    av_channel_layout_describe(&params->ch_layout, ch_layout_desc, sizeof(ch_layout_desc));
+    ret = graph.addBufferSourceFilter(FILTER_ABUFFER_SRC_NAME, AVMEDIA_TYPE_AUDIO, params);
+    av_free(params);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    ret = graph.addAudioBufferSinkFilter(FILTER_ABUFFER_SINK_NAME, decoder.getSampleRate(), AV_SAMPLE_FMT_DBL, ch_layout_desc);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    ret = graph.parse("[" + FILTER_ABUFFER_SRC_NAME + "]ebur128=peak=true:metadata=1[" + FILTER_ABUFFER_SINK_NAME + "]");
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    ret = graph.configure();
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    BufferSourceHandle buf_src = graph.getBufferSource(FILTER_ABUFFER_SRC_NAME);
+    BufferSinkHandle buf_sink = graph.getBufferSink(FILTER_ABUFFER_SINK_NAME);
+
+    AVPacket* pkt = PacketPool::shared().acquire();
+    AVFrame* dec_frame = FramePool::shared().acquire();
+    AVFrame* filt_frame = FramePool::shared().acquire();
+    LoudnessResult loudness;
+    bool eof = false;
+    auto on_filtered = [&loudness](AVFrame* frame) {
+        read_loudness_metadata(frame, loudness);
+        return 0;
+    };
+
+    do {
+        if ( interrupt_requested.load(std::memory_order_relaxed) ) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+
+        ret = reader.readPacket(pkt);
+        if ( ret == AVERROR_EOF ) {
+            eof = true;
+            ret = AudioUtils::transcode(nullptr, &decoder, dec_frame, &graph, filt_frame, buf_src, buf_sink, on_filtered);
+        }
+        else if ( ret >= 0 ) {
+            if ( pkt->stream_index == stream->index ) {
+                ret = AudioUtils::transcode(pkt, &decoder, dec_frame, &graph, filt_frame, buf_src, buf_sink, on_filtered);
+            }
+            av_packet_unref(pkt);
+        }
+
+        if ( ret == AVERROR(EAGAIN) ) {
+            ret = 0;
+        }
+        // 解码出错的包直接跳过
+        else if ( ret == AVERROR_INVALIDDATA ) {
+            ret = 0;
+        }
+    } while ( ret >= 0 && !eof );
+
+    PacketPool::shared().release(pkt);
+    FramePool::shared().release(dec_frame);
+    FramePool::shared().release(filt_frame);
+
+    if ( ret < 0 && ret != AVERROR_EOF ) {
+        return ret;
+    }
+
+    result = loudness;
+    return 0;
+}
+
+void LoudnessAnalyzer::interrupt() {
+    interrupt_requested.store(true);
+}
+
+void LoudnessAnalyzer::analyzeConcurrently(
+    const std::vector<std::string>& urls,
+    int thread_count,
+    ResultCallback callback,
+    const std::atomic<bool>* _Nullable cancelled
+) {
+    if ( urls.empty() ) {
+        return;
+    }
+
+    if ( thread_count <= 0 ) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, (int)urls.size());
+
+    std::atomic<size_t> next_index { 0 };
+    auto worker = [&]() {
+        LoudnessAnalyzer analyzer;
+        size_t index;
+        while ( (index = next_index.fetch_add(1)) < urls.size() ) {
+            if ( cancelled && cancelled->load(std::memory_order_relaxed) ) {
+                break;
+            }
+
+            LoudnessResult result;
+            int ret = analyzer.analyze(urls[index], result);
+            if ( callback ) callback(index, ret, result);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for ( int i = 1; i < thread_count; ++i ) {
+        threads.emplace_back(worker);
+    }
+    worker(); // 当前线程也参与分析
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+}
+
+LoudnessCache::LoudnessCache(const std::string& file_path): file_path(file_path) { }
+LoudnessCache::~LoudnessCache() = default;
+
+bool LoudnessCache::get(const std::string& key, LoudnessResult& result) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = results.find(key);
+    if ( it == results.end() ) {
+        return false;
+    }
+    result = it->second;
+    return true;
+}
+
+void LoudnessCache::put(const std::string& key, const LoudnessResult& result) {
+    std::lock_guard<std::mutex> lock(mtx);
+    results[key] = result;
+}
+
+int LoudnessCache::load() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if ( file_path.empty() ) {
+        return 0;
+    }
+
+    std::ifstream in(file_path);
+    if ( !in.is_open() ) {
+        return 0; // 首次使用时文件不存在
+    }
+
+    std::string line;
+    while ( std::getline(in, line) ) {
+        std::istringstream ls(line);
+        LoudnessResult result;
+        std::string key;
+        if ( (ls >> result.integrated >> result.loudness_range >> result.true_peak) && ls.get() == '\t' && std::getline(ls, key) && !key.empty() ) {
+            results[key] = result;
+        }
+    }
+    return 0;
+}
+
+int LoudnessCache::save() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if ( file_path.empty() ) {
+        return 0;
+    }
+
+    std::string tmp_path = file_path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::trunc);
+    if ( !out.is_open() ) {
+        return AVERROR(EIO);
+    }
+
+    for ( const auto& pair : results ) {
+        out << pair.second.integrated << '\t' << pair.second.loudness_range << '\t' << pair.second.true_peak << '\t' << pair.first << '\n';
+    }
+    out.close();
+    if ( out.fail() || rename(tmp_path.c_str(), file_path.c_str()) != 0 ) {
+        return AVERROR(EIO);
+    }
+    return 0;
+}
+
+}
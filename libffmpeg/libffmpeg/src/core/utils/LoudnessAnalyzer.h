@@ -0,0 +1,98 @@
+//
+// Created on 2025/5/26.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_LOUDNESSANALYZER_H
+#define FFMPEGPROJ_LOUDNESSANALYZER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FFAV {
+
+/// EBU R128 响度分析结果
+struct LoudnessResult {
+    double integrated { -70.0 };     // 综合响度, LUFS
+    double loudness_range { 0.0 };   // 响度范围, LU
+    double true_peak { -144.0 };     // 真峰值, dBTP
+
+    /// 播放时使用的静态增益(dB): 将综合响度调整到 target_lufs, 同时保证真峰值不超过 max_true_peak, 提升不超过 max_gain;
+    /// 静音(没有测得综合响度)时返回 0;
+    double getGain(double target_lufs = -16.0, double max_true_peak = -1.0, double max_gain = 12.0) const;
+};
+
+/**
+ * @class LoudnessAnalyzer
+ * @brief 基于 MediaReader/MediaDecoder/FilterGraph(ebur128) 的离线响度分析;
+ *
+ * 仅解码(不做重采样及格式转换), 一次遍历得到综合响度与真峰值;
+ * 多个文件之间可以并发分析, 见 `analyzeConcurrently`;
+ *
+ * 使用示例：
+ * ```
+ * LoudnessAnalyzer analyzer;
+ * LoudnessResult result;
+ * if ( analyzer.analyze("a.flac", result) >= 0 ) {
+ *     double gain = result.getGain();
+ * }
+ * ```
+ */
+class LoudnessAnalyzer {
+public:
+    using ResultCallback = std::function<void(size_t index, int ret, const LoudnessResult& result)>;
+
+    LoudnessAnalyzer();
+    ~LoudnessAnalyzer();
+
+    // 同步分析; 返回值小于0表示报错;
+    int analyze(const std::string& url, LoudnessResult& result);
+
+    // 中断正在进行的分析;
+    void interrupt();
+
+    /// 使用 thread_count 个线程并发分析多个文件(thread_count <= 0 时使用 CPU 核数);
+    /// 每个文件完成后在工作线程回调; 设置 cancelled 后未开始的文件不再分析;
+    static void analyzeConcurrently(
+        const std::vector<std::string>& urls,
+        int thread_count,
+        ResultCallback callback,
+        const std::atomic<bool>* _Nullable cancelled = nullptr
+    );
+
+private:
+    std::atomic<bool> interrupt_requested { false };
+};
+
+/**
+ * @class LoudnessCache
+ * @brief 响度分析结果的缓存, 可持久化到文件;
+ *
+ * 文件格式为逐行文本: `integrated \t loudness_range \t true_peak \t key`;
+ * 线程安全;
+ */
+class LoudnessCache {
+public:
+    explicit LoudnessCache(const std::string& file_path = "");
+    ~LoudnessCache();
+
+    bool get(const std::string& key, LoudnessResult& result);
+    void put(const std::string& key, const LoudnessResult& result);
+
+    int load();
+    int save();
+
+private:
+    std::string file_path;
+    std::map<std::string, LoudnessResult> results;
+    std::mutex mtx;
+};
+
+}
+
+#endif //FFMPEGPROJ_LOUDNESSANALYZER_H
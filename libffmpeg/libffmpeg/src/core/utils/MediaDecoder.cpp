@@ -5,6 +5,11 @@
 // please include "napi/native_api.h".
 
 #include "MediaDecoder.h"
+#include "AudioKernels.h"
+
+EXTERN_C_START
+#include <libavutil/opt.h>
+EXTERN_C_END
 
 namespace FFAV {
 
@@ -16,7 +21,7 @@ MediaDecoder::~MediaDecoder() {
     release();
 }
 
-int MediaDecoder::init(AVCodecParameters* _Nonnull codecpar) {
+int MediaDecoder::init(AVCodecParameters* _Nonnull codecpar, const MediaDecoderOptions& options) {
     // 获取解码器
     const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
     if ( codec == nullptr ) {
@@ -36,11 +41,58 @@ int MediaDecoder::init(AVCodecParameters* _Nonnull codecpar) {
         return error;
     }    
     
+    // 解码选项
+    dec_ctx->thread_count = options.thread_count;
+    dec_ctx->thread_type = options.thread_type;
+    dec_ctx->skip_frame = options.skip_frame;
+    dec_ctx->request_sample_fmt = options.request_sample_fmt;
+    
+    AVDictionary* opts = nullptr;
+    AVChannelLayout req_ch_layout { };
+    bool decoder_downmix = false;
+    if ( !options.downmix.empty() ) {
+        error = av_channel_layout_from_string(&req_ch_layout, options.downmix.c_str());
+        if ( error < 0 ) {
+            return error;
+        }
+        
+        // ac3/eac3/dca 等解码器支持在解码阶段直接下混, 省去先输出全部声道再转换
+        decoder_downmix = codec->priv_class != nullptr && av_opt_find((void *)&codec->priv_class, "downmix", nullptr, 0, AV_OPT_SEARCH_FAKE_OBJ) != nullptr;
+        if ( decoder_downmix ) {
+            av_dict_set(&opts, "downmix", options.downmix.c_str(), 0);
+        }
+    }
+    for ( auto& pair : options.private_options ) {
+        av_dict_set(&opts, pair.first.c_str(), pair.second.c_str(), 0);
+    }
+
     // 打开解码器
-    error = avcodec_open2(dec_ctx, codec, nullptr);
+    // 解码器不支持的选项会留在 opts 中, 直接忽略
+    error = avcodec_open2(dec_ctx, codec, &opts);
+    av_dict_free(&opts);
     if ( error < 0 ) {
+        av_channel_layout_uninit(&req_ch_layout);
         return error;
     }
+    
+    // 确定输出布局
+    // buffersrc 不接受中途变化的声道布局, 因此只有能保证每一帧都输出 req_ch_layout 时才声明下混;
+    // 解码器不一定能完成下混(例如 dca 没有内嵌下混系数时), float 格式下混为 stereo 时由 AudioKernels 兜底;
+    if ( req_ch_layout.nb_channels > 0 && dec_ctx->ch_layout.nb_channels > req_ch_layout.nb_channels ) {
+        AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+        bool is_float = dec_ctx->sample_fmt == AV_SAMPLE_FMT_FLTP || dec_ctx->sample_fmt == AV_SAMPLE_FMT_FLT;
+        bool can_fallback = is_float && av_channel_layout_compare(&req_ch_layout, &stereo) == 0;
+        if ( decoder_downmix || can_fallback ) {
+            decoded_frame = av_frame_alloc();
+            if ( decoded_frame == nullptr ) {
+                av_channel_layout_uninit(&req_ch_layout);
+                return AVERROR(ENOMEM);
+            }
+            av_channel_layout_copy(&out_ch_layout, &req_ch_layout);
+            downmix_fallback = can_fallback;
+        }
+    }
+    av_channel_layout_uninit(&req_ch_layout);
     return 0;
 }
 
@@ -57,7 +109,89 @@ int MediaDecoder::receive(AVFrame* _Nonnull frame) {
         return AVERROR_INVALIDDATA;
     }
     
-    return avcodec_receive_frame(dec_ctx, frame);
+    if ( out_ch_layout.nb_channels == 0 ) {
+        return avcodec_receive_frame(dec_ctx, frame);
+    }
+    
+    int ret = avcodec_receive_frame(dec_ctx, decoded_frame);
+    if ( ret < 0 ) {
+        return ret;
+    }
+    
+    // 解码器已完成下混
+    if ( decoded_frame->ch_layout.nb_channels == out_ch_layout.nb_channels ) {
+        av_frame_move_ref(frame, decoded_frame);
+        return 0;
+    }
+    
+    ret = downmix_fallback ? downmix(decoded_frame, frame) : AVERROR_INPUT_CHANGED;
+    av_frame_unref(decoded_frame);
+    return ret;
+}
+
+int MediaDecoder::downmix(AVFrame* _Nonnull in, AVFrame* _Nonnull out) {
+    if ( in->format != AV_SAMPLE_FMT_FLTP && in->format != AV_SAMPLE_FMT_FLT ) {
+        return AVERROR_INPUT_CHANGED;
+    }
+    
+    // 输入布局变化时重新生成下混矩阵
+    if ( av_channel_layout_compare(&matrix_ch_layout, &in->ch_layout) != 0 ) {
+        av_channel_layout_uninit(&matrix_ch_layout);
+        av_channel_layout_copy(&matrix_ch_layout, &in->ch_layout);
+        if ( in->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC ) {
+            AVChannelLayout layout { };
+            av_channel_layout_default(&layout, in->ch_layout.nb_channels);
+            AudioKernels::makeStereoDownmixMatrix(&layout, downmix_matrix);
+            av_channel_layout_uninit(&layout);
+        }
+        else {
+            AudioKernels::makeStereoDownmixMatrix(&in->ch_layout, downmix_matrix);
+        }
+    }
+    
+    // 输出缓冲从 pool 中复用, 稳态下不产生额外的内存分配
+    int size = in->nb_samples * 2 * (int)sizeof(float);
+    if ( downmix_pool == nullptr || size > downmix_pool_size ) {
+        av_buffer_pool_uninit(&downmix_pool);
+        downmix_pool = av_buffer_pool_init(size, nullptr);
+        if ( downmix_pool == nullptr ) {
+            return AVERROR(ENOMEM);
+        }
+        downmix_pool_size = size;
+    }
+    
+    AVBufferRef* buf = av_buffer_pool_get(downmix_pool);
+    if ( buf == nullptr ) {
+        return AVERROR(ENOMEM);
+    }
+    
+    int ret = av_frame_copy_props(out, in);
+    if ( ret < 0 ) {
+        av_buffer_unref(&buf);
+        return ret;
+    }
+    
+    out->buf[0] = buf;
+    out->format = in->format;
+    out->sample_rate = in->sample_rate;
+    out->nb_samples = in->nb_samples;
+    av_channel_layout_copy(&out->ch_layout, &out_ch_layout);
+    
+    if ( in->format == AV_SAMPLE_FMT_FLTP ) {
+        float* out_l = (float *)buf->data;
+        float* out_r = out_l + in->nb_samples;
+        out->data[0] = (uint8_t *)out_l;
+        out->data[1] = (uint8_t *)out_r;
+        out->linesize[0] = in->nb_samples * (int)sizeof(float);
+        AudioKernels::downmixToStereoPlanar((const float **)in->extended_data, in->ch_layout.nb_channels, downmix_matrix.data(), out_l, out_r, in->nb_samples);
+    }
+    else {
+        out->data[0] = buf->data;
+        out->linesize[0] = size;
+        AudioKernels::downmixToStereoInterleaved((const float *)in->data[0], in->ch_layout.nb_channels, downmix_matrix.data(), (float *)buf->data, in->nb_samples);
+    }
+    out->extended_data = out->data;
+    return 0;
 }
 
 void MediaDecoder::flush() {
@@ -89,7 +223,7 @@ AVBufferSrcParameters* _Nullable MediaDecoder::createBufferSrcParameters(AVRatio
             params->time_base = time_base;
             params->sample_rate = dec_ctx->sample_rate;
             params->format = dec_ctx->sample_fmt;
-            params->ch_layout = dec_ctx->ch_layout;
+            params->ch_layout = out_ch_layout.nb_channels > 0 ? out_ch_layout : dec_ctx->ch_layout;
             return params;
         }
         case AVMEDIA_TYPE_UNKNOWN:
@@ -110,13 +244,21 @@ int MediaDecoder::getSampleRate() {
 }
 
 int MediaDecoder::getChannels() {
-    return dec_ctx->ch_layout.nb_channels;
+    return out_ch_layout.nb_channels > 0 ? out_ch_layout.nb_channels : dec_ctx->ch_layout.nb_channels;
 }
 
 void MediaDecoder::release() {
     if ( dec_ctx != nullptr ) {
         avcodec_free_context(&dec_ctx);
     }
+    
+    if ( decoded_frame != nullptr ) {
+        av_frame_free(&decoded_frame);
+    }
+    
+    av_buffer_pool_uninit(&downmix_pool);
+    av_channel_layout_uninit(&out_ch_layout);
+    av_channel_layout_uninit(&matrix_ch_layout);
 }
 
 }
@@ -15,17 +15,32 @@ EXTERN_C_START
 #include <libavutil/frame.h>
 #include <libavfilter/buffersrc.h>
 #include <libavutil/rational.h>
+#include <libavutil/buffer.h>
 EXTERN_C_END
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace FFAV {
 
+/** 解码器选项; 默认值与 avcodec 的默认行为一致 */
+struct MediaDecoderOptions {
+    int thread_count { 1 };                                     // 0 表示由 avcodec 根据 CPU 核数决定
+    int thread_type { FF_THREAD_FRAME | FF_THREAD_SLICE };      // 仅对支持多线程的解码器(如 flac, alac)生效
+    AVDiscard skip_frame { AVDISCARD_DEFAULT };
+    AVSampleFormat request_sample_fmt { AV_SAMPLE_FMT_NONE };   // 解码器支持时直接输出该格式
+    std::string downmix;                                        // 请求的输出声道布局, 例如 "stereo"; 优先由解码器完成(ac3, eac3, dca), 不支持时 float 格式下混为 stereo 由 AudioKernels 完成
+    std::map<std::string, std::string> private_options;         // 解码器私有选项, 例如 { "drc_scale", "0" }
+};
+
 /** 用于解码 */
 class MediaDecoder {
 public:
     MediaDecoder();
     ~MediaDecoder();
 
-    int init(AVCodecParameters* _Nonnull codecpar);
+    int init(AVCodecParameters* _Nonnull codecpar, const MediaDecoderOptions& options = { });
 
     int send(AVPacket* _Nullable pkt);
     
@@ -38,10 +53,21 @@ public:
 
     AVSampleFormat getSampleFormat();
     int getSampleRate();
-    int getChannels();
+    int getChannels();  // 输出的声道数; 请求下混时为下混后的声道数
     
 private:
     AVCodecContext* _Nullable dec_ctx;      // AVCodecContext 用于解码
+    
+    // 下混; out_ch_layout.nb_channels == 0 表示未请求或无法下混, 输出与解码器一致
+    AVChannelLayout out_ch_layout { };
+    bool downmix_fallback { false };        // 解码器未完成下混时, 由 AudioKernels 下混
+    AVChannelLayout matrix_ch_layout { };   // downmix_matrix 对应的输入布局
+    std::vector<float> downmix_matrix;
+    AVFrame* _Nullable decoded_frame { nullptr };
+    AVBufferPool* _Nullable downmix_pool { nullptr };
+    int downmix_pool_size { 0 };
+    
+    int downmix(AVFrame* _Nonnull in, AVFrame* _Nonnull out);
 
     // 关闭媒体文件
     void release();
@@ -0,0 +1,127 @@
+//
+// Created on 2025/5/28.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "MediaObjectPool.h"
+
+namespace FFAV {
+
+PacketPool::PacketPool(size_t max_idle_count): max_idle_count(max_idle_count) { }
+
+PacketPool::~PacketPool() {
+    for ( AVPacket* pkt : idle ) {
+        av_packet_free(&pkt);
+    }
+}
+
+PacketPool& PacketPool::shared() {
+    static PacketPool pool;
+    return pool;
+}
+
+AVPacket* _Nullable PacketPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( !idle.empty() ) {
+            AVPacket* pkt = idle.back();
+            idle.pop_back();
+            reused_count.fetch_add(1, std::memory_order_relaxed);
+            return pkt;
+        }
+    }
+    
+    AVPacket* pkt = av_packet_alloc();
+    if ( pkt ) allocated_count.fetch_add(1, std::memory_order_relaxed);
+    return pkt;
+}
+
+void PacketPool::release(AVPacket* _Nullable pkt) {
+    if ( pkt == nullptr ) {
+        return;
+    }
+    
+    av_packet_unref(pkt);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( idle.size() < max_idle_count ) {
+            idle.push_back(pkt);
+            return;
+        }
+    }
+    av_packet_free(&pkt);
+}
+
+uint64_t PacketPool::getAllocatedCount() const {
+    return allocated_count.load(std::memory_order_relaxed);
+}
+
+uint64_t PacketPool::getReusedCount() const {
+    return reused_count.load(std::memory_order_relaxed);
+}
+
+size_t PacketPool::getIdleCount() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return idle.size();
+}
+
+FramePool::FramePool(size_t max_idle_count): max_idle_count(max_idle_count) { }
+
+FramePool::~FramePool() {
+    for ( AVFrame* frame : idle ) {
+        av_frame_free(&frame);
+    }
+}
+
+FramePool& FramePool::shared() {
+    static FramePool pool;
+    return pool;
+}
+
+AVFrame* _Nullable FramePool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( !idle.empty() ) {
+            AVFrame* frame = idle.back();
+            idle.pop_back();
+            reused_count.fetch_add(1, std::memory_order_relaxed);
+            return frame;
+        }
+    }
+    
+    AVFrame* frame = av_frame_alloc();
+    if ( frame ) allocated_count.fetch_add(1, std::memory_order_relaxed);
+    return frame;
+}
+
+void FramePool::release(AVFrame* _Nullable frame) {
+    if ( frame == nullptr ) {
+        return;
+    }
+    
+    av_frame_unref(frame);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( idle.size() < max_idle_count ) {
+            idle.push_back(frame);
+            return;
+        }
+    }
+    av_frame_free(&frame);
+}
+
+uint64_t FramePool::getAllocatedCount() const {
+    return allocated_count.load(std::memory_order_relaxed);
+}
+
+uint64_t FramePool::getReusedCount() const {
+    return reused_count.load(std::memory_order_relaxed);
+}
+
+size_t FramePool::getIdleCount() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return idle.size();
+}
+
+}
@@ -0,0 +1,88 @@
+//
+// Created on 2025/5/28.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_MEDIAOBJECTPOOL_H
+#define FFMPEGPROJ_MEDIAOBJECTPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/packet.h>
+#include <libavutil/frame.h>
+}
+
+namespace FFAV {
+
+/**
+ * @class PacketPool
+ * @brief AVPacket 结构体的对象池; 回收的 packet 已 unref, 仅复用结构体本身;
+ *
+ * 数据缓冲由 packet 的引用计数管理(move 而非 ref), 池只负责避免 av_packet_alloc/av_packet_free;
+ * 线程安全; 空闲对象的数量有上限, 超出时直接释放;
+ *
+ * 使用示例：
+ * ```
+ * AVPacket* pkt = PacketPool::shared().acquire();
+ * av_packet_move_ref(pkt, src);
+ * ...
+ * PacketPool::shared().release(pkt);
+ * ```
+ */
+class PacketPool {
+public:
+    explicit PacketPool(size_t max_idle_count = 1024);
+    ~PacketPool();
+
+    static PacketPool& shared();
+
+    AVPacket* _Nullable acquire();
+    void release(AVPacket* _Nullable pkt);
+
+    // 统计; 稳态下 allocated 不再增长;
+    uint64_t getAllocatedCount() const;
+    uint64_t getReusedCount() const;
+    size_t getIdleCount();
+
+private:
+    std::mutex mtx;
+    std::vector<AVPacket*> idle;
+    size_t max_idle_count;
+    std::atomic<uint64_t> allocated_count { 0 };
+    std::atomic<uint64_t> reused_count { 0 };
+};
+
+/**
+ * @class FramePool
+ * @brief AVFrame 结构体的对象池; 与 PacketPool 相同, 回收时 unref, 仅复用结构体本身;
+ */
+class FramePool {
+public:
+    explicit FramePool(size_t max_idle_count = 64);
+    ~FramePool();
+
+    static FramePool& shared();
+
+    AVFrame* _Nullable acquire();
+    void release(AVFrame* _Nullable frame);
+
+    uint64_t getAllocatedCount() const;
+    uint64_t getReusedCount() const;
+    size_t getIdleCount();
+
+private:
+    std::mutex mtx;
+    std::vector<AVFrame*> idle;
+    size_t max_idle_count;
+    std::atomic<uint64_t> allocated_count { 0 };
+    std::atomic<uint64_t> reused_count { 0 };
+};
+
+}
+
+#endif //FFMPEGPROJ_MEDIAOBJECTPOOL_H
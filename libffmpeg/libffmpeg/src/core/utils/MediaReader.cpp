@@ -18,7 +18,7 @@ MediaReader::MediaReader() = default;
 
 MediaReader::~MediaReader() { release(); }
 
-int MediaReader::open(const std::string& url, const std::map<std::string, std::string>& http_options) {
+int MediaReader::open(const std::string& url, const std::map<std::string, std::string>& http_options, AVMediaType media_type) {
     fmt_ctx = avformat_alloc_context();
     if ( fmt_ctx == nullptr ) {
         return AVERROR(ENOMEM);
@@ -42,22 +42,22 @@ int MediaReader::open(const std::string& url, const std::map<std::string, std::s
         return AVERROR_EXIT;
     }
 
+    // 在 find_stream_info 之前丢弃不需要的流;
+    // 视频流没有可用的解码器, 不丢弃时 find_stream_info 会一直读取到 analyzeduration/probesize 的上限;
+    if ( media_type != AVMEDIA_TYPE_UNKNOWN ) {
+        for ( unsigned int i = 0; i < fmt_ctx->nb_streams; ++i ) {
+            AVStream* stream = fmt_ctx->streams[i];
+            bool attached_pic = (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) != 0;
+            if ( stream->codecpar->codec_type != media_type || attached_pic ) {
+                stream->discard = AVDISCARD_ALL;
+            }
+        }
+    }
+
     ret = avformat_find_stream_info(fmt_ctx, nullptr);
     if ( ret < 0 ) {
         return  ret;
     }
-    
-    // 遍历流
-    for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i) {
-        AVStream *stream = fmt_ctx->streams[i];
-        AVCodecParameters *codecpar = stream->codecpar;
-        if (codecpar == NULL) {
-            printf("stream %d: codecpar is NULL ❌\n", i);
-        } else {
-            printf("stream %d: codec type = %d ✅\n", i, codecpar->codec_type);
-        }
-    }
-    
     return 0;
 }
 
@@ -97,6 +97,36 @@ int MediaReader::findBestStream(AVMediaType type) {
     return av_find_best_stream(fmt_ctx, type, -1, -1, nullptr, 0);
 }
 
+std::vector<int> MediaReader::findStreams(AVMediaType type) {
+    std::vector<int> indices;
+    if ( fmt_ctx == nullptr ) {
+        return indices;
+    }
+    
+    for ( unsigned int i = 0; i < fmt_ctx->nb_streams; ++i ) {
+        AVCodecParameters* codecpar = fmt_ctx->streams[i]->codecpar;
+        if ( codecpar != nullptr && codecpar->codec_type == type ) {
+            indices.push_back(i);
+        }
+    }
+    return indices;
+}
+
+int MediaReader::selectStream(int stream_index) {
+    if ( fmt_ctx == nullptr ) {
+        throw std::runtime_error("AVFormatContext is not initialized");
+    }
+    
+    if ( stream_index < 0 || (unsigned int)stream_index >= fmt_ctx->nb_streams ) {
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+    
+    for ( unsigned int i = 0; i < fmt_ctx->nb_streams; ++i ) {
+        fmt_ctx->streams[i]->discard = i == (unsigned int)stream_index ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+    return 0;
+}
+
 int MediaReader::readPacket(AVPacket* _Nonnull pkt) {
     if ( fmt_ctx == nullptr ) {
         throw std::runtime_error("AVFormatContext is not initialized");
@@ -9,6 +9,8 @@
 
 #include <string>
 #include <map>
+#include <atomic>
+#include <vector>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -26,8 +28,13 @@ public:
     MediaReader();
     ~MediaReader();
 
-    // 打开媒体文件
-    int open(const std::string& url, const std::map<std::string, std::string>& http_options = {});
+    /* 打开媒体文件
+     *
+     * @param media_type 不为 AVMEDIA_TYPE_UNKNOWN 时, 其他类型的流及封面(attached pic)在 avformat_find_stream_info 之前
+     *                   即设置为 AVDISCARD_ALL; 对带视频的容器(mp4/mov), demuxer 不再读取和分配这些流的数据,
+     *                   find_stream_info 也只需分析音频; 之后可以通过 selectStream 进一步选择;
+    */
+    int open(const std::string& url, const std::map<std::string, std::string>& http_options = {}, AVMediaType media_type = AVMEDIA_TYPE_UNKNOWN);
     
     // 获取流的数量
     unsigned int getStreamCount();
@@ -46,6 +53,18 @@ public:
     */
     int findBestStream(AVMediaType type);
     
+    // 获取指定类型的所有流的索引
+    std::vector<int> findStreams(AVMediaType type);
+    
+    /* 仅读取指定的流
+     *
+     * 其他流设置为 AVDISCARD_ALL, demuxer 不再为其读取和解析数据, readPacket 也不会再返回这些流的 packet;
+     * 可在读取过程中调用, 用于切换音轨;
+     *
+     * @return 0 表示成功, 流不存在时返回 AVERROR_STREAM_NOT_FOUND;
+    */
+    int selectStream(int stream_index);
+    
     // 读取下一帧
     int readPacket(AVPacket* _Nonnull pkt);
 
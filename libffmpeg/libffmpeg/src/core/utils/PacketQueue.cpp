@@ -5,6 +5,7 @@
 // please include "napi/native_api.h".
 
 #include "PacketQueue.h"
+#include "MediaObjectPool.h"
 #include <stdint.h>
 
 namespace FFAV {
@@ -16,7 +17,7 @@ PacketQueue::~PacketQueue() {
 }
 
 void PacketQueue::push(AVPacket* _Nonnull packet) {
-    AVPacket* pkt = av_packet_alloc();
+    AVPacket* pkt = PacketPool::shared().acquire();
     av_packet_ref(pkt, packet);
     
     queue.push(pkt);
@@ -24,6 +25,15 @@ void PacketQueue::push(AVPacket* _Nonnull packet) {
     last_push_pts = pkt->pts;
 }
 
+void PacketQueue::pushMoveRef(AVPacket* _Nonnull packet) {
+    AVPacket* pkt = PacketPool::shared().acquire();
+    av_packet_move_ref(pkt, packet);
+    
+    queue.push(pkt);
+    total_size += pkt->size;
+    last_push_pts = pkt->pts;
+}
+
 bool PacketQueue::pop(AVPacket* _Nonnull packet) {
     if ( queue.empty() ) {
         return false;
@@ -35,7 +45,7 @@ bool PacketQueue::pop(AVPacket* _Nonnull packet) {
     last_pop_pts = pkt->pts;
     
     av_packet_move_ref(packet, pkt);
-    av_packet_free(&pkt);
+    PacketPool::shared().release(pkt);
     return true;
 }
 
@@ -43,7 +53,7 @@ void PacketQueue::clear() {
     while(!queue.empty()) {
         AVPacket* pkt = queue.front();
         queue.pop();
-        av_packet_free(&pkt);
+        PacketPool::shared().release(pkt);
     }
     total_size = 0;
     last_push_pts = AV_NOPTS_VALUE;
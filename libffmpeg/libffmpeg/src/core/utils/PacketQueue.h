@@ -22,8 +22,9 @@ public:
     PacketQueue();
     ~PacketQueue();
     
-    void push(AVPacket* _Nonnull packet);
-    bool pop(AVPacket* _Nonnull packet);
+    void push(AVPacket* _Nonnull packet); // 增加引用
+    void pushMoveRef(AVPacket* _Nonnull packet); // 转移引用, 调用后 packet 被重置; 不会分配新的缓冲引用
+    bool pop(AVPacket* _Nonnull packet); // 转移引用到 packet
     void clear();
     
     int64_t getLastPushPts();
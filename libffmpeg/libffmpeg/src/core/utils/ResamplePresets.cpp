@@ -0,0 +1,25 @@
+//
+// Created on 2025/5/30.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "ResamplePresets.h"
+
+namespace FFAV {
+
+std::string ResamplePresets::getOptions(ResampleQuality quality) {
+    switch ( quality ) {
+        case ResampleQuality::Balanced:
+            // filter_size=32, phase_shift=10, linear_interp=1, cutoff=0.97
+            return "";
+        case ResampleQuality::Low:
+            // 滤波器变短后过渡带变宽, 适当降低截止频率以抑制混叠
+            return ":filter_size=8:phase_shift=6:cutoff=0.91";
+        case ResampleQuality::High:
+            return ":filter_size=64:phase_shift=12:cutoff=0.985:kaiser_beta=12";
+    }
+    return "";
+}
+
+}
@@ -0,0 +1,41 @@
+//
+// Created on 2025/5/30.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_RESAMPLEPRESETS_H
+#define FFMPEGPROJ_RESAMPLEPRESETS_H
+
+#include <string>
+
+namespace FFAV {
+
+enum class ResampleQuality {
+    Balanced,   // swr 默认参数
+    Low,        // 短滤波器, 延迟与 CPU 占用更低, 适合低端设备或仅预览
+    High,       // 长滤波器, 通带更平坦、阻带衰减更高
+};
+
+/**
+ * @class ResamplePresets
+ * @brief aresample(swr) 的质量预设;
+ *
+ * 输入与输出采样率一致时 swr 不做重采样, 预设不影响性能;
+ * 常见的 48000 -> 44100 为精确比例(147/160), swr 默认开启 exact_rational, 滤波器组只需 147 个相位;
+ *
+ * 使用示例:
+ * ```
+ * // "aresample=44100:filter_size=8:..."
+ * desc << "aresample=" << 44100 << ResamplePresets::getOptions(ResampleQuality::Low);
+ * ```
+ */
+class ResamplePresets {
+public:
+    /// 返回追加在 `aresample=<rate>` 之后的参数(以 ':' 开头); Balanced 返回空字符串;
+    static std::string getOptions(ResampleQuality quality);
+};
+
+}
+
+#endif //FFMPEGPROJ_RESAMPLEPRESETS_H
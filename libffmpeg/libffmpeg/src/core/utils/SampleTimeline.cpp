@@ -0,0 +1,84 @@
+//
+// Created on 2025/5/20.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "SampleTimeline.h"
+#include <cmath>
+
+namespace FFAV {
+
+SampleTimeline::SampleTimeline() = default;
+SampleTimeline::~SampleTimeline() = default;
+
+void SampleTimeline::clear() {
+    anchors.clear();
+}
+
+bool SampleTimeline::isEmpty() const {
+    return anchors.empty();
+}
+
+void SampleTimeline::start(int64_t out_pts, int64_t media_pts, double rate) {
+    anchors.clear();
+    anchors.push_back({ out_pts, media_pts, rate });
+}
+
+void SampleTimeline::append(int64_t out_pts, int64_t media_pts, double rate) {
+    if ( !anchors.empty() ) {
+        // 同一位置的锚点直接覆盖
+        if ( anchors.back().out_pts == out_pts ) {
+            anchors.back() = { out_pts, media_pts, rate };
+            return;
+        }
+        // 不允许回退
+        if ( anchors.back().out_pts > out_pts ) {
+            return;
+        }
+    }
+    anchors.push_back({ out_pts, media_pts, rate });
+}
+
+void SampleTimeline::changeRate(int64_t out_pts, double rate) {
+    if ( anchors.empty() ) {
+        anchors.push_back({ out_pts, out_pts, rate });
+        return;
+    }
+    append(out_pts, toMedia(out_pts), rate);
+}
+
+int64_t SampleTimeline::toMedia(int64_t out_pts) const {
+    const Anchor* anchor = find(out_pts);
+    if ( anchor == nullptr ) {
+        return out_pts;
+    }
+    return anchor->media_pts + llround((double)(out_pts - anchor->out_pts) * anchor->rate);
+}
+
+double SampleTimeline::getRate(int64_t out_pts) const {
+    const Anchor* anchor = find(out_pts);
+    return anchor != nullptr ? anchor->rate : 1.0;
+}
+
+void SampleTimeline::trim(int64_t out_pts) {
+    while ( anchors.size() > 1 && anchors[1].out_pts <= out_pts ) {
+        anchors.pop_front();
+    }
+}
+
+const SampleTimeline::Anchor* _Nullable SampleTimeline::find(int64_t out_pts) const {
+    if ( anchors.empty() ) {
+        return nullptr;
+    }
+
+    // 锚点数量很少(仅在变速时追加), 从后向前查找即可
+    for ( auto it = anchors.rbegin(); it != anchors.rend(); ++it ) {
+        if ( it->out_pts <= out_pts ) {
+            return &(*it);
+        }
+    }
+    return &anchors.front();
+}
+
+}
@@ -0,0 +1,59 @@
+//
+// Created on 2025/5/20.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_SAMPLETIMELINE_H
+#define FFMPEGPROJ_SAMPLETIMELINE_H
+
+#include <cstdint>
+#include <deque>
+
+namespace FFAV {
+
+/**
+ * 输出样本位置 与 媒体时间 之间的映射;
+ *
+ * 变速(atempo)后输出的样本数不再等于媒体时长, 输出的 pts 只是输出样本的计数;
+ * 这里通过分段锚点记录每一段的起始位置及速率, 用于把输出位置换算回媒体时间;
+ *
+ * out_pts 与 media_pts 使用相同的时间基(输出采样率);
+ * 未设置任何锚点时为恒等映射;
+ */
+class SampleTimeline {
+public:
+    SampleTimeline();
+    ~SampleTimeline();
+
+    void clear();
+    bool isEmpty() const;
+
+    // 清空后以指定位置作为起点
+    void start(int64_t out_pts, int64_t media_pts, double rate);
+
+    // 追加锚点; out_pts 需不小于最后一个锚点的位置;
+    void append(int64_t out_pts, int64_t media_pts, double rate);
+
+    // 在 out_pts 处变更速率, 媒体位置取当前映射值;
+    void changeRate(int64_t out_pts, double rate);
+
+    int64_t toMedia(int64_t out_pts) const;
+    double getRate(int64_t out_pts) const;
+
+    // 丢弃 out_pts 之前不再需要的锚点;
+    void trim(int64_t out_pts);
+
+private:
+    struct Anchor {
+        int64_t out_pts;
+        int64_t media_pts;
+        double rate;
+    };
+    std::deque<Anchor> anchors;
+
+    const Anchor* _Nullable find(int64_t out_pts) const;
+};
+
+}
+#endif //FFMPEGPROJ_SAMPLETIMELINE_H
@@ -0,0 +1,261 @@
+//
+// Created on 2025/6/6.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "SegmentedDecoder.h"
+#include "MediaReader.h"
+#include "AudioUtils.h"
+#include "MediaObjectPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+namespace FFAV {
+
+// 引用 src 中 [offset, offset + nb_samples) 的数据, 不复制
+static int trim_frame(AVFrame* _Nonnull src, int offset, int nb_samples, AVFrame* _Nonnull dst) {
+    int ret = av_frame_ref(dst, src);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVSampleFormat fmt = (AVSampleFormat)src->format;
+    int nb_channels = src->ch_layout.nb_channels;
+    bool planar = av_sample_fmt_is_planar(fmt);
+    int nb_planes = planar ? nb_channels : 1;
+    int shift = offset * av_get_bytes_per_sample(fmt) * (planar ? 1 : nb_channels);
+    for ( int i = 0; i < nb_planes; ++i ) {
+        dst->extended_data[i] += shift;
+    }
+    if ( dst->extended_data != dst->data ) {
+        for ( int i = 0; i < std::min(nb_planes, AV_NUM_DATA_POINTERS); ++i ) {
+            dst->data[i] += shift;
+        }
+    }
+    dst->nb_samples = nb_samples;
+    return 0;
+}
+
+SegmentClipper::SegmentClipper(int64_t start_sample, int64_t end_sample): start_sample(start_sample), end_sample(end_sample) {
+    position = start_sample > 0 ? AV_NOPTS_VALUE : 0;
+}
+
+int SegmentClipper::clip(int64_t frame_position, int nb_samples, int& out_offset, int& out_count) {
+    out_offset = 0;
+    out_count = 0;
+    if ( position == AV_NOPTS_VALUE ) {
+        if ( frame_position == AV_NOPTS_VALUE ) {
+            return AVERROR(ENOSYS);
+        }
+        // seek 落在起点之后, [start_sample, frame_position) 的样本会缺失
+        if ( frame_position > start_sample ) {
+            return AVERROR(ERANGE);
+        }
+        position = frame_position;
+    }
+
+    int64_t frame_start = position;
+    int64_t frame_end = position + nb_samples;
+    position = frame_end;
+
+    int64_t from = std::max(frame_start, start_sample);
+    int64_t to = end_sample >= 0 ? std::min(frame_end, end_sample) : frame_end;
+    if ( end_sample >= 0 && frame_end >= end_sample ) {
+        reached_end = true;
+    }
+    if ( from < to ) {
+        out_offset = (int)(from - frame_start);
+        out_count = (int)(to - from);
+    }
+    return 0;
+}
+
+int SegmentedDecoder::plan(const std::string& url, const SegmentedDecodeOptions& options, SegmentPlan& plan) {
+    MediaReader reader;
+    int ret = reader.open(url, { }, AVMEDIA_TYPE_AUDIO);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVStream* stream = reader.getBestStream(AVMEDIA_TYPE_AUDIO);
+    if ( stream == nullptr ) {
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+
+    // 声道数以解码器的输出为准(可能请求了下混)
+    MediaDecoder decoder;
+    ret = decoder.init(stream->codecpar, options.decoder_options);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    plan = SegmentPlan();
+    plan.sample_rate = decoder.getSampleRate();
+    plan.nb_channels = decoder.getChannels();
+    if ( stream->duration != AV_NOPTS_VALUE && plan.sample_rate > 0 ) {
+        plan.total_samples = av_rescale_q(stream->duration, stream->time_base, (AVRational){ 1, plan.sample_rate });
+    }
+
+    // 时长未知时只能顺序解码
+    int alignment = std::max(1, options.alignment);
+    int nb_segments = options.nb_segments > 0 ? options.nb_segments : (int)std::max(1u, std::thread::hardware_concurrency());
+    if ( plan.total_samples <= 0 ) {
+        nb_segments = 1;
+    }
+    else {
+        int64_t min_segment_samples = std::max<int64_t>(1, (int64_t)plan.sample_rate * options.min_segment_seconds);
+        nb_segments = (int)std::max<int64_t>(1, std::min<int64_t>(nb_segments, plan.total_samples / min_segment_samples));
+    }
+
+    int64_t total_units = (plan.total_samples + alignment - 1) / alignment;
+    int64_t units_per_segment = nb_segments > 1 ? (total_units + nb_segments - 1) / nb_segments : 0;
+    plan.boundaries.reserve(nb_segments);
+    for ( int i = 0; i < nb_segments; ++i ) {
+        plan.boundaries.push_back((int64_t)i * units_per_segment * alignment);
+    }
+    return 0;
+}
+
+int SegmentedDecoder::decode(
+    const std::string& url,
+    const SegmentedDecodeOptions& options,
+    int64_t start_sample,
+    int64_t end_sample,
+    FrameCallback on_frame,
+    const std::atomic<bool>* _Nullable cancelled,
+    int64_t* _Nullable out_end_sample
+) {
+    MediaReader reader;
+    int ret = reader.open(url, { }, AVMEDIA_TYPE_AUDIO);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    AVStream* stream = reader.getBestStream(AVMEDIA_TYPE_AUDIO);
+    if ( stream == nullptr ) {
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+    reader.selectStream(stream->index);
+
+    MediaDecoder decoder;
+    ret = decoder.init(stream->codecpar, options.decoder_options);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    int sample_rate = decoder.getSampleRate();
+    int64_t start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+    // 非首段: 提前 pre-roll seek, 之后按第一个 frame 的 pts 定位
+    if ( start_sample > 0 ) {
+        int64_t preroll = std::max<int64_t>(stream->codecpar->seek_preroll, sample_rate / 10);
+        int64_t seek_time = av_rescale(std::max<int64_t>(0, start_sample - preroll), AV_TIME_BASE, sample_rate);
+        ret = reader.seek(seek_time, -1);
+        if ( ret < 0 ) {
+            return ret;
+        }
+    }
+
+    SegmentClipper clipper(start_sample, end_sample);
+    AVFrame* trimmed = FramePool::shared().acquire();
+    auto on_decoded = [&](AVFrame* frame) {
+        int64_t frame_position = frame->pts != AV_NOPTS_VALUE ? av_rescale_q(frame->pts - start_time, stream->time_base, (AVRational){ 1, sample_rate }) : AV_NOPTS_VALUE;
+        int offset = 0;
+        int count = 0;
+        int ret = clipper.clip(frame_position, frame->nb_samples, offset, count);
+        if ( ret < 0 || count == 0 ) {
+            return ret;
+        }
+
+        int64_t frame_start = clipper.getPosition() - frame->nb_samples;
+        if ( count == frame->nb_samples ) {
+            frame->pts = frame_start;
+            return on_frame(frame);
+        }
+
+        ret = trim_frame(frame, offset, count, trimmed);
+        if ( ret < 0 ) {
+            return ret;
+        }
+        trimmed->pts = frame_start + offset;
+        ret = on_frame(trimmed);
+        av_frame_unref(trimmed);
+        return ret;
+    };
+
+    AVPacket* pkt = PacketPool::shared().acquire();
+    AVFrame* dec_frame = FramePool::shared().acquire();
+    bool eof = false;
+    do {
+        if ( cancelled && cancelled->load(std::memory_order_relaxed) ) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+
+        ret = reader.readPacket(pkt);
+        if ( ret == AVERROR_EOF ) {
+            eof = true;
+            ret = AudioUtils::decode(nullptr, &decoder, dec_frame, on_decoded);
+        }
+        else if ( ret >= 0 ) {
+            if ( pkt->stream_index == stream->index ) {
+                ret = AudioUtils::decode(pkt, &decoder, dec_frame, on_decoded);
+            }
+            av_packet_unref(pkt);
+        }
+
+        if ( ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ) {
+            ret = 0;
+        }
+        // 解码出错的包直接跳过
+        else if ( ret == AVERROR_INVALIDDATA ) {
+            ret = 0;
+        }
+    } while ( ret >= 0 && !eof && !clipper.reachedEnd() );
+
+    PacketPool::shared().release(pkt);
+    FramePool::shared().release(dec_frame);
+    FramePool::shared().release(trimmed);
+
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    // seek 超出文件末尾时没有任何数据
+    int64_t position = clipper.getPosition();
+    if ( position == AV_NOPTS_VALUE ) position = start_sample;
+    if ( out_end_sample ) *out_end_sample = end_sample >= 0 ? std::min(position, end_sample) : position;
+    return 0;
+}
+
+int SegmentedDecoder::run(int nb_jobs, const Job& job) {
+    if ( nb_jobs <= 0 ) {
+        return 0;
+    }
+
+    std::vector<int> results(nb_jobs, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(nb_jobs - 1);
+    for ( int i = 1; i < nb_jobs; ++i ) {
+        threads.emplace_back([&results, &job, i] { results[i] = job(i); });
+    }
+    results[0] = job(0); // 当前线程也参与
+    for ( auto& thread : threads ) {
+        thread.join();
+    }
+
+    int ret = 0;
+    for ( int result : results ) {
+        if ( result == AVERROR_EXIT ) {
+            return result;
+        }
+        if ( ret >= 0 && result < 0 ) {
+            ret = result;
+        }
+    }
+    return ret;
+}
+
+}
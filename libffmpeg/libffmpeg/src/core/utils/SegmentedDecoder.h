@@ -0,0 +1,122 @@
+//
+// Created on 2025/6/6.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_SEGMENTEDDECODER_H
+#define FFMPEGPROJ_SEGMENTEDDECODER_H
+
+#include "MediaDecoder.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace FFAV {
+
+struct SegmentedDecodeOptions {
+    int nb_segments { 0 };              // 分段数; 0 表示使用 CPU 核数, 1 表示不分段; 不可 seek 或时长未知时总是不分段
+    int min_segment_seconds { 30 };     // 每段的最短时长; 过短时并行的收益抵不过打开文件和预滚的开销
+    int alignment { 1 };                // 分段边界对齐到该采样数的整数倍, 例如峰值的粒度或编码器的帧长
+    MediaDecoderOptions decoder_options;
+};
+
+/// 分段结果; 第 i 段为 [getStart(i), getEnd(i)), 最后一段读取到文件末尾(getEnd 返回 -1);
+struct SegmentPlan {
+    int sample_rate { 0 };
+    int nb_channels { 0 };
+    int64_t total_samples { 0 };        // 由容器时长估算, 未知时为 0; 实际解码得到的样本数可能略有出入
+    std::vector<int64_t> boundaries;    // 各段的起点, 以采样为单位
+
+    int getSegmentCount() const { return (int)boundaries.size(); }
+    int64_t getStart(int index) const { return boundaries[index]; }
+    int64_t getEnd(int index) const { return index + 1 < (int)boundaries.size() ? boundaries[index + 1] : -1; }
+};
+
+/**
+ * @class SegmentClipper
+ * @brief 将解码得到的 frame 按顺序裁剪到分段的范围 [start_sample, end_sample); 由 SegmentedDecoder::decode 使用;
+ *
+ * 首段从 0 开始; 非首段(start_sample > 0)的位置由第一个 frame 的 pts 确定, 之后按样本数累加;
+ * 第一个 frame 晚于起点时(seek 不精确, 例如没有 TOC 的 VBR MP3 或只能 seek 到关键帧的容器)其间的样本会缺失,
+ * 返回 AVERROR(ERANGE), 调用方退回顺序解码;
+ */
+class SegmentClipper {
+public:
+    SegmentClipper(int64_t start_sample, int64_t end_sample);
+
+    /// frame_position: frame 的起点(采样位置), 未知时为 AV_NOPTS_VALUE; 只有确定位置之前(非首段的第一个 frame)使用;
+    /// 成功时 out_offset/out_count 为 frame 中需要保留的部分, out_count 为 0 时整个丢弃;
+    int clip(int64_t frame_position, int nb_samples, int& out_offset, int& out_count);
+
+    /// 已到达 end_sample;
+    bool reachedEnd() const { return reached_end; }
+
+    /// 下一个 frame 的起点; 非首段在第一个 frame 之前为 AV_NOPTS_VALUE;
+    int64_t getPosition() const { return position; }
+
+private:
+    int64_t start_sample;
+    int64_t end_sample;
+    int64_t position;
+    bool reached_end { false };
+};
+
+/**
+ * @class SegmentedDecoder
+ * @brief 长文件的分段解码; 将可 seek 的文件按时间分为多段, 每段使用独立的 MediaReader/MediaDecoder 并发解码;
+ *
+ * decode 解码其中任意一段: 在起点之前多 seek 一段预滚(max(seek_preroll, 100ms)), 按 pts 定位后丢弃起点之前的数据,
+ * 使解码器在起点处已稳定; 回调的 frame 已裁剪到请求的范围, pts 为以 1/sample_rate 为单位的采样位置;
+ *
+ * 各段的结果如何拼接由调用方决定: 与顺序无关的统计(峰值等)可以直接合并, 需要有序输出的(转码)按段缓存后依次写出;
+ *
+ * 使用示例:
+ * ```
+ * SegmentPlan plan;
+ * SegmentedDecoder::plan(url, options, plan);
+ * std::vector<Result> results(plan.getSegmentCount());
+ * int ret = SegmentedDecoder::run(plan.getSegmentCount(), [&](int i) {
+ *     return SegmentedDecoder::decode(url, options, plan.getStart(i), plan.getEnd(i), [&](AVFrame* frame) {
+ *         results[i].add(frame);
+ *         return 0;
+ *     }, cancelled);
+ * });
+ * ```
+ */
+class SegmentedDecoder {
+public:
+    using FrameCallback = std::function<int(AVFrame* _Nonnull frame)>;
+    using Job = std::function<int(int index)>;
+
+    /// 探测时长并划分分段;
+    static int plan(const std::string& url, const SegmentedDecodeOptions& options, SegmentPlan& plan);
+
+    /**
+     * 解码 [start_sample, end_sample); end_sample 为 -1 时解码到文件末尾;
+     * start_sample 大于 0 时需要 seek 及 pts, 并且 seek 之后的第一个 frame 不晚于 start_sample, 否则返回错误(调用方可退回顺序解码);
+     * 回调返回值小于 0 时停止并返回该值; out_end_sample 返回实际解码到的位置;
+     */
+    static int decode(
+        const std::string& url,
+        const SegmentedDecodeOptions& options,
+        int64_t start_sample,
+        int64_t end_sample,
+        FrameCallback on_frame,
+        const std::atomic<bool>* _Nullable cancelled = nullptr,
+        int64_t* _Nullable out_end_sample = nullptr
+    );
+
+    /// 并发执行 nb_jobs 个任务, 每个任务一个线程, 当前线程也参与; 全部结束后返回第一个错误, 取消(AVERROR_EXIT)优先;
+    static int run(int nb_jobs, const Job& job);
+};
+
+}
+
+#endif //FFMPEGPROJ_SEGMENTEDDECODER_H
@@ -0,0 +1,190 @@
+//
+// Created on 2025/6/14.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "SilenceTrimmer.h"
+#include "AudioKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace FFAV {
+
+SilenceTrimmer::SilenceTrimmer(int nb_channels, int sample_rate, Output output): nb_channels(std::max(1, nb_channels)), sample_rate(std::max(1, sample_rate)), output(std::move(output)) {
+    window_samples = std::max(1, this->sample_rate / 100); // 10ms
+    min_samples = this->sample_rate;
+    pending_planes.resize(this->nb_channels);
+    offset_planes.resize(this->nb_channels);
+    resizePending();
+}
+
+void SilenceTrimmer::setThreshold(float db) {
+    threshold_db = db;
+    threshold_sq = std::pow(10.0, db / 10.0);
+}
+
+int SilenceTrimmer::setMinimumDuration(double seconds) {
+    int64_t samples = (int64_t)std::llround(std::max(0.0, seconds) * sample_rate);
+    if ( samples == min_samples ) {
+        return 0;
+    }
+
+    // 暂存区的容量随之变化, 先输出暂存的数据
+    int ret = emitPending(nb_pending);
+    silent_run = 0;
+    min_samples = samples;
+    keep_samples = std::min(keep_samples, min_samples);
+    resizePending();
+    return ret;
+}
+
+void SilenceTrimmer::setKeepDuration(double seconds) {
+    keep_samples = std::min((int64_t)std::llround(std::max(0.0, seconds) * sample_rate), min_samples);
+}
+
+int SilenceTrimmer::process(const float* _Nonnull const* _Nonnull planes, int nb_samples, int64_t media_pts, double rate) {
+    int ret = 0;
+    if ( !enabled ) {
+        ret = flush();
+        return ret < 0 ? ret : output(planes, nb_samples, media_pts, rate);
+    }
+
+    // 连续的非静音窗口合并为一段输出
+    int loud_start = -1;
+    auto emitLoud = [&](int end) -> int {
+        if ( loud_start < 0 ) {
+            return 0;
+        }
+        for ( int c = 0; c < nb_channels; ++c ) {
+            offset_planes[c] = planes[c] + loud_start;
+        }
+        int r = output(offset_planes.data(), end - loud_start, media_pts + std::llround(loud_start * rate), rate);
+        loud_start = -1;
+        return r;
+    };
+
+    for ( int offset = 0, n = 0; offset < nb_samples; offset += n ) {
+        n = std::min(window_samples, nb_samples - offset);
+        int64_t window_pts = media_pts + std::llround(offset * rate);
+
+        if ( !isSilent(planes, offset, n) ) {
+            if ( dropping ) {
+                endSkip();
+            }
+            else if ( nb_pending > 0 && (ret = emitPending(nb_pending)) < 0 ) {
+                return ret;
+            }
+            silent_run = 0;
+            if ( loud_start < 0 ) loud_start = offset;
+            continue;
+        }
+
+        if ( (ret = emitLoud(offset)) < 0 ) {
+            return ret;
+        }
+
+        silent_run += n;
+        if ( dropping ) {
+            skip(window_pts, window_pts + std::llround(n * rate));
+            continue;
+        }
+
+        // 速率变化或媒体时间不连续时, 暂存的数据不能与之合并, 先输出
+        if ( nb_pending > 0 ) {
+            int64_t expected_pts = pending_media_pts + std::llround(nb_pending * pending_rate);
+            if ( rate != pending_rate || std::llabs(window_pts - expected_pts) > 1 ) {
+                if ( (ret = emitPending(nb_pending)) < 0 ) {
+                    return ret;
+                }
+                silent_run = n;
+            }
+        }
+        appendPending(planes, offset, n, window_pts, rate);
+
+        // 超过 min_duration, 保留开头的 keep_duration, 其余丢弃
+        if ( silent_run > min_samples ) {
+            dropping = true;
+            int keep = (int)std::min<int64_t>(keep_samples, nb_pending);
+            int64_t start = pending_media_pts + std::llround(keep * pending_rate);
+            int64_t end = pending_media_pts + std::llround(nb_pending * pending_rate);
+            if ( (ret = emitPending(keep)) < 0 ) {
+                return ret;
+            }
+            skip(start, end);
+        }
+    }
+    return emitLoud(nb_samples);
+}
+
+int SilenceTrimmer::flush() {
+    endSkip();
+    silent_run = 0;
+    return emitPending(nb_pending);
+}
+
+void SilenceTrimmer::reset() {
+    endSkip();
+    silent_run = 0;
+    nb_pending = 0;
+}
+
+bool SilenceTrimmer::isSilent(const float* _Nonnull const* _Nonnull planes, int offset, int nb_samples) const {
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+    double sum_sq = 0;
+    for ( int c = 0; c < nb_channels; ++c ) {
+        AudioKernels::peakSummary(planes[c] + offset, nb_samples, min, max, sum_sq);
+    }
+    return sum_sq < threshold_sq * nb_samples * nb_channels;
+}
+
+// 输出暂存区开头的 nb_samples 个采样, 其余丢弃
+int SilenceTrimmer::emitPending(int nb_samples) {
+    int ret = 0;
+    if ( nb_samples > 0 ) {
+        ret = output(pending_planes.data(), nb_samples, pending_media_pts, pending_rate);
+    }
+    nb_pending = 0;
+    return ret;
+}
+
+void SilenceTrimmer::appendPending(const float* _Nonnull const* _Nonnull planes, int offset, int nb_samples, int64_t media_pts, double rate) {
+    if ( nb_pending == 0 ) {
+        pending_media_pts = media_pts;
+        pending_rate = rate;
+    }
+    for ( int c = 0; c < nb_channels; ++c ) {
+        std::copy(planes[c] + offset, planes[c] + offset + nb_samples, pending.data() + (size_t)c * pending_capacity + nb_pending);
+    }
+    nb_pending += nb_samples;
+}
+
+void SilenceTrimmer::skip(int64_t media_start, int64_t media_end) {
+    if ( !has_skip ) {
+        has_skip = true;
+        skip_start = media_start;
+    }
+    skip_end = media_end;
+}
+
+void SilenceTrimmer::endSkip() {
+    if ( has_skip && skip_end > skip_start && skip_handler ) {
+        skip_handler(skip_start, skip_end);
+    }
+    has_skip = false;
+    dropping = false;
+}
+
+// 暂存的静音最多为 min_duration 加一个窗口
+void SilenceTrimmer::resizePending() {
+    pending_capacity = (int)min_samples + window_samples;
+    pending.assign((size_t)nb_channels * pending_capacity, 0);
+    for ( int c = 0; c < nb_channels; ++c ) {
+        pending_planes[c] = pending.data() + (size_t)c * pending_capacity;
+    }
+}
+
+}
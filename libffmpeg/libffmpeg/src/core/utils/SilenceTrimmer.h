@@ -0,0 +1,119 @@
+//
+// Created on 2025/6/14.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_SILENCETRIMMER_H
+#define FFMPEGPROJ_SILENCETRIMMER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace FFAV {
+
+/**
+ * @class SilenceTrimmer
+ * @brief 静音裁剪; 位于 filter graph 的输出与 fifo 之间, 跳过或缩短较长的静音(例如播客/有声书的片头片尾及段落间隙);
+ *
+ * 输入为 fltp, 按 10ms 的窗口通过 AudioKernels::peakSummary 计算各声道合并的 RMS, 低于 threshold 的窗口视为静音;
+ * 连续的静音在达到 min_duration 之前暂存(不输出), 期间出现非静音时原样输出;
+ * 超过 min_duration 后只保留开头的 keep_duration(为 0 时完全跳过), 其余部分丢弃直到静音结束;
+ *
+ * 输出的每一段都带有其媒体时间(media_pts), 由调用方写入 fifo 并记录到 SampleTimeline,
+ * 被丢弃的部分在时间线上表现为不连续, 输出位置换算回媒体时间时自动跳过, 因此播放进度保持正确;
+ * 每段被丢弃的范围结束时通过 SkipHandler 回调一次(媒体时间, 输出采样率);
+ *
+ * 所有方法都应在同一个线程(或同一把锁内)调用;
+ *
+ * 使用示例:
+ * ```
+ * SilenceTrimmer trimmer(2, 44100, [&](const float* const* planes, int nb_samples, int64_t media_pts, double rate) {
+ *     return write_to_fifo(planes, nb_samples, media_pts, rate);
+ * });
+ * trimmer.setEnabled(true);
+ *
+ * trimmer.process(planes, nb_samples, media_pts, rate);
+ * ...
+ * trimmer.flush(); // eof
+ * ```
+ */
+class SilenceTrimmer {
+public:
+    /// 输出未被丢弃的数据; 返回小于 0 表示出错;
+    using Output = std::function<int(const float* _Nonnull const* _Nonnull planes, int nb_samples, int64_t media_pts, double rate)>;
+    using SkipHandler = std::function<void(int64_t media_start, int64_t media_end)>;
+
+    SilenceTrimmer(int nb_channels, int sample_rate, Output output);
+
+    void setSkipHandler(SkipHandler handler) { skip_handler = std::move(handler); }
+
+    /// 关闭后暂存的数据在下次 process 时输出;
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+
+    /// 静音阈值, dBFS, 默认 -50;
+    void setThreshold(float db);
+    float getThreshold() const { return threshold_db; }
+
+    /// 超过该时长的静音才会被裁剪, 秒, 默认 1.0; 变更时先输出暂存的数据;
+    int setMinimumDuration(double seconds);
+    double getMinimumDuration() const { return (double)min_samples / sample_rate; }
+
+    /// 每段被裁剪的静音保留的时长, 秒, 默认 0(完全跳过); 不超过 min_duration;
+    void setKeepDuration(double seconds);
+    double getKeepDuration() const { return (double)keep_samples / sample_rate; }
+
+    /// 是否需要经过 process; 关闭后仍有暂存数据时返回 true;
+    bool isActive() const { return enabled || nb_pending > 0; }
+
+    /// rate 为每个输出样本对应的媒体样本数(变速);
+    int process(const float* _Nonnull const* _Nonnull planes, int nb_samples, int64_t media_pts, double rate);
+
+    /// eof; 输出暂存的数据;
+    int flush();
+
+    /// 丢弃暂存的数据(seek, 切换音轨); 正在跳过的范围会先回调;
+    void reset();
+
+private:
+    int nb_channels;
+    int sample_rate;
+    int window_samples;
+    Output output;
+    SkipHandler skip_handler;
+
+    bool enabled { false };
+    float threshold_db { -50 };
+    double threshold_sq { 1e-5 };       // 均方阈值
+    int64_t min_samples;
+    int64_t keep_samples { 0 };
+
+    // 当前的静音
+    int64_t silent_run { 0 };           // 输出样本数
+    bool dropping { false };            // 已超过 min_duration, 正在丢弃
+    bool has_skip { false };
+    int64_t skip_start { 0 };           // 正在丢弃的媒体范围
+    int64_t skip_end { 0 };
+
+    // 暂存的静音, 未达到 min_duration 之前不确定是否需要丢弃
+    std::vector<float> pending;         // nb_channels * pending_capacity
+    std::vector<const float*> pending_planes;
+    int pending_capacity { 0 };
+    int nb_pending { 0 };
+    int64_t pending_media_pts { 0 };
+    double pending_rate { 1 };
+    std::vector<const float*> offset_planes;
+
+    bool isSilent(const float* _Nonnull const* _Nonnull planes, int offset, int nb_samples) const;
+    int emitPending(int nb_samples);
+    void appendPending(const float* _Nonnull const* _Nonnull planes, int offset, int nb_samples, int64_t media_pts, double rate);
+    void skip(int64_t media_start, int64_t media_end);
+    void endSkip();
+    void resizePending();
+};
+
+}
+
+#endif //FFMPEGPROJ_SILENCETRIMMER_H
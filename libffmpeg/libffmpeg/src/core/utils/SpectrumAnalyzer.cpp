@@ -0,0 +1,229 @@
+//
+// Created on 2025/6/9.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "SpectrumAnalyzer.h"
+#include "AudioKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace FFAV {
+
+static constexpr int MIN_FFT_SIZE = 64;
+static constexpr int MAX_FFT_SIZE = 32768;
+// 分析线程被抢占导致数据被覆盖时的重试次数
+static constexpr int MAX_READ_ATTEMPTS = 3;
+
+static int floor_pow2(int value) {
+    int result = 1;
+    while ( result * 2 <= value ) result *= 2;
+    return result;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(int sample_rate, int nb_channels, const SpectrumOptions& options):
+    sample_rate(std::max(1, sample_rate)),
+    nb_channels(std::max(1, nb_channels)),
+    fft_size(floor_pow2(std::clamp(options.fft_size, MIN_FFT_SIZE, MAX_FFT_SIZE))),
+    smoothing(std::clamp(options.smoothing, 0.f, 0.99f)) {
+
+    capacity = (uint64_t)fft_size * 4;
+    ring.assign((size_t)(capacity * this->nb_channels), 0.f);
+
+    int n = fft_size / 2;
+    int bits = 0;
+    while ( (1 << bits) < n ) ++bits;
+    bitrev.resize(n);
+    for ( int i = 0; i < n; ++i ) {
+        int r = 0;
+        for ( int b = 0; b < bits; ++b ) {
+            if ( i & (1 << b) ) r |= 1 << (bits - 1 - b);
+        }
+        bitrev[i] = r;
+    }
+
+    // 半长为 h 的一级使用 e^(-2πij/2h), j in [0, h), 存放在 [h - 1, 2h - 1)
+    twiddle_re.resize(std::max(1, n - 1));
+    twiddle_im.resize(std::max(1, n - 1));
+    for ( int h = 1; h < n; h *= 2 ) {
+        for ( int j = 0; j < h; ++j ) {
+            double angle = -M_PI * j / h;
+            twiddle_re[h - 1 + j] = (float)std::cos(angle);
+            twiddle_im[h - 1 + j] = (float)std::sin(angle);
+        }
+    }
+
+    split_re.resize(n);
+    split_im.resize(n);
+    for ( int k = 0; k < n; ++k ) {
+        double angle = -2.0 * M_PI * k / fft_size;
+        split_re[k] = (float)std::cos(angle);
+        split_im[k] = (float)std::sin(angle);
+    }
+
+    // 周期 Hann 窗
+    window.resize(fft_size);
+    double window_sum = 0;
+    for ( int i = 0; i < fft_size; ++i ) {
+        window[i] = (float)(0.5 - 0.5 * std::cos(2.0 * M_PI * i / fft_size));
+        window_sum += window[i];
+    }
+    window_gain = (float)(2.0 / window_sum);
+
+    // 频带按对数均分; 低频处频点稀疏, 相邻频带可能落在同一个频点上
+    double nyquist = this->sample_rate / 2.0;
+    double max_frequency = std::clamp<double>(options.max_frequency, 1.0, nyquist);
+    double min_frequency = std::clamp<double>(options.min_frequency, 1.0, max_frequency);
+    double bin_hz = (double)this->sample_rate / fft_size;
+    int nb_bands = std::max(1, options.nb_bands);
+    band_bins.reserve(nb_bands);
+    for ( int b = 0; b < nb_bands; ++b ) {
+        double f_lo = min_frequency * std::pow(max_frequency / min_frequency, (double)b / nb_bands);
+        double f_hi = min_frequency * std::pow(max_frequency / min_frequency, (double)(b + 1) / nb_bands);
+        int lo = std::clamp((int)std::floor(f_lo / bin_hz), 1, n);
+        int hi = std::clamp((int)std::ceil(f_hi / bin_hz), lo + 1, n + 1);
+        band_bins.emplace_back(lo, hi);
+    }
+    smoothed.assign(nb_bands, 0.f);
+
+    input.resize((size_t)this->nb_channels * fft_size);
+    mono.resize(fft_size);
+    re.resize(n);
+    im.resize(n);
+    out_re.resize(n + 1);
+    out_im.resize(n + 1);
+    power.resize(n + 1);
+}
+
+void SpectrumAnalyzer::push(const float* _Nonnull const* _Nonnull planes, int nb_samples) {
+    if ( nb_samples <= 0 ) {
+        return;
+    }
+
+    uint64_t pos = write_end.load(std::memory_order_relaxed); // 只有生产者写入
+    uint64_t new_end = pos + nb_samples;
+    // 先声明即将覆盖的范围, 再写入数据
+    write_begin.store(new_end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // 超出容量的部分只保留最后 capacity 个采样
+    int skip = nb_samples > (int)capacity ? nb_samples - (int)capacity : 0;
+    uint64_t start = pos + skip;
+    int count = nb_samples - skip;
+    int offset = (int)(start & (capacity - 1));
+    int first = std::min(count, (int)capacity - offset);
+    for ( int c = 0; c < nb_channels; ++c ) {
+        float* dst = ring.data() + (size_t)c * capacity;
+        const float* src = planes[c] + skip;
+        memcpy(dst + offset, src, first * sizeof(float));
+        if ( count > first ) memcpy(dst, src + first, (count - first) * sizeof(float));
+    }
+
+    write_end.store(new_end, std::memory_order_release);
+}
+
+bool SpectrumAnalyzer::readLatest(uint64_t& end) {
+    for ( int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt ) {
+        end = write_end.load(std::memory_order_acquire);
+        if ( end == last_end || end < (uint64_t)fft_size ) {
+            return false;
+        }
+
+        uint64_t start = end - fft_size;
+        int offset = (int)(start & (capacity - 1));
+        int first = std::min(fft_size, (int)capacity - offset);
+        for ( int c = 0; c < nb_channels; ++c ) {
+            const float* src = ring.data() + (size_t)c * capacity;
+            float* dst = input.data() + (size_t)c * fft_size;
+            memcpy(dst, src + offset, first * sizeof(float));
+            if ( fft_size > first ) memcpy(dst + first, src, (fft_size - first) * sizeof(float));
+        }
+
+        // 复制期间生产者没有写到 start 之前的位置(环形缓冲中同一个位置), 数据才是完整的
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t begin = write_begin.load(std::memory_order_relaxed);
+        if ( begin <= start + capacity ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SpectrumAnalyzer::transform() {
+    int n = fft_size / 2;
+
+    // 下混为单声道并加窗
+    AudioKernels::scale(mono.data(), input.data(), 1.f / nb_channels, fft_size);
+    for ( int c = 1; c < nb_channels; ++c ) {
+        AudioKernels::mixAdd(mono.data(), input.data() + (size_t)c * fft_size, 1.f / nb_channels, fft_size);
+    }
+    AudioKernels::multiply(mono.data(), mono.data(), window.data(), fft_size);
+
+    // 偶数下标为实部, 奇数下标为虚部, 做 n 点复数 FFT
+    float* planes[2] = { re.data(), im.data() };
+    AudioKernels::deinterleave(planes, mono.data(), 2, n);
+    for ( int i = 0; i < n; ++i ) {
+        int j = bitrev[i];
+        if ( i < j ) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    // 第一级的旋转因子为 1
+    for ( int i = 0; i + 1 < n; i += 2 ) {
+        float tr = re[i + 1], ti = im[i + 1];
+        re[i + 1] = re[i] - tr;
+        im[i + 1] = im[i] - ti;
+        re[i] += tr;
+        im[i] += ti;
+    }
+    for ( int h = 2; h < n; h *= 2 ) {
+        const float* wr = twiddle_re.data() + h - 1;
+        const float* wi = twiddle_im.data() + h - 1;
+        for ( int s = 0; s < n; s += 2 * h ) {
+            AudioKernels::fftButterfly(re.data() + s, im.data() + s, re.data() + s + h, im.data() + s + h, wr, wi, h);
+        }
+    }
+
+    // 由 Z = FFT(z) 得到实数序列的 X[0, n]:
+    // X[k] = E[k] + W^k * O[k], E[k] = (Z[k] + conj(Z[n - k])) / 2, O[k] = -i * (Z[k] - conj(Z[n - k])) / 2
+    out_re[0] = re[0] + im[0];
+    out_im[0] = 0;
+    out_re[n] = re[0] - im[0];
+    out_im[n] = 0;
+    for ( int k = 1; k < n; ++k ) {
+        float ar = re[k], ai = im[k];
+        float br = re[n - k], bi = im[n - k];
+        float er = 0.5f * (ar + br);
+        float ei = 0.5f * (ai - bi);
+        float or_ = 0.5f * (ai + bi);
+        float oi = -0.5f * (ar - br);
+        out_re[k] = er + (split_re[k] * or_ - split_im[k] * oi);
+        out_im[k] = ei + (split_re[k] * oi + split_im[k] * or_);
+    }
+    AudioKernels::powerSpectrum(power.data(), out_re.data(), out_im.data(), n + 1);
+}
+
+bool SpectrumAnalyzer::analyze(float* _Nonnull bands) {
+    uint64_t end = 0;
+    if ( !readLatest(end) ) {
+        return false;
+    }
+    last_end = end;
+
+    transform();
+
+    for ( size_t b = 0; b < band_bins.size(); ++b ) {
+        auto [lo, hi] = band_bins[b];
+        float peak = *std::max_element(power.begin() + lo, power.begin() + hi);
+        float magnitude = std::sqrt(peak) * window_gain;
+        smoothed[b] = std::max(magnitude, smoothed[b] * smoothing);
+        bands[b] = smoothed[b];
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,107 @@
+//
+// Created on 2025/6/9.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_SPECTRUMANALYZER_H
+#define FFMPEGPROJ_SPECTRUMANALYZER_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace FFAV {
+
+struct SpectrumOptions {
+    int fft_size { 2048 };          // 2 的整数次幂, 范围 [64, 32768]
+    int nb_bands { 32 };            // 频带数, 在 [min_frequency, max_frequency] 内按对数均分
+    float min_frequency { 40 };
+    float max_frequency { 16000 };  // 超过 sample_rate / 2 时取 sample_rate / 2
+    float smoothing { 0.6f };       // 下落的平滑系数 [0, 1); 上升立即生效, 下降时每次最多衰减到上次的 smoothing 倍
+};
+
+/**
+ * @class SpectrumAnalyzer
+ * @brief 播放时的频谱分析; 渲染线程只做一次复制, FFT 在分析线程进行;
+ *
+ * push 在渲染线程调用, 将 pcm 复制到单生产者/单消费者的环形缓冲中, 不加锁, 不分配内存, 不等待;
+ * analyze 在分析线程调用(同一时刻只能有一个), 取最近的 fft_size 个采样做下混、Hann 窗与实数 FFT, 按频带输出幅度;
+ * 读取期间若数据被覆盖(分析线程被长时间挂起)会重新读取, 所有缓冲都在构造时分配;
+ *
+ * 输出为线性幅度, 满幅的正弦波约为 1.0; 需要 dB 时使用 20 * log10(x);
+ *
+ * 使用示例:
+ * ```
+ * auto analyzer = std::make_shared<SpectrumAnalyzer>(44100, 2, SpectrumOptions());
+ *
+ * // 渲染线程
+ * analyzer->push(planes, nb_samples);
+ *
+ * // 分析线程, 例如每 33ms 一次
+ * std::vector<float> bands(analyzer->getBandCount());
+ * if ( analyzer->analyze(bands.data()) ) {
+ *     ...
+ * }
+ * ```
+ */
+class SpectrumAnalyzer {
+public:
+    SpectrumAnalyzer(int sample_rate, int nb_channels, const SpectrumOptions& options = SpectrumOptions());
+    SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
+    SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
+
+    int getSampleRate() const { return sample_rate; }
+    int getChannels() const { return nb_channels; }
+    int getFFTSize() const { return fft_size; }
+    int getBandCount() const { return (int)band_bins.size(); }
+
+    /// 渲染线程调用; planes 为 nb_channels 个 float 平面;
+    void push(const float* _Nonnull const* _Nonnull planes, int nb_samples);
+
+    /// 分析线程调用; bands 大小为 getBandCount();
+    /// 自上次分析后没有新数据或数据还不足 fft_size 时返回 false, bands 保持不变;
+    bool analyze(float* _Nonnull bands);
+
+private:
+    int sample_rate;
+    int nb_channels;
+    int fft_size;
+    float smoothing;
+
+    // 环形缓冲; 写入前先更新 write_begin, 写完后更新 write_end, 读取方据此判断复制的数据是否完整
+    std::vector<float> ring;        // nb_channels 个平面, 每个平面 capacity 个采样
+    uint64_t capacity;
+    std::atomic<uint64_t> write_begin { 0 };
+    std::atomic<uint64_t> write_end { 0 };
+    uint64_t last_end { 0 };
+
+    // FFT; n = fft_size / 2 点复数 FFT + 实数拆分
+    std::vector<int> bitrev;                    // n
+    std::vector<float> twiddle_re;              // 各级的旋转因子依次存放, 共 n - 1 个
+    std::vector<float> twiddle_im;
+    std::vector<float> split_re;                // 实数拆分使用的 e^(-2πik/fft_size), n 个
+    std::vector<float> split_im;
+    std::vector<float> window;                  // fft_size
+    float window_gain;                          // 2 / sum(window)
+
+    std::vector<std::pair<int, int>> band_bins; // 每个频带的 [lo, hi) 频点
+    std::vector<float> smoothed;
+
+    // 工作缓冲
+    std::vector<float> input;                   // nb_channels * fft_size
+    std::vector<float> mono;                    // fft_size
+    std::vector<float> re;                      // n
+    std::vector<float> im;
+    std::vector<float> out_re;                  // n + 1
+    std::vector<float> out_im;
+    std::vector<float> power;                   // n + 1
+
+    bool readLatest(uint64_t& end);
+    void transform();
+};
+
+}
+
+#endif //FFMPEGPROJ_SPECTRUMANALYZER_H
@@ -0,0 +1,47 @@
+//
+// Created on 2025/6/15.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "TimeRangeList.h"
+#include <algorithm>
+
+namespace FFAV {
+
+void TimeRangeList::add(int64_t start, int64_t end) {
+    if ( start >= end ) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    // 第一个 end >= start 的范围; 从这里开始与新范围重叠或相接的范围都合并进来
+    auto first = std::lower_bound(ranges.begin(), ranges.end(), start, [](const Range& range, int64_t value) {
+        return range.end < value;
+    });
+    auto last = first;
+    while ( last != ranges.end() && last->start <= end ) {
+        start = std::min(start, last->start);
+        end = std::max(end, last->end);
+        ++last;
+    }
+    first = ranges.erase(first, last);
+    ranges.insert(first, { start, end });
+}
+
+void TimeRangeList::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    ranges.clear();
+}
+
+std::vector<TimeRangeList::Range> TimeRangeList::getRanges() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ranges;
+}
+
+size_t TimeRangeList::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ranges.size();
+}
+
+}
@@ -0,0 +1,52 @@
+//
+// Created on 2025/6/15.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_TIMERANGELIST_H
+#define FFMPEGPROJ_TIMERANGELIST_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace FFAV {
+
+/**
+ * @class TimeRangeList
+ * @brief 精确的时间范围列表, 例如静音裁剪跳过的范围; 线程安全;
+ *
+ * 范围均为 [start, end), 按起点排序; 只合并重叠或相接的范围, 结果始终是加入的范围的精确并集;
+ * 与 BufferedRanges 不同, 数量不受限制, 不会将相距较远的范围合并成一个(覆盖其间未加入的部分);
+ *
+ * 使用示例:
+ * ```
+ * TimeRangeList ranges;
+ * ranges.add(1000000, 3000000);
+ * for ( auto& range : ranges.getRanges() ) { ... }
+ * ```
+ */
+class TimeRangeList {
+public:
+    struct Range {
+        int64_t start;
+        int64_t end;
+    };
+
+    /// 加入范围; start >= end 时忽略;
+    void add(int64_t start, int64_t end);
+    void clear();
+
+    /// 全部范围的副本(按起点排序);
+    std::vector<Range> getRanges() const;
+    size_t size() const;
+
+private:
+    mutable std::mutex mtx;
+    std::vector<Range> ranges;
+};
+
+}
+
+#endif //FFMPEGPROJ_TIMERANGELIST_H
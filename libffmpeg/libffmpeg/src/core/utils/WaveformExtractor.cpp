@@ -0,0 +1,444 @@
+//
+// Created on 2025/6/4.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#include "WaveformExtractor.h"
+#include "SegmentedDecoder.h"
+#include "AudioKernels.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FFAV {
+
+static const char WAVEFORM_MAGIC[4] = { 'F', 'F', 'W', 'F' };
+static const uint32_t WAVEFORM_VERSION = 1;
+static const int WAVEFORM_MAX_LEVELS = 24;
+
+namespace {
+struct WaveformFileHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t sample_rate;
+    int32_t samples_per_peak;
+    int64_t total_samples;
+    uint32_t nb_levels;
+    uint32_t reserved;
+};
+static_assert(sizeof(WaveformFileHeader) == 32, "unexpected header size");
+
+// 当前峰值的累计状态
+struct PeakAccumulator {
+    float min { INFINITY };
+    float max { -INFINITY };
+    double sum_sq { 0 };
+    int64_t nb_values { 0 };
+
+    WaveformPeak finish() {
+        WaveformPeak peak;
+        if ( nb_values > 0 ) {
+            peak.min = min;
+            peak.max = max;
+            peak.rms = (float)std::sqrt(sum_sq / nb_values);
+        }
+        *this = PeakAccumulator();
+        return peak;
+    }
+};
+}
+
+static WaveformPeak merge_peaks(const WaveformPeak& a, int64_t wa, const WaveformPeak& b, int64_t wb) {
+    WaveformPeak peak;
+    peak.min = std::min(a.min, b.min);
+    peak.max = std::max(a.max, b.max);
+    peak.rms = (float)std::sqrt(((double)a.rms * a.rms * wa + (double)b.rms * b.rms * wb) / (wa + wb));
+    return peak;
+}
+
+#pragma mark - Waveform
+
+Waveform::Waveform() = default;
+
+Waveform::~Waveform() {
+    reset();
+}
+
+Waveform::Waveform(Waveform&& other) noexcept {
+    *this = std::move(other);
+}
+
+Waveform& Waveform::operator=(Waveform&& other) noexcept {
+    if ( this != &other ) {
+        reset();
+        sample_rate = other.sample_rate;
+        samples_per_peak = other.samples_per_peak;
+        total_samples = other.total_samples;
+        levels = std::move(other.levels);
+        storage = std::move(other.storage);
+        peaks = other.map_addr ? other.peaks : storage.data();
+        map_addr = other.map_addr;
+        map_size = other.map_size;
+        other.peaks = nullptr;
+        other.map_addr = nullptr;
+        other.map_size = 0;
+        other.reset();
+    }
+    return *this;
+}
+
+void Waveform::reset() {
+    if ( map_addr ) {
+        munmap(map_addr, map_size);
+        map_addr = nullptr;
+        map_size = 0;
+    }
+    sample_rate = 0;
+    samples_per_peak = 0;
+    total_samples = 0;
+    levels.clear();
+    storage.clear();
+    peaks = nullptr;
+}
+
+const WaveformPeak* _Nullable Waveform::getLevel(int level, size_t& count) const {
+    if ( level < 0 || level >= (int)levels.size() ) {
+        count = 0;
+        return nullptr;
+    }
+    count = (size_t)levels[level].count;
+    return peaks + levels[level].offset;
+}
+
+void Waveform::build(std::vector<WaveformPeak>&& base) {
+    levels.clear();
+    storage = std::move(base);
+    levels.push_back({ 0, storage.size() });
+
+    // 最后一个峰值覆盖的采样数可能不足一个完整的宽度, 合并时按采样数加权
+    int64_t width = samples_per_peak;
+    int64_t last_width = total_samples - (int64_t)(storage.size() - 1) * width;
+    if ( storage.empty() || last_width <= 0 ) last_width = width;
+
+    while ( levels.back().count > 1 && (int)levels.size() < WAVEFORM_MAX_LEVELS ) {
+        Level prev = levels.back();
+        Level next = { storage.size(), (prev.count + 1) / 2 };
+        storage.reserve(storage.size() + next.count);
+        for ( uint64_t i = 0; i < next.count; ++i ) {
+            uint64_t a = prev.offset + 2 * i;
+            if ( 2 * i + 1 >= prev.count ) {
+                storage.push_back(storage[a]);
+                continue;
+            }
+            int64_t wb = (2 * i + 2 == prev.count) ? last_width : width;
+            storage.push_back(merge_peaks(storage[a], width, storage[a + 1], wb));
+        }
+        last_width = (prev.count % 2 == 1) ? last_width : width + last_width;
+        width *= 2;
+        levels.push_back(next);
+    }
+    peaks = storage.data();
+}
+
+int Waveform::query(int64_t start_sample, int64_t end_sample, int nb_bins, std::vector<WaveformPeak>& out) const {
+    out.clear();
+    if ( nb_bins <= 0 || levels.empty() ) {
+        return AVERROR(EINVAL);
+    }
+
+    start_sample = std::max<int64_t>(0, start_sample);
+    end_sample = std::min(end_sample, total_samples);
+    out.resize(nb_bins);
+    if ( end_sample <= start_sample ) {
+        return 0;
+    }
+
+    // 选择宽度不超过每个输出峰值所需采样数的最粗层级
+    double samples_per_bin = (double)(end_sample - start_sample) / nb_bins;
+    int level = 0;
+    while ( level + 1 < (int)levels.size() && (double)((int64_t)samples_per_peak << (level + 1)) <= samples_per_bin ) {
+        level += 1;
+    }
+
+    int64_t width = (int64_t)samples_per_peak << level;
+    const WaveformPeak* data = peaks + levels[level].offset;
+    int64_t count = (int64_t)levels[level].count;
+    for ( int i = 0; i < nb_bins; ++i ) {
+        int64_t s0 = start_sample + (int64_t)(samples_per_bin * i);
+        int64_t s1 = start_sample + (int64_t)(samples_per_bin * (i + 1));
+        int64_t first = std::min(s0 / width, count - 1);
+        int64_t last = std::min(std::max(first + 1, (s1 + width - 1) / width), count);
+
+        WaveformPeak peak = data[first];
+        double sum_sq = (double)peak.rms * peak.rms;
+        for ( int64_t k = first + 1; k < last; ++k ) {
+            peak.min = std::min(peak.min, data[k].min);
+            peak.max = std::max(peak.max, data[k].max);
+            sum_sq += (double)data[k].rms * data[k].rms;
+        }
+        peak.rms = (float)std::sqrt(sum_sq / (last - first));
+        out[i] = peak;
+    }
+    return 0;
+}
+
+int Waveform::save(const std::string& path) const {
+    if ( levels.empty() ) {
+        return AVERROR(EINVAL);
+    }
+
+    std::string tmp_path = path + ".tmp";
+    FILE* file = fopen(tmp_path.c_str(), "wb");
+    if ( file == nullptr ) {
+        return AVERROR(errno);
+    }
+
+    WaveformFileHeader header;
+    memcpy(header.magic, WAVEFORM_MAGIC, sizeof(header.magic));
+    header.version = WAVEFORM_VERSION;
+    header.sample_rate = sample_rate;
+    header.samples_per_peak = samples_per_peak;
+    header.total_samples = total_samples;
+    header.nb_levels = (uint32_t)levels.size();
+    header.reserved = 0;
+
+    size_t nb_peaks = (size_t)(levels.back().offset + levels.back().count);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(levels.data(), sizeof(Level), levels.size(), file) == levels.size() &&
+              fwrite(peaks, sizeof(WaveformPeak), nb_peaks, file) == nb_peaks;
+    ok = (fclose(file) == 0) && ok;
+    if ( !ok || rename(tmp_path.c_str(), path.c_str()) != 0 ) {
+        unlink(tmp_path.c_str());
+        return AVERROR(EIO);
+    }
+    return 0;
+}
+
+int Waveform::open(const std::string& path) {
+    reset();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if ( fd < 0 ) {
+        return AVERROR(errno);
+    }
+
+    struct stat st;
+    if ( fstat(fd, &st) != 0 ) {
+        int ret = AVERROR(errno);
+        close(fd);
+        return ret;
+    }
+
+    size_t size = (size_t)st.st_size;
+    if ( size < sizeof(WaveformFileHeader) ) {
+        close(fd);
+        return AVERROR_INVALIDDATA;
+    }
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // 映射建立后即可关闭
+    if ( addr == MAP_FAILED ) {
+        return AVERROR(errno);
+    }
+
+    const WaveformFileHeader* header = (const WaveformFileHeader*)addr;
+    size_t levels_size = (size_t)header->nb_levels * sizeof(Level);
+    bool valid = memcmp(header->magic, WAVEFORM_MAGIC, sizeof(WAVEFORM_MAGIC)) == 0 &&
+                 header->version == WAVEFORM_VERSION &&
+                 header->samples_per_peak > 0 &&
+                 header->nb_levels > 0 && header->nb_levels <= WAVEFORM_MAX_LEVELS &&
+                 size >= sizeof(WaveformFileHeader) + levels_size;
+    if ( valid ) {
+        const Level* file_levels = (const Level*)((const uint8_t*)addr + sizeof(WaveformFileHeader));
+        size_t nb_peaks = (size - sizeof(WaveformFileHeader) - levels_size) / sizeof(WaveformPeak);
+        for ( uint32_t i = 0; i < header->nb_levels && valid; ++i ) {
+            valid = file_levels[i].count > 0 && file_levels[i].offset + file_levels[i].count <= nb_peaks;
+        }
+        if ( valid ) {
+            levels.assign(file_levels, file_levels + header->nb_levels);
+        }
+    }
+
+    if ( !valid ) {
+        munmap(addr, size);
+        return AVERROR_INVALIDDATA;
+    }
+
+    map_addr = addr;
+    map_size = size;
+    sample_rate = header->sample_rate;
+    samples_per_peak = header->samples_per_peak;
+    total_samples = header->total_samples;
+    peaks = (const WaveformPeak*)((const uint8_t*)addr + sizeof(WaveformFileHeader) + levels_size);
+    return 0;
+}
+
+#pragma mark - WaveformExtractor
+
+// 将 frame 转为 float; 交错格式为 1 个平面, 平面格式为 nb_channels 个平面;
+static void frame_to_float(AVFrame* _Nonnull frame, int nb_channels, std::vector<std::vector<float>>& scratch, std::vector<const float*>& planes) {
+    AVSampleFormat fmt = (AVSampleFormat)frame->format;
+    bool planar = av_sample_fmt_is_planar(fmt);
+    int nb_planes = planar ? nb_channels : 1;
+    int nb_values = planar ? frame->nb_samples : frame->nb_samples * nb_channels;
+
+    planes.resize(nb_planes);
+    if ( fmt == AV_SAMPLE_FMT_FLT || fmt == AV_SAMPLE_FMT_FLTP ) {
+        for ( int i = 0; i < nb_planes; ++i ) planes[i] = (const float*)frame->extended_data[i];
+        return;
+    }
+
+    scratch.resize(nb_planes);
+    for ( int i = 0; i < nb_planes; ++i ) {
+        std::vector<float>& dst = scratch[i];
+        dst.resize(nb_values);
+        const uint8_t* src = frame->extended_data[i];
+        switch ( av_get_packed_sample_fmt(fmt) ) {
+            case AV_SAMPLE_FMT_S16:
+                AudioKernels::s16ToFloat(dst.data(), (const int16_t*)src, nb_values);
+                break;
+            case AV_SAMPLE_FMT_S32:
+                for ( int k = 0; k < nb_values; ++k ) dst[k] = (float)((const int32_t*)src)[k] * (1.0f / 2147483648.0f);
+                break;
+            case AV_SAMPLE_FMT_DBL:
+                for ( int k = 0; k < nb_values; ++k ) dst[k] = (float)((const double*)src)[k];
+                break;
+            case AV_SAMPLE_FMT_U8:
+                for ( int k = 0; k < nb_values; ++k ) dst[k] = (float)((int)src[k] - 128) * (1.0f / 128.0f);
+                break;
+            default:
+                std::fill(dst.begin(), dst.end(), 0.0f);
+                break;
+        }
+        planes[i] = dst.data();
+    }
+}
+
+/**
+ * 提取 [start_sample, end_sample) 的第 0 层峰值; start_sample 需要对齐到 samples_per_peak; end_sample 为 -1 时读取到文件末尾;
+ * bins[0] 对应 start_sample 所在的峰值;
+ */
+static int extract_segment(
+    const std::string& url,
+    const SegmentedDecodeOptions& decode_options,
+    int samples_per_peak,
+    int64_t start_sample,
+    int64_t end_sample,
+    std::vector<WaveformPeak>& bins,
+    int64_t* _Nonnull out_end_sample,
+    const std::atomic<bool>* _Nullable cancelled
+) {
+    bins.clear();
+    PeakAccumulator acc;
+    const int64_t first_index = start_sample / samples_per_peak;
+    int64_t acc_index = first_index;
+    std::vector<std::vector<float>> scratch;
+    std::vector<const float*> planes;
+
+    // frame 已裁剪到 [start_sample, end_sample), pts 为采样位置
+    auto on_frame = [&](AVFrame* frame) {
+        int nb_channels = frame->ch_layout.nb_channels;
+        frame_to_float(frame, nb_channels, scratch, planes);
+        bool interleaved = planes.size() == 1 && nb_channels > 1;
+        int stride = interleaved ? nb_channels : 1;
+        int64_t frame_start = frame->pts;
+        int64_t frame_end = frame_start + frame->nb_samples;
+        for ( int64_t s = frame_start; s < frame_end; ) {
+            int64_t index = s / samples_per_peak;
+            int64_t chunk_end = std::min(frame_end, (index + 1) * samples_per_peak);
+            // pts 回退时并入当前峰值
+            if ( index > acc_index ) {
+                // 中间缺失的峰值(pts 不连续)保持为 0
+                bins.resize(acc_index - first_index);
+                bins.push_back(acc.finish());
+                acc_index = index;
+            }
+
+            int offset = (int)(s - frame_start);
+            int count = (int)(chunk_end - s);
+            for ( const float* plane : planes ) {
+                AudioKernels::peakSummary(plane + (size_t)offset * stride, count * stride, acc.min, acc.max, acc.sum_sq);
+            }
+            acc.nb_values += (int64_t)count * nb_channels;
+            s = chunk_end;
+        }
+        return 0;
+    };
+
+    int ret = SegmentedDecoder::decode(url, decode_options, start_sample, end_sample, on_frame, cancelled, out_end_sample);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    if ( acc.nb_values > 0 ) {
+        bins.resize(acc_index - first_index);
+        bins.push_back(acc.finish());
+    }
+    return 0;
+}
+
+int WaveformExtractor::extract(const std::string& url, const WaveformOptions& options, Waveform& waveform, const std::atomic<bool>* _Nullable cancelled) {
+    if ( options.samples_per_peak <= 0 ) {
+        return AVERROR(EINVAL);
+    }
+
+    // 分段边界对齐到第 0 层的峰值, 拼接时不需要合并跨段的峰值
+    int samples_per_peak = options.samples_per_peak;
+    SegmentedDecodeOptions decode_options;
+    decode_options.nb_segments = options.nb_segments;
+    decode_options.alignment = samples_per_peak;
+
+    SegmentPlan plan;
+    int ret = SegmentedDecoder::plan(url, decode_options, plan);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    int nb_segments = plan.getSegmentCount();
+    std::vector<std::vector<WaveformPeak>> segment_bins(nb_segments);
+    std::vector<int64_t> segment_end(nb_segments, 0);
+    ret = SegmentedDecoder::run(nb_segments, [&](int i) {
+        return extract_segment(url, decode_options, samples_per_peak, plan.getStart(i), plan.getEnd(i), segment_bins[i], &segment_end[i], cancelled);
+    });
+
+    // 分段解码失败时退回顺序解码
+    if ( ret < 0 && ret != AVERROR_EXIT && nb_segments > 1 ) {
+        plan.boundaries.assign(1, 0);
+        nb_segments = 1;
+        segment_bins.assign(1, { });
+        segment_end.assign(1, 0);
+        ret = extract_segment(url, decode_options, samples_per_peak, 0, -1, segment_bins[0], &segment_end[0], cancelled);
+    }
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    // 按顺序拼接; 实际解码得到的数据少于预期时补 0 保持对齐
+    int64_t total_bins = (plan.total_samples + samples_per_peak - 1) / samples_per_peak;
+    std::vector<WaveformPeak> base;
+    base.reserve((size_t)total_bins);
+    for ( int i = 0; i < nb_segments; ++i ) {
+        if ( i + 1 < nb_segments ) {
+            segment_bins[i].resize((size_t)((plan.getEnd(i) - plan.getStart(i)) / samples_per_peak));
+        }
+        base.insert(base.end(), segment_bins[i].begin(), segment_bins[i].end());
+    }
+    if ( base.empty() ) {
+        return AVERROR_INVALIDDATA;
+    }
+
+    waveform.reset();
+    waveform.sample_rate = plan.sample_rate;
+    waveform.samples_per_peak = samples_per_peak;
+    waveform.total_samples = std::max(segment_end.back(), (int64_t)(base.size() - 1) * samples_per_peak + 1);
+    waveform.build(std::move(base));
+    return 0;
+}
+
+}
@@ -0,0 +1,124 @@
+//
+// Created on 2025/6/4.
+//
+// Node APIs are not fully supported. To solve the compilation error of the interface cannot be found,
+// please include "napi/native_api.h".
+
+#ifndef FFMPEGPROJ_WAVEFORMEXTRACTOR_H
+#define FFMPEGPROJ_WAVEFORMEXTRACTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FFAV {
+
+/// 一段采样(所有声道)的峰值摘要
+struct WaveformPeak {
+    float min { 0 };
+    float max { 0 };
+    float rms { 0 };
+};
+
+/**
+ * @class Waveform
+ * @brief 多分辨率的波形摘要; 第 0 层每个峰值覆盖 samples_per_peak 个采样, 之后每层覆盖的采样数翻倍;
+ *
+ * 可以保存为缓存文件, 之后通过 open 以 mmap 的方式加载, 不需要读取整个文件即可按任意缩放级别查询;
+ *
+ * 缓存文件格式(本机字节序):
+ * ```
+ * Header { "FFWF", version, sample_rate, samples_per_peak, total_samples, nb_levels, reserved }  // 32 bytes
+ * Level  { offset, count } * nb_levels                                                            // uint64_t, 单位为 WaveformPeak
+ * WaveformPeak[]                                                                                  // 各层依次存放
+ * ```
+ */
+class Waveform {
+public:
+    Waveform();
+    ~Waveform();
+    Waveform(Waveform&& other) noexcept;
+    Waveform& operator=(Waveform&& other) noexcept;
+    Waveform(const Waveform&) = delete;
+    Waveform& operator=(const Waveform&) = delete;
+
+    int getSampleRate() const { return sample_rate; }
+    int getSamplesPerPeak() const { return samples_per_peak; }
+    int64_t getTotalSamples() const { return total_samples; }
+    int getLevelCount() const { return (int)levels.size(); }
+
+    /// 第 level 层的峰值; 每个峰值覆盖 samples_per_peak << level 个采样;
+    const WaveformPeak* _Nullable getLevel(int level, size_t& count) const;
+
+    /// 将 [start_sample, end_sample) 汇总为 nb_bins 个峰值;
+    /// 自动选择分辨率不低于所需的最粗的层级, 每次查询只访问 nb_bins 量级的数据;
+    int query(int64_t start_sample, int64_t end_sample, int nb_bins, std::vector<WaveformPeak>& out) const;
+
+    int save(const std::string& path) const;
+
+    /// 以 mmap 的方式加载缓存文件; 格式不匹配时返回 AVERROR_INVALIDDATA;
+    int open(const std::string& path);
+
+private:
+    friend class WaveformExtractor;
+    struct Level {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    int sample_rate { 0 };
+    int samples_per_peak { 0 };
+    int64_t total_samples { 0 };
+    std::vector<Level> levels;
+    std::vector<WaveformPeak> storage;              // 提取得到的数据
+    const WaveformPeak* _Nullable peaks { nullptr }; // 指向 storage 或 mmap 的数据
+    void* _Nullable map_addr { nullptr };
+    size_t map_size { 0 };
+
+    // 由第 0 层生成其余各层
+    void build(std::vector<WaveformPeak>&& base);
+    void reset();
+};
+
+struct WaveformOptions {
+    int samples_per_peak { 256 };   // 第 0 层的分辨率
+    int nb_segments { 0 };          // 并行解码的分段数; 0 表示使用 CPU 核数, 1 表示顺序解码; 不可 seek 或时长未知时总是顺序解码
+};
+
+/**
+ * @class WaveformExtractor
+ * @brief 基于 SegmentedDecoder 的峰值提取;
+ *
+ * 仅解码, 不经过重采样/filter graph; 峰值统计由 AudioKernels::peakSummary 完成;
+ * 可 seek 的文件按时间分为多段并行解码, 分段边界对齐到第 0 层的峰值, 各段的峰值直接按顺序拼接;
+ * 分段解码失败(例如无法 seek 或缺少 pts)时退回顺序解码;
+ *
+ * 使用示例:
+ * ```
+ * Waveform waveform;
+ * if ( WaveformExtractor::extract("a.flac", { }, waveform) >= 0 ) {
+ *     waveform.save(cache_path);
+ * }
+ *
+ * // 之后
+ * Waveform cached;
+ * cached.open(cache_path);
+ * std::vector<WaveformPeak> bins;
+ * cached.query(0, cached.getTotalSamples(), width, bins);
+ * ```
+ */
+class WaveformExtractor {
+public:
+    static int extract(
+        const std::string& url,
+        const WaveformOptions& options,
+        Waveform& waveform,
+        const std::atomic<bool>* _Nullable cancelled = nullptr
+    );
+};
+
+}
+
+#endif //FFMPEGPROJ_WAVEFORMEXTRACTOR_H
@@ -11,10 +11,19 @@
 #import <CoreMedia/CMTimeRange.h>
 
 @protocol FFAudioItemDelegate;
-@class FFAudioItemOptions;
+@class FFAudioItemOptions, FFAudioTrack, FFAudioSpectrumAnalyzer;
 
 NS_ASSUME_NONNULL_BEGIN
 FOUNDATION_EXPORT NSErrorDomain const FFAudioItemErrorDomain;
+/// 均衡器频段数量; 各频段中心频率(Hz): 31, 62, 125, 250, 500, 1k, 2k, 4k, 8k, 16k;
+FOUNDATION_EXPORT const NSUInteger FFAudioItemEqualizerBandCount;
+
+/// 重采样质量; 仅在输入采样率不是 44100 Hz 时生效;
+typedef NS_ENUM(NSInteger, FFAudioResamplerQuality) {
+    FFAudioResamplerQualityBalanced = 0, // 默认
+    FFAudioResamplerQualityLow, // 低延迟/低 CPU 占用
+    FFAudioResamplerQualityHigh, // 更高的通带平坦度与阻带衰减, CPU 占用更高
+};
 
 /// 固定输出格式: 44100 Hz, 32-bit float, fltp, stereo
 @interface FFAudioItem : NSObject
@@ -25,12 +34,49 @@ FOUNDATION_EXPORT NSErrorDomain const FFAudioItemErrorDomain;
 @property (nonatomic, weak, readonly, nullable) id<FFAudioItemDelegate> delegate;
 
 @property (nonatomic, readonly) CMTime duration;
-@property (nonatomic, readonly) CMTimeRange playableTimeRange;
+@property (nonatomic, readonly) CMTimeRange playableTimeRange; // 从未播放的位置到已读取的末尾;
+/// 全部已缓冲的范围(CMTimeRange), 已合并并按起点排序, 包含 playableTimeRange; 读取快照不加锁;
+@property (nonatomic, copy, readonly) NSArray<NSValue *> *bufferedTimeRanges;
 @property (nonatomic, strong, readonly, nullable) NSError *error;
 
+/// 播放速率, 默认 1.0; 在转码阶段完成变速(不变调), 输出的 pts 仍为媒体时间;
+/// 依赖 libavfilter 中的 atempo; 未包含时只支持 1.0, 设置其他速率无效;
+/// 目前 SJAudioPlayer 使用的 libffmpeg.xcframework 不包含 atempo, 播放器的变速仍由 AVAudioUnitTimePitch 完成, 不使用该属性;
+@property (nonatomic) float rate;
+
+/// 重采样质量, 默认 FFAudioResamplerQualityBalanced; 变更后会在下次转码前重建 filter graph;
+@property (nonatomic) FFAudioResamplerQuality resamplerQuality;
+
+/// 音效; 参数变更通过 filter 命令实时生效; 开启/关闭某一项时会在下次转码前重建 filter graph;
+@property (nonatomic) float volume; // 线性增益, 默认 1.0;
+@property (nonatomic) float replayGain; // 静态增益(dB), 默认 0; 通常使用 FFAudioLoudnessAnalyzer 的分析结果;
+@property (nonatomic, getter=isEqualizerEnabled) BOOL equalizerEnabled;
+- (void)setEqualizerGain:(float)gain forBandAtIndex:(NSUInteger)index; // dB, -24 ~ 24;
+- (float)equalizerGainForBandAtIndex:(NSUInteger)index;
+@property (nonatomic, getter=isDynamicRangeCompressionEnabled) BOOL dynamicRangeCompressionEnabled;
+@property (nonatomic, getter=isLoudnessNormalizationEnabled) BOOL loudnessNormalizationEnabled;
+
+/// 静音裁剪, 默认关闭; 连续超过 silenceMinimumDuration 且低于 silenceThreshold 的静音会被缩短为 silenceKeepDuration(默认 0, 即跳过);
+/// 适用于片头片尾及段落间隙较长的播客/有声书; 输出的 pts 跳过被裁剪的部分, 播放进度保持正确;
+@property (nonatomic, getter=isSilenceTrimmingEnabled) BOOL silenceTrimmingEnabled;
+@property (nonatomic) float silenceThreshold; // dBFS, 默认 -50;
+@property (nonatomic) NSTimeInterval silenceMinimumDuration; // 默认 1.0;
+@property (nonatomic) NSTimeInterval silenceKeepDuration; // 默认 0, 不超过 silenceMinimumDuration;
+/// 被裁剪跳过的范围(CMTimeRange), 按起点排序; 每一段都精确记录(只合并重叠或相接的范围); 不要在渲染线程读取;
+@property (nonatomic, copy, readonly) NSArray<NSValue *> *skippedTimeRanges;
+
+/// 实时频谱; 分析的是最终输出的 pcm(变速及音效之后), 不会给渲染回调增加计算或锁;
+@property (nonatomic, strong, nullable) FFAudioSpectrumAnalyzer *spectrumAnalyzer;
+
+/// 音轨; 准备好(readyToRead)之后可用, 之前为空数组;
+@property (nonatomic, copy, readonly) NSArray<FFAudioTrack *> *audioTracks;
+@property (nonatomic, strong, readonly, nullable) FFAudioTrack *selectedAudioTrack;
+/// 切换音轨; 无需重新打开, 从当前播放位置继续; 切换完成后回调 audioItemDidSeek:;
+- (void)selectAudioTrack:(FFAudioTrack *)track;
+
 - (void)seekToTime:(CMTime)time;
 
-/// 返回值小于0表示报错
+/// 返回值小于0表示报错; outError 可以为 NULL, 此时不创建 NSError
 - (int)tryTranscodeWithFrameCapacity:(int)frameCapacity data:(void *_Nonnull*_Nonnull)outData pts:(int64_t *)outPts eof:(BOOL *)outEOF error:(NSError **)outError;
 @end
 
@@ -38,11 +84,23 @@ FOUNDATION_EXPORT NSErrorDomain const FFAudioItemErrorDomain;
 @property (nonatomic) CMTime startTimePosition; // 默认 kCMTimeZero;
 @end
 
+@interface FFAudioTrack : NSObject
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+@property (nonatomic, readonly) NSInteger trackID; // 流的索引
+@property (nonatomic, copy, readonly, nullable) NSString *languageCode; // ISO 639-2, 例如 "eng", "chi"
+@property (nonatomic, copy, readonly, nullable) NSString *title;
+@property (nonatomic, copy, readonly) NSString *codecName;
+@property (nonatomic, readonly) int sampleRate;
+@property (nonatomic, readonly) int channels;
+@property (nonatomic, readonly, getter=isDefaultTrack) BOOL defaultTrack; // 容器中标记为默认的音轨
+@end
+
 // 在子线程回调
 @protocol FFAudioItemDelegate <NSObject>
 - (void)audioItemDidReadyToRead:(FFAudioItem *)item; // 可以通过`readBufferWithPts:`读取数据了;
 - (void)audioItem:(FFAudioItem *)item anErrorOccurred:(NSError *)error; // 发生了不可恢复的错误;
-- (void)audioItem:(FFAudioItem *)item playableTimeRangeDidChange:(CMTimeRange)timeRange;
+- (void)audioItem:(FFAudioItem *)item playableTimeRangeDidChange:(CMTimeRange)timeRange; // 合并通知: 范围跳变(seek)、eof 及缓冲已满时立即回调, 其余变化最多每 100ms 回调一次;
 - (void)audioItemDidSeek:(FFAudioItem *)item; // seek 完成的回调
 @end
 NS_ASSUME_NONNULL_END
@@ -6,11 +6,24 @@
 //
 
 #import "FFAudioItem.h"
+#import "FFAudioSpectrumAnalyzer.h"
 #import "FFCoreAudioReader.h"
 #import "FFCoreAudioTranscoder.h"
+#import <AVFoundation/AVTime.h>
+#include "BufferedRanges.h"
+#include "CommandChannel.h"
 #include <mutex>
 
 NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
+const NSUInteger FFAudioItemEqualizerBandCount = FFAV::AudioEffectChain::EQ_BAND_COUNT;
+
+@interface FFAudioTrack ()
+- (instancetype)initWithStream:(AVStream *)stream;
+@end
+
+@interface FFAudioSpectrumAnalyzer (Internal)
+@property (nonatomic, readonly) std::shared_ptr<FFAV::SpectrumAnalyzer> core;
+@end
 
 @interface FFAudioItem ()<FFCoreAudioReaderDelegate>
 
@@ -25,19 +38,26 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
     int64_t mStartTimePosition; // in base q
     
     std::atomic<bool> mReadyToRead;
-    std::atomic<CMTimeRange> mPlayableTimeRange;
+    FFAV::BufferedRanges *mBufferedRanges; // 在 mtx 中更新, 读取快照不需要加锁
+    
+    NSArray<FFAudioTrack *> *mAudioTracks;
+    FFAudioTrack *mSelectedAudioTrack;
+    int mAudioStreamIndex; // transcoder 当前使用的流
+    int64_t mLastOutputPts; // 最近一次输出的 pts(媒体时间, 输出采样率); 用于切换音轨时确定位置
     
     BOOL mHasError;
-    BOOL mSeeking; // seeking 的时候会停止接收pkt和转码操作, 等待seek操作完成后继续;
+    // seek/切换音轨时记录 reader 返回的命令 generation; 小于该值的 packet 为过期数据, 直接丢弃;
+    // transcoder 按该命令 flush 之前(applied < requested)停止转码输出; 两者均可无锁读取;
+    FFAV::GenerationGate mGenerationGate;
     
     BOOL mShouldReprepareReader;
-    BOOL mSeekedBeforeReprepareReader;
     BOOL mShouldOnlyFlushPackets; // flush 时是否仅清空 packets 的缓存
     
     std::mutex mtx;
     
     FFCoreAudioReader *mAudioReader;
     FFCoreAudioTranscoder *mAudioTranscoder;
+    FFAudioSpectrumAnalyzer *mSpectrumAnalyzer;
 }
 
 - (instancetype)initWithURL:(NSURL *)URL options:(nullable FFAudioItemOptions *)options delegate:(id<FFAudioItemDelegate>)delegate {
@@ -48,7 +68,10 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
     mDuration = kCMTimeZero;
     
     mReadyToRead.store(false, std::__1::memory_order_relaxed);
-    mPlayableTimeRange.store(kCMTimeRangeZero, std::__1::memory_order_relaxed);
+    mBufferedRanges = new FFAV::BufferedRanges();
+    mAudioTracks = @[];
+    mAudioStreamIndex = -1;
+    mLastOutputPts = 0;
     
     mAudioReader = [FFCoreAudioReader.alloc initWithURL:URL delegate:self];
     
@@ -71,6 +94,7 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
     [mAudioReader stop];
     mAudioReader = nil;
     mAudioTranscoder = nil;
+    delete mBufferedRanges;
 }
 
 - (BOOL)isReadyToRead {
@@ -82,7 +106,22 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
 }
 
 - (CMTimeRange)playableTimeRange {
-    return mPlayableTimeRange.load(std::__1::memory_order_relaxed);
+    FFAV::BufferedRanges::Range range;
+    if ( !mBufferedRanges->getActive(range) ) {
+        return kCMTimeRangeZero;
+    }
+    return CMTimeRangeFromTimeToTime(CMTimeMake(range.start, AV_TIME_BASE), CMTimeMake(range.end, AV_TIME_BASE));
+}
+
+- (NSArray<NSValue *> *)bufferedTimeRanges {
+    FFAV::BufferedRanges::Range ranges[FFAV::BufferedRanges::MAX_RANGES];
+    int count = mBufferedRanges->getRanges(ranges, FFAV::BufferedRanges::MAX_RANGES);
+    NSMutableArray<NSValue *> *timeRanges = [NSMutableArray arrayWithCapacity:count];
+    for ( int i = 0; i < count; ++i ) {
+        CMTimeRange timeRange = CMTimeRangeFromTimeToTime(CMTimeMake(ranges[i].start, AV_TIME_BASE), CMTimeMake(ranges[i].end, AV_TIME_BASE));
+        [timeRanges addObject:[NSValue valueWithCMTimeRange:timeRange]];
+    }
+    return timeRanges;
 }
 
 - (AVAudioFormat *)outputFormat {
@@ -94,24 +133,219 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
     return mError;
 }
 
-- (void)seekToTime:(CMTime)time {
+- (void)setRate:(float)rate {
+    std::lock_guard<std::mutex> lock(mtx);
+    [mAudioTranscoder setRate:rate];
+    // 缓冲阈值随速率变化
+    if ( mReadyToRead.load(std::__1::memory_order_relaxed) && !mAudioTranscoder.isPacketBufferFull ) {
+        [mAudioReader setPacketBufferFull:NO];
+    }
+}
+
+- (float)rate {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.rate;
+}
+
+- (void)setResamplerQuality:(FFAudioResamplerQuality)resamplerQuality {
+    std::lock_guard<std::mutex> lock(mtx);
+    switch ( resamplerQuality ) {
+        case FFAudioResamplerQualityLow:
+            mAudioTranscoder.resampleQuality = FFAV::ResampleQuality::Low;
+            break;
+        case FFAudioResamplerQualityHigh:
+            mAudioTranscoder.resampleQuality = FFAV::ResampleQuality::High;
+            break;
+        default:
+            mAudioTranscoder.resampleQuality = FFAV::ResampleQuality::Balanced;
+            break;
+    }
+}
+
+- (FFAudioResamplerQuality)resamplerQuality {
+    std::lock_guard<std::mutex> lock(mtx);
+    switch ( mAudioTranscoder.resampleQuality ) {
+        case FFAV::ResampleQuality::Low:
+            return FFAudioResamplerQualityLow;
+        case FFAV::ResampleQuality::High:
+            return FFAudioResamplerQualityHigh;
+        case FFAV::ResampleQuality::Balanced:
+            return FFAudioResamplerQualityBalanced;
+    }
+}
+
+- (void)setVolume:(float)volume {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.effects->setVolume(volume);
+}
+
+- (float)volume {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.effects->getVolume();
+}
+
+- (void)setReplayGain:(float)replayGain {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.effects->setReplayGain(replayGain);
+}
+
+- (float)replayGain {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.effects->getReplayGain();
+}
+
+- (void)setEqualizerEnabled:(BOOL)equalizerEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.effects->setEqualizerEnabled(equalizerEnabled);
+}
+
+- (BOOL)isEqualizerEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.effects->isEqualizerEnabled();
+}
+
+- (void)setEqualizerGain:(float)gain forBandAtIndex:(NSUInteger)index {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.effects->setEqualizerGain((int)index, gain);
+}
+
+- (float)equalizerGainForBandAtIndex:(NSUInteger)index {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.effects->getEqualizerGain((int)index);
+}
+
+- (void)setDynamicRangeCompressionEnabled:(BOOL)dynamicRangeCompressionEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.effects->setCompressorEnabled(dynamicRangeCompressionEnabled);
+}
+
+- (BOOL)isDynamicRangeCompressionEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.effects->isCompressorEnabled();
+}
+
+- (void)setLoudnessNormalizationEnabled:(BOOL)loudnessNormalizationEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.effects->setLoudnessNormalizationEnabled(loudnessNormalizationEnabled);
+}
+
+- (BOOL)isLoudnessNormalizationEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.effects->isLoudnessNormalizationEnabled();
+}
+
+- (void)setSilenceTrimmingEnabled:(BOOL)silenceTrimmingEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.silenceTrimmer->setEnabled(silenceTrimmingEnabled);
+}
+
+- (BOOL)isSilenceTrimmingEnabled {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.silenceTrimmer->isEnabled();
+}
+
+- (void)setSilenceThreshold:(float)silenceThreshold {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.silenceTrimmer->setThreshold(silenceThreshold);
+}
+
+- (float)silenceThreshold {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.silenceTrimmer->getThreshold();
+}
+
+- (void)setSilenceMinimumDuration:(NSTimeInterval)silenceMinimumDuration {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.silenceTrimmer->setMinimumDuration(silenceMinimumDuration);
+}
+
+- (NSTimeInterval)silenceMinimumDuration {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.silenceTrimmer->getMinimumDuration();
+}
+
+- (void)setSilenceKeepDuration:(NSTimeInterval)silenceKeepDuration {
+    std::lock_guard<std::mutex> lock(mtx);
+    mAudioTranscoder.silenceTrimmer->setKeepDuration(silenceKeepDuration);
+}
+
+- (NSTimeInterval)silenceKeepDuration {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTranscoder.silenceTrimmer->getKeepDuration();
+}
+
+- (NSArray<NSValue *> *)skippedTimeRanges {
+    std::vector<FFAV::TimeRangeList::Range> ranges = mAudioTranscoder.skippedRanges->getRanges();
+    NSMutableArray<NSValue *> *timeRanges = [NSMutableArray arrayWithCapacity:ranges.size()];
+    for ( auto& range : ranges ) {
+        CMTimeRange timeRange = CMTimeRangeFromTimeToTime(CMTimeMake(range.start, AV_TIME_BASE), CMTimeMake(range.end, AV_TIME_BASE));
+        [timeRanges addObject:[NSValue valueWithCMTimeRange:timeRange]];
+    }
+    return timeRanges;
+}
+
+- (void)setSpectrumAnalyzer:(nullable FFAudioSpectrumAnalyzer *)spectrumAnalyzer {
+    std::lock_guard<std::mutex> lock(mtx);
+    mSpectrumAnalyzer = spectrumAnalyzer;
+    mAudioTranscoder.spectrumAnalyzer = spectrumAnalyzer != nil ? spectrumAnalyzer.core : nullptr;
+}
+
+- (nullable FFAudioSpectrumAnalyzer *)spectrumAnalyzer {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mSpectrumAnalyzer;
+}
+
+- (NSArray<FFAudioTrack *> *)audioTracks {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mAudioTracks;
+}
+
+- (nullable FFAudioTrack *)selectedAudioTrack {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mSelectedAudioTrack;
+}
+
+- (void)selectAudioTrack:(FFAudioTrack *)track {
     std::lock_guard<std::mutex> lock(mtx);
     if ( !mReadyToRead.load(std::__1::memory_order_relaxed) || mHasError ) {
         return;
     }
     
-    mSeeking = true;
+    if ( track == mSelectedAudioTrack || ![mAudioTracks containsObject:track] ) {
+        return;
+    }
+    
+    mSelectedAudioTrack = track;
+    
+    // 从当前播放位置继续
+    int64_t time = av_rescale(mLastOutputPts, AV_TIME_BASE, (int64_t)mAudioTranscoder.outputFormat.sampleRate);
+    mStartTimePosition = time;
+    mGenerationGate.request([mAudioReader switchToStreamAtIndex:(int)track.trackID time:time]);
+    if ( mShouldReprepareReader ) {
+        // 等待重新 prepare 的 reader 会直接选择该流
+        mShouldOnlyFlushPackets = false;
+        [self _reprepareReaderWithStartTimePosition:mStartTimePosition];
+        mGenerationGate.request(mAudioReader.generation);
+    }
+}
+
+- (void)seekToTime:(CMTime)time {
+    std::lock_guard<std::mutex> lock(mtx);
+    if ( !mReadyToRead.load(std::__1::memory_order_relaxed) || mHasError ) {
+        return;
+    }
     
     int64_t seekTime = av_rescale_q(time.value, (AVRational){ 1, time.timescale }, AV_TIME_BASE_Q);
+    mLastOutputPts = av_rescale(seekTime, (int64_t)mAudioTranscoder.outputFormat.sampleRate, AV_TIME_BASE);
+    mStartTimePosition = seekTime; // 完成之前 reader 报错时, 从 seekTime 重新 prepare;
     if ( mShouldReprepareReader ) {
-        mSeekedBeforeReprepareReader = true;
         mShouldOnlyFlushPackets = false;
-        mStartTimePosition = seekTime; // 修改 startTimePos 为 seekTime;
         [self _reprepareReaderWithStartTimePosition:mStartTimePosition];
+        mGenerationGate.request(mAudioReader.generation);
         return;
     }
     
-    [mAudioReader seekToTime:seekTime];
+    mGenerationGate.request([mAudioReader seekToTime:seekTime]);
 }
 
 #pragma mark - FFCoreAudioReaderDelegate
@@ -120,7 +354,18 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
     std::unique_lock<std::mutex> lock(mtx);
     // reprepared
     if ( mReadyToRead.load(std::__1::memory_order_relaxed) ) {
-        mSeekedBeforeReprepareReader = false;
+        // 等待重新 prepare 期间切换了音轨
+        if ( audio->index != mAudioStreamIndex ) {
+            int ff_ret = [self _switchToAudioStream:audio];
+            if ( ff_ret < 0 ) {
+                NSError *error = [self _makeError:ff_ret];
+                mError = error;
+                [mAudioReader stop];
+                lock.unlock();
+                [_delegate audioItem:self anErrorOccurred:error];
+                return;
+            }
+        }
         [reader start];
         return;
     }
@@ -130,6 +375,18 @@ NSErrorDomain const FFAudioItemErrorDomain = @"FFAudioItemErrorDomain";
         goto on_exit;
     }
     
+    // tracks
+    {
+        NSMutableArray<FFAudioTrack *> *tracks = [NSMutableArray array];
+        for ( AVStream *stream : reader.audioStreams ) {
+            FFAudioTrack *track = [FFAudioTrack.alloc initWithStream:stream];
+            [tracks addObject:track];
+            if ( stream->index == audio->index ) mSelectedAudioTrack = track;
+        }
+        mAudioTracks = tracks.copy;
+        mAudioStreamIndex = audio->index;
+    }
+    
     // ready
     mDuration = CMTimeMake(audio->duration * audio->time_base.num, audio->time_base.den);
     mReadyToRead.store(true, std::__1::memory_order_relaxed);
@@ -152,6 +409,18 @@ on_exit:
     [_delegate audioItemDidReadyToRead:self];
 }
 
+- (void)audioReader:(FFCoreAudioReader *)reader didSwitchToStream:(AVStream *)stream {
+    std::unique_lock<std::mutex> lock(mtx);
+    int ff_ret = [self _switchToAudioStream:stream];
+    if ( ff_ret < 0 ) {
+        NSError *error = [self _makeError:ff_ret];
+        mError = error;
+        [mAudioReader stop];
+        lock.unlock();
+        [_delegate audioItem:self anErrorOccurred:error];
+    }
+}
+
 - (void)audioReader:(FFCoreAudioReader *)reader anErrorOccurred:(int)ff_err {
     std::unique_lock<std::mutex> lock(mtx);
     if ( ff_err == AVERROR(EIO) ||
@@ -177,20 +446,23 @@ on_exit:
     [_delegate audioItem:self anErrorOccurred:error];
 }
 
-- (void)audioReader:(FFCoreAudioReader *)reader didReadPacket:(AVPacket *_Nullable)packet shouldFlush:(BOOL)shouldFlush {
+- (void)audioReader:(FFCoreAudioReader *)reader didReadPacket:(AVPacket *_Nullable)packet generation:(uint64_t)generation shouldFlush:(BOOL)shouldFlush {
+    // 之后又有新的 seek/切换音轨, 过期的数据直接丢弃
+    if ( mGenerationGate.isOutdated(generation) ) {
+        return;
+    }
+    
     std::unique_lock<std::mutex> lock(mtx);
+    // 等待锁期间可能有新的请求
+    if ( mGenerationGate.isOutdated(generation) ) {
+        return;
+    }
     
     if ( shouldFlush ) {
-        mSeeking = false;
-        mSeekedBeforeReprepareReader = false;
-    }
-
-    // return if seeking
-    if ( mSeeking ) {
-        return;
+        mGenerationGate.apply(generation);
     }
 
-    CMTimeRange timeRange = kCMTimeRangeZero;
+    BOOL shouldNotifyTimeRange = NO;
     
     // push pkt
     int ff_ret = 0;
@@ -210,9 +482,17 @@ on_exit:
         mAudioReader.packetBufferFull = true;
     }
     
-    // update time range
-    timeRange = mAudioTranscoder.timeRange;
-    mPlayableTimeRange.store(timeRange, std::__1::memory_order_relaxed);
+    // update time range; 合并通知, eof、seek 完成及缓冲已满时立即通知
+    {
+        int64_t start = 0, end = 0;
+        if ( [mAudioTranscoder getBufferedRangeStart:&start end:&end] ) {
+            mBufferedRanges->setActive(start, end);
+        }
+        else {
+            mBufferedRanges->clearActive();
+        }
+        shouldNotifyTimeRange = mBufferedRanges->publish(packet == nullptr || shouldFlush || mAudioTranscoder.isPacketBufferFull);
+    }
     
 on_exit:
     NSError *error = nil;
@@ -229,7 +509,9 @@ on_exit:
         return;
     }
     
-    [_delegate audioItem:self playableTimeRangeDidChange:timeRange];
+    if ( shouldNotifyTimeRange ) {
+        [_delegate audioItem:self playableTimeRangeDidChange:self.playableTimeRange];
+    }
     
     if ( shouldFlush ) {
         [_delegate audioItemDidSeek:self];
@@ -237,17 +519,22 @@ on_exit:
 }
 
 - (int)tryTranscodeWithFrameCapacity:(int)frameCapacity data:(void *_Nonnull*_Nonnull)outData pts:(int64_t *)outPts eof:(BOOL *)outEOF error:(NSError **)outError {
-    if ( !mReadyToRead.load(std::__1::memory_order_relaxed) || mSeeking ) {
+    if ( !mReadyToRead.load(std::__1::memory_order_relaxed) || [self _isSeeking] ) {
         return 0;
     }
     
     std::unique_lock<std::mutex> lock(mtx);
+    // 等待锁期间可能有新的 seek
+    if ( [self _isSeeking] ) {
+        return 0;
+    }
     int ret = [mAudioTranscoder tryTranscodeWithFrameCapacity:frameCapacity data:outData pts:outPts eof:outEOF];
-    if ( ret < 0 ) {
-        NSError *error = [self _makeError:ret];
-        if ( outError ) {
-            *outError = error;
-        }
+    if ( ret > 0 && outPts ) {
+        mLastOutputPts = *outPts;
+    }
+    // outError 为 NULL 时不创建 NSError(渲染线程中不分配内存)
+    if ( ret < 0 && outError ) {
+        *outError = [self _makeError:ret];
     }
     
     if ( !mAudioTranscoder.isPacketBufferFull ) {
@@ -258,12 +545,34 @@ on_exit:
 
 #pragma mark - mark
 
+// seeking 的时候停止转码输出, 等待 transcoder 按最新的命令 flush 后继续;
+- (BOOL)_isSeeking {
+    return mGenerationGate.isPending();
+}
+
 - (NSError *)_makeError:(int)ff_err {
     return [NSError errorWithDomain:FFAudioItemErrorDomain code:-1 userInfo:@{
         NSLocalizedDescriptionKey: [NSString stringWithFormat:@"%s", av_err2str(ff_err)]
     }];
 }
 
+- (int)_switchToAudioStream:(AVStream *)stream {
+    int ff_ret = [mAudioTranscoder switchToAudioStream:stream];
+    if ( ff_ret < 0 ) {
+        return ff_ret;
+    }
+    
+    mAudioStreamIndex = stream->index;
+    mDuration = CMTimeMake(stream->duration * stream->time_base.num, stream->time_base.den);
+    for ( FFAudioTrack *track in mAudioTracks ) {
+        if ( track.trackID == stream->index ) {
+            mSelectedAudioTrack = track;
+            break;
+        }
+    }
+    return 0;
+}
+
 - (void)_setNeedsReprepareReader {
     mShouldReprepareReader = true;
     __weak typeof(self) _self = self;
@@ -281,10 +590,11 @@ on_exit:
         // 例如网络不通时延迟n秒后重试
         // 如果之前未完成初始化, 则直接重新创建 reader 即可;
         // 如果已完成初始化, 则需要考虑读取的开始位置;
-        // - 等待期间用户可能调用seek, 需要从seek的位置开始播放(模糊位置)
+        // - 等待期间用户可能调用seek(或报错时 seek 还未完成), 需要从seek的位置开始播放(模糊位置)
         // - 如果未执行seek操作, 则需要从当前位置开始播放(精确位置), 需要在解码时对齐数据
-        if ( !mReadyToRead || mSeekedBeforeReprepareReader ) {
+        if ( !mReadyToRead || [self _isSeeking] ) {
             [self _reprepareReaderWithStartTimePosition:mStartTimePosition];
+            mGenerationGate.request(mAudioReader.generation);
             return;
         }
         
@@ -307,6 +617,22 @@ on_exit:
 @end
 
 
+@implementation FFAudioTrack
+- (instancetype)initWithStream:(AVStream *)stream {
+    self = [super init];
+    AVDictionaryEntry *language = av_dict_get(stream->metadata, "language", nullptr, 0);
+    AVDictionaryEntry *title = av_dict_get(stream->metadata, "title", nullptr, 0);
+    _trackID = stream->index;
+    _languageCode = language ? [NSString stringWithUTF8String:language->value] : nil;
+    _title = title ? [NSString stringWithUTF8String:title->value] : nil;
+    _codecName = [NSString stringWithUTF8String:avcodec_get_name(stream->codecpar->codec_id)];
+    _sampleRate = stream->codecpar->sample_rate;
+    _channels = stream->codecpar->ch_layout.nb_channels;
+    _defaultTrack = (stream->disposition & AV_DISPOSITION_DEFAULT) != 0;
+    return self;
+}
+@end
+
 @implementation FFAudioItemOptions
 - (instancetype)init {
     self = [super init];
@@ -0,0 +1,35 @@
+//
+//  FFAudioLoudnessAnalyzer.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/5/26.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+/// EBU R128 响度分析结果
+@interface FFAudioLoudness : NSObject
+@property (nonatomic, readonly) double integratedLoudness; // LUFS
+@property (nonatomic, readonly) double loudnessRange; // LU
+@property (nonatomic, readonly) double truePeak; // dBTP
+/// 将综合响度调整到 targetLoudness 所需的静态增益(dB), 同时保证真峰值不超过 -1 dBTP, 提升不超过 12 dB; 静音时为 0; 可直接设置给 FFAudioItem.replayGain;
+- (float)replayGainForTargetLoudness:(double)targetLoudness;
+@end
+
+/// 离线响度分析; 仅解码, 多个文件在后台线程并发分析; 结果会缓存, 设置 cachePath 时持久化到文件;
+@interface FFAudioLoudnessAnalyzer : NSObject
+- (instancetype)initWithCachePath:(nullable NSString *)cachePath;
+
+/// 已缓存的结果; 未分析过时返回 nil;
+- (nullable FFAudioLoudness *)cachedLoudnessForURL:(NSURL *)URL;
+
+/// 在后台分析(已缓存的直接返回); 每个文件完成后在子线程回调, 全部完成后回调 completion 并保存缓存;
+- (void)analyzeURLs:(NSArray<NSURL *> *)URLs
+        resultHandler:(void(^_Nullable)(NSURL *URL, FFAudioLoudness *_Nullable loudness, NSError *_Nullable error))resultHandler
+        completion:(void(^_Nullable)(void))completion;
+
+/// 取消尚未开始的分析;
+- (void)cancel;
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,122 @@
+//
+//  FFAudioLoudnessAnalyzer.m
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/5/26.
+//
+
+#import "FFAudioLoudnessAnalyzer.h"
+#import "FFAudioItem.h"
+#include "LoudnessAnalyzer.h"
+#include <atomic>
+#include <vector>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+@interface FFAudioLoudness ()
+- (instancetype)initWithResult:(const FFAV::LoudnessResult &)result;
+@end
+
+@implementation FFAudioLoudness {
+    FFAV::LoudnessResult mResult;
+}
+
+- (instancetype)initWithResult:(const FFAV::LoudnessResult &)result {
+    self = [super init];
+    mResult = result;
+    return self;
+}
+
+- (double)integratedLoudness {
+    return mResult.integrated;
+}
+
+- (double)loudnessRange {
+    return mResult.loudness_range;
+}
+
+- (double)truePeak {
+    return mResult.true_peak;
+}
+
+- (float)replayGainForTargetLoudness:(double)targetLoudness {
+    return (float)mResult.getGain(targetLoudness);
+}
+@end
+
+@implementation FFAudioLoudnessAnalyzer {
+    FFAV::LoudnessCache *mCache;
+    std::atomic<bool> mCancelled;
+    dispatch_queue_t mQueue;
+}
+
+- (instancetype)initWithCachePath:(nullable NSString *)cachePath {
+    self = [super init];
+    mCache = new FFAV::LoudnessCache(cachePath != nil ? cachePath.UTF8String : "");
+    mCache->load();
+    mCancelled.store(false, std::__1::memory_order_relaxed);
+    mQueue = dispatch_queue_create("com.lwz.ffmpeg.loudness", DISPATCH_QUEUE_SERIAL);
+    return self;
+}
+
+- (void)dealloc {
+    mCancelled.store(true, std::__1::memory_order_relaxed);
+    // 分析任务持有 self, 执行到这里时已没有进行中的任务
+    delete mCache;
+}
+
+- (nullable FFAudioLoudness *)cachedLoudnessForURL:(NSURL *)URL {
+    FFAV::LoudnessResult result;
+    if ( !mCache->get(URL.absoluteString.UTF8String, result) ) {
+        return nil;
+    }
+    return [FFAudioLoudness.alloc initWithResult:result];
+}
+
+- (void)analyzeURLs:(NSArray<NSURL *> *)URLs
+        resultHandler:(void(^_Nullable)(NSURL *URL, FFAudioLoudness *_Nullable loudness, NSError *_Nullable error))resultHandler
+        completion:(void(^_Nullable)(void))completion {
+    mCancelled.store(false, std::__1::memory_order_relaxed);
+    NSArray<NSURL *> *items = URLs.copy;
+    dispatch_async(mQueue, ^{
+        NSMutableArray<NSURL *> *pending = [NSMutableArray arrayWithCapacity:items.count];
+        std::vector<std::string> urls;
+        for ( NSURL *URL in items ) {
+            FFAudioLoudness *cached = [self cachedLoudnessForURL:URL];
+            if ( cached != nil ) {
+                if ( resultHandler ) resultHandler(URL, cached, nil);
+                continue;
+            }
+            [pending addObject:URL];
+            urls.push_back(URL.isFileURL ? URL.path.UTF8String : URL.absoluteString.UTF8String);
+        }
+
+        FFAV::LoudnessAnalyzer::analyzeConcurrently(urls, 0, [&](size_t index, int ret, const FFAV::LoudnessResult& result) {
+            NSURL *URL = pending[index];
+            if ( ret < 0 ) {
+                if ( resultHandler ) resultHandler(URL, nil, [self _makeError:ret]);
+                return;
+            }
+            self->mCache->put(URL.absoluteString.UTF8String, result);
+            if ( resultHandler ) resultHandler(URL, [FFAudioLoudness.alloc initWithResult:result], nil);
+        }, &self->mCancelled);
+
+        self->mCache->save();
+        if ( completion ) completion();
+    });
+}
+
+- (void)cancel {
+    mCancelled.store(true, std::__1::memory_order_relaxed);
+}
+
+#pragma mark - mark
+
+- (NSError *)_makeError:(int)ff_err {
+    return [NSError errorWithDomain:FFAudioItemErrorDomain code:-1 userInfo:@{
+        NSLocalizedDescriptionKey: [NSString stringWithFormat:@"%s", av_err2str(ff_err)]
+    }];
+}
+@end
@@ -0,0 +1,28 @@
+//
+//  FFAudioSpectrumAnalyzer.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/9.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+/// 播放时的实时频谱; 设置给 FFAudioItem.spectrumAnalyzer 后生效;
+///
+/// 渲染线程只将输出的 pcm 复制到无锁的环形缓冲中; 下混、加窗及 FFT 在内部的串行队列中按 updateRate 进行;
+@interface FFAudioSpectrumAnalyzer : NSObject
+/// fftSize 为 2 的整数次幂(64 ~ 32768), 默认 2048; bandCount 默认 32, 在 40 Hz ~ 16 kHz 内按对数均分;
+- (instancetype)initWithFFTSize:(NSUInteger)fftSize bandCount:(NSUInteger)bandCount;
+
+@property (nonatomic, readonly) NSUInteger fftSize;
+@property (nonatomic, readonly) NSUInteger bandCount;
+
+/// 每秒更新的次数, 范围 1 ~ 120, 默认 30;
+@property (nonatomic) double updateRate;
+
+/// 在子线程回调; magnitudes 为 bandCount 个线性幅度(满幅的正弦波约为 1.0), 仅在回调期间有效;
+/// 没有新数据时(例如暂停)不回调; 设置为 nil 时停止分析;
+@property (nonatomic, copy, nullable) void(^updateHandler)(const float *magnitudes, NSUInteger count);
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,114 @@
+//
+//  FFAudioSpectrumAnalyzer.m
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/9.
+//
+
+#import "FFAudioSpectrumAnalyzer.h"
+#import "FFCoreFormat.h"
+#include "SpectrumAnalyzer.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+@interface FFAudioSpectrumAnalyzer (Internal)
+@property (nonatomic, readonly) std::shared_ptr<FFAV::SpectrumAnalyzer> core;
+@end
+
+@implementation FFAudioSpectrumAnalyzer {
+    std::shared_ptr<FFAV::SpectrumAnalyzer> mCore;
+    std::vector<float> mBands; // 仅在 mQueue 中访问
+    dispatch_queue_t mQueue;
+    dispatch_source_t mTimer;
+    BOOL mTimerRunning;
+    double mUpdateRate;
+    void(^mUpdateHandler)(const float *magnitudes, NSUInteger count);
+    std::mutex mtx;
+}
+
+- (instancetype)init {
+    return [self initWithFFTSize:2048 bandCount:32];
+}
+
+- (instancetype)initWithFFTSize:(NSUInteger)fftSize bandCount:(NSUInteger)bandCount {
+    self = [super init];
+    FFAV::SpectrumOptions options;
+    options.fft_size = (int)fftSize;
+    options.nb_bands = (int)bandCount;
+    mCore = std::make_shared<FFAV::SpectrumAnalyzer>(FFCoreFormat::FF_OUTPUT_SAMPLE_RATE, FFCoreFormat::FF_OUTPUT_CHANNELS, options);
+    mBands.assign(mCore->getBandCount(), 0.f);
+    mQueue = dispatch_queue_create("com.lwz.ffmpeg.spectrum", DISPATCH_QUEUE_SERIAL);
+    mTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, mQueue);
+    __weak typeof(self) _self = self;
+    dispatch_source_set_event_handler(mTimer, ^{
+        __strong typeof(_self) self = _self;
+        if ( self == nil ) return;
+        [self _update];
+    });
+    mUpdateRate = 30;
+    [self _resetTimerInterval];
+    return self;
+}
+
+- (void)dealloc {
+    // 挂起状态的 source 不能直接释放
+    if ( !mTimerRunning ) dispatch_resume(mTimer);
+    dispatch_source_cancel(mTimer);
+}
+
+- (NSUInteger)fftSize {
+    return mCore->getFFTSize();
+}
+
+- (NSUInteger)bandCount {
+    return mCore->getBandCount();
+}
+
+- (void)setUpdateRate:(double)updateRate {
+    std::lock_guard<std::mutex> lock(mtx);
+    mUpdateRate = std::clamp(updateRate, 1.0, 120.0);
+    [self _resetTimerInterval];
+}
+
+- (double)updateRate {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mUpdateRate;
+}
+
+- (void)setUpdateHandler:(void (^_Nullable)(const float * _Nonnull, NSUInteger))updateHandler {
+    std::lock_guard<std::mutex> lock(mtx);
+    mUpdateHandler = [updateHandler copy];
+    BOOL shouldRun = mUpdateHandler != nil;
+    if ( shouldRun != mTimerRunning ) {
+        if ( shouldRun ) dispatch_resume(mTimer);
+        else dispatch_suspend(mTimer);
+        mTimerRunning = shouldRun;
+    }
+}
+
+- (void (^_Nullable)(const float * _Nonnull, NSUInteger))updateHandler {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mUpdateHandler;
+}
+
+- (std::shared_ptr<FFAV::SpectrumAnalyzer>)core {
+    return mCore;
+}
+
+#pragma mark - mark
+
+- (void)_resetTimerInterval {
+    uint64_t interval = (uint64_t)(NSEC_PER_SEC / mUpdateRate);
+    dispatch_source_set_timer(mTimer, dispatch_time(DISPATCH_TIME_NOW, interval), interval, interval / 10);
+}
+
+- (void)_update {
+    void(^handler)(const float *magnitudes, NSUInteger count) = self.updateHandler;
+    if ( handler == nil ) return;
+    if ( mCore->analyze(mBands.data()) ) {
+        handler(mBands.data(), mBands.size());
+    }
+}
+@end
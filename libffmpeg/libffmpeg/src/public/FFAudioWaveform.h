@@ -0,0 +1,45 @@
+//
+//  FFAudioWaveform.h
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/4.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CMTimeRange.h>
+
+NS_ASSUME_NONNULL_BEGIN
+/// 一段时间内(所有声道)的峰值
+typedef struct {
+    float min;
+    float max;
+    float rms;
+} FFAudioWaveformPeak;
+
+/// 多分辨率的波形摘要; 从缓存加载时以 mmap 的方式读取, 查询任意缩放级别都只访问所需的数据;
+@interface FFAudioWaveform : NSObject
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+@property (nonatomic, readonly) CMTime duration;
+
+/// 将 timeRange 汇总为 count 个峰值; 返回 count 个 FFAudioWaveformPeak;
+- (NSData *)peaksInTimeRange:(CMTimeRange)timeRange count:(NSUInteger)count;
+@end
+
+/// 波形提取; 仅解码, 本地文件分段并行解码; 设置 cacheDirectory 时结果会缓存到该目录;
+@interface FFAudioWaveformExtractor : NSObject
+- (instancetype)initWithCacheDirectory:(nullable NSString *)cacheDirectory;
+
+/// 第 0 层每个峰值覆盖的采样数, 默认 256; 在提取之前设置;
+@property (nonatomic) NSUInteger samplesPerPeak;
+
+/// 已缓存的波形; 未提取过时返回 nil;
+- (nullable FFAudioWaveform *)cachedWaveformForURL:(NSURL *)URL;
+
+/// 在后台提取(已缓存的直接返回); 在子线程回调;
+- (void)extractWaveformForURL:(NSURL *)URL completion:(void(^)(FFAudioWaveform *_Nullable waveform, NSError *_Nullable error))completion;
+
+/// 取消进行中的提取; 被取消的提取以错误回调;
+- (void)cancel;
+@end
+NS_ASSUME_NONNULL_END
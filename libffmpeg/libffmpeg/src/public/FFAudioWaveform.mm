@@ -0,0 +1,134 @@
+//
+//  FFAudioWaveform.m
+//  LWZFFmpegLib
+//
+//  Created by db on 2025/6/4.
+//
+
+#import "FFAudioWaveform.h"
+#import "FFAudioItem.h"
+#include "WaveformExtractor.h"
+#include <atomic>
+#include <vector>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+@interface FFAudioWaveform ()
+- (instancetype)initWithWaveform:(FFAV::Waveform &&)waveform;
+@end
+
+@implementation FFAudioWaveform {
+    FFAV::Waveform mWaveform;
+}
+
+- (instancetype)initWithWaveform:(FFAV::Waveform &&)waveform {
+    self = [super init];
+    mWaveform = std::move(waveform);
+    return self;
+}
+
+- (CMTime)duration {
+    return CMTimeMake(mWaveform.getTotalSamples(), mWaveform.getSampleRate());
+}
+
+- (NSData *)peaksInTimeRange:(CMTimeRange)timeRange count:(NSUInteger)count {
+    int sampleRate = mWaveform.getSampleRate();
+    CMTime start = CMTimeConvertScale(timeRange.start, sampleRate, kCMTimeRoundingMethod_RoundTowardNegativeInfinity);
+    CMTime end = CMTimeConvertScale(CMTimeRangeGetEnd(timeRange), sampleRate, kCMTimeRoundingMethod_RoundTowardPositiveInfinity);
+    
+    std::vector<FFAV::WaveformPeak> peaks;
+    if ( mWaveform.query(start.value, end.value, (int)count, peaks) < 0 ) {
+        return [NSData data];
+    }
+    static_assert(sizeof(FFAV::WaveformPeak) == sizeof(FFAudioWaveformPeak), "layout mismatch");
+    return [NSData dataWithBytes:peaks.data() length:peaks.size() * sizeof(FFAudioWaveformPeak)];
+}
+@end
+
+@implementation FFAudioWaveformExtractor {
+    NSString *mCacheDirectory;
+    std::atomic<bool> mCancelled;
+}
+
+- (instancetype)initWithCacheDirectory:(nullable NSString *)cacheDirectory {
+    self = [super init];
+    mCacheDirectory = cacheDirectory.copy;
+    mCancelled.store(false, std::__1::memory_order_relaxed);
+    _samplesPerPeak = 256;
+    if ( mCacheDirectory != nil ) {
+        [NSFileManager.defaultManager createDirectoryAtPath:mCacheDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+    return self;
+}
+
+- (nullable FFAudioWaveform *)cachedWaveformForURL:(NSURL *)URL {
+    NSString *path = [self _cachePathForURL:URL];
+    if ( path == nil ) {
+        return nil;
+    }
+    
+    FFAV::Waveform waveform;
+    if ( waveform.open(path.UTF8String) < 0 || waveform.getSamplesPerPeak() != (int)_samplesPerPeak ) {
+        return nil;
+    }
+    return [FFAudioWaveform.alloc initWithWaveform:std::move(waveform)];
+}
+
+- (void)extractWaveformForURL:(NSURL *)URL completion:(void(^)(FFAudioWaveform *_Nullable waveform, NSError *_Nullable error))completion {
+    mCancelled.store(false, std::__1::memory_order_relaxed);
+    NSUInteger samplesPerPeak = _samplesPerPeak;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        FFAudioWaveform *cached = [self cachedWaveformForURL:URL];
+        if ( cached != nil ) {
+            completion(cached, nil);
+            return;
+        }
+        
+        FFAV::WaveformOptions options;
+        options.samples_per_peak = (int)samplesPerPeak;
+        // 网络资源只顺序解码一次
+        options.nb_segments = URL.isFileURL ? 0 : 1;
+        
+        FFAV::Waveform waveform;
+        int ret = FFAV::WaveformExtractor::extract(URL.isFileURL ? URL.path.UTF8String : URL.absoluteString.UTF8String, options, waveform, &self->mCancelled);
+        if ( ret < 0 ) {
+            completion(nil, [self _makeError:ret]);
+            return;
+        }
+        
+        NSString *path = [self _cachePathForURL:URL];
+        if ( path != nil ) {
+            waveform.save(path.UTF8String);
+        }
+        completion([FFAudioWaveform.alloc initWithWaveform:std::move(waveform)], nil);
+    });
+}
+
+- (void)cancel {
+    mCancelled.store(true, std::__1::memory_order_relaxed);
+}
+
+#pragma mark - mark
+
+- (nullable NSString *)_cachePathForURL:(NSURL *)URL {
+    if ( mCacheDirectory == nil ) {
+        return nil;
+    }
+    
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for ( const char *p = URL.absoluteString.UTF8String; *p; ++p ) {
+        hash ^= (uint8_t)*p;
+        hash *= 1099511628211ULL;
+    }
+    return [mCacheDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"%016llx.ffwf", hash]];
+}
+
+- (NSError *)_makeError:(int)ff_err {
+    return [NSError errorWithDomain:FFAudioItemErrorDomain code:-1 userInfo:@{
+        NSLocalizedDescriptionKey: [NSString stringWithFormat:@"%s", av_err2str(ff_err)]
+    }];
+}
+@end
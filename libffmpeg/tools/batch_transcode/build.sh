@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# 在 Linux 上构建批量转码工具; 依赖系统安装的 FFmpeg 开发包(libavformat-dev, libavcodec-dev, libavfilter-dev, libswresample-dev)
+# 用法: ./build.sh [output]
+
+set -e
+
+CXX=${CXX:-clang++}
+OUTPUT=${1:-batch_transcode}
+ROOT_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+UTILS_DIR="$ROOT_DIR/libffmpeg/src/core/utils"
+
+SOURCES=(
+  "$(dirname "$0")/main.cpp"
+  "$UTILS_DIR/BatchTranscoder.cpp"
+  "$UTILS_DIR/SegmentedDecoder.cpp"
+  "$UTILS_DIR/MediaReader.cpp"
+  "$UTILS_DIR/MediaDecoder.cpp"
+  "$UTILS_DIR/AudioKernels.cpp"
+  "$UTILS_DIR/FilterGraph.cpp"
+  "$UTILS_DIR/AudioUtils.cpp"
+  "$UTILS_DIR/AudioFifo.cpp"
+  "$UTILS_DIR/AudioEncoder.cpp"
+  "$UTILS_DIR/AudioMuxer.cpp"
+  "$UTILS_DIR/AudioWriter.cpp"
+  "$UTILS_DIR/MediaObjectPool.cpp"
+)
+
+# _Nullable/_Nonnull 仅 clang 支持
+if ! $CXX --version | grep -q clang; then
+  EXTRA_FLAGS="-D_Nullable= -D_Nonnull="
+fi
+
+$CXX -std=c++20 -O2 -pthread $EXTRA_FLAGS \
+  -I"$UTILS_DIR" \
+  "${SOURCES[@]}" \
+  $(pkg-config --cflags --libs libavformat libavcodec libavfilter libswresample libavutil) \
+  -o "$OUTPUT"
+
+echo "✅ $OUTPUT"
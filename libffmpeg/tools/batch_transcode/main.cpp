@@ -0,0 +1,121 @@
+//
+// Created on 2025/5/27.
+//
+// 批量转码工具; 用于离线处理曲库, 替代原先的 ffmpeg 脚本;
+//
+// 用法: batch_transcode [-j threads] [-t decoder_threads] [-s segments] [-f format] -o output_dir input...
+//      输入为 "-" 时从标准输入逐行读取文件路径;
+
+#include "BatchTranscoder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/log.h>
+}
+
+static FFAV::BatchTranscoder* _Nullable g_transcoder = nullptr;
+
+static void on_signal(int) {
+    if ( g_transcoder ) g_transcoder->cancel();
+}
+
+static void print_usage(const char* name) {
+    fprintf(stderr, "usage: %s [-j threads] [-t decoder_threads] [-s segments] [-f format] -o output_dir input...\n", name);
+    fprintf(stderr, "  -j threads    number of concurrent jobs, defaults to the number of cores\n");
+    fprintf(stderr, "  -t threads    decoder threads per job, defaults to 1 (0 = auto)\n");
+    fprintf(stderr, "  -s segments   split each long file into segments transcoded in parallel, defaults to 1 (0 = number of cores)\n");
+    fprintf(stderr, "  -f format     output file extension, defaults to m4a (m4a, mp3, flac, wav, ...)\n");
+    fprintf(stderr, "  -o dir        output directory\n");
+    fprintf(stderr, "  input         input files; \"-\" reads paths from stdin, one per line\n");
+}
+
+int main(int argc, const char* argv[]) {
+    int thread_count = 0;
+    int decoder_thread_count = 1;
+    int segment_count = 1;
+    std::string format = "m4a";
+    std::string output_dir;
+    std::vector<std::string> inputs;
+
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( (arg == "-j" || arg == "-t" || arg == "-s" || arg == "-f" || arg == "-o") && i + 1 < argc ) {
+            std::string value = argv[++i];
+            if ( arg == "-j" ) thread_count = atoi(value.c_str());
+            else if ( arg == "-t" ) decoder_thread_count = atoi(value.c_str());
+            else if ( arg == "-s" ) segment_count = atoi(value.c_str());
+            else if ( arg == "-f" ) format = value;
+            else output_dir = value;
+        }
+        else if ( arg == "-h" || arg == "--help" ) {
+            print_usage(argv[0]);
+            return 0;
+        }
+        else if ( arg == "-" ) {
+            std::string line;
+            while ( std::getline(std::cin, line) ) {
+                if ( !line.empty() ) inputs.push_back(line);
+            }
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if ( output_dir.empty() || inputs.empty() ) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(output_dir, ec);
+    if ( ec ) {
+        fprintf(stderr, "cannot create %s: %s\n", output_dir.c_str(), ec.message().c_str());
+        return 1;
+    }
+
+    std::vector<FFAV::BatchJob> jobs;
+    jobs.reserve(inputs.size());
+    for ( const auto& input : inputs ) {
+        std::filesystem::path output = std::filesystem::path(output_dir) / std::filesystem::path(input).stem();
+        output += "." + format;
+        jobs.push_back({ input, output.string() });
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    FFAV::BatchTranscoder transcoder(thread_count);
+    FFAV::MediaDecoderOptions decoder_options;
+    decoder_options.thread_count = decoder_thread_count;
+    transcoder.setDecoderOptions(decoder_options);
+    transcoder.setSegmentCount(segment_count);
+    transcoder.setProgressCallback([](size_t, const FFAV::BatchJob& job, int ret, const FFAV::BatchStats& stats) {
+        if ( ret < 0 ) {
+            // av_err2str 是 compound literal, g++ 不支持
+            char err[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+            av_strerror(ret, err, sizeof(err));
+            fprintf(stderr, "[%zu/%zu] failed %s: %s\n", stats.completed, stats.total, job.input.c_str(), err);
+        }
+        else {
+            fprintf(stderr, "[%zu/%zu] %s -> %s\n", stats.completed, stats.total, job.input.c_str(), job.output.c_str());
+        }
+    });
+
+    g_transcoder = &transcoder;
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    FFAV::BatchStats stats = transcoder.run(jobs);
+    g_transcoder = nullptr;
+
+    fprintf(stderr, "%zu files, %zu failed, %.2fs elapsed, %.2f files/s, %.1fx realtime\n",
+            stats.completed, stats.failed, stats.elapsed, stats.getFilesPerSecond(), stats.getRealtimeFactor());
+    return stats.failed > 0 || stats.completed < stats.total ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+//
+// Created on 2025/6/15.
+//
+// 基准测试工具共用的计时与测试信号; 仅在 tools/bench 中使用;
+
+#ifndef FFMPEGPROJ_BENCH_COMMON_H
+#define FFMPEGPROJ_BENCH_COMMON_H
+
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/error.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
+namespace bench {
+
+static inline double wallSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 进程内所有线程的 CPU 时间
+static inline double cpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// av_err2str 是 compound literal, g++ 不支持
+static inline std::string errorString(int err) {
+    char buf[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+    av_strerror(err, buf, sizeof(buf));
+    return buf;
+}
+
+/// 音乐化的测试信号: 三个不相关的正弦叠加少量噪声, 峰值约 -6dBFS; 使压缩/均衡等 stage 处于正常工作状态;
+/// 返回 fltp 帧, 失败返回 nullptr;
+static inline AVFrame* _Nullable makeTestFrame(int sample_rate, int nb_channels, int nb_samples, int64_t pts) {
+    AVFrame* frame = av_frame_alloc();
+    if ( frame == nullptr ) {
+        return nullptr;
+    }
+    frame->format = AV_SAMPLE_FMT_FLTP;
+    frame->sample_rate = sample_rate;
+    frame->nb_samples = nb_samples;
+    frame->pts = pts;
+    av_channel_layout_default(&frame->ch_layout, nb_channels);
+    if ( av_frame_get_buffer(frame, 0) < 0 ) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+
+    uint32_t seed = 0x9e3779b9u;
+    for ( int c = 0; c < nb_channels; ++c ) {
+        float* dst = (float*)frame->data[c];
+        for ( int i = 0; i < nb_samples; ++i ) {
+            double t = (double)(pts + i) / sample_rate;
+            seed = seed * 1664525u + 1013904223u;
+            double noise = ((seed >> 8) / 16777216.0 - 0.5) * 0.02;
+            dst[i] = (float)(0.2 * sin(2 * M_PI * 110 * t) + 0.15 * sin(2 * M_PI * (1000 + 30 * c) * t) + 0.1 * sin(2 * M_PI * 6000 * t) + noise);
+        }
+    }
+    return frame;
+}
+
+}
+
+#endif //FFMPEGPROJ_BENCH_COMMON_H
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# 在 Linux 上构建基准测试工具; 依赖系统安装的 FFmpeg 开发包(libavformat-dev, libavcodec-dev, libavfilter-dev, libswresample-dev)
+# 用法: ./build.sh [output_dir]
+
+set -e
+
+CXX=${CXX:-clang++}
+OUTPUT_DIR=${1:-.}
+BENCH_DIR="$(cd "$(dirname "$0")" && pwd)"
+ROOT_DIR="$(cd "$BENCH_DIR/../.." && pwd)"
+UTILS_DIR="$ROOT_DIR/libffmpeg/src/core/utils"
+
+# 各工具依赖的 utils 源文件
+declare -A SOURCES=(
+  [effect_bench]="AudioEffectChain.cpp FilterGraph.cpp"
+  [graph_bench]="FilterGraph.cpp"
+  [decode_bench]="MediaDecoder.cpp MediaReader.cpp AudioKernels.cpp"
+  [kernels_bench]="AudioKernels.cpp"
+  [resample_bench]="ResamplePresets.cpp"
+  [discard_bench]="MediaReader.cpp"
+  [reader_scale_bench]="IOScheduler.cpp"
+)
+
+# _Nullable/_Nonnull 仅 clang 支持
+if ! $CXX --version | grep -q clang; then
+  EXTRA_FLAGS="-D_Nullable= -D_Nonnull="
+fi
+
+mkdir -p "$OUTPUT_DIR"
+for name in "${!SOURCES[@]}"; do
+  files=("$BENCH_DIR/$name.cpp")
+  for src in ${SOURCES[$name]}; do
+    files+=("$UTILS_DIR/$src")
+  done
+
+  # -ffp-contract=off: 与 AudioKernels.cpp 中的 FP_CONTRACT OFF 一致(gcc 不识别该 pragma)
+  $CXX -std=c++20 -O2 -pthread -ffp-contract=off $EXTRA_FLAGS \
+    -I"$UTILS_DIR" -I"$BENCH_DIR" \
+    "${files[@]}" \
+    $(pkg-config --cflags --libs libavformat libavcodec libavfilter libswresample libavutil) \
+    -o "$OUTPUT_DIR/$name"
+
+  echo "✅ $OUTPUT_DIR/$name"
+done
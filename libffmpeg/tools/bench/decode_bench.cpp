@@ -0,0 +1,238 @@
+//
+// Created on 2025/6/15.
+//
+// 解码的实时倍数与 CPU 开销; 按编码格式与 MediaDecoderOptions::thread_count 分别统计;
+//
+// 输入的 packet 预先全部读入内存, 只统计解码本身; 未指定输入文件时生成测试数据:
+// 96kHz/24bit 立体声编码为 flac 与 alac(无损格式, 单线程解码是低端设备上的瓶颈);
+//
+// 用法: decode_bench [-t threads,...] [-d seconds] [input...]
+
+#include "bench_common.h"
+#include "MediaDecoder.h"
+#include "MediaReader.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/log.h>
+}
+
+struct Source {
+    std::string name;
+    AVCodecParameters* _Nullable codecpar { avcodec_parameters_alloc() };
+    std::vector<AVPacket*> packets;
+    double duration { 0 }; // 秒
+
+    Source() = default;
+    Source(const Source&) = delete;
+    Source(Source&& other) noexcept : name(std::move(other.name)), codecpar(other.codecpar), packets(std::move(other.packets)), duration(other.duration) {
+        other.codecpar = nullptr;
+    }
+    ~Source() {
+        avcodec_parameters_free(&codecpar);
+        for ( AVPacket* pkt : packets ) av_packet_free(&pkt);
+    }
+};
+
+static int load_file(const std::string& path, Source& source) {
+    FFAV::MediaReader reader;
+    int ret = reader.open(path, {}, AVMEDIA_TYPE_AUDIO);
+    if ( ret < 0 ) return ret;
+
+    AVStream* stream = reader.getBestStream(AVMEDIA_TYPE_AUDIO);
+    if ( stream == nullptr ) return AVERROR_STREAM_NOT_FOUND;
+    ret = reader.selectStream(stream->index);
+    if ( ret < 0 ) return ret;
+
+    ret = avcodec_parameters_copy(source.codecpar, stream->codecpar);
+    if ( ret < 0 ) return ret;
+
+    source.name = std::string(avcodec_get_name(stream->codecpar->codec_id)) + " " + path.substr(path.find_last_of('/') + 1);
+    int64_t samples = 0;
+    while ( true ) {
+        AVPacket* pkt = av_packet_alloc();
+        ret = reader.readPacket(pkt);
+        if ( ret < 0 ) {
+            av_packet_free(&pkt);
+            break;
+        }
+        if ( pkt->stream_index != stream->index ) {
+            av_packet_free(&pkt);
+            continue;
+        }
+        samples += av_rescale_q(pkt->duration, stream->time_base, { 1, stream->codecpar->sample_rate });
+        source.packets.push_back(pkt);
+    }
+    source.duration = (double)samples / stream->codecpar->sample_rate;
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+// fltp 测试信号转换为编码器的整数格式(s16/s32, packed/planar); 24bit 有效位
+static void convert(const AVFrame* in, AVFrame* out) {
+    AVSampleFormat fmt = (AVSampleFormat)out->format;
+    bool planar = av_sample_fmt_is_planar(fmt);
+    bool s32 = av_get_bytes_per_sample(fmt) == 4;
+    int nb_channels = in->ch_layout.nb_channels;
+    for ( int c = 0; c < nb_channels; ++c ) {
+        const float* src = (const float*)in->data[c];
+        for ( int i = 0; i < in->nb_samples; ++i ) {
+            int32_t v = (int32_t)(src[i] * 8388607.0f) * 256; // 24bit 左对齐
+            int index = planar ? i : i * nb_channels + c;
+            if ( s32 ) ((int32_t*)out->data[planar ? c : 0])[index] = v;
+            else ((int16_t*)out->data[planar ? c : 0])[index] = (int16_t)(v >> 16);
+        }
+    }
+}
+
+static int make_source(AVCodecID codec_id, int sample_rate, double seconds, Source& source) {
+    const AVCodec* codec = avcodec_find_encoder(codec_id);
+    if ( codec == nullptr ) return AVERROR_ENCODER_NOT_FOUND;
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if ( ctx == nullptr ) return AVERROR(ENOMEM);
+
+    // 优先 32bit 整数格式
+    ctx->sample_fmt = AV_SAMPLE_FMT_NONE;
+    for ( const AVSampleFormat* fmt = codec->sample_fmts; fmt && *fmt != AV_SAMPLE_FMT_NONE; ++fmt ) {
+        if ( *fmt == AV_SAMPLE_FMT_S32 || *fmt == AV_SAMPLE_FMT_S32P ) { ctx->sample_fmt = *fmt; break; }
+        if ( (*fmt == AV_SAMPLE_FMT_S16 || *fmt == AV_SAMPLE_FMT_S16P) && ctx->sample_fmt == AV_SAMPLE_FMT_NONE ) ctx->sample_fmt = *fmt;
+    }
+    ctx->sample_rate = sample_rate;
+    ctx->time_base = { 1, sample_rate };
+    ctx->bits_per_raw_sample = 24;
+    av_channel_layout_default(&ctx->ch_layout, 2);
+
+    int ret = ctx->sample_fmt == AV_SAMPLE_FMT_NONE ? AVERROR(EINVAL) : avcodec_open2(ctx, codec, nullptr);
+    if ( ret >= 0 ) ret = avcodec_parameters_from_context(source.codecpar, ctx);
+
+    int frame_size = ctx->frame_size > 0 ? ctx->frame_size : 4096;
+    int64_t total = (int64_t)(seconds * sample_rate);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* pkt = av_packet_alloc();
+    for ( int64_t pts = 0; ret >= 0; pts += frame_size ) {
+        if ( pts < total ) {
+            AVFrame* signal = bench::makeTestFrame(sample_rate, 2, frame_size, pts);
+            frame->format = ctx->sample_fmt;
+            frame->sample_rate = sample_rate;
+            frame->nb_samples = frame_size;
+            frame->pts = pts;
+            av_channel_layout_copy(&frame->ch_layout, &ctx->ch_layout);
+            ret = signal ? av_frame_get_buffer(frame, 0) : AVERROR(ENOMEM);
+            if ( ret >= 0 ) convert(signal, frame);
+            av_frame_free(&signal);
+            if ( ret >= 0 ) ret = avcodec_send_frame(ctx, frame);
+            av_frame_unref(frame);
+        }
+        else {
+            ret = avcodec_send_frame(ctx, nullptr);
+        }
+
+        while ( ret >= 0 && (ret = avcodec_receive_packet(ctx, pkt)) >= 0 ) {
+            source.packets.push_back(av_packet_clone(pkt));
+            av_packet_unref(pkt);
+        }
+        if ( ret == AVERROR(EAGAIN) ) ret = 0;
+    }
+
+    source.name = std::string(codec->name) + " " + std::to_string(sample_rate / 1000) + "k/24";
+    source.duration = seconds;
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&ctx);
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int decode_all(const Source& source, int thread_count, double& wall, double& cpu) {
+    FFAV::MediaDecoderOptions options;
+    options.thread_count = thread_count;
+    FFAV::MediaDecoder decoder;
+    int ret = decoder.init(source.codecpar, options);
+    if ( ret < 0 ) return ret;
+
+    AVFrame* frame = av_frame_alloc();
+    double wall_begin = bench::wallSeconds();
+    double cpu_begin = bench::cpuSeconds();
+    for ( size_t i = 0; i <= source.packets.size() && ret >= 0; ++i ) {
+        ret = decoder.send(i < source.packets.size() ? source.packets[i] : nullptr);
+        while ( ret >= 0 && (ret = decoder.receive(frame)) >= 0 ) {
+            av_frame_unref(frame);
+        }
+        if ( ret == AVERROR(EAGAIN) ) ret = 0;
+    }
+    wall = bench::wallSeconds() - wall_begin;
+    cpu = bench::cpuSeconds() - cpu_begin;
+    av_frame_free(&frame);
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+int main(int argc, const char* argv[]) {
+    std::vector<int> thread_counts = { 1, 2, 4, 0 };
+    double seconds = 300;
+    std::vector<std::string> inputs;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( arg == "-t" && i + 1 < argc ) {
+            thread_counts.clear();
+            std::stringstream ss(argv[++i]);
+            for ( std::string item; std::getline(ss, item, ','); ) thread_counts.push_back(atoi(item.c_str()));
+        }
+        else if ( arg == "-d" && i + 1 < argc ) {
+            seconds = atof(argv[++i]);
+        }
+        else if ( arg == "-h" || arg == "--help" || arg[0] == '-' ) {
+            fprintf(stderr, "usage: %s [-t threads,...] [-d seconds] [input...]\n", argv[0]);
+            fprintf(stderr, "  -t threads    decoder thread counts to compare, defaults to 1,2,4,0 (0 = auto)\n");
+            fprintf(stderr, "  -d seconds    length of the generated flac/alac sources, defaults to 300\n");
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+        else {
+            inputs.push_back(arg);
+        }
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    std::vector<Source> sources;
+    int ret = 0;
+    if ( inputs.empty() ) {
+        for ( AVCodecID codec_id : { AV_CODEC_ID_FLAC, AV_CODEC_ID_ALAC } ) {
+            Source source;
+            if ( (ret = make_source(codec_id, 96000, seconds, source)) < 0 ) {
+                fprintf(stderr, "cannot encode %s: %s\n", avcodec_get_name(codec_id), bench::errorString(ret).c_str());
+                continue;
+            }
+            sources.push_back(std::move(source));
+        }
+    }
+    for ( const std::string& input : inputs ) {
+        Source source;
+        if ( (ret = load_file(input, source)) < 0 ) {
+            fprintf(stderr, "cannot read %s: %s\n", input.c_str(), bench::errorString(ret).c_str());
+            continue;
+        }
+        sources.push_back(std::move(source));
+    }
+    if ( sources.empty() ) {
+        return 1;
+    }
+
+    printf("%-28s %8s %10s %10s %12s\n", "source", "threads", "wall(s)", "cpu(s)", "realtime");
+    int failed = 0;
+    for ( const Source& source : sources ) {
+        for ( int thread_count : thread_counts ) {
+            double wall = 0, cpu = 0;
+            if ( (ret = decode_all(source, thread_count, wall, cpu)) < 0 ) {
+                fprintf(stderr, "%s (%d threads) failed: %s\n", source.name.c_str(), thread_count, bench::errorString(ret).c_str());
+                ++failed;
+                continue;
+            }
+            std::string threads = thread_count == 0 ? "auto" : std::to_string(thread_count);
+            printf("%-28s %8s %10.3f %10.3f %11.0fx\n", source.name.c_str(), threads.c_str(), wall, cpu, wall > 0 ? source.duration / wall : 0);
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
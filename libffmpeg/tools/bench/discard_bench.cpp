@@ -0,0 +1,107 @@
+//
+// Created on 2025/6/15.
+//
+// 带视频的容器只播放音频时, 丢弃非音频流(MediaReader::open 的 media_type + selectStream)前后的 I/O 与 CPU 开销;
+//
+// all:     不丢弃任何流, readPacket 返回所有 packet, 由调用方按 stream_index 过滤(此前 FFCoreAudioReader 的做法);
+// discard: 以 AVMEDIA_TYPE_AUDIO 打开并只选择音频流;
+// 读取的字节数取自 /proc/self/io 的 rchar(进程经 read 系统调用读取的字节数, 包括 page cache 命中), 包括 open 时的探测;
+//
+// 用法: discard_bench input...(建议使用较大的、带视频的 mp4/mkv 文件)
+
+#include "bench_common.h"
+#include "MediaReader.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include <libavutil/log.h>
+}
+
+struct Result {
+    double audio_seconds { 0 };
+    int64_t bytes_read { 0 };
+    int64_t packets { 0 };          // readPacket 返回的 packet 数
+    int64_t packet_bytes { 0 };     // 这些 packet 的数据大小(demuxer 为其分配的内存)
+    double cpu { 0 };
+};
+
+static int64_t read_rchar() {
+    FILE* file = fopen("/proc/self/io", "r");
+    if ( file == nullptr ) {
+        return -1;
+    }
+    char line[128];
+    long long value = -1;
+    while ( fgets(line, sizeof(line), file) ) {
+        if ( sscanf(line, "rchar: %lld", &value) == 1 ) break;
+    }
+    fclose(file);
+    return value;
+}
+
+static int run(const std::string& path, bool discard, Result& result) {
+    int64_t bytes_begin = read_rchar();
+    double cpu_begin = bench::cpuSeconds();
+
+    FFAV::MediaReader reader;
+    int ret = reader.open(path, {}, discard ? AVMEDIA_TYPE_AUDIO : AVMEDIA_TYPE_UNKNOWN);
+    if ( ret < 0 ) return ret;
+
+    AVStream* stream = reader.getBestStream(AVMEDIA_TYPE_AUDIO);
+    if ( stream == nullptr ) return AVERROR_STREAM_NOT_FOUND;
+    if ( discard && (ret = reader.selectStream(stream->index)) < 0 ) return ret;
+
+    AVPacket* pkt = av_packet_alloc();
+    if ( pkt == nullptr ) return AVERROR(ENOMEM);
+
+    int64_t samples = 0;
+    while ( (ret = reader.readPacket(pkt)) >= 0 ) {
+        result.packets += 1;
+        result.packet_bytes += pkt->size;
+        if ( pkt->stream_index == stream->index ) {
+            samples += av_rescale_q(pkt->duration, stream->time_base, { 1, stream->codecpar->sample_rate });
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+
+    result.cpu = bench::cpuSeconds() - cpu_begin;
+    result.bytes_read = read_rchar() - bytes_begin;
+    result.audio_seconds = (double)samples / stream->codecpar->sample_rate;
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+int main(int argc, const char* argv[]) {
+    if ( argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0 ) {
+        fprintf(stderr, "usage: %s input...\n", argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+    if ( read_rchar() < 0 ) {
+        fprintf(stderr, "/proc/self/io is not available\n");
+        return 1;
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    printf("%-8s %12s %14s %12s %14s %14s\n", "mode", "audio(s)", "KiB/audio-sec", "packets/s", "pkt KiB/s", "cpu ms/s");
+    int failed = 0;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string path = argv[i];
+        printf("%s\n", path.c_str());
+        for ( bool discard : { false, true } ) {
+            Result result;
+            int ret = run(path, discard, result);
+            if ( ret < 0 || result.audio_seconds <= 0 ) {
+                fprintf(stderr, "%s: %s\n", path.c_str(), ret < 0 ? bench::errorString(ret).c_str() : "no audio");
+                ++failed;
+                break;
+            }
+
+            double s = result.audio_seconds;
+            printf("%-8s %12.1f %14.1f %12.1f %14.1f %14.3f\n", discard ? "discard" : "all", s, result.bytes_read / 1024.0 / s, result.packets / s, result.packet_bytes / 1024.0 / s, result.cpu * 1000 / s);
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+//
+// Created on 2025/6/15.
+//
+// 音效链各 stage 的 CPU 开销; 每个 stage 单独构建 abuffer -> stage -> abuffersink, 与直通(anull)对比;
+//
+// 用法: effect_bench [-d seconds]
+
+#include "bench_common.h"
+#include "AudioEffectChain.h"
+#include "FilterGraph.h"
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/log.h>
+}
+
+static const int SAMPLE_RATE = 44100;
+static const int FRAME_SIZE = 1024;
+
+struct Stage {
+    const char* name;
+    const char* filter;                                 // 检查可用性; nullptr 表示直通
+    std::function<void(FFAV::AudioEffectChain&)> setup; // 开启对应的 stage
+};
+
+// 返回处理 seconds 秒音频的 CPU 时间; 出错返回小于 0
+static int run_stage(const Stage& stage, const std::vector<AVFrame*>& frames, double seconds, double& cpu) {
+    FFAV::AudioEffectChain effects;
+    if ( stage.setup ) stage.setup(effects);
+
+    std::string desc = effects.getFilterDescription();
+    if ( stage.filter == nullptr || desc.empty() ) desc = "anull";
+
+    FFAV::FilterGraph graph;
+    int ret = graph.init();
+    if ( ret >= 0 ) ret = graph.addAudioBufferSourceFilter("in", { 1, SAMPLE_RATE }, SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, "stereo");
+    if ( ret >= 0 ) ret = graph.addAudioBufferSinkFilter("out", SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, "stereo");
+    if ( ret >= 0 ) ret = graph.parse("[in]" + desc + "[out]");
+    if ( ret >= 0 ) ret = graph.configure();
+    if ( ret >= 0 && stage.setup ) ret = effects.attach(&graph);
+    if ( ret < 0 ) {
+        return ret;
+    }
+
+    FFAV::BufferSourceHandle src = graph.getBufferSource("in");
+    FFAV::BufferSinkHandle sink = graph.getBufferSink("out");
+    AVFrame* in = av_frame_alloc();
+    AVFrame* out = av_frame_alloc();
+    int64_t total = (int64_t)(seconds * SAMPLE_RATE);
+
+    double begin = bench::cpuSeconds();
+    for ( int64_t pts = 0, i = 0; ret >= 0; pts += FRAME_SIZE, ++i ) {
+        if ( pts < total ) {
+            ret = av_frame_ref(in, frames[i % frames.size()]);
+            if ( ret < 0 ) break;
+            in->pts = pts;
+            ret = graph.addFrame(src, in, 0);
+        }
+        else {
+            ret = graph.addFrame(src, nullptr, AV_BUFFERSRC_FLAG_PUSH);
+        }
+        if ( ret < 0 ) break;
+
+        while ( (ret = graph.getFrame(sink, out)) >= 0 ) {
+            av_frame_unref(out);
+        }
+        if ( ret == AVERROR(EAGAIN) ) ret = 0;
+    }
+    cpu = bench::cpuSeconds() - begin;
+
+    av_frame_free(&in);
+    av_frame_free(&out);
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+int main(int argc, const char* argv[]) {
+    double seconds = 60;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( arg == "-d" && i + 1 < argc ) {
+            seconds = atof(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-d seconds]\n", argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    // 1s 的测试信号循环使用, 生成信号的开销不计入
+    std::vector<AVFrame*> frames;
+    for ( int64_t pts = 0; pts < SAMPLE_RATE; pts += FRAME_SIZE ) {
+        AVFrame* frame = bench::makeTestFrame(SAMPLE_RATE, 2, FRAME_SIZE, pts);
+        if ( frame == nullptr ) {
+            fprintf(stderr, "cannot allocate frames\n");
+            return 1;
+        }
+        frames.push_back(frame);
+    }
+
+    const Stage stages[] = {
+        { "passthrough", nullptr, nullptr },
+        { "equalizer", "equalizer", [](FFAV::AudioEffectChain& e) {
+            e.setEqualizerEnabled(true);
+            for ( int i = 0; i < FFAV::AudioEffectChain::EQ_BAND_COUNT; ++i ) e.setEqualizerGain(i, i % 2 ? 3.0f : -3.0f);
+        } },
+        { "acompressor", "acompressor", [](FFAV::AudioEffectChain& e) { e.setCompressorEnabled(true); } },
+        { "dynaudnorm", "dynaudnorm", [](FFAV::AudioEffectChain& e) { e.setLoudnessNormalizationEnabled(true); } },
+        { "volume", "volume", [](FFAV::AudioEffectChain& e) { e.setVolume(0.8f); } },
+        { "all", "volume", [](FFAV::AudioEffectChain& e) {
+            e.setEqualizerEnabled(true);
+            e.setCompressorEnabled(true);
+            e.setLoudnessNormalizationEnabled(true);
+            e.setVolume(0.8f);
+        } },
+    };
+
+    printf("%-12s %12s %14s %12s\n", "stage", "cpu(s)", "ms/audio-sec", "realtime");
+    double baseline = 0;
+    int failed = 0;
+    for ( const Stage& stage : stages ) {
+        if ( stage.filter && !FFAV::FilterGraph::isFilterAvailable(stage.filter) ) {
+            printf("%-12s %12s\n", stage.name, "unavailable");
+            continue;
+        }
+
+        double cpu = 0;
+        int ret = run_stage(stage, frames, seconds, cpu);
+        if ( ret < 0 ) {
+            fprintf(stderr, "%s failed: %s\n", stage.name, bench::errorString(ret).c_str());
+            ++failed;
+            continue;
+        }
+        if ( stage.filter == nullptr ) baseline = cpu;
+
+        // 扣除直通 graph 本身(frame 传递)的开销
+        double net = stage.filter ? cpu - baseline : cpu;
+        printf("%-12s %12.3f %14.3f %11.0fx\n", stage.name, cpu, net * 1000 / seconds, cpu > 0 ? seconds / cpu : 0);
+    }
+
+    for ( AVFrame* frame : frames ) av_frame_free(&frame);
+    return failed > 0 ? 1 : 0;
+}
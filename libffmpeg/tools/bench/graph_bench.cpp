@@ -0,0 +1,139 @@
+//
+// Created on 2025/6/15.
+//
+// filter graph 每帧的传递开销, 三种方式对比:
+//  - lookup: 每帧通过 avfilter_graph_get_filter 按名称线性查找(引入 handle 之前的实现);
+//  - name:   addFrame/getFrame 的 std::string 重载, 查找 configure 时缓存的表;
+//  - handle: configure 时缓存的 BufferSourceHandle/BufferSinkHandle, 直接调用 av_buffersrc/av_buffersink;
+// graph 为 abuffer -> anull x N -> abuffersink, N 越大线性查找的开销越明显;
+//
+// 用法: graph_bench [-n frames] [-f filters]
+
+#include "bench_common.h"
+#include "FilterGraph.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/log.h>
+}
+
+enum class Mode { Lookup, Name, Handle };
+
+static const int SAMPLE_RATE = 44100;
+static const int FRAME_SIZE = 256; // 较小的帧使传递开销占主导
+
+static int build(FFAV::FilterGraph& graph, int nb_filters) {
+    std::string desc = "[in]";
+    for ( int i = 0; i < nb_filters; ++i ) {
+        desc += i == 0 ? "anull" : ",anull";
+    }
+    desc += "[out]";
+
+    int ret = graph.init();
+    if ( ret >= 0 ) ret = graph.addAudioBufferSourceFilter("in", { 1, SAMPLE_RATE }, SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, "stereo");
+    if ( ret >= 0 ) ret = graph.addAudioBufferSinkFilter("out", SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, "stereo");
+    if ( ret >= 0 ) ret = graph.parse(desc);
+    if ( ret >= 0 ) ret = graph.configure();
+    return ret;
+}
+
+// 返回每秒传递的帧数; 出错返回小于 0
+template <Mode M>
+static double run(const AVFrame* source, int nb_frames, int nb_filters) {
+    FFAV::FilterGraph graph;
+    int ret = build(graph, nb_filters);
+    if ( ret < 0 ) {
+        fprintf(stderr, "cannot build graph: %s\n", bench::errorString(ret).c_str());
+        return ret;
+    }
+
+    FFAV::BufferSourceHandle src = graph.getBufferSource("in");
+    FFAV::BufferSinkHandle sink = graph.getBufferSink("out");
+    const std::string src_name = "in";
+    const std::string sink_name = "out";
+    AVFrame* in = av_frame_alloc();
+    AVFrame* out = av_frame_alloc();
+
+    double begin = bench::wallSeconds();
+    for ( int i = 0; i < nb_frames && ret >= 0; ++i ) {
+        ret = av_frame_ref(in, source);
+        if ( ret < 0 ) break;
+        in->pts = (int64_t)i * FRAME_SIZE;
+
+        if constexpr ( M == Mode::Lookup ) ret = av_buffersrc_add_frame_flags(avfilter_graph_get_filter(src.filter_ctx->graph, "in"), in, 0);
+        else if constexpr ( M == Mode::Name ) ret = graph.addFrame(src_name, in, 0);
+        else ret = graph.addFrame(src, in, 0);
+        if ( ret < 0 ) break;
+
+        while ( true ) {
+            if constexpr ( M == Mode::Lookup ) ret = av_buffersink_get_frame(avfilter_graph_get_filter(sink.filter_ctx->graph, "out"), out);
+            else if constexpr ( M == Mode::Name ) ret = graph.getFrame(sink_name, out);
+            else ret = graph.getFrame(sink, out);
+            if ( ret < 0 ) break;
+            av_frame_unref(out);
+        }
+        if ( ret == AVERROR(EAGAIN) ) ret = 0;
+    }
+    double elapsed = bench::wallSeconds() - begin;
+
+    av_frame_unref(in);
+    av_frame_free(&in);
+    av_frame_free(&out);
+    if ( ret < 0 ) {
+        fprintf(stderr, "transfer failed: %s\n", bench::errorString(ret).c_str());
+        return ret;
+    }
+    return nb_frames / elapsed;
+}
+
+int main(int argc, const char* argv[]) {
+    int nb_frames = 200000;
+    int nb_filters = 8;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( (arg == "-n" || arg == "-f") && i + 1 < argc ) {
+            int value = atoi(argv[++i]);
+            if ( arg == "-n" ) nb_frames = value;
+            else nb_filters = value;
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n frames] [-f filters]\n", argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if ( nb_frames <= 0 || nb_filters <= 0 ) {
+        fprintf(stderr, "frames and filters must be positive\n");
+        return 1;
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    AVFrame* source = bench::makeTestFrame(SAMPLE_RATE, 2, FRAME_SIZE, 0);
+    if ( source == nullptr ) {
+        fprintf(stderr, "cannot allocate frame\n");
+        return 1;
+    }
+
+    // 先各跑一轮预热
+    run<Mode::Lookup>(source, nb_frames / 10, nb_filters);
+    run<Mode::Name>(source, nb_frames / 10, nb_filters);
+    run<Mode::Handle>(source, nb_frames / 10, nb_filters);
+
+    double by_lookup = run<Mode::Lookup>(source, nb_frames, nb_filters);
+    double by_name = run<Mode::Name>(source, nb_frames, nb_filters);
+    double by_handle = run<Mode::Handle>(source, nb_frames, nb_filters);
+    av_frame_free(&source);
+    if ( by_lookup < 0 || by_name < 0 || by_handle < 0 ) {
+        return 1;
+    }
+
+    printf("%d frames x %d samples, %d filters\n", nb_frames, FRAME_SIZE, nb_filters);
+    printf("%-8s %14.0f frames/s\n", "lookup", by_lookup);
+    printf("%-8s %14.0f frames/s (%.2fx)\n", "name", by_name, by_name / by_lookup);
+    printf("%-8s %14.0f frames/s (%.2fx)\n", "handle", by_handle, by_handle / by_lookup);
+    return 0;
+}
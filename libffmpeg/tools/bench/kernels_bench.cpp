@@ -0,0 +1,129 @@
+//
+// Created on 2025/6/15.
+//
+// AudioKernels::convert 与 swresample(采样率不变, 只转换格式/声道)的吞吐对比; 各实现(neon/avx2/sse2/scalar)分别统计;
+//
+// 用法: kernels_bench [-n frames]
+
+#include "bench_common.h"
+#include "AudioKernels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libswresample/swresample.h>
+#include <libavutil/log.h>
+}
+
+static const int SAMPLE_RATE = 44100;
+static const int CHUNK = 4096; // 每次转换的帧数, 与渲染/转码时的典型大小相当
+
+struct Case {
+    const char* name;
+    AVSampleFormat src_fmt;
+    int src_channels;
+    AVSampleFormat dst_fmt;
+    int dst_channels;
+};
+
+// 每个平面 CHUNK 帧, 交错数据只使用第一个平面
+struct Buffers {
+    std::vector<std::vector<uint8_t>> planes;
+    std::vector<uint8_t*> ptrs;
+
+    Buffers(AVSampleFormat fmt, int nb_channels) {
+        bool planar = av_sample_fmt_is_planar(fmt);
+        int nb_planes = planar ? nb_channels : 1;
+        size_t size = (size_t)CHUNK * av_get_bytes_per_sample(fmt) * (planar ? 1 : nb_channels);
+        for ( int i = 0; i < nb_planes; ++i ) {
+            planes.emplace_back(size);
+            for ( size_t k = 0; k < size; ++k ) planes.back()[k] = (uint8_t)(k * 131 + i * 7); // 任意数据, 不含 NaN(float 的高字节不会为 0xff)
+            ptrs.push_back(planes.back().data());
+        }
+    }
+};
+
+// 返回每秒转换的帧数
+static double run_kernels(const Case& c, int64_t nb_frames) {
+    Buffers src(c.src_fmt, c.src_channels);
+    Buffers dst(c.dst_fmt, c.dst_channels);
+    double begin = bench::wallSeconds();
+    for ( int64_t done = 0; done < nb_frames; done += CHUNK ) {
+        FFAV::AudioKernels::convert(dst.ptrs.data(), c.dst_fmt, c.dst_channels, (const uint8_t* const*)src.ptrs.data(), c.src_fmt, c.src_channels, CHUNK);
+    }
+    return nb_frames / (bench::wallSeconds() - begin);
+}
+
+static double run_swr(const Case& c, int64_t nb_frames) {
+    AVChannelLayout in_layout, out_layout;
+    av_channel_layout_default(&in_layout, c.src_channels);
+    av_channel_layout_default(&out_layout, c.dst_channels);
+    SwrContext* swr = nullptr;
+    int ret = swr_alloc_set_opts2(&swr, &out_layout, c.dst_fmt, SAMPLE_RATE, &in_layout, c.src_fmt, SAMPLE_RATE, 0, nullptr);
+    if ( ret >= 0 ) ret = swr_init(swr);
+    if ( ret < 0 ) {
+        fprintf(stderr, "%s: swr_init failed: %s\n", c.name, bench::errorString(ret).c_str());
+        swr_free(&swr);
+        return ret;
+    }
+
+    Buffers src(c.src_fmt, c.src_channels);
+    Buffers dst(c.dst_fmt, c.dst_channels);
+    double begin = bench::wallSeconds();
+    for ( int64_t done = 0; done < nb_frames && ret >= 0; done += CHUNK ) {
+        ret = swr_convert(swr, dst.ptrs.data(), CHUNK, (const uint8_t**)src.ptrs.data(), CHUNK);
+    }
+    double elapsed = bench::wallSeconds() - begin;
+    swr_free(&swr);
+    return ret < 0 ? ret : nb_frames / elapsed;
+}
+
+int main(int argc, const char* argv[]) {
+    int64_t nb_frames = 20000000;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( arg == "-n" && i + 1 < argc ) {
+            nb_frames = atoll(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n frames]\n", argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    const Case cases[] = {
+        { "s16 -> fltp", AV_SAMPLE_FMT_S16, 2, AV_SAMPLE_FMT_FLTP, 2 },
+        { "flt -> s16", AV_SAMPLE_FMT_FLT, 2, AV_SAMPLE_FMT_S16, 2 },
+        { "fltp -> s16p", AV_SAMPLE_FMT_FLTP, 2, AV_SAMPLE_FMT_S16P, 2 },
+        { "flt -> fltp", AV_SAMPLE_FMT_FLT, 2, AV_SAMPLE_FMT_FLTP, 2 },
+        { "fltp -> flt", AV_SAMPLE_FMT_FLTP, 2, AV_SAMPLE_FMT_FLT, 2 },
+        { "mono -> fltp", AV_SAMPLE_FMT_FLTP, 1, AV_SAMPLE_FMT_FLTP, 2 },
+    };
+
+    std::vector<const char*> implementations = FFAV::AudioKernels::getAvailableImplementations();
+    printf("%-14s %10s", "Mframes/s", "swr");
+    for ( const char* name : implementations ) printf(" %10s", name);
+    printf("\n");
+
+    for ( const Case& c : cases ) {
+        if ( !FFAV::AudioKernels::canConvert(c.dst_fmt, c.dst_channels, c.src_fmt, c.src_channels) ) {
+            fprintf(stderr, "%s: not supported by AudioKernels\n", c.name);
+            continue;
+        }
+
+        double swr = run_swr(c, nb_frames);
+        printf("%-14s %10.1f", c.name, swr / 1e6);
+        for ( const char* name : implementations ) {
+            FFAV::AudioKernels::setImplementation(name);
+            double kernels = run_kernels(c, nb_frames);
+            printf(" %6.1f(%2.0fx)", kernels / 1e6, swr > 0 ? kernels / swr : 0);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+//
+// Created on 2025/6/15.
+//
+// 大量并发 reader 时 IOScheduler 与每个 reader 一个线程(此前每个 FFCoreAudioReader 一个串行队列, EOF/缓冲已满时阻塞)的对比;
+//
+// 每个 reader 按 FFCoreAudioReader 的方式工作: 每步最多读取 16 个 packet(pread, 可附加模拟的网络延迟),
+// 缓冲已满时返回 Wait, 消费者取走数据使缓冲由满变为不满时 wake;
+// 消费者线程模拟播放, 每 10ms 从每个 reader 取走一个 packet; 预热之后缓冲为空即记为一次欠载(underrun);
+//
+// 用法: reader_scale_bench [-n readers,...] [-d seconds] [-l latency_us] [-w workers] [-f file]
+
+#include "bench_common.h"
+#include "IOScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const int READ_PACKETS_PER_STEP = 16;    // 与 FFCoreAudioReader 相同
+static const int PACKET_SIZE = 4096;            // 每 10ms 一个 packet, 约 400KB/s(高码率无损)
+static const int BUFFER_CAPACITY = 32;          // 约 320ms
+static const auto TICK = std::chrono::milliseconds(10);
+static const auto WARMUP = std::chrono::milliseconds(300);
+
+struct Options {
+    double seconds { 5 };
+    int latency_us { 0 };
+    int workers { 0 };
+    int fd { -1 };
+    off_t file_size { 0 };
+};
+
+struct Reader {
+    const Options& options;
+    off_t offset;
+    std::vector<char> scratch = std::vector<char>(PACKET_SIZE);
+
+    std::mutex mtx;
+    std::condition_variable cv;     // 仅用于线程模式
+    int buffered { 0 };
+    bool stopped { false };
+    long underruns { 0 };
+    std::shared_ptr<FFAV::IOTask> task;
+
+    Reader(const Options& options, off_t offset): options(options), offset(offset) { }
+
+    // 读取一个 packet(可能阻塞)
+    void readPacket() {
+        if ( offset + PACKET_SIZE > options.file_size ) offset = 0;
+        if ( pread(options.fd, scratch.data(), PACKET_SIZE, offset) != PACKET_SIZE ) {
+            perror("pread");
+        }
+        offset += PACKET_SIZE;
+        if ( options.latency_us > 0 ) std::this_thread::sleep_for(std::chrono::microseconds(options.latency_us));
+
+        std::lock_guard<std::mutex> lock(mtx);
+        ++buffered;
+    }
+
+    // IOScheduler 的 job; 与 FFCoreAudioReader::_onRead 相同的 Wait/Yield 策略
+    FFAV::IOTask::Status onRead() {
+        for ( int i = 0; i < READ_PACKETS_PER_STEP; ++i ) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if ( stopped ) return FFAV::IOTask::Status::Done;
+                if ( buffered >= BUFFER_CAPACITY ) return FFAV::IOTask::Status::Wait;
+            }
+            readPacket();
+        }
+        return FFAV::IOTask::Status::Yield;
+    }
+
+    // 线程模式; 缓冲已满时阻塞在条件变量上
+    void threadLoop() {
+        while ( true ) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopped || buffered < BUFFER_CAPACITY; });
+                if ( stopped ) return;
+            }
+            readPacket();
+        }
+    }
+
+    // 消费者取走一个 packet; 返回缓冲是否由满变为不满
+    bool consume(bool count_underrun) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( buffered == 0 ) {
+            if ( count_underrun ) ++underruns;
+            return false;
+        }
+        return buffered-- == BUFFER_CAPACITY;
+    }
+};
+
+static int thread_count() {
+    FILE* file = fopen("/proc/self/status", "r");
+    if ( file == nullptr ) return -1;
+    char line[128];
+    int threads = -1;
+    while ( fgets(line, sizeof(line), file) ) {
+        if ( sscanf(line, "Threads: %d", &threads) == 1 ) break;
+    }
+    fclose(file);
+    return threads;
+}
+
+struct Result {
+    int peak_threads { 0 };
+    double cpu { 0 };
+    long underruns { 0 };
+    long ticks { 0 };           // 统计欠载的 reader-tick 数
+    long late_ticks { 0 };      // 消费者自身落后超过一个 tick 的次数
+};
+
+static void run(const Options& options, int nb_readers, bool use_scheduler, Result& result) {
+    std::unique_ptr<FFAV::IOScheduler> scheduler;
+    if ( use_scheduler ) scheduler = std::make_unique<FFAV::IOScheduler>(options.workers);
+
+    std::vector<std::unique_ptr<Reader>> readers;
+    std::vector<std::thread> threads;
+    off_t nb_slots = std::max<off_t>(1, options.file_size / PACKET_SIZE);
+    for ( int i = 0; i < nb_readers; ++i ) {
+        readers.push_back(std::make_unique<Reader>(options, (off_t)(i * 7919 % nb_slots) * PACKET_SIZE));
+    }
+
+    double cpu_begin = bench::cpuSeconds();
+    for ( auto& reader : readers ) {
+        if ( use_scheduler ) {
+            reader->task = scheduler->createTask();
+            Reader* r = reader.get();
+            reader->task->post([r] { return r->onRead(); });
+        }
+        else {
+            threads.emplace_back(&Reader::threadLoop, reader.get());
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::microseconds((int64_t)(options.seconds * 1e6));
+    auto next = start + TICK;
+    for ( ; next < end; next += TICK ) {
+        std::this_thread::sleep_until(next);
+        auto now = std::chrono::steady_clock::now();
+        if ( now - next > TICK ) ++result.late_ticks;
+
+        bool count = now - start >= WARMUP;
+        for ( auto& reader : readers ) {
+            if ( reader->consume(count) ) {
+                if ( use_scheduler ) reader->task->wake();
+                else reader->cv.notify_one();
+            }
+        }
+        if ( count ) result.ticks += nb_readers;
+        result.peak_threads = std::max(result.peak_threads, thread_count());
+    }
+
+    for ( auto& reader : readers ) {
+        {
+            std::lock_guard<std::mutex> lock(reader->mtx);
+            reader->stopped = true;
+        }
+        if ( use_scheduler ) reader->task->wake();
+        else reader->cv.notify_one();
+    }
+    for ( auto& thread : threads ) thread.join();
+    scheduler.reset(); // 等待 worker 退出
+    result.cpu = bench::cpuSeconds() - cpu_begin;
+
+    for ( auto& reader : readers ) result.underruns += reader->underruns;
+}
+
+static std::vector<int> parse_list(const std::string& arg) {
+    std::vector<int> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while ( std::getline(ss, item, ',') ) values.push_back(atoi(item.c_str()));
+    return values;
+}
+
+int main(int argc, const char* argv[]) {
+    Options options;
+    std::vector<int> reader_counts = { 50, 200, 500 };
+    std::string path;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( arg == "-n" && i + 1 < argc ) {
+            reader_counts = parse_list(argv[++i]);
+        }
+        else if ( arg == "-d" && i + 1 < argc ) {
+            options.seconds = atof(argv[++i]);
+        }
+        else if ( arg == "-l" && i + 1 < argc ) {
+            options.latency_us = atoi(argv[++i]);
+        }
+        else if ( arg == "-w" && i + 1 < argc ) {
+            options.workers = atoi(argv[++i]);
+        }
+        else if ( arg == "-f" && i + 1 < argc ) {
+            path = argv[++i];
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n readers,...] [-d seconds] [-l latency_us] [-w workers] [-f file]\n", argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // 未指定文件时生成 32MB 的临时文件
+    if ( path.empty() ) {
+        char tmp[] = "/tmp/reader_scale_bench.XXXXXX";
+        options.fd = mkstemp(tmp);
+        if ( options.fd >= 0 ) {
+            unlink(tmp);
+            std::vector<char> chunk(1 << 20, 0x5a);
+            for ( int i = 0; i < 32; ++i ) {
+                if ( write(options.fd, chunk.data(), chunk.size()) != (ssize_t)chunk.size() ) break;
+            }
+        }
+    }
+    else {
+        options.fd = open(path.c_str(), O_RDONLY);
+    }
+    if ( options.fd < 0 || (options.file_size = lseek(options.fd, 0, SEEK_END)) < PACKET_SIZE ) {
+        fprintf(stderr, "cannot open input file\n");
+        return 1;
+    }
+
+    int nb_workers = FFAV::IOScheduler(options.workers).getWorkerCount();
+    printf("%.0fs per run, %d us read latency, scheduler workers %d\n", options.seconds, options.latency_us, nb_workers);
+    printf("%-10s %8s %10s %12s %14s %12s\n", "mode", "readers", "threads", "cpu(s)", "underrun(%)", "late ticks");
+    for ( int nb_readers : reader_counts ) {
+        if ( nb_readers <= 0 ) continue;
+        for ( bool use_scheduler : { false, true } ) {
+            Result result;
+            run(options, nb_readers, use_scheduler, result);
+            double underrun = result.ticks > 0 ? 100.0 * result.underruns / result.ticks : 0;
+            printf("%-10s %8d %10d %12.3f %14.3f %12ld\n", use_scheduler ? "scheduler" : "thread", nb_readers, result.peak_threads, result.cpu, underrun, result.late_ticks);
+        }
+    }
+    close(options.fd);
+    return 0;
+}
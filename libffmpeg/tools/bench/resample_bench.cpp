@@ -0,0 +1,212 @@
+//
+// Created on 2025/6/15.
+//
+// 各重采样质量预设(ResamplePresets)的 CPU 开销与音质; 默认 48000 -> 44100;
+// aresample 把选项原样转交给 swr, 这里直接以相同的选项字符串配置 SwrContext, 排除 graph 本身的开销;
+//
+// 音质:
+//   THD+N: -1dBFS 1kHz 正弦, 最小二乘拟合出基波后, 残差(谐波 + 噪声 + 混叠)相对基波的能量, dB;
+//   ripple: 20Hz ~ 18kHz 各频点增益的最大值与最小值之差, dB; 同时列出 20kHz 处的增益(截止频率附近的滚降);
+//   alias: 输入奈奎斯特频率以上(23kHz)的正弦折叠到输出中的电平, dB;
+//
+// 用法: resample_bench [-d seconds] [-i input_rate] [-o output_rate]
+
+#include "bench_common.h"
+#include "ResamplePresets.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/log.h>
+#include <libavutil/opt.h>
+#include <libswresample/swresample.h>
+}
+
+static const int CHUNK = 1024;
+
+struct Preset {
+    const char* name;
+    FFAV::ResampleQuality quality;
+};
+
+static SwrContext* _Nullable create_swr(FFAV::ResampleQuality quality, int nb_channels, int in_rate, int out_rate) {
+    AVChannelLayout layout;
+    av_channel_layout_default(&layout, nb_channels);
+    SwrContext* swr = nullptr;
+    int ret = swr_alloc_set_opts2(&swr, &layout, AV_SAMPLE_FMT_FLTP, out_rate, &layout, AV_SAMPLE_FMT_FLTP, in_rate, 0, nullptr);
+    std::string options = FFAV::ResamplePresets::getOptions(quality);
+    if ( ret >= 0 && !options.empty() ) ret = av_set_options_string(swr, options.c_str() + 1, "=", ":"); // 跳过开头的 ':'
+    if ( ret >= 0 ) ret = swr_init(swr);
+    if ( ret < 0 ) {
+        fprintf(stderr, "swr_init failed: %s\n", bench::errorString(ret).c_str());
+        swr_free(&swr);
+    }
+    return swr;
+}
+
+// 单声道正弦经过重采样, 返回输出(包括 flush 的部分)
+static std::vector<float> resample_sine(FFAV::ResampleQuality quality, int in_rate, int out_rate, double freq, double amplitude, double seconds) {
+    std::vector<float> output;
+    SwrContext* swr = create_swr(quality, 1, in_rate, out_rate);
+    if ( swr == nullptr ) {
+        return output;
+    }
+
+    int64_t total = (int64_t)(seconds * in_rate);
+    int out_capacity = swr_get_out_samples(swr, CHUNK) + 64;
+    std::vector<float> in(CHUNK), out(out_capacity);
+    for ( int64_t pos = 0; ; pos += CHUNK ) {
+        int n = (int)std::min<int64_t>(CHUNK, total - pos);
+        for ( int i = 0; i < n; ++i ) in[i] = (float)(amplitude * sin(2 * M_PI * freq * (pos + i) / in_rate));
+        const uint8_t* src = (const uint8_t*)in.data();
+        uint8_t* dst = (uint8_t*)out.data();
+        int ret = swr_convert(swr, &dst, out_capacity, n > 0 ? &src : nullptr, std::max(0, n));
+        if ( ret <= 0 && n <= 0 ) break;
+        if ( ret > 0 ) output.insert(output.end(), out.begin(), out.begin() + ret);
+    }
+    swr_free(&swr);
+    return output;
+}
+
+// 最小二乘拟合 a*sin + b*cos, 返回基波幅度; residual 为残差的均方值
+static double fit_sine(const std::vector<float>& signal, size_t begin, size_t end, double freq, int rate, double* _Nullable residual) {
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+    for ( size_t i = begin; i < end; ++i ) {
+        double w = 2 * M_PI * freq * i / rate;
+        double s = sin(w), c = cos(w);
+        ss += s * s; cc += c * c; sc += s * c;
+        ys += signal[i] * s; yc += signal[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    if ( residual ) {
+        double sum = 0;
+        for ( size_t i = begin; i < end; ++i ) {
+            double w = 2 * M_PI * freq * i / rate;
+            double r = signal[i] - (a * sin(w) + b * cos(w));
+            sum += r * r;
+        }
+        *residual = sum / (end - begin);
+    }
+    return sqrt(a * a + b * b);
+}
+
+// 跳过开头与结尾各 0.1s(滤波器的建立与 flush)后测量; 输出过短返回 false
+static bool measure_sine(FFAV::ResampleQuality quality, int in_rate, int out_rate, double freq, double in_freq, double& amplitude, double* _Nullable residual) {
+    std::vector<float> out = resample_sine(quality, in_rate, out_rate, in_freq, 0.891, 1.0); // -1dBFS
+    size_t margin = out_rate / 10;
+    if ( out.size() <= margin * 3 ) {
+        return false;
+    }
+    amplitude = fit_sine(out, margin, out.size() - margin, freq, out_rate, residual) / 0.891;
+    return true;
+}
+
+static double to_db(double x) {
+    return 20 * log10(std::max(x, 1e-12));
+}
+
+// 返回每秒处理的输入采样数(立体声); 出错返回小于 0
+static double run_cpu(FFAV::ResampleQuality quality, int in_rate, int out_rate, double seconds, double& cpu) {
+    SwrContext* swr = create_swr(quality, 2, in_rate, out_rate);
+    if ( swr == nullptr ) {
+        return -1;
+    }
+
+    // 与 makeTestFrame 相同的信号; 只需要平面数据, 不经过 AVFrame
+    std::vector<float> in0(CHUNK), in1(CHUNK);
+    for ( int i = 0; i < CHUNK; ++i ) {
+        double t = (double)i / in_rate;
+        in0[i] = (float)(0.2 * sin(2 * M_PI * 110 * t) + 0.15 * sin(2 * M_PI * 1000 * t) + 0.1 * sin(2 * M_PI * 6000 * t));
+        in1[i] = (float)(0.2 * sin(2 * M_PI * 110 * t) + 0.15 * sin(2 * M_PI * 1030 * t) + 0.1 * sin(2 * M_PI * 6000 * t));
+    }
+    const uint8_t* src[2] = { (const uint8_t*)in0.data(), (const uint8_t*)in1.data() };
+    int out_capacity = swr_get_out_samples(swr, CHUNK) + 64;
+    std::vector<float> out0(out_capacity), out1(out_capacity);
+    uint8_t* dst[2] = { (uint8_t*)out0.data(), (uint8_t*)out1.data() };
+    int64_t total = (int64_t)(seconds * in_rate);
+    int ret = 0;
+
+    double begin = bench::cpuSeconds();
+    for ( int64_t pos = 0; pos < total && ret >= 0; pos += CHUNK ) {
+        ret = swr_convert(swr, dst, out_capacity, src, CHUNK);
+    }
+    cpu = bench::cpuSeconds() - begin;
+
+    swr_free(&swr);
+    return ret < 0 ? ret : total / cpu;
+}
+
+int main(int argc, const char* argv[]) {
+    double seconds = 60;
+    int in_rate = 48000;
+    int out_rate = 44100;
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg = argv[i];
+        if ( arg == "-d" && i + 1 < argc ) {
+            seconds = atof(argv[++i]);
+        }
+        else if ( arg == "-i" && i + 1 < argc ) {
+            in_rate = atoi(argv[++i]);
+        }
+        else if ( arg == "-o" && i + 1 < argc ) {
+            out_rate = atoi(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "usage: %s [-d seconds] [-i input_rate] [-o output_rate]\n", argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if ( in_rate <= 0 || out_rate <= 0 ) {
+        fprintf(stderr, "invalid sample rate\n");
+        return 1;
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    const Preset presets[] = {
+        { "low", FFAV::ResampleQuality::Low },
+        { "balanced", FFAV::ResampleQuality::Balanced },
+        { "high", FFAV::ResampleQuality::High },
+    };
+    const double ripple_freqs[] = { 20, 100, 500, 1000, 2000, 4000, 8000, 12000, 16000, 18000 };
+    int nyquist = std::min(in_rate, out_rate) / 2;
+    double alias_in = in_rate > out_rate ? out_rate / 2.0 + (in_rate - out_rate) / 4.0 : 0; // 两个奈奎斯特频率之间
+    double alias_out = out_rate - alias_in;
+
+    printf("%d -> %d, %.0fs\n", in_rate, out_rate, seconds);
+    printf("%-10s %10s %12s %10s %12s %12s %10s\n", "preset", "cpu(s)", "ms/audio-sec", "thd+n(dB)", "ripple(dB)", "@20kHz(dB)", "alias(dB)");
+    int failed = 0;
+    for ( const Preset& preset : presets ) {
+        double cpu = 0;
+        if ( run_cpu(preset.quality, in_rate, out_rate, seconds, cpu) < 0 ) {
+            ++failed;
+            continue;
+        }
+
+        double amplitude = 0, residual = 0;
+        if ( !measure_sine(preset.quality, in_rate, out_rate, 1000, 1000, amplitude, &residual) ) {
+            ++failed;
+            continue;
+        }
+        double thdn = to_db(sqrt(residual) / (amplitude * 0.891 / M_SQRT2));
+
+        double min_gain = 1e9, max_gain = -1e9;
+        for ( double freq : ripple_freqs ) {
+            if ( freq >= nyquist || !measure_sine(preset.quality, in_rate, out_rate, freq, freq, amplitude, nullptr) ) continue;
+            min_gain = std::min(min_gain, to_db(amplitude));
+            max_gain = std::max(max_gain, to_db(amplitude));
+        }
+
+        char rolloff[16] = "-", alias[16] = "-";
+        if ( 20000 < nyquist && measure_sine(preset.quality, in_rate, out_rate, 20000, 20000, amplitude, nullptr) ) snprintf(rolloff, sizeof(rolloff), "%.2f", to_db(amplitude));
+        if ( alias_in > 0 && measure_sine(preset.quality, in_rate, out_rate, alias_out, alias_in, amplitude, nullptr) ) snprintf(alias, sizeof(alias), "%.1f", to_db(amplitude));
+
+        printf("%-10s %10.3f %12.3f %10.1f %12.4f %12s %10s\n", preset.name, cpu, cpu * 1000 / seconds, thdn, max_gain - min_gain, rolloff, alias);
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+//
+// Created on 2025/6/15.
+//
+// SJAudioCrossfader(SJAudioPlayer 切换音频时使用的交叉淡化)的增益曲线与分块处理:
+//
+//  - 淡入从 0 到 1, 淡出为其镜像; 等功率曲线两侧功率之和为 1, 线性曲线两侧增益之和为 1;
+//  - 按任意大小分块处理的结果与一次处理相同, 淡化结束之后的采样保持原样;
+//  - 未知的曲线按等功率处理, 时长为 0 时不淡化;
+
+#include "test_common.h"
+#include "SJAudioCrossfader.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+static const int DURATION = 10000;
+
+// 分别测量淡入与淡出的增益: incoming/outgoing 一侧为 1, 另一侧为 0
+static void measure_gains(SJAudioCrossfader::Curve curve, std::vector<float>& gain_in, std::vector<float>& gain_out) {
+    gain_in.assign(DURATION, 0);
+    gain_out.assign(DURATION, 0);
+    auto fader_in = std::make_unique<SJAudioCrossfader>();
+    auto fader_out = std::make_unique<SJAudioCrossfader>();
+    fader_in->begin(DURATION, curve);
+    fader_out->begin(DURATION, curve);
+
+    std::vector<float> ones(SJAudioCrossfader::MAX_FRAMES), zeros(SJAudioCrossfader::MAX_FRAMES);
+    for ( int offset = 0; offset < DURATION; ) {
+        int n = std::min(SJAudioCrossfader::MAX_FRAMES, DURATION - offset);
+        std::fill(ones.begin(), ones.end(), 1.0f);
+        std::fill(zeros.begin(), zeros.end(), 0.0f);
+        float* in[1] = { ones.data() };
+        float* out[1] = { zeros.data() };
+        fader_in->process(in, out, 1, n);
+        std::copy(ones.begin(), ones.begin() + n, gain_in.begin() + offset);
+
+        std::fill(ones.begin(), ones.end(), 1.0f);
+        std::fill(zeros.begin(), zeros.end(), 0.0f);
+        float* in2[1] = { zeros.data() };
+        float* out2[1] = { ones.data() };
+        fader_out->process(in2, out2, 1, n);
+        std::copy(zeros.begin(), zeros.begin() + n, gain_out.begin() + offset);
+        offset += n;
+    }
+    TEST_CHECK(!fader_in->isActive() && !fader_out->isActive());
+}
+
+static void test_curves() {
+    std::vector<float> gain_in, gain_out;
+
+    measure_gains(SJAudioCrossfader::EqualPower, gain_in, gain_out);
+    TEST_CHECK_NEAR(gain_in[0], 0, 1e-6);
+    TEST_CHECK_NEAR(gain_out[0], 1, 1e-6);
+    TEST_CHECK_NEAR(gain_in[DURATION - 1], 1, 1e-3);
+    TEST_CHECK_NEAR(gain_in[DURATION / 2], 0.70710678, 1e-4); // -3dB
+    bool constant_power = true;
+    bool monotonic = true;
+    for ( int i = 0; i < DURATION; ++i ) {
+        double power = (double)gain_in[i] * gain_in[i] + (double)gain_out[i] * gain_out[i];
+        constant_power = constant_power && power > 1 - 1e-4 && power < 1 + 1e-4;
+        if ( i > 0 ) monotonic = monotonic && gain_in[i] >= gain_in[i - 1] && gain_out[i] <= gain_out[i - 1];
+    }
+    TEST_CHECK(constant_power);
+    TEST_CHECK(monotonic);
+
+    measure_gains(SJAudioCrossfader::Linear, gain_in, gain_out);
+    TEST_CHECK_NEAR(gain_in[DURATION / 2], 0.5, 1e-5); // -6dB
+    bool constant_sum = true;
+    for ( int i = 0; i < DURATION; ++i ) {
+        constant_sum = constant_sum && gain_in[i] + gain_out[i] > 1 - 1e-5f && gain_in[i] + gain_out[i] < 1 + 1e-5f;
+    }
+    TEST_CHECK(constant_sum);
+
+    measure_gains(SJAudioCrossfader::SCurve, gain_in, gain_out);
+    TEST_CHECK_NEAR(gain_in[DURATION / 2], 0.5, 1e-4);
+    TEST_CHECK(gain_in[DURATION / 10] < 0.1f); // 两端平缓: 开始阶段低于线性
+
+    // 未知的曲线按等功率处理
+    std::vector<float> fallback_in, fallback_out;
+    measure_gains((SJAudioCrossfader::Curve)7, fallback_in, fallback_out);
+    measure_gains(SJAudioCrossfader::EqualPower, gain_in, gain_out);
+    TEST_CHECK(fallback_in == gain_in && fallback_out == gain_out);
+}
+
+// 渲染块的大小不固定; 分块处理的结果应与整块处理相同
+static void test_chunking() {
+    const int total = DURATION + 3000; // 淡化在最后一块的中途结束
+    std::vector<float> incoming(total), outgoing(total);
+    std::minstd_rand rng(20250615);
+    for ( int i = 0; i < total; ++i ) {
+        incoming[i] = (float)(rng() % 2001) / 1000.0f - 1.0f;
+        outgoing[i] = (float)(rng() % 2001) / 1000.0f - 1.0f;
+    }
+
+    auto render = [&](auto next_size) {
+        std::vector<float> in = incoming, out = outgoing;
+        auto fader = std::make_unique<SJAudioCrossfader>();
+        fader->begin(DURATION, SJAudioCrossfader::SCurve);
+        for ( int offset = 0; offset < total; ) {
+            int n = std::min(next_size(), total - offset);
+            float* in_planes[1] = { in.data() + offset };
+            float* out_planes[1] = { out.data() + offset };
+            fader->process(in_planes, out_planes, 1, n);
+            offset += n;
+        }
+        TEST_CHECK(!fader->isActive());
+        return in;
+    };
+
+    std::vector<float> whole = render([] { return SJAudioCrossfader::MAX_FRAMES; });
+    std::vector<float> chunked = render([&] { return 1 + (int)(rng() % 1500); });
+    TEST_CHECK(whole == chunked);
+
+    // 淡化结束之后 incoming 保持原样
+    TEST_CHECK(std::equal(whole.begin() + DURATION, whole.end(), incoming.begin() + DURATION));
+    TEST_CHECK(!std::equal(whole.begin(), whole.begin() + DURATION, incoming.begin()));
+}
+
+static void test_inactive() {
+    auto fader = std::make_unique<SJAudioCrossfader>();
+    TEST_CHECK(!fader->isActive());
+
+    std::vector<float> in(256, 0.5f), out(256, 0.25f);
+    float* in_planes[1] = { in.data() };
+    float* out_planes[1] = { out.data() };
+
+    fader->begin(0, SJAudioCrossfader::EqualPower);
+    TEST_CHECK(!fader->isActive());
+    fader->process(in_planes, out_planes, 1, 256);
+    TEST_CHECK(std::all_of(in.begin(), in.end(), [](float v) { return v == 0.5f; }));
+
+    // 中途结束后不再混合
+    fader->begin(1000, SJAudioCrossfader::Linear);
+    fader->process(in_planes, out_planes, 1, 128);
+    TEST_CHECK(fader->isActive());
+    fader->end();
+    TEST_CHECK(!fader->isActive());
+    std::fill(in.begin(), in.end(), 0.5f);
+    fader->process(in_planes, out_planes, 1, 256);
+    TEST_CHECK(std::all_of(in.begin(), in.end(), [](float v) { return v == 0.5f; }));
+}
+
+int main() {
+    test_curves();
+    test_chunking();
+    test_inactive();
+    return TEST_RESULT();
+}
@@ -0,0 +1,252 @@
+//
+// Created on 2025/6/15.
+//
+// AudioKernels 各实现(neon/avx2/sse2)与标量实现逐位一致;
+//
+// 每个内核在多种长度(覆盖向量宽度的整数倍及各种尾部)与非对齐地址上运行, 输出按字节与标量实现比较;
+// 输入包含边界值: ±1 附近及超出范围的值、s16 的舍入中点(ties to even)、非规格化数与 -0;
+
+#include "test_common.h"
+#include "AudioKernels.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+using FFAV::AudioKernels;
+
+static const int LENGTHS[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1000, 4099 };
+static const int MAX_LENGTH = 4099;
+static const int OFFSET = 1; // 非对齐
+
+// 每个内核的输出(字节); 按名称与标量实现比较
+struct Output {
+    std::string name;
+    std::vector<uint8_t> bytes;
+};
+
+template <typename T>
+static void append(std::vector<Output>& outputs, const std::string& name, const T* data, size_t count) {
+    Output output { name, std::vector<uint8_t>((const uint8_t*)data, (const uint8_t*)(data + count)) };
+    outputs.push_back(std::move(output));
+}
+
+static std::vector<float> make_samples(uint32_t seed, int count, float range) {
+    std::vector<float> v(count + OFFSET);
+    for ( int i = 0; i < count + OFFSET; ++i ) {
+        seed = seed * 1664525u + 1013904223u;
+        v[i] = ((seed >> 8) / 16777216.0f * 2 - 1) * range;
+    }
+    return v;
+}
+
+// float -> s16 的边界输入
+static std::vector<float> make_edge_samples(int count) {
+    const float specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 1.5f, -1.5f, 32767.0f / 32768, 32767.5f / 32768, -32768.5f / 32768,
+        0.5f / 32768, 1.5f / 32768, 2.5f / 32768, -0.5f / 32768, -2.5f / 32768,
+        std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+    };
+    std::vector<float> v = make_samples(7, count, 1.2f);
+    for ( int i = 0; i < count + OFFSET; ++i ) {
+        if ( i % 3 == 0 ) v[i] = specials[(i / 3) % (sizeof(specials) / sizeof(specials[0]))];
+        else if ( i % 3 == 1 ) v[i] = (float)((int)(v[i] * 32768) + 0.5f) / 32768; // 舍入中点
+    }
+    return v;
+}
+
+static std::vector<Output> run_kernels() {
+    std::vector<Output> outputs;
+    for ( int n : LENGTHS ) {
+        std::string suffix = "[" + std::to_string(n) + "]";
+        std::vector<float> a = make_samples(1, n, 1.0f);
+        std::vector<float> b = make_samples(2, n, 1.0f);
+        std::vector<float> c = make_samples(3, n, 1.0f);
+        std::vector<float> d = make_samples(4, n, 1.0f);
+        std::vector<float> dst(n + OFFSET, 0.25f);
+
+        AudioKernels::scale(dst.data() + OFFSET, a.data() + OFFSET, 0.7071f, n);
+        append(outputs, "scale" + suffix, dst.data(), dst.size());
+
+        AudioKernels::mixAdd(dst.data() + OFFSET, b.data() + OFFSET, -0.3f, n);
+        append(outputs, "mixAdd" + suffix, dst.data(), dst.size());
+
+        for ( float gain : { 0.0f, 1.0f, 1.9f } ) {
+            std::vector<float> p0 = a, p1 = b;
+            float* planes[2] = { p0.data() + OFFSET, p1.data() + OFFSET };
+            AudioKernels::applyGain(planes, 2, gain, n);
+            append(outputs, "applyGain" + suffix, p0.data(), p0.size());
+            append(outputs, "applyGain" + suffix, p1.data(), p1.size());
+        }
+
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double sum_sq = 0;
+        AudioKernels::peakSummary(a.data() + OFFSET, n, min, max, sum_sq);
+        AudioKernels::peakSummary(b.data() + OFFSET, n, min, max, sum_sq);
+        append(outputs, "peakSummary.min" + suffix, &min, 1);
+        append(outputs, "peakSummary.max" + suffix, &max, 1);
+        append(outputs, "peakSummary.sum_sq" + suffix, &sum_sq, 1);
+
+        AudioKernels::multiply(dst.data() + OFFSET, a.data() + OFFSET, b.data() + OFFSET, n);
+        append(outputs, "multiply" + suffix, dst.data(), dst.size());
+
+        {
+            std::vector<float> re0 = a, im0 = b, re1 = c, im1 = d;
+            std::vector<float> wr = make_samples(5, n, 1.0f), wi = make_samples(6, n, 1.0f);
+            AudioKernels::fftButterfly(re0.data() + OFFSET, im0.data() + OFFSET, re1.data() + OFFSET, im1.data() + OFFSET, wr.data() + OFFSET, wi.data() + OFFSET, n);
+            append(outputs, "fftButterfly.re0" + suffix, re0.data(), re0.size());
+            append(outputs, "fftButterfly.im0" + suffix, im0.data(), im0.size());
+            append(outputs, "fftButterfly.re1" + suffix, re1.data(), re1.size());
+            append(outputs, "fftButterfly.im1" + suffix, im1.data(), im1.size());
+        }
+
+        AudioKernels::powerSpectrum(dst.data() + OFFSET, a.data() + OFFSET, b.data() + OFFSET, n);
+        append(outputs, "powerSpectrum" + suffix, dst.data(), dst.size());
+
+        AudioKernels::fillSilence(dst.data() + OFFSET, n);
+        append(outputs, "fillSilence" + suffix, dst.data(), dst.size());
+
+        {
+            std::vector<int16_t> s16(n + OFFSET);
+            for ( int i = 0; i < n + OFFSET; ++i ) s16[i] = (int16_t)(i * 2654435761u >> 16);
+            if ( n > 2 ) { s16[OFFSET] = -32768; s16[OFFSET + 1] = 32767; }
+            AudioKernels::s16ToFloat(dst.data() + OFFSET, s16.data() + OFFSET, n);
+            append(outputs, "s16ToFloat" + suffix, dst.data(), dst.size());
+
+            std::vector<float> edge = make_edge_samples(n);
+            std::fill(s16.begin(), s16.end(), 0);
+            AudioKernels::floatToS16(s16.data() + OFFSET, edge.data() + OFFSET, n);
+            append(outputs, "floatToS16" + suffix, s16.data(), s16.size());
+        }
+
+        // 交错/解交错: 立体声走向量实现, 单声道复制与 3 声道走通用路径
+        for ( int nb_channels : { 1, 2, 3 } ) {
+            std::string ch = "(" + std::to_string(nb_channels) + "ch)";
+            const float* src[3] = { a.data() + OFFSET, b.data() + OFFSET, c.data() + OFFSET };
+            std::vector<float> interleaved((size_t)n * nb_channels + OFFSET);
+            AudioKernels::interleave(interleaved.data() + OFFSET, src, nb_channels, n);
+            append(outputs, "interleave" + ch + suffix, interleaved.data(), interleaved.size());
+
+            std::vector<float> p0(n + OFFSET), p1(n + OFFSET), p2(n + OFFSET);
+            float* planes[3] = { p0.data() + OFFSET, p1.data() + OFFSET, p2.data() + OFFSET };
+            AudioKernels::deinterleave(planes, interleaved.data() + OFFSET, nb_channels, n);
+            append(outputs, "deinterleave" + ch + suffix, p0.data(), p0.size());
+            append(outputs, "deinterleave" + ch + suffix, p1.data(), p1.size());
+            append(outputs, "deinterleave" + ch + suffix, p2.data(), p2.size());
+        }
+        {
+            const float* mono[2] = { a.data() + OFFSET, a.data() + OFFSET };
+            std::vector<float> interleaved((size_t)n * 2 + OFFSET);
+            AudioKernels::interleave(interleaved.data() + OFFSET, mono, 2, n);
+            append(outputs, "interleave(mono->stereo)" + suffix, interleaved.data(), interleaved.size());
+        }
+
+        // 5.1 下混
+        {
+            AVChannelLayout layout { };
+            av_channel_layout_from_mask(&layout, AV_CH_LAYOUT_5POINT1);
+            std::vector<float> matrix;
+            AudioKernels::makeStereoDownmixMatrix(&layout, matrix);
+            std::vector<std::vector<float>> in;
+            const float* in_planes[6];
+            for ( int ch = 0; ch < 6; ++ch ) {
+                in.push_back(make_samples(10 + ch, n, 1.0f));
+                in_planes[ch] = in[ch].data() + OFFSET;
+            }
+            std::vector<float> l(n + OFFSET), r(n + OFFSET);
+            AudioKernels::downmixToStereoPlanar(in_planes, 6, matrix.data(), l.data() + OFFSET, r.data() + OFFSET, n);
+            append(outputs, "downmixToStereoPlanar.l" + suffix, l.data(), l.size());
+            append(outputs, "downmixToStereoPlanar.r" + suffix, r.data(), r.size());
+
+            std::vector<float> interleaved((size_t)n * 6 + OFFSET), out((size_t)n * 2 + OFFSET);
+            AudioKernels::interleave(interleaved.data() + OFFSET, in_planes, 6, n);
+            AudioKernels::downmixToStereoInterleaved(interleaved.data() + OFFSET, 6, matrix.data(), out.data() + OFFSET, n);
+            append(outputs, "downmixToStereoInterleaved" + suffix, out.data(), out.size());
+        }
+
+        // convert: s16 交错 -> fltp, fltp -> s16p, 单声道 flt -> 立体声 fltp
+        {
+            std::vector<int16_t> s16((size_t)n * 2 + OFFSET);
+            for ( size_t i = 0; i < s16.size(); ++i ) s16[i] = (int16_t)(i * 40503u);
+            std::vector<float> l(n + OFFSET), r(n + OFFSET);
+            const uint8_t* src[1] = { (const uint8_t*)(s16.data() + OFFSET) };
+            uint8_t* dst_planes[2] = { (uint8_t*)(l.data() + OFFSET), (uint8_t*)(r.data() + OFFSET) };
+            TEST_CHECK(AudioKernels::convert(dst_planes, AV_SAMPLE_FMT_FLTP, 2, src, AV_SAMPLE_FMT_S16, 2, n) == 0);
+            append(outputs, "convert(s16->fltp).l" + suffix, l.data(), l.size());
+            append(outputs, "convert(s16->fltp).r" + suffix, r.data(), r.size());
+
+            std::vector<float> e0 = make_edge_samples(n), e1 = make_edge_samples(n);
+            std::vector<int16_t> o0(n + OFFSET), o1(n + OFFSET);
+            const uint8_t* fsrc[2] = { (const uint8_t*)(e0.data() + OFFSET), (const uint8_t*)(e1.data() + OFFSET) };
+            uint8_t* s16_planes[2] = { (uint8_t*)(o0.data() + OFFSET), (uint8_t*)(o1.data() + OFFSET) };
+            TEST_CHECK(AudioKernels::convert(s16_planes, AV_SAMPLE_FMT_S16P, 2, fsrc, AV_SAMPLE_FMT_FLTP, 2, n) == 0);
+            append(outputs, "convert(fltp->s16p).0" + suffix, o0.data(), o0.size());
+            append(outputs, "convert(fltp->s16p).1" + suffix, o1.data(), o1.size());
+
+            const uint8_t* mono[1] = { (const uint8_t*)(a.data() + OFFSET) };
+            TEST_CHECK(AudioKernels::convert(dst_planes, AV_SAMPLE_FMT_FLTP, 2, mono, AV_SAMPLE_FMT_FLT, 1, n) == 0);
+            append(outputs, "convert(flt mono->fltp).l" + suffix, l.data(), l.size());
+            append(outputs, "convert(flt mono->fltp).r" + suffix, r.data(), r.size());
+        }
+    }
+    return outputs;
+}
+
+// 标量实现的几个已知结果, 确认基准本身正确
+static void check_scalar_reference() {
+    TEST_CHECK(AudioKernels::setImplementation("scalar"));
+
+    const int16_t s16[] = { -32768, -1, 0, 1, 16384, 32767 };
+    float f[6];
+    AudioKernels::s16ToFloat(f, s16, 6);
+    TEST_CHECK(f[0] == -1.0f && f[2] == 0.0f && f[4] == 0.5f && f[5] == 32767.0f / 32768);
+
+    const float in[] = { 1.0f, -1.0f, 1.5f, -1.5f, 0.5f / 32768, 1.5f / 32768, 2.5f / 32768, -0.5f / 32768 };
+    int16_t out[8];
+    AudioKernels::floatToS16(out, in, 8);
+    TEST_CHECK(out[0] == 32767 && out[1] == -32768 && out[2] == 32767 && out[3] == -32768);
+    TEST_CHECK(out[4] == 0 && out[5] == 2 && out[6] == 2 && out[7] == 0); // ties to even
+
+    const float x[] = { 3.0f, -4.0f };
+    float min = std::numeric_limits<float>::infinity(), max = -min;
+    double sum_sq = 0;
+    AudioKernels::peakSummary(x, 2, min, max, sum_sq);
+    TEST_CHECK(min == -4.0f && max == 3.0f && sum_sq == 25.0);
+}
+
+int main() {
+    check_scalar_reference();
+
+    std::vector<const char*> implementations = AudioKernels::getAvailableImplementations();
+    TEST_CHECK(!implementations.empty() && strcmp(implementations.back(), "scalar") == 0);
+    TEST_CHECK(!AudioKernels::setImplementation("unknown"));
+
+    TEST_CHECK(AudioKernels::setImplementation("scalar"));
+    std::vector<Output> reference = run_kernels();
+
+    for ( const char* name : implementations ) {
+        if ( strcmp(name, "scalar") == 0 ) {
+            continue;
+        }
+        TEST_CHECK(AudioKernels::setImplementation(name));
+        TEST_CHECK(strcmp(AudioKernels::getImplementationName(), name) == 0);
+
+        std::vector<Output> outputs = run_kernels();
+        TEST_CHECK(outputs.size() == reference.size());
+        int mismatches = 0;
+        for ( size_t i = 0; i < outputs.size() && i < reference.size(); ++i ) {
+            if ( outputs[i].bytes != reference[i].bytes ) {
+                fprintf(stderr, "%s: %s differs from scalar\n", name, outputs[i].name.c_str());
+                ++mismatches;
+            }
+        }
+        TEST_CHECK(mismatches == 0);
+        printf("%s: %zu outputs bit-exact with scalar\n", name, outputs.size() - mismatches);
+    }
+    return TEST_RESULT();
+}
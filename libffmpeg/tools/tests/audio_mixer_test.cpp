@@ -0,0 +1,237 @@
+//
+// Created on 2025/6/15.
+//
+// SJAudioMixerCore(SJAudioPlayer 中 SJAudioMixer 使用的混音核心)的混音结果与并发移除; 不接输出设备, 直接调用 render(null sink);
+//
+//  - 多个音源按增益求和, 声像只衰减一侧;
+//  - 音源返回的采样不足时其余部分视为静音, 未启用或返回 0 的音源不参与混音;
+//  - 请求超过 max_frames 时分块拉取, 输出连续;
+//  - 渲染线程持续 render 时反复添加/移除音源, removeSource 返回后不会再调用该回调;
+
+#include "test_common.h"
+#include "SJAudioMixerCore.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static const int FRAMES = 256;
+
+struct Output {
+    std::vector<float> left = std::vector<float>(FRAMES * 4, 123.0f); // 预填非零值, 检查是否被覆盖
+    std::vector<float> right = std::vector<float>(FRAMES * 4, 123.0f);
+    float* planes[2] = { left.data(), right.data() };
+};
+
+// 各声道输出常数的音源; count 为每次写入的采样数(-1 表示写满)
+static SJAudioMixerCore::RenderCallback constant_source(float left, float right, int count = -1) {
+    return [=](float* const* planes, int nb_samples) {
+        int n = count < 0 ? nb_samples : std::min(count, nb_samples);
+        std::fill(planes[0], planes[0] + n, left);
+        std::fill(planes[1], planes[1] + n, right);
+        return n;
+    };
+}
+
+static void test_sum_and_gain() {
+    SJAudioMixerCore mixer(2, 1024);
+    int a = mixer.addSource(constant_source(0.1f, 0.2f));
+    int b = mixer.addSource(constant_source(0.3f, -0.4f));
+    int c = mixer.addSource(constant_source(0.9f, 0.9f)); // 未启用
+    TEST_CHECK(a >= 0 && b >= 0 && c >= 0 && a != b && b != c);
+
+    mixer.setActive(a, true);
+    mixer.setActive(b, true);
+    mixer.setGain(a, 0.5f);
+    mixer.setGain(b, 2.0f);
+    TEST_CHECK(mixer.getActiveCount() == 2);
+    TEST_CHECK(mixer.isActive(a) && !mixer.isActive(c));
+
+    Output out;
+    TEST_CHECK(mixer.render(out.planes, FRAMES) == 2);
+    for ( int i = 0; i < FRAMES; ++i ) {
+        TEST_CHECK_NEAR(out.left[i], 0.1 * 0.5 + 0.3 * 2.0, 1e-6);
+        TEST_CHECK_NEAR(out.right[i], 0.2 * 0.5 - 0.4 * 2.0, 1e-6);
+    }
+    TEST_CHECK(out.left[FRAMES] == 123.0f); // 不越界写入
+
+    // 负增益按 0 处理
+    mixer.setGain(b, -1.0f);
+    mixer.render(out.planes, FRAMES);
+    TEST_CHECK_NEAR(out.left[0], 0.05, 1e-6);
+    TEST_CHECK_NEAR(out.right[0], 0.1, 1e-6);
+}
+
+static void test_pan() {
+    SJAudioMixerCore mixer(2, 1024);
+    int a = mixer.addSource(constant_source(1.0f, 1.0f));
+    int b = mixer.addSource(constant_source(0.5f, 0.5f));
+    mixer.setActive(a, true);
+    mixer.setActive(b, true);
+
+    Output out;
+    // 居中时两侧均不衰减
+    mixer.render(out.planes, FRAMES);
+    TEST_CHECK_NEAR(out.left[0], 1.5, 1e-6);
+    TEST_CHECK_NEAR(out.right[0], 1.5, 1e-6);
+
+    // a 偏右 0.5: 左侧 x0.5; b 完全偏左: 右侧 x0
+    mixer.setPan(a, 0.5f);
+    mixer.setPan(b, -1.0f);
+    mixer.render(out.planes, FRAMES);
+    TEST_CHECK_NEAR(out.left[FRAMES - 1], 0.5 + 0.5, 1e-6);
+    TEST_CHECK_NEAR(out.right[FRAMES - 1], 1.0 + 0.0, 1e-6);
+
+    // 超出范围时截断到 -1 ~ 1
+    mixer.setPan(a, 3.0f);
+    mixer.setPan(b, 0.0f);
+    mixer.render(out.planes, FRAMES);
+    TEST_CHECK_NEAR(out.left[0], 0.0 + 0.5, 1e-6);
+    TEST_CHECK_NEAR(out.right[0], 1.0 + 0.5, 1e-6);
+
+    // 单声道输出不受声像影响
+    SJAudioMixerCore mono(1, 1024);
+    int m = mono.addSource([](float* const* planes, int nb_samples) {
+        std::fill(planes[0], planes[0] + nb_samples, 0.25f);
+        return nb_samples;
+    });
+    mono.setActive(m, true);
+    mono.setPan(m, 1.0f);
+    mono.render(out.planes, FRAMES);
+    TEST_CHECK_NEAR(out.left[0], 0.25, 1e-6);
+}
+
+static void test_partial_and_silence() {
+    SJAudioMixerCore mixer(2, 1024);
+    int a = mixer.addSource(constant_source(0.5f, 0.5f, FRAMES / 4)); // 只写入 1/4
+    int b = mixer.addSource(constant_source(0.25f, 0.25f, FRAMES / 2));
+    int c = mixer.addSource(constant_source(0.9f, 0.9f, 0)); // 返回 0, 不参与混音
+    mixer.setActive(a, true);
+    mixer.setActive(b, true);
+    mixer.setActive(c, true);
+
+    Output out;
+    TEST_CHECK(mixer.render(out.planes, FRAMES) == 2);
+    TEST_CHECK_NEAR(out.left[0], 0.75, 1e-6);
+    TEST_CHECK_NEAR(out.left[FRAMES / 4], 0.25, 1e-6);
+    TEST_CHECK_NEAR(out.right[FRAMES / 2 - 1], 0.25, 1e-6);
+    TEST_CHECK(out.left[FRAMES / 2] == 0.0f);
+    TEST_CHECK(out.right[FRAMES - 1] == 0.0f);
+
+    // 没有启用的音源时输出静音
+    mixer.setActive(a, false);
+    mixer.setActive(b, false);
+    mixer.setActive(c, false);
+    std::fill(out.left.begin(), out.left.end(), 123.0f);
+    TEST_CHECK(mixer.render(out.planes, FRAMES) == 0);
+    TEST_CHECK(std::all_of(out.left.begin(), out.left.begin() + FRAMES, [](float v) { return v == 0.0f; }));
+    TEST_CHECK(std::all_of(out.right.begin(), out.right.begin() + FRAMES, [](float v) { return v == 0.0f; }));
+}
+
+// 请求超过 max_frames 时分块拉取; 音源输出递增的序号, 输出应连续
+static void test_chunking() {
+    SJAudioMixerCore mixer(2, 100);
+    int counter = 0;
+    int max_request = 0;
+    int id = mixer.addSource([&](float* const* planes, int nb_samples) {
+        max_request = std::max(max_request, nb_samples);
+        for ( int i = 0; i < nb_samples; ++i, ++counter ) {
+            planes[0][i] = (float)counter;
+            planes[1][i] = (float)-counter;
+        }
+        return nb_samples;
+    });
+    mixer.setActive(id, true);
+
+    Output out;
+    mixer.render(out.planes, FRAMES * 3 + 17);
+    TEST_CHECK(max_request == 100);
+    bool continuous = true;
+    for ( int i = 0; i < FRAMES * 3 + 17; ++i ) {
+        continuous = continuous && out.left[i] == (float)i && out.right[i] == (float)-i;
+    }
+    TEST_CHECK(continuous);
+}
+
+static void test_slots() {
+    SJAudioMixerCore mixer(2, 1024);
+    std::vector<int> ids;
+    for ( int i = 0; i < SJAudioMixerCore::MAX_SOURCES; ++i ) {
+        ids.push_back(mixer.addSource(constant_source(0, 0)));
+    }
+    TEST_CHECK(std::none_of(ids.begin(), ids.end(), [](int id) { return id < 0; }));
+    TEST_CHECK(mixer.addSource(constant_source(0, 0)) == -1);
+
+    // 移除后槽位可以复用, 新的音源默认未启用、增益 1、声像居中
+    mixer.setActive(ids[5], true);
+    mixer.setGain(ids[5], 0.1f);
+    mixer.setPan(ids[5], 1.0f);
+    mixer.removeSource(ids[5]);
+    mixer.removeSource(ids[5]); // 重复移除无效果
+    mixer.removeSource(-1);
+    mixer.removeSource(SJAudioMixerCore::MAX_SOURCES);
+    int id = mixer.addSource(constant_source(0.5f, 0.5f));
+    TEST_CHECK(id == ids[5]);
+    TEST_CHECK(!mixer.isActive(id));
+    mixer.setActive(id, true);
+
+    Output out;
+    mixer.render(out.planes, FRAMES);
+    TEST_CHECK_NEAR(out.left[0], 0.5, 1e-6);
+    TEST_CHECK_NEAR(out.right[0], 0.5, 1e-6);
+}
+
+// 回调持有的资源在 removeSource 返回后立即释放; 渲染线程不能再访问
+static void test_concurrent_remove() {
+    struct Resource {
+        std::atomic<bool> alive { true };
+    };
+
+    SJAudioMixerCore mixer(2, 256);
+    std::atomic<bool> running { true };
+    std::atomic<long> use_after_remove { 0 };
+    std::atomic<long> renders { 0 };
+
+    std::thread renderer([&] {
+        Output out;
+        while ( running.load(std::memory_order_relaxed) ) {
+            mixer.render(out.planes, FRAMES);
+            renders.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    const int iterations = 20000;
+    for ( int i = 0; i < iterations; ++i ) {
+        auto resource = std::make_unique<Resource>();
+        Resource* raw = resource.get();
+        int id = mixer.addSource([raw, &use_after_remove](float* const* planes, int nb_samples) {
+            if ( !raw->alive.load(std::memory_order_relaxed) ) use_after_remove.fetch_add(1, std::memory_order_relaxed);
+            std::fill(planes[0], planes[0] + nb_samples, 0.1f);
+            std::fill(planes[1], planes[1] + nb_samples, 0.1f);
+            return nb_samples;
+        });
+        mixer.setActive(id, true);
+        if ( i % 4 == 0 ) std::this_thread::yield();
+        mixer.removeSource(id);
+        // 移除返回后标记为已释放; 渲染线程若之后仍调用该回调即计数
+        raw->alive.store(false, std::memory_order_relaxed);
+        resource.reset();
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    renderer.join();
+    TEST_CHECK(use_after_remove.load() == 0);
+    TEST_CHECK(mixer.getActiveCount() == 0);
+    printf("%d add/remove cycles during %ld renders\n", iterations, renders.load());
+}
+
+int main() {
+    test_sum_and_gain();
+    test_pan();
+    test_partial_and_silence();
+    test_chunking();
+    test_slots();
+    test_concurrent_remove();
+    return TEST_RESULT();
+}
@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# 在 Linux 上构建并运行 utils 及 SJAudioPlayer 中 C++ 源文件的测试; 依赖系统安装的 FFmpeg 开发包(libavformat-dev, libavcodec-dev, libavfilter-dev, libswresample-dev)
+# 用法: ./build.sh [output_dir] [test...]     未指定 test 时构建并运行全部
+
+set -e
+
+CXX=${CXX:-clang++}
+OUTPUT_DIR=${1:-.}
+shift || true
+TESTS_DIR="$(cd "$(dirname "$0")" && pwd)"
+ROOT_DIR="$(cd "$TESTS_DIR/../.." && pwd)"
+UTILS_DIR="$ROOT_DIR/libffmpeg/src/core/utils"
+POD_DIR="$(cd "$ROOT_DIR/../SJAudioPlayer" && pwd)"
+
+# 各测试依赖的 utils 源文件
+declare -A SOURCES=(
+  [audio_crossfader_test]=""
+  [audio_kernels_test]="AudioKernels.cpp"
+  [audio_mixer_test]=""
+  [command_channel_test]="CommandChannel.cpp"
+  [segment_clipper_test]="SegmentedDecoder.cpp MediaReader.cpp MediaDecoder.cpp AudioUtils.cpp AudioKernels.cpp FilterGraph.cpp AudioFifo.cpp AudioEncoder.cpp AudioMuxer.cpp AudioWriter.cpp MediaObjectPool.cpp"
+  [time_range_list_test]="TimeRangeList.cpp"
+  [transcode_alloc_test]="MediaDecoder.cpp FilterGraph.cpp AudioKernels.cpp"
+)
+
+# 各测试依赖的 SJAudioPlayer 源文件
+declare -A POD_SOURCES=(
+  [audio_crossfader_test]="SJAudioCrossfader.cpp"
+  [audio_mixer_test]="SJAudioMixerCore.cpp"
+)
+
+NAMES=("$@")
+if [ ${#NAMES[@]} -eq 0 ]; then
+  NAMES=($(printf '%s\n' "${!SOURCES[@]}" | sort))
+fi
+
+# _Nullable/_Nonnull 仅 clang 支持
+if ! $CXX --version | grep -q clang; then
+  EXTRA_FLAGS="-D_Nullable= -D_Nonnull="
+fi
+
+# Accelerate 仅在 Apple 平台上存在, 其余平台使用 shim 中的标量实现
+if [ "$(uname)" = "Darwin" ]; then
+  EXTRA_FLAGS="$EXTRA_FLAGS -framework Accelerate"
+else
+  EXTRA_FLAGS="$EXTRA_FLAGS -I$TESTS_DIR/shim"
+fi
+
+mkdir -p "$OUTPUT_DIR"
+FAILED=0
+for name in "${NAMES[@]}"; do
+  files=("$TESTS_DIR/$name.cpp")
+  for src in ${SOURCES[$name]}; do
+    files+=("$UTILS_DIR/$src")
+  done
+  for src in ${POD_SOURCES[$name]}; do
+    files+=("$POD_DIR/$src")
+  done
+
+  # -ffp-contract=off: 与 AudioKernels.cpp 中的 FP_CONTRACT OFF 一致(gcc 不识别该 pragma)
+  $CXX -std=c++20 -O2 -g -pthread -ffp-contract=off $EXTRA_FLAGS \
+    -I"$UTILS_DIR" -I"$POD_DIR" -I"$TESTS_DIR" \
+    "${files[@]}" \
+    $(pkg-config --cflags --libs libavformat libavcodec libavfilter libswresample libavutil) \
+    -o "$OUTPUT_DIR/$name"
+
+  "$OUTPUT_DIR/$name" || FAILED=1
+done
+exit $FAILED
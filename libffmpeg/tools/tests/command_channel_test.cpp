@@ -0,0 +1,240 @@
+//
+// Created on 2025/6/15.
+//
+// CommandChannel 与 generation(epoch) 过滤的压力测试;
+//
+// FFCoreAudioReader 与 FFAudioItem 的 generation 判断都由 CommandConsumer/GenerationGate 完成, 这里直接驱动这两者:
+//  - 控制线程: 随机间隔发送 seek, GenerationGate::request, 每轮最后 stop;
+//  - 读取线程: 按 FFCoreAudioReader::_onRead 的步骤调用 CommandConsumer, 每个样本的内容为 (generation, 媒体位置);
+//  - 渲染线程: 与 FFAudioItem 相同, GenerationGate::isPending 时输出静音, 否则从 fifo 取样本;
+// 断言:
+//  - 渲染线程输出的每个样本都属于当时最新的 generation(不输出过期的数据);
+//  - 每个 generation 输出的第一个样本位于该次 seek 的目标位置, 之后连续;
+//  - 最后一次 seek 最终会生效并输出数据;
+//  - stop 之后不再输出任何样本;
+//
+// 用法: command_channel_test [rounds]
+
+#include "test_common.h"
+#include "CommandChannel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const int PACKET_SAMPLES = 64;
+static const int RENDER_SAMPLES = 256;
+static const size_t FIFO_CAPACITY = 4096;
+static const int MAX_SEEKS_PER_ROUND = 60;
+
+struct Sample {
+    uint64_t generation;
+    int64_t position;
+};
+
+// 随机让出 CPU, 放大各线程交错的可能
+static inline void jitter(std::minstd_rand& rng) {
+    switch ( rng() % 8 ) {
+        case 0: std::this_thread::yield(); break;
+        case 1: std::this_thread::sleep_for(std::chrono::microseconds(rng() % 20)); break;
+        default: break;
+    }
+}
+
+struct Round {
+    FFAV::CommandChannel channel;
+    std::vector<std::atomic<int64_t>> targets;      // generation -> seek 的目标位置
+    FFAV::GenerationGate gate;                      // FFAudioItem::mGenerationGate
+    std::atomic<bool> stop_requested { false };
+
+    std::atomic<bool> finished { false };
+
+    std::mutex mtx;                                 // FFAudioItem::mtx
+    std::deque<Sample> fifo;
+
+    // 渲染线程的统计
+    long emitted { 0 };
+    long emitted_after_stop { 0 };
+    long stale { 0 };
+    long discontinuities { 0 };
+    std::vector<std::pair<uint64_t, int64_t>> first_samples; // 每个 generation 输出的第一个样本
+
+    Round(): targets(MAX_SEEKS_PER_ROUND + 2) {
+        for ( auto& target : targets ) target.store(-1, std::memory_order_relaxed);
+        targets[0].store(0, std::memory_order_relaxed);
+    }
+
+    // FFAudioItem::audioReader:didReadPacket:generation:shouldFlush:
+    void deliver(uint64_t generation, int64_t position, bool should_flush) {
+        if ( gate.isOutdated(generation) ) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if ( gate.isOutdated(generation) ) {
+            return;
+        }
+
+        if ( should_flush ) {
+            fifo.clear();
+            gate.apply(generation);
+        }
+        for ( int i = 0; i < PACKET_SAMPLES; ++i ) {
+            fifo.push_back({ generation, position + i });
+        }
+    }
+
+    bool bufferFull() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return fifo.size() >= FIFO_CAPACITY;
+    }
+
+    // FFCoreAudioReader::_onRead; "媒体文件"从 seek 的位置开始无限长
+    void readLoop(unsigned seed) {
+        std::minstd_rand rng(seed);
+        FFAV::CommandConsumer consumer;
+        int64_t position = 0;
+
+        while ( true ) {
+            bool is_new = false;
+            FFAV::CommandChannel::Command cmd = consumer.next(channel, is_new);
+            if ( cmd.stopped ) {
+                return;
+            }
+
+            if ( is_new ) {
+                if ( cmd.seek_time != AV_NOPTS_VALUE ) {
+                    jitter(rng); // media_reader->seek
+                    position = cmd.seek_time;
+                    if ( consumer.isOutdated(channel) ) {
+                        continue;
+                    }
+                }
+            }
+
+            if ( consumer.hasDelivered() && bufferFull() ) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            jitter(rng); // media_reader->readPacket
+            int64_t packet_position = position;
+            position += PACKET_SAMPLES;
+            if ( consumer.isOutdated(channel) ) {
+                continue;
+            }
+
+            bool should_flush = consumer.deliver();
+            deliver(consumer.getGeneration(), packet_position, should_flush);
+        }
+    }
+
+    // 最后一次 seek 生效并且已输出该 generation 的数据(不会一直停在静音); 超时返回 false
+    bool waitRendered(uint64_t generation) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while ( std::chrono::steady_clock::now() < deadline ) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if ( !first_samples.empty() && first_samples.back().first == generation ) return true;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        return false;
+    }
+
+    // 渲染回调; seek 未生效时输出静音
+    void renderLoop(unsigned seed) {
+        std::minstd_rand rng(seed);
+        uint64_t last_generation = UINT64_MAX;
+        int64_t last_position = 0;
+
+        while ( !finished.load(std::memory_order_acquire) ) {
+            jitter(rng);
+            // 无锁检查, 与 tryTranscode 相同
+            if ( gate.isPending() ) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(mtx);
+            bool stopped = stop_requested.load(std::memory_order_acquire);
+            uint64_t current = gate.getRequested();
+            if ( gate.isPending() ) {
+                continue;
+            }
+
+            for ( int i = 0; i < RENDER_SAMPLES && !fifo.empty(); ++i ) {
+                Sample sample = fifo.front();
+                fifo.pop_front();
+                ++emitted;
+                if ( stopped ) ++emitted_after_stop;
+                if ( sample.generation < current ) ++stale;
+
+                if ( sample.generation != last_generation ) {
+                    first_samples.emplace_back(sample.generation, sample.position);
+                }
+                else if ( sample.position != last_position + 1 ) {
+                    ++discontinuities;
+                }
+                last_generation = sample.generation;
+                last_position = sample.position;
+            }
+        }
+    }
+};
+
+int main(int argc, const char* argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 300;
+    std::minstd_rand rng(20250615);
+
+    long total_seeks = 0, total_emitted = 0, total_generations = 0;
+    for ( int r = 0; r < rounds; ++r ) {
+        Round round;
+        std::thread reader(&Round::readLoop, &round, (unsigned)rng());
+        std::thread renderer(&Round::renderLoop, &round, (unsigned)rng());
+
+        // 连续的 seek, 间隔从 0 到约 1ms 不等; 部分 seek 在上一次生效之前即被覆盖
+        int seeks = 1 + (int)(rng() % MAX_SEEKS_PER_ROUND);
+        uint64_t last_seek = 0;
+        for ( int i = 0; i < seeks; ++i ) {
+            int64_t target = (int64_t)(rng() % 1000000000);
+            uint64_t generation = round.channel.seek(target);
+            round.targets[generation].store(target, std::memory_order_relaxed);
+            round.gate.request(generation);
+            last_seek = generation;
+
+            int pause = (int)(rng() % 4);
+            if ( pause > 0 ) std::this_thread::sleep_for(std::chrono::microseconds(rng() % (300 * pause)));
+        }
+        total_seeks += seeks;
+        TEST_CHECK(round.waitRendered(last_seek));
+
+        uint64_t generation = round.channel.stop();
+        round.gate.request(generation);
+        round.stop_requested.store(true, std::memory_order_release);
+        reader.join();
+        std::this_thread::sleep_for(std::chrono::microseconds(200)); // 给渲染线程留出输出的机会
+        round.finished.store(true, std::memory_order_release);
+        renderer.join();
+
+        TEST_CHECK(round.stale == 0);
+        TEST_CHECK(round.discontinuities == 0);
+        TEST_CHECK(round.emitted_after_stop == 0);
+        for ( auto& [generation, position] : round.first_samples ) {
+            int64_t target = round.targets[generation].load(std::memory_order_relaxed);
+            if ( target != position ) {
+                fprintf(stderr, "round %d: generation %llu started at %lld, expected %lld\n", r, (unsigned long long)generation, (long long)position, (long long)target);
+                ++g_test_failures;
+            }
+        }
+        total_emitted += round.emitted;
+        total_generations += (long)round.first_samples.size();
+    }
+
+    printf("%d rounds, %ld seeks + %d stops, %ld generations rendered, %ld samples checked\n", rounds, total_seeks, rounds, total_generations, total_emitted);
+    return TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+//
+// Created on 2025/6/15.
+//
+// SegmentClipper 的裁剪与定位; 分段解码拼接时每一段必须从起点开始, 不能有缺失:
+//
+//  - 首段从 0 开始, 裁剪到 end_sample, 到达后 reachedEnd;
+//  - 非首段丢弃起点之前(预滚)的样本, 第一个输出的样本正好是 start_sample;
+//  - seek 落在起点之后(第一个 frame 晚于 start_sample)时返回 AVERROR(ERANGE), 没有 pts 时返回 AVERROR(ENOSYS);
+//  - 按 1152 样本的 frame(MP3)模拟多段拼接, 结果与顺序解码一致;
+
+#include "test_common.h"
+#include "SegmentedDecoder.h"
+#include <vector>
+
+using FFAV::SegmentClipper;
+
+static const int FRAME_SAMPLES = 1152;
+
+static void test_first_segment() {
+    SegmentClipper clipper(0, 2000);
+    TEST_CHECK(clipper.getPosition() == 0);
+
+    int offset = -1, count = -1;
+    // 首段不使用 pts
+    TEST_CHECK(clipper.clip(AV_NOPTS_VALUE, FRAME_SAMPLES, offset, count) == 0);
+    TEST_CHECK(offset == 0 && count == FRAME_SAMPLES);
+    TEST_CHECK(!clipper.reachedEnd());
+
+    TEST_CHECK(clipper.clip(AV_NOPTS_VALUE, FRAME_SAMPLES, offset, count) == 0);
+    TEST_CHECK(offset == 0 && count == 2000 - FRAME_SAMPLES);
+    TEST_CHECK(clipper.reachedEnd());
+    TEST_CHECK(clipper.getPosition() == 2 * FRAME_SAMPLES);
+
+    // 到达末尾之后的 frame 整个丢弃
+    TEST_CHECK(clipper.clip(AV_NOPTS_VALUE, FRAME_SAMPLES, offset, count) == 0);
+    TEST_CHECK(count == 0);
+}
+
+static void test_preroll() {
+    // seek 到起点之前 100ms 左右, 第一个 frame 位于 [10000 - 4410, ...)
+    SegmentClipper clipper(10000, -1);
+    TEST_CHECK(clipper.getPosition() == AV_NOPTS_VALUE);
+
+    int64_t frame_position = 10000 - 4410;
+    int offset = -1, count = -1;
+    int emitted_from = -1;
+    for ( int i = 0; i < 6; ++i, frame_position += FRAME_SAMPLES ) {
+        TEST_CHECK(clipper.clip(frame_position, FRAME_SAMPLES, offset, count) == 0);
+        if ( count > 0 && emitted_from < 0 ) {
+            emitted_from = (int)(clipper.getPosition() - FRAME_SAMPLES + offset);
+        }
+    }
+    TEST_CHECK(emitted_from == 10000);
+    TEST_CHECK(!clipper.reachedEnd());
+
+    // 第一个 frame 正好位于起点
+    SegmentClipper exact(10000, 20000);
+    TEST_CHECK(exact.clip(10000, FRAME_SAMPLES, offset, count) == 0);
+    TEST_CHECK(offset == 0 && count == FRAME_SAMPLES);
+}
+
+static void test_late_seek() {
+    int offset = -1, count = -1;
+    // seek 不精确, 第一个 frame 晚于起点; 拼接后 [10000, 10001) 会缺失
+    SegmentClipper late(10000, 20000);
+    TEST_CHECK(late.clip(10001, FRAME_SAMPLES, offset, count) == AVERROR(ERANGE));
+    TEST_CHECK(count == 0);
+    TEST_CHECK(late.getPosition() == AV_NOPTS_VALUE);
+
+    SegmentClipper no_pts(10000, 20000);
+    TEST_CHECK(no_pts.clip(AV_NOPTS_VALUE, FRAME_SAMPLES, offset, count) == AVERROR(ENOSYS));
+
+    // 确定位置之后不再检查 pts
+    SegmentClipper clipper(10000, 20000);
+    TEST_CHECK(clipper.clip(9000, FRAME_SAMPLES, offset, count) == 0);
+    TEST_CHECK(clipper.clip(50000, FRAME_SAMPLES, offset, count) == 0);
+    TEST_CHECK(clipper.getPosition() == 9000 + 2 * FRAME_SAMPLES);
+}
+
+// 三段拼接; 每段从其起点之前的某个 frame 边界开始解码(模拟预滚 seek), 输出的采样位置应连续覆盖 [0, total)
+static void test_stitching() {
+    const int64_t total = 100000;
+    const int64_t boundaries[] = { 0, 33333, 66666 };
+    std::vector<int> coverage(total, 0);
+
+    for ( int i = 0; i < 3; ++i ) {
+        int64_t start = boundaries[i];
+        int64_t end = i + 1 < 3 ? boundaries[i + 1] : -1;
+        SegmentClipper clipper(start, end);
+        int64_t frame_position = start > 0 ? (start - 4410) / FRAME_SAMPLES * FRAME_SAMPLES : 0;
+        while ( frame_position < total && !clipper.reachedEnd() ) {
+            int nb_samples = (int)std::min<int64_t>(FRAME_SAMPLES, total - frame_position);
+            int offset = 0, count = 0;
+            TEST_CHECK(clipper.clip(frame_position, nb_samples, offset, count) == 0);
+            for ( int64_t s = frame_position + offset; s < frame_position + offset + count; ++s ) {
+                ++coverage[s];
+            }
+            frame_position += nb_samples;
+        }
+    }
+
+    bool exact = true;
+    for ( int c : coverage ) exact = exact && c == 1;
+    TEST_CHECK(exact);
+}
+
+int main() {
+    test_first_segment();
+    test_preroll();
+    test_late_seek();
+    test_stitching();
+    return TEST_RESULT();
+}
@@ -0,0 +1,40 @@
+//
+// Created on 2025/6/15.
+//
+// 仅在 Linux 上构建测试时使用; 以标量实现代替 Accelerate 中用到的 vDSP 函数, 使 SJAudioPlayer 中的 C++ 源文件可以直接参与测试;
+// 在 macOS 上 build.sh 不添加该目录, 使用系统的 Accelerate;
+
+#ifndef FFMPEGPROJ_TEST_ACCELERATE_SHIM_H
+#define FFMPEGPROJ_TEST_ACCELERATE_SHIM_H
+
+#include <cstddef>
+
+typedef long vDSP_Stride;
+typedef unsigned long vDSP_Length;
+
+// C[i] = A[i] * B
+inline void vDSP_vsmul(const float* A, vDSP_Stride IA, const float* B, float* C, vDSP_Stride IC, vDSP_Length N) {
+    for ( vDSP_Length i = 0; i < N; ++i ) C[i * IC] = A[i * IA] * *B;
+}
+
+// D[i] = A[i] * B + C[i]
+inline void vDSP_vsma(const float* A, vDSP_Stride IA, const float* B, const float* C, vDSP_Stride IC, float* D, vDSP_Stride ID, vDSP_Length N) {
+    for ( vDSP_Length i = 0; i < N; ++i ) D[i * ID] = A[i * IA] * *B + C[i * IC];
+}
+
+// C[i] = A[i] * B[i]
+inline void vDSP_vmul(const float* A, vDSP_Stride IA, const float* B, vDSP_Stride IB, float* C, vDSP_Stride IC, vDSP_Length N) {
+    for ( vDSP_Length i = 0; i < N; ++i ) C[i * IC] = A[i * IA] * B[i * IB];
+}
+
+// C[i] = A[i] + B[i]
+inline void vDSP_vadd(const float* A, vDSP_Stride IA, const float* B, vDSP_Stride IB, float* C, vDSP_Stride IC, vDSP_Length N) {
+    for ( vDSP_Length i = 0; i < N; ++i ) C[i * IC] = A[i * IA] + B[i * IB];
+}
+
+// C[i] = 0
+inline void vDSP_vclr(float* C, vDSP_Stride IC, vDSP_Length N) {
+    for ( vDSP_Length i = 0; i < N; ++i ) C[i * IC] = 0;
+}
+
+#endif //FFMPEGPROJ_TEST_ACCELERATE_SHIM_H
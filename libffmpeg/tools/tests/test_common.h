@@ -0,0 +1,31 @@
+//
+// Created on 2025/6/15.
+//
+// 测试工具共用的断言; 仅在 tools/tests 中使用;
+
+#ifndef FFMPEGPROJ_TEST_COMMON_H
+#define FFMPEGPROJ_TEST_COMMON_H
+
+#include <cstdio>
+
+static int g_test_failures = 0;
+
+#define TEST_CHECK(cond) do { \
+    if ( !(cond) ) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        ++g_test_failures; \
+    } \
+} while (0)
+
+#define TEST_CHECK_NEAR(a, b, eps) do { \
+    double _a = (a), _b = (b); \
+    if ( !(_a - _b <= (eps) && _b - _a <= (eps)) ) { \
+        fprintf(stderr, "%s:%d: check failed: %s ~= %s (%.9g vs %.9g)\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+        ++g_test_failures; \
+    } \
+} while (0)
+
+// 在 main 的末尾返回
+#define TEST_RESULT() (g_test_failures == 0 ? (printf("✅ %s\n", __FILE__), 0) : (fprintf(stderr, "❌ %d check(s) failed\n", g_test_failures), 1))
+
+#endif //FFMPEGPROJ_TEST_COMMON_H
@@ -0,0 +1,102 @@
+//
+// Created on 2025/6/15.
+//
+// TimeRangeList 的合并规则; 静音裁剪跳过的范围超过 BufferedRanges::MAX_RANGES(16) 时仍然精确:
+//
+//  - 不相接的范围全部保留, 不会合并成覆盖其间(未跳过)音频的范围;
+//  - 重叠或相接的范围合并, 乱序加入时结果相同;
+
+#include "test_common.h"
+#include "TimeRangeList.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using FFAV::TimeRangeList;
+
+// 按 SilenceTrimmer 的方式依次加入 count 段间隙: 每 10s 跳过 [10s*i + 4s, 10s*i + 6s)
+static void test_many_gaps() {
+    const int count = 40;
+    TimeRangeList ranges;
+    for ( int i = 0; i < count; ++i ) {
+        int64_t base = i * 10000000LL;
+        ranges.add(base + 4000000, base + 6000000);
+    }
+
+    std::vector<TimeRangeList::Range> result = ranges.getRanges();
+    TEST_CHECK(result.size() == count);
+    TEST_CHECK(ranges.size() == count);
+    for ( int i = 0; i < (int)result.size(); ++i ) {
+        int64_t base = i * 10000000LL;
+        TEST_CHECK(result[i].start == base + 4000000);
+        TEST_CHECK(result[i].end == base + 6000000);
+    }
+
+    // 任意两段之间的音频都不在结果中
+    for ( int i = 0; i + 1 < (int)result.size(); ++i ) {
+        TEST_CHECK(result[i].end < result[i + 1].start);
+    }
+
+    ranges.clear();
+    TEST_CHECK(ranges.getRanges().empty());
+}
+
+static void test_merge() {
+    TimeRangeList ranges;
+    ranges.add(100, 200);
+    ranges.add(300, 400);
+    ranges.add(500, 600);
+    ranges.add(50, 50);    // 空范围忽略
+    ranges.add(700, 650);
+    TEST_CHECK(ranges.size() == 3);
+
+    // 相接
+    ranges.add(200, 250);
+    // 跨越两个范围
+    ranges.add(350, 550);
+    std::vector<TimeRangeList::Range> result = ranges.getRanges();
+    TEST_CHECK(result.size() == 2);
+    TEST_CHECK(result[0].start == 100 && result[0].end == 250);
+    TEST_CHECK(result[1].start == 300 && result[1].end == 600);
+
+    // 包含在已有范围中
+    ranges.add(320, 330);
+    // 覆盖全部
+    ranges.add(0, 1000);
+    result = ranges.getRanges();
+    TEST_CHECK(result.size() == 1);
+    TEST_CHECK(result[0].start == 0 && result[0].end == 1000);
+}
+
+// 乱序加入时结果与按位图计算的并集一致
+static void test_random_order() {
+    const int length = 2000;
+    std::minstd_rand rng(20250615);
+    for ( int round = 0; round < 200; ++round ) {
+        TimeRangeList ranges;
+        std::vector<bool> covered(length, false);
+        int count = 1 + (int)(rng() % 60);
+        for ( int i = 0; i < count; ++i ) {
+            int start = (int)(rng() % length);
+            int end = std::min(length, start + 1 + (int)(rng() % 40));
+            ranges.add(start, end);
+            std::fill(covered.begin() + start, covered.begin() + end, true);
+        }
+
+        std::vector<bool> actual(length, false);
+        std::vector<TimeRangeList::Range> result = ranges.getRanges();
+        for ( int i = 0; i < (int)result.size(); ++i ) {
+            std::fill(actual.begin() + result[i].start, actual.begin() + result[i].end, true);
+            // 有序且不相接
+            if ( i > 0 ) TEST_CHECK(result[i - 1].end < result[i].start);
+        }
+        TEST_CHECK(actual == covered);
+    }
+}
+
+int main() {
+    test_many_gaps();
+    test_merge();
+    test_random_order();
+    return TEST_RESULT();
+}
@@ -0,0 +1,242 @@
+//
+// Created on 2025/6/15.
+//
+// AudioUtils::transcodePackets 稳态下的内存分配;
+//
+// 替换全局 operator new 与 malloc 系列函数(glibc), 统计转码 N 个 packet 期间的分配次数:
+//  - operator new 必须为 0: 流水线本身(模板展开的 sink、handle)不产生任何 C++ 分配;
+//  - malloc 不超过直接调用 FFmpeg API 的同等流程: avcodec/libavfilter 内部每帧都会创建 AVBufferRef, 这部分不可避免,
+//    但流水线不能额外增加(例如 AV_BUFFERSRC_FLAG_KEEP_REF 会为每帧多创建一份引用);
+//
+// 输入为手工构造的 pcm_s16le(48000Hz, stereo) packet, 经 aresample 转为 44100Hz fltp;
+
+#include "test_common.h"
+#include "AudioUtils.h"
+#include "FilterGraph.h"
+#include "MediaDecoder.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavutil/log.h>
+}
+
+// 分配统计
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<bool> g_counting { false };
+static std::atomic<long> g_new_count { 0 };
+static std::atomic<long> g_malloc_count { 0 };
+
+static inline void count_malloc() {
+    if ( g_counting.load(std::memory_order_relaxed) ) g_malloc_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" {
+void* malloc(size_t size) { count_malloc(); return __libc_malloc(size); }
+void* calloc(size_t n, size_t size) { count_malloc(); return __libc_calloc(n, size); }
+void* realloc(void* ptr, size_t size) { count_malloc(); return __libc_realloc(ptr, size); }
+void* memalign(size_t alignment, size_t size) { count_malloc(); return __libc_memalign(alignment, size); }
+void* aligned_alloc(size_t alignment, size_t size) { count_malloc(); return __libc_memalign(alignment, size); }
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    count_malloc();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+void free(void* ptr) { __libc_free(ptr); }
+}
+
+static void* count_new(size_t size) {
+    if ( g_counting.load(std::memory_order_relaxed) ) g_new_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = __libc_malloc(size ? size : 1);
+    if ( ptr == nullptr ) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size) { return count_new(size); }
+void* operator new[](size_t size) { return count_new(size); }
+void operator delete(void* ptr) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { __libc_free(ptr); }
+
+// 转码流程
+
+static const int IN_SAMPLE_RATE = 48000;
+static const int OUT_SAMPLE_RATE = 44100;
+static const int PACKET_SAMPLES = 1152;
+static const int WARMUP_PACKETS = 200;
+static const int MEASURE_PACKETS = 2000;
+
+struct Pipeline {
+    FFAV::MediaDecoder decoder;
+    FFAV::FilterGraph graph;
+    FFAV::BufferSourceHandle src;
+    FFAV::BufferSinkHandle sink;
+    AVFrame* dec_frame { av_frame_alloc() };
+    AVFrame* filt_frame { av_frame_alloc() };
+    int64_t nb_output_samples { 0 };
+
+    ~Pipeline() {
+        av_frame_free(&dec_frame);
+        av_frame_free(&filt_frame);
+    }
+
+    int init(AVCodecParameters* codecpar) {
+        int ret = decoder.init(codecpar);
+        if ( ret < 0 ) return ret;
+
+        AVBufferSrcParameters* params = decoder.createBufferSrcParameters({ 1, IN_SAMPLE_RATE });
+        if ( params == nullptr ) return AVERROR(ENOMEM);
+        ret = graph.init();
+        if ( ret >= 0 ) ret = graph.addBufferSourceFilter("in", AVMEDIA_TYPE_AUDIO, params);
+        av_free(params);
+        if ( ret >= 0 ) ret = graph.addAudioBufferSinkFilter("out", OUT_SAMPLE_RATE, AV_SAMPLE_FMT_FLTP, "stereo");
+        if ( ret >= 0 ) ret = graph.parse("[in]aresample=44100,aformat=sample_fmts=fltp:channel_layouts=stereo[out]");
+        if ( ret >= 0 ) ret = graph.configure();
+        src = graph.getBufferSource("in");
+        sink = graph.getBufferSink("out");
+        return ret;
+    }
+};
+
+// 循环使用预先生成的 packet; 引用 packet 的分配属于输入端(demuxer), 不计入
+struct PacketSource {
+    std::vector<AVPacket*> packets;
+    AVPacket* pkt { av_packet_alloc() };
+    int64_t next { 0 };
+    int64_t end { 0 };
+
+    ~PacketSource() {
+        for ( AVPacket* p : packets ) av_packet_free(&p);
+        av_packet_free(&pkt);
+    }
+
+    bool make(int count) {
+        for ( int i = 0; i < count; ++i ) {
+            AVPacket* p = av_packet_alloc();
+            if ( p == nullptr || av_new_packet(p, PACKET_SAMPLES * 2 * sizeof(int16_t)) < 0 ) {
+                av_packet_free(&p);
+                return false;
+            }
+            int16_t* data = (int16_t*)p->data;
+            for ( int s = 0; s < PACKET_SAMPLES * 2; ++s ) {
+                data[s] = (int16_t)((s * 7919 + i * 104729) % 20000 - 10000);
+            }
+            packets.push_back(p);
+        }
+        return true;
+    }
+
+    // 返回 false 表示本轮的 packet 已用完
+    bool next_packet(AVPacket*& out) {
+        if ( next >= end ) {
+            return false;
+        }
+        bool counting = g_counting.exchange(false);
+        av_packet_ref(pkt, packets[next % packets.size()]);
+        pkt->pts = pkt->dts = next * PACKET_SAMPLES;
+        pkt->duration = PACKET_SAMPLES;
+        g_counting.store(counting);
+        ++next;
+        out = pkt;
+        return true;
+    }
+};
+
+// 直接调用 FFmpeg API 的同等流程, 作为分配次数的基准
+static int transfer_direct(Pipeline& p, PacketSource& packets) {
+    AVPacket* pkt = nullptr;
+    int ret = 0;
+    while ( ret >= 0 && packets.next_packet(pkt) ) {
+        ret = p.decoder.send(pkt);
+        av_packet_unref(pkt);
+        while ( ret >= 0 && (ret = p.decoder.receive(p.dec_frame)) >= 0 ) {
+            ret = av_buffersrc_add_frame_flags(p.src.filter_ctx, p.dec_frame, 0);
+            av_frame_unref(p.dec_frame);
+            while ( ret >= 0 && (ret = av_buffersink_get_frame(p.sink.filter_ctx, p.filt_frame)) >= 0 ) {
+                p.nb_output_samples += p.filt_frame->nb_samples;
+                av_frame_unref(p.filt_frame);
+            }
+            if ( ret == AVERROR(EAGAIN) ) ret = 0;
+        }
+        if ( ret == AVERROR(EAGAIN) ) ret = 0;
+    }
+    return ret;
+}
+
+static int transfer_pipeline(Pipeline& p, PacketSource& packets) {
+    return FFAV::AudioUtils::transcodePackets([&](AVPacket*& pkt) { return packets.next_packet(pkt); },
+        &p.decoder, p.dec_frame, &p.graph, p.filt_frame, p.src, p.sink, [&](AVFrame* frame) {
+            p.nb_output_samples += frame->nb_samples;
+            return 0;
+        });
+}
+
+// 预热(填充各级 buffer pool)后统计 MEASURE_PACKETS 个 packet 的分配次数
+template <typename Transfer>
+static bool measure(AVCodecParameters* codecpar, Transfer&& transfer, long& nb_new, long& nb_malloc, int64_t& nb_samples) {
+    Pipeline p;
+    PacketSource packets;
+    if ( p.init(codecpar) < 0 || !packets.make(16) ) {
+        return false;
+    }
+
+    packets.end = WARMUP_PACKETS;
+    if ( transfer(p, packets) < 0 ) {
+        return false;
+    }
+
+    int64_t warmup_samples = p.nb_output_samples;
+    packets.end += MEASURE_PACKETS;
+    g_new_count = 0;
+    g_malloc_count = 0;
+    g_counting = true;
+    int ret = transfer(p, packets);
+    g_counting = false;
+    nb_new = g_new_count;
+    nb_malloc = g_malloc_count;
+    nb_samples = p.nb_output_samples - warmup_samples;
+    return ret >= 0;
+}
+
+int main() {
+    av_log_set_level(AV_LOG_ERROR);
+
+    AVCodecParameters* codecpar = avcodec_parameters_alloc();
+    codecpar->codec_type = AVMEDIA_TYPE_AUDIO;
+    codecpar->codec_id = AV_CODEC_ID_PCM_S16LE;
+    codecpar->format = AV_SAMPLE_FMT_S16;
+    codecpar->sample_rate = IN_SAMPLE_RATE;
+    av_channel_layout_default(&codecpar->ch_layout, 2);
+
+    long direct_new = 0, direct_malloc = 0;
+    long pipeline_new = 0, pipeline_malloc = 0;
+    int64_t direct_samples = 0, pipeline_samples = 0;
+    TEST_CHECK(measure(codecpar, transfer_direct, direct_new, direct_malloc, direct_samples));
+    TEST_CHECK(measure(codecpar, transfer_pipeline, pipeline_new, pipeline_malloc, pipeline_samples));
+    avcodec_parameters_free(&codecpar);
+
+    printf("%d packets: direct %ld malloc, pipeline %ld malloc / %ld new\n", MEASURE_PACKETS, direct_malloc, pipeline_malloc, pipeline_new);
+
+    // 输出了 MEASURE_PACKETS 个 packet 对应的数据(aresample 内部的延迟在 ±1 帧之内)
+    int64_t expected = (int64_t)MEASURE_PACKETS * PACKET_SAMPLES * OUT_SAMPLE_RATE / IN_SAMPLE_RATE;
+    TEST_CHECK_NEAR(pipeline_samples, expected, PACKET_SAMPLES);
+    TEST_CHECK(pipeline_samples == direct_samples);
+
+    TEST_CHECK(pipeline_new == 0);
+    TEST_CHECK(pipeline_malloc <= direct_malloc);
+    return TEST_RESULT();
+}